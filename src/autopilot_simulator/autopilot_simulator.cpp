@@ -0,0 +1,1791 @@
+#include "autopilot_simulator.h"
+#include "global_include.h"
+#include "log.h"
+#include "loopback_connection.h"
+
+#ifdef WINDOWS
+#include <winsock2.h>
+#include <Ws2tcpip.h>
+#ifndef MINGW
+#pragma comment(lib, "Ws2_32.lib")
+#endif
+#else
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#ifdef WINDOWS
+#define GET_ERROR(_x) WSAGetLastError()
+#else
+#define GET_ERROR(_x) strerror(_x)
+#endif
+
+namespace mavsdk {
+
+namespace {
+
+// The MAVLink FTP payload, see FtpImpl for the client side.
+namespace ftp {
+
+enum Opcode : uint8_t {
+    CMD_NONE,
+    CMD_TERMINATE_SESSION,
+    CMD_RESET_SESSIONS,
+    CMD_LIST_DIRECTORY,
+    CMD_OPEN_FILE_RO,
+    CMD_READ_FILE,
+    CMD_CREATE_FILE,
+    CMD_WRITE_FILE,
+    CMD_REMOVE_FILE,
+    CMD_CREATE_DIRECTORY,
+    CMD_REMOVE_DIRECTORY,
+    CMD_OPEN_FILE_WO,
+    CMD_TRUNCATE_FILE,
+    CMD_RENAME,
+    CMD_CALC_FILE_CRC32,
+    CMD_BURST_READ_FILE,
+
+    RSP_ACK = 128,
+    RSP_NAK
+};
+
+enum ServerResult : uint8_t {
+    SUCCESS,
+    ERR_FAIL,
+    ERR_FAIL_ERRNO,
+    ERR_INVALID_DATA_SIZE,
+    ERR_INVALID_SESSION,
+    ERR_NO_SESSIONS_AVAILABLE,
+    ERR_EOF,
+    ERR_UNKOWN_COMMAND,
+    ERR_FAIL_FILE_EXISTS,
+    ERR_FAIL_FILE_PROTECTED,
+    ERR_FAIL_FILE_DOES_NOT_EXIST,
+};
+
+// Offsets in the payload, which is packed.
+constexpr std::size_t seq_number_offset = 0;
+constexpr std::size_t session_offset = 2;
+constexpr std::size_t opcode_offset = 3;
+constexpr std::size_t size_offset = 4;
+constexpr std::size_t req_opcode_offset = 5;
+constexpr std::size_t burst_complete_offset = 6;
+constexpr std::size_t offset_offset = 8;
+constexpr std::size_t data_offset = 12;
+constexpr std::size_t max_data_length = 239;
+constexpr std::size_t payload_length = data_offset + max_data_length;
+
+uint16_t get_u16(const uint8_t* payload, std::size_t offset)
+{
+    return uint16_t(payload[offset] | (payload[offset + 1] << 8));
+}
+
+uint32_t get_u32(const uint8_t* payload, std::size_t offset)
+{
+    return uint32_t(payload[offset]) | (uint32_t(payload[offset + 1]) << 8) |
+           (uint32_t(payload[offset + 2]) << 16) | (uint32_t(payload[offset + 3]) << 24);
+}
+
+void set_u16(uint8_t* payload, std::size_t offset, uint16_t value)
+{
+    payload[offset] = uint8_t(value);
+    payload[offset + 1] = uint8_t(value >> 8);
+}
+
+void set_u32(uint8_t* payload, std::size_t offset, uint32_t value)
+{
+    for (std::size_t i = 0; i < 4; ++i) {
+        payload[offset + i] = uint8_t(value >> (8 * i));
+    }
+}
+
+// Path in the data, which is not necessarily null-terminated.
+std::string get_path(const uint8_t* payload)
+{
+    const char* data = reinterpret_cast<const char*>(&payload[data_offset]);
+    const std::size_t size = std::min<std::size_t>(payload[size_offset], max_data_length);
+    return std::string(data, strnlen(data, size));
+}
+
+// Same as Crc32 used by the FTP plugin and PX4.
+uint32_t crc32(const std::vector<uint8_t>& content)
+{
+    static const auto table = []() {
+        std::vector<uint32_t> result(256);
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                value = (value & 1) ? (0xEDB88320 ^ (value >> 1)) : (value >> 1);
+            }
+            result[i] = value;
+        }
+        return result;
+    }();
+
+    uint32_t value = 0;
+    for (const auto byte : content) {
+        value = table[(value ^ byte) & 0xff] ^ (value >> 8);
+    }
+    return value;
+}
+
+} // namespace ftp
+
+// Circle flown around home.
+constexpr double home_latitude_deg = 47.397742;
+constexpr double home_longitude_deg = 8.545594;
+constexpr float home_altitude_m = 488.0f;
+constexpr float flight_altitude_m = 10.0f;
+constexpr double circle_radius_m = 50.0;
+constexpr double circle_rate_rad_s = 0.1;
+constexpr double earth_radius_m = 6371000.0;
+
+// Log data sent at once when not rate limited, so requests in between get their turn.
+constexpr unsigned max_log_data_per_turn = 64;
+
+bool is_streamable(uint32_t msgid)
+{
+    switch (msgid) {
+        case MAVLINK_MSG_ID_HEARTBEAT:
+        case MAVLINK_MSG_ID_SYS_STATUS:
+        case MAVLINK_MSG_ID_EXTENDED_SYS_STATE:
+        case MAVLINK_MSG_ID_HOME_POSITION:
+        case MAVLINK_MSG_ID_GPS_RAW_INT:
+        case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+        case MAVLINK_MSG_ID_LOCAL_POSITION_NED:
+        case MAVLINK_MSG_ID_ATTITUDE:
+        case MAVLINK_MSG_ID_ATTITUDE_QUATERNION:
+        case MAVLINK_MSG_ID_MISSION_CURRENT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+AutopilotSimulator::AutopilotSimulator(const Config& config) :
+    _config(config),
+    _receive_random(config.random_seed + 1),
+    _random(config.random_seed)
+{
+    add_param("SYS_AUTOSTART", int32_t(4001));
+    add_param("SYS_HITL", int32_t(0));
+    add_param("COM_RC_IN_MODE", int32_t(1));
+    add_param("NAV_RCL_ACT", int32_t(2));
+    add_param("BAT1_N_CELLS", int32_t(4));
+    add_param("CAL_ACC0_ID", int32_t(1310988));
+    add_param("MPC_XY_CRUISE", 5.0f);
+    add_param("MIS_TAKEOFF_ALT", 2.5f);
+
+    for (unsigned i = 0; i < _config.num_extra_params; ++i) {
+        // Param ids are at most 16 characters.
+        char id[32];
+        snprintf(id, sizeof(id), "SIM_PARAM_%04u", i % 10000);
+        add_param(id, float(i));
+    }
+}
+
+AutopilotSimulator::~AutopilotSimulator()
+{
+    stop();
+}
+
+bool AutopilotSimulator::start_udp(const std::string& remote_ip, int remote_port)
+{
+#ifdef WINDOWS
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        LogErr() << "Error: Winsock failed, error: " << WSAGetLastError();
+        return false;
+    }
+#endif
+
+    _socket_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (_socket_fd < 0) {
+        LogErr() << "socket error" << GET_ERROR(errno);
+        return false;
+    }
+
+    struct sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    inet_pton(AF_INET, "0.0.0.0", &(addr.sin_addr));
+    addr.sin_port = 0;
+
+    if (bind(_socket_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        LogErr() << "bind error: " << GET_ERROR(errno);
+        return false;
+    }
+
+    _remote_ip = remote_ip;
+    _remote_port = remote_port;
+
+    _udp_receive_thread = new std::thread(&AutopilotSimulator::udp_receive, this);
+    start(std::bind(&AutopilotSimulator::send_udp, this, std::placeholders::_1));
+    return true;
+}
+
+bool AutopilotSimulator::start_loopback(const std::string& name)
+{
+    _loopback_connection.reset(new LoopbackConnection(
+        [this](mavlink_message_t& message, Connection*) { receive(message); }, name));
+    if (_loopback_connection->start() != ConnectionResult::Success) {
+        _loopback_connection.reset();
+        return false;
+    }
+
+    auto* connection = _loopback_connection.get();
+    start([connection](const mavlink_message_t& message) { connection->send_message(message); });
+    return true;
+}
+
+void AutopilotSimulator::start(SendFunction send)
+{
+    _send_function = send;
+    _should_exit = false;
+    _thread = new std::thread(&AutopilotSimulator::run, this);
+}
+
+void AutopilotSimulator::stop()
+{
+    _should_exit = true;
+
+    if (_thread != nullptr) {
+        _inbox_cv.notify_all();
+        _thread->join();
+        delete _thread;
+        _thread = nullptr;
+    }
+
+    if (_loopback_connection) {
+        _loopback_connection->stop();
+        _loopback_connection.reset();
+    }
+
+    if (_socket_fd >= 0) {
+#ifndef WINDOWS
+        shutdown(_socket_fd, SHUT_RDWR);
+        close(_socket_fd);
+#else
+        shutdown(_socket_fd, SD_BOTH);
+        closesocket(_socket_fd);
+        WSACleanup();
+#endif
+        _socket_fd = -1;
+    }
+
+    if (_udp_receive_thread != nullptr) {
+        _udp_receive_thread->join();
+        delete _udp_receive_thread;
+        _udp_receive_thread = nullptr;
+    }
+}
+
+void AutopilotSimulator::send_udp(const mavlink_message_t& message)
+{
+    struct sockaddr_in dest_addr {};
+    dest_addr.sin_family = AF_INET;
+    inet_pton(AF_INET, _remote_ip.c_str(), &dest_addr.sin_addr.s_addr);
+    dest_addr.sin_port = htons(_remote_port);
+
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+
+    const auto send_len = sendto(
+        _socket_fd,
+        reinterpret_cast<char*>(buffer),
+        buffer_len,
+        0,
+        reinterpret_cast<const sockaddr*>(&dest_addr),
+        sizeof(dest_addr));
+
+    if (send_len != buffer_len) {
+        LogErr() << "sendto failure: " << GET_ERROR(errno);
+    }
+}
+
+void AutopilotSimulator::udp_receive()
+{
+    // We don't use a MAVLink channel, there are not enough for many
+    // simulators, but keep the parser state ourselves.
+    mavlink_message_t parse_buffer{};
+    mavlink_status_t parse_status{};
+    mavlink_message_t message{};
+
+    // Enough for MTU 1500 bytes.
+    char buffer[2048];
+
+    while (!_should_exit) {
+        const auto recv_len = recvfrom(_socket_fd, buffer, sizeof(buffer), 0, nullptr, nullptr);
+        if (recv_len <= 0) {
+            // Happens on stop when the socket is closed.
+            continue;
+        }
+
+        for (auto i = decltype(recv_len){0}; i < recv_len; ++i) {
+            if (mavlink_frame_char_buffer(
+                    &parse_buffer, &parse_status, uint8_t(buffer[i]), &message, nullptr) ==
+                MAVLINK_FRAMING_OK) {
+                receive(message);
+            }
+        }
+    }
+}
+
+void AutopilotSimulator::receive(const mavlink_message_t& message)
+{
+    std::lock_guard<std::mutex> lock(_inbox_mutex);
+
+    if (is_lost(_receive_random)) {
+        ++_num_lost;
+        return;
+    }
+    ++_num_received;
+
+    DelayedMessage delayed{};
+    delayed.due_time = Clock::now() + _config.latency;
+    delayed.message = message;
+    _inbox.push_back(delayed);
+    _inbox_cv.notify_one();
+}
+
+bool AutopilotSimulator::is_lost(std::mt19937& random)
+{
+    if (_link_down) {
+        return true;
+    }
+    if (_config.loss_ratio <= 0.0) {
+        return false;
+    }
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    return uniform(random) < _config.loss_ratio;
+}
+
+void AutopilotSimulator::run()
+{
+    _start_time = Clock::now();
+
+    for (const auto& rate : _config.telemetry_rates_hz) {
+        if (rate.second > 0.0 && is_streamable(rate.first)) {
+            Stream stream{};
+            stream.interval = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(1.0 / rate.second));
+            stream.next_time = _start_time;
+            _streams[rate.first] = stream;
+        }
+    }
+
+    std::vector<mavlink_message_t> received;
+
+    while (!_should_exit) {
+        auto now = Clock::now();
+
+        received.clear();
+        {
+            std::lock_guard<std::mutex> lock(_inbox_mutex);
+            while (!_inbox.empty() && _inbox.front().due_time <= now) {
+                received.push_back(_inbox.front().message);
+                _inbox.pop_front();
+            }
+        }
+        for (const auto& message : received) {
+            process_message(message);
+        }
+        send_changed_camera_params();
+
+        const auto next_stream_time = send_due_streams();
+        const auto next_log_data_time = send_due_log_data();
+        const auto next_outbox_time = flush_due_messages();
+
+        auto wakeup_time = std::min(next_stream_time, next_outbox_time);
+        wakeup_time = std::min(wakeup_time, next_log_data_time);
+        wakeup_time = std::min(wakeup_time, Clock::now() + std::chrono::milliseconds(100));
+
+        std::unique_lock<std::mutex> lock(_inbox_mutex);
+        if (!_inbox.empty()) {
+            wakeup_time = std::min(wakeup_time, _inbox.front().due_time);
+        }
+        if (!_should_exit && wakeup_time > Clock::now()) {
+            // Woken up early for anything received.
+            _inbox_cv.wait_until(lock, wakeup_time);
+        }
+    }
+}
+
+AutopilotSimulator::Clock::time_point AutopilotSimulator::send_due_streams()
+{
+    auto next_time = Clock::time_point::max();
+    const auto now = Clock::now();
+
+    for (auto& entry : _streams) {
+        auto& stream = entry.second;
+        if (stream.next_time <= now) {
+            send_stream(entry.first);
+            stream.next_time += stream.interval;
+            if (stream.next_time <= now) {
+                // We fell behind, don't try to catch up with a burst.
+                stream.next_time = now + stream.interval;
+            }
+        }
+        next_time = std::min(next_time, stream.next_time);
+    }
+
+    return next_time;
+}
+
+AutopilotSimulator::Clock::time_point AutopilotSimulator::flush_due_messages()
+{
+    const auto now = Clock::now();
+
+    while (!_outbox.empty() && _outbox.front().due_time <= now) {
+        _send_function(_outbox.front().message);
+        ++_num_sent;
+        _outbox.pop_front();
+    }
+
+    return _outbox.empty() ? Clock::time_point::max() : _outbox.front().due_time;
+}
+
+void AutopilotSimulator::send(const mavlink_message_t& message)
+{
+    if (is_lost(_random)) {
+        ++_num_lost;
+        return;
+    }
+
+    if (_config.latency.count() == 0) {
+        _send_function(message);
+        ++_num_sent;
+        return;
+    }
+
+    // The latency is constant, so this stays in order.
+    DelayedMessage delayed{};
+    delayed.due_time = Clock::now() + _config.latency;
+    delayed.message = message;
+    _outbox.push_back(delayed);
+}
+
+uint32_t AutopilotSimulator::time_boot_ms() const
+{
+    return uint32_t(
+        std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - _start_time).count());
+}
+
+bool AutopilotSimulator::send_stream(uint32_t msgid)
+{
+    const uint8_t system_id = _config.system_id;
+    const uint8_t component_id = _config.component_id;
+
+    // Flying a circle around home.
+    const double t = double(time_boot_ms()) / 1000.0;
+    const double angle = circle_rate_rad_s * t;
+    const double north_m = circle_radius_m * std::cos(angle);
+    const double east_m = circle_radius_m * std::sin(angle);
+    const double speed_m_s = circle_radius_m * circle_rate_rad_s;
+    const double velocity_north_m_s = -speed_m_s * std::sin(angle);
+    const double velocity_east_m_s = speed_m_s * std::cos(angle);
+    const double yaw = std::atan2(velocity_east_m_s, velocity_north_m_s);
+    const double latitude_deg = home_latitude_deg + north_m / earth_radius_m * 180.0 / M_PI;
+    const double longitude_deg =
+        home_longitude_deg +
+        east_m / (earth_radius_m * std::cos(home_latitude_deg * M_PI / 180.0)) * 180.0 / M_PI;
+
+    mavlink_message_t message;
+
+    switch (msgid) {
+        case MAVLINK_MSG_ID_HEARTBEAT: {
+            mavlink_heartbeat_t heartbeat{};
+            heartbeat.type = MAV_TYPE_QUADROTOR;
+            heartbeat.autopilot = MAV_AUTOPILOT_PX4;
+            heartbeat.base_mode = MAV_MODE_FLAG_CUSTOM_MODE_ENABLED |
+                                  (_armed ? MAV_MODE_FLAG_SAFETY_ARMED : 0);
+            heartbeat.custom_mode = _custom_mode;
+            heartbeat.system_status = _armed ? MAV_STATE_ACTIVE : MAV_STATE_STANDBY;
+            heartbeat.mavlink_version = 3;
+            mavlink_msg_heartbeat_encode(system_id, component_id, &message, &heartbeat);
+            if (has_camera()) {
+                send_camera_heartbeat();
+            }
+            break;
+        }
+        case MAVLINK_MSG_ID_SYS_STATUS: {
+            mavlink_sys_status_t sys_status{};
+            sys_status.load = 300;
+            sys_status.voltage_battery = 16200;
+            sys_status.current_battery = 1000;
+            sys_status.battery_remaining = 80;
+            mavlink_msg_sys_status_encode(system_id, component_id, &message, &sys_status);
+            break;
+        }
+        case MAVLINK_MSG_ID_EXTENDED_SYS_STATE: {
+            mavlink_extended_sys_state_t extended_sys_state{};
+            extended_sys_state.vtol_state = MAV_VTOL_STATE_UNDEFINED;
+            extended_sys_state.landed_state =
+                _armed ? MAV_LANDED_STATE_IN_AIR : MAV_LANDED_STATE_ON_GROUND;
+            mavlink_msg_extended_sys_state_encode(
+                system_id, component_id, &message, &extended_sys_state);
+            break;
+        }
+        case MAVLINK_MSG_ID_HOME_POSITION: {
+            mavlink_home_position_t home_position{};
+            home_position.latitude = int32_t(home_latitude_deg * 1e7);
+            home_position.longitude = int32_t(home_longitude_deg * 1e7);
+            home_position.altitude = int32_t(home_altitude_m * 1e3f);
+            home_position.q[0] = 1.0f;
+            mavlink_msg_home_position_encode(system_id, component_id, &message, &home_position);
+            break;
+        }
+        case MAVLINK_MSG_ID_GPS_RAW_INT: {
+            mavlink_gps_raw_int_t gps_raw_int{};
+            gps_raw_int.time_usec = uint64_t(t * 1e6);
+            gps_raw_int.fix_type = GPS_FIX_TYPE_3D_FIX;
+            gps_raw_int.lat = int32_t(latitude_deg * 1e7);
+            gps_raw_int.lon = int32_t(longitude_deg * 1e7);
+            gps_raw_int.alt = int32_t((home_altitude_m + flight_altitude_m) * 1e3f);
+            gps_raw_int.eph = 80;
+            gps_raw_int.epv = 120;
+            gps_raw_int.vel = uint16_t(speed_m_s * 100.0);
+            gps_raw_int.cog = uint16_t(std::fmod(yaw * 180.0 / M_PI + 360.0, 360.0) * 100.0);
+            gps_raw_int.satellites_visible = 12;
+            mavlink_msg_gps_raw_int_encode(system_id, component_id, &message, &gps_raw_int);
+            break;
+        }
+        case MAVLINK_MSG_ID_GLOBAL_POSITION_INT: {
+            mavlink_global_position_int_t global_position_int{};
+            global_position_int.time_boot_ms = time_boot_ms();
+            global_position_int.lat = int32_t(latitude_deg * 1e7);
+            global_position_int.lon = int32_t(longitude_deg * 1e7);
+            global_position_int.alt = int32_t((home_altitude_m + flight_altitude_m) * 1e3f);
+            global_position_int.relative_alt = int32_t(flight_altitude_m * 1e3f);
+            global_position_int.vx = int16_t(velocity_north_m_s * 100.0);
+            global_position_int.vy = int16_t(velocity_east_m_s * 100.0);
+            global_position_int.hdg =
+                uint16_t(std::fmod(yaw * 180.0 / M_PI + 360.0, 360.0) * 100.0);
+            mavlink_msg_global_position_int_encode(
+                system_id, component_id, &message, &global_position_int);
+            break;
+        }
+        case MAVLINK_MSG_ID_LOCAL_POSITION_NED: {
+            mavlink_local_position_ned_t local_position_ned{};
+            local_position_ned.time_boot_ms = time_boot_ms();
+            local_position_ned.x = float(north_m);
+            local_position_ned.y = float(east_m);
+            local_position_ned.z = -flight_altitude_m;
+            local_position_ned.vx = float(velocity_north_m_s);
+            local_position_ned.vy = float(velocity_east_m_s);
+            mavlink_msg_local_position_ned_encode(
+                system_id, component_id, &message, &local_position_ned);
+            break;
+        }
+        case MAVLINK_MSG_ID_ATTITUDE: {
+            mavlink_attitude_t attitude{};
+            attitude.time_boot_ms = time_boot_ms();
+            attitude.roll = 0.05f;
+            attitude.yaw = float(yaw);
+            attitude.yawspeed = float(circle_rate_rad_s);
+            mavlink_msg_attitude_encode(system_id, component_id, &message, &attitude);
+            break;
+        }
+        case MAVLINK_MSG_ID_ATTITUDE_QUATERNION: {
+            mavlink_attitude_quaternion_t attitude_quaternion{};
+            attitude_quaternion.time_boot_ms = time_boot_ms();
+            attitude_quaternion.q1 = float(std::cos(yaw / 2.0));
+            attitude_quaternion.q4 = float(std::sin(yaw / 2.0));
+            attitude_quaternion.yawspeed = float(circle_rate_rad_s);
+            mavlink_msg_attitude_quaternion_encode(
+                system_id, component_id, &message, &attitude_quaternion);
+            break;
+        }
+        case MAVLINK_MSG_ID_MISSION_CURRENT: {
+            mavlink_mission_current_t mission_current{};
+            mission_current.seq = _current_mission_item;
+            mavlink_msg_mission_current_encode(system_id, component_id, &message, &mission_current);
+            break;
+        }
+        default:
+            return false;
+    }
+
+    send(message);
+    return true;
+}
+
+bool AutopilotSimulator::is_for_us(uint8_t target_system, uint8_t target_component) const
+{
+    return (target_system == 0 || target_system == _config.system_id) &&
+           (target_component == 0 || target_component == _config.component_id);
+}
+
+void AutopilotSimulator::process_message(const mavlink_message_t& message)
+{
+    if (message.sysid == _config.system_id && message.compid == _config.component_id) {
+        // Our own, e.g. on a shared link.
+        return;
+    }
+
+    _peer_system_id = message.sysid;
+    _peer_component_id = message.compid;
+
+    switch (message.msgid) {
+        case MAVLINK_MSG_ID_COMMAND_LONG:
+            process_command_long(message);
+            break;
+        case MAVLINK_MSG_ID_COMMAND_INT:
+            process_command_int(message);
+            break;
+        case MAVLINK_MSG_ID_TIMESYNC:
+            process_timesync(message);
+            break;
+        case MAVLINK_MSG_ID_PARAM_REQUEST_LIST:
+            process_param_request_list(message);
+            break;
+        case MAVLINK_MSG_ID_PARAM_REQUEST_READ:
+            process_param_request_read(message);
+            break;
+        case MAVLINK_MSG_ID_PARAM_SET:
+            process_param_set(message);
+            break;
+        case MAVLINK_MSG_ID_MISSION_COUNT:
+            process_mission_count(message);
+            break;
+        case MAVLINK_MSG_ID_MISSION_ITEM_INT:
+            process_mission_item_int(message);
+            break;
+        case MAVLINK_MSG_ID_MISSION_REQUEST_LIST:
+            process_mission_request_list(message);
+            break;
+        case MAVLINK_MSG_ID_MISSION_REQUEST_INT: {
+            mavlink_mission_request_int_t request;
+            mavlink_msg_mission_request_int_decode(&message, &request);
+            if (is_for_us(request.target_system, request.target_component)) {
+                process_mission_request_int(request.seq, request.mission_type);
+            }
+            break;
+        }
+        case MAVLINK_MSG_ID_MISSION_REQUEST: {
+            // Answered with MISSION_ITEM_INT anyway.
+            mavlink_mission_request_t request;
+            mavlink_msg_mission_request_decode(&message, &request);
+            if (is_for_us(request.target_system, request.target_component)) {
+                process_mission_request_int(request.seq, request.mission_type);
+            }
+            break;
+        }
+        case MAVLINK_MSG_ID_MISSION_CLEAR_ALL:
+            process_mission_clear_all(message);
+            break;
+        case MAVLINK_MSG_ID_MISSION_SET_CURRENT:
+            process_mission_set_current(message);
+            break;
+        case MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL:
+            process_ftp(message);
+            break;
+        case MAVLINK_MSG_ID_PARAM_EXT_REQUEST_LIST:
+            process_param_ext_request_list(message);
+            break;
+        case MAVLINK_MSG_ID_PARAM_EXT_REQUEST_READ:
+            process_param_ext_request_read(message);
+            break;
+        case MAVLINK_MSG_ID_PARAM_EXT_SET:
+            process_param_ext_set(message);
+            break;
+        case MAVLINK_MSG_ID_LOG_REQUEST_LIST:
+            process_log_request_list(message);
+            break;
+        case MAVLINK_MSG_ID_LOG_REQUEST_DATA:
+            process_log_request_data(message);
+            break;
+        case MAVLINK_MSG_ID_LOG_REQUEST_END:
+            process_log_request_end(message);
+            break;
+        default:
+            break;
+    }
+}
+
+void AutopilotSimulator::process_command_long(const mavlink_message_t& message)
+{
+    mavlink_command_long_t command_long;
+    mavlink_msg_command_long_decode(&message, &command_long);
+    if (is_for_camera(command_long.target_system, command_long.target_component)) {
+        process_camera_command(command_long.command);
+        return;
+    }
+    if (!is_for_us(command_long.target_system, command_long.target_component)) {
+        return;
+    }
+
+    const float params[7] = {command_long.param1,
+                             command_long.param2,
+                             command_long.param3,
+                             command_long.param4,
+                             command_long.param5,
+                             command_long.param6,
+                             command_long.param7};
+    process_command(command_long.command, params);
+}
+
+void AutopilotSimulator::process_command_int(const mavlink_message_t& message)
+{
+    mavlink_command_int_t command_int;
+    mavlink_msg_command_int_decode(&message, &command_int);
+    if (!is_for_us(command_int.target_system, command_int.target_component)) {
+        return;
+    }
+
+    const float params[7] = {command_int.param1,
+                             command_int.param2,
+                             command_int.param3,
+                             command_int.param4,
+                             float(command_int.x),
+                             float(command_int.y),
+                             command_int.z};
+    process_command(command_int.command, params);
+}
+
+void AutopilotSimulator::process_command(uint16_t command, const float (&params)[7])
+{
+    switch (command) {
+        case MAV_CMD_SET_MESSAGE_INTERVAL:
+            send_command_ack(
+                command,
+                set_message_interval(uint32_t(params[0]), params[1]) ? MAV_RESULT_ACCEPTED :
+                                                                       MAV_RESULT_UNSUPPORTED);
+            break;
+
+        case MAV_CMD_REQUEST_MESSAGE: {
+            const uint32_t msgid = uint32_t(params[0]);
+            if (msgid == MAVLINK_MSG_ID_AUTOPILOT_VERSION) {
+                send_command_ack(command, MAV_RESULT_ACCEPTED);
+                send_autopilot_version();
+            } else if (is_streamable(msgid)) {
+                send_command_ack(command, MAV_RESULT_ACCEPTED);
+                send_stream(msgid);
+            } else {
+                send_command_ack(command, MAV_RESULT_UNSUPPORTED);
+            }
+            break;
+        }
+
+        case MAV_CMD_REQUEST_AUTOPILOT_CAPABILITIES:
+            send_command_ack(command, MAV_RESULT_ACCEPTED);
+            send_autopilot_version();
+            break;
+
+        case MAV_CMD_COMPONENT_ARM_DISARM:
+            _armed = (params[0] > 0.5f);
+            send_command_ack(command, MAV_RESULT_ACCEPTED);
+            break;
+
+        case MAV_CMD_DO_SET_MODE:
+            // PX4 main mode and sub mode.
+            _custom_mode = (uint32_t(params[1]) << 16) | (uint32_t(params[2]) << 24);
+            send_command_ack(command, MAV_RESULT_ACCEPTED);
+            break;
+
+        default:
+            // Everything else is just accepted.
+            send_command_ack(command, MAV_RESULT_ACCEPTED);
+            break;
+    }
+}
+
+void AutopilotSimulator::send_command_ack(uint16_t command, uint8_t result)
+{
+    send_command_ack(command, result, _config.component_id);
+}
+
+void AutopilotSimulator::send_command_ack(uint16_t command, uint8_t result, uint8_t component_id)
+{
+    mavlink_command_ack_t command_ack{};
+    command_ack.command = command;
+    command_ack.result = result;
+    command_ack.target_system = _peer_system_id;
+    command_ack.target_component = _peer_component_id;
+
+    mavlink_message_t message;
+    mavlink_msg_command_ack_encode(_config.system_id, component_id, &message, &command_ack);
+    send(message);
+}
+
+bool AutopilotSimulator::set_message_interval(uint32_t msgid, float interval_us)
+{
+    if (!is_streamable(msgid)) {
+        return false;
+    }
+
+    if (interval_us < 0.0f) {
+        _streams.erase(msgid);
+        return true;
+    }
+
+    double rate_hz = 0.0;
+    if (interval_us > 0.0f) {
+        rate_hz = 1e6 / double(interval_us);
+    } else {
+        // Default rate.
+        const auto it = _config.telemetry_rates_hz.find(msgid);
+        if (it != _config.telemetry_rates_hz.end()) {
+            rate_hz = it->second;
+        }
+    }
+
+    if (rate_hz <= 0.0) {
+        _streams.erase(msgid);
+        return true;
+    }
+
+    auto& stream = _streams[msgid];
+    stream.interval =
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate_hz));
+    stream.next_time = Clock::now();
+    return true;
+}
+
+void AutopilotSimulator::send_autopilot_version()
+{
+    mavlink_autopilot_version_t autopilot_version{};
+    autopilot_version.capabilities =
+        MAV_PROTOCOL_CAPABILITY_MISSION_FLOAT | MAV_PROTOCOL_CAPABILITY_PARAM_FLOAT |
+        MAV_PROTOCOL_CAPABILITY_MISSION_INT | MAV_PROTOCOL_CAPABILITY_COMMAND_INT |
+        MAV_PROTOCOL_CAPABILITY_FTP | MAV_PROTOCOL_CAPABILITY_SET_ATTITUDE_TARGET |
+        MAV_PROTOCOL_CAPABILITY_MISSION_FENCE | MAV_PROTOCOL_CAPABILITY_MISSION_RALLY |
+        MAV_PROTOCOL_CAPABILITY_MAVLINK2;
+    // Unique per simulated vehicle.
+    autopilot_version.uid = 0x53494d0000000000ULL | _config.system_id;
+    autopilot_version.flight_sw_version = (1u << 24) | (11u << 16) | (0xFFu);
+
+    mavlink_message_t message;
+    mavlink_msg_autopilot_version_encode(
+        _config.system_id, _config.component_id, &message, &autopilot_version);
+    send(message);
+}
+
+void AutopilotSimulator::process_timesync(const mavlink_message_t& message)
+{
+    mavlink_timesync_t timesync;
+    mavlink_msg_timesync_decode(&message, &timesync);
+
+    if (timesync.tc1 != 0) {
+        // A reply, not for us.
+        return;
+    }
+
+    timesync.tc1 = int64_t(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - _start_time).count());
+
+    mavlink_message_t reply;
+    mavlink_msg_timesync_encode(_config.system_id, _config.component_id, &reply, &timesync);
+    send(reply);
+}
+
+void AutopilotSimulator::add_param(const std::string& id, float value)
+{
+    Param param{};
+    param.id = id;
+    param.type = MAV_PARAM_TYPE_REAL32;
+    std::memcpy(param.value, &value, sizeof(param.value));
+    _param_indices[id] = _params.size();
+    _params.push_back(param);
+}
+
+void AutopilotSimulator::add_param(const std::string& id, int32_t value)
+{
+    Param param{};
+    param.id = id;
+    param.type = MAV_PARAM_TYPE_INT32;
+    std::memcpy(param.value, &value, sizeof(param.value));
+    _param_indices[id] = _params.size();
+    _params.push_back(param);
+}
+
+void AutopilotSimulator::send_param_value(std::size_t index)
+{
+    const auto& param = _params[index];
+
+    mavlink_param_value_t param_value{};
+    std::memcpy(&param_value.param_value, param.value, sizeof(param.value));
+    param_value.param_count = uint16_t(_params.size());
+    param_value.param_index = uint16_t(index);
+    // Not null-terminated if it uses all 16 characters.
+    std::memcpy(
+        param_value.param_id,
+        param.id.c_str(),
+        std::min(param.id.size(), sizeof(param_value.param_id)));
+    param_value.param_type = param.type;
+
+    mavlink_message_t message;
+    mavlink_msg_param_value_encode(_config.system_id, _config.component_id, &message, &param_value);
+    send(message);
+}
+
+void AutopilotSimulator::process_param_request_list(const mavlink_message_t& message)
+{
+    mavlink_param_request_list_t request;
+    mavlink_msg_param_request_list_decode(&message, &request);
+    if (!is_for_us(request.target_system, request.target_component)) {
+        return;
+    }
+
+    for (std::size_t i = 0; i < _params.size(); ++i) {
+        send_param_value(i);
+    }
+}
+
+void AutopilotSimulator::process_param_request_read(const mavlink_message_t& message)
+{
+    mavlink_param_request_read_t request;
+    mavlink_msg_param_request_read_decode(&message, &request);
+    if (!is_for_us(request.target_system, request.target_component)) {
+        return;
+    }
+
+    if (request.param_index >= 0) {
+        if (std::size_t(request.param_index) < _params.size()) {
+            send_param_value(std::size_t(request.param_index));
+        }
+        return;
+    }
+
+    const std::string id(request.param_id, strnlen(request.param_id, sizeof(request.param_id)));
+    const auto it = _param_indices.find(id);
+    if (it != _param_indices.end()) {
+        send_param_value(it->second);
+    }
+}
+
+void AutopilotSimulator::process_param_set(const mavlink_message_t& message)
+{
+    mavlink_param_set_t param_set;
+    mavlink_msg_param_set_decode(&message, &param_set);
+    if (!is_for_us(param_set.target_system, param_set.target_component)) {
+        return;
+    }
+
+    const std::string id(
+        param_set.param_id, strnlen(param_set.param_id, sizeof(param_set.param_id)));
+    const auto it = _param_indices.find(id);
+    if (it == _param_indices.end()) {
+        // PX4 doesn't answer either.
+        return;
+    }
+
+    auto& param = _params[it->second];
+    std::memcpy(param.value, &param_set.param_value, sizeof(param.value));
+    param.type = param_set.param_type;
+    send_param_value(it->second);
+}
+
+void AutopilotSimulator::process_mission_count(const mavlink_message_t& message)
+{
+    mavlink_mission_count_t mission_count;
+    mavlink_msg_mission_count_decode(&message, &mission_count);
+    if (!is_for_us(mission_count.target_system, mission_count.target_component)) {
+        return;
+    }
+
+    if (mission_count.count == 0) {
+        {
+            std::lock_guard<std::mutex> lock(_data_mutex);
+            _mission_items[mission_count.mission_type].clear();
+        }
+        send_mission_ack(MAV_MISSION_ACCEPTED, mission_count.mission_type);
+        return;
+    }
+
+    _mission_upload.clear();
+    _mission_upload.reserve(mission_count.count);
+    _mission_upload_type = mission_count.mission_type;
+    _mission_upload_count = mission_count.count;
+    _mission_upload_active = true;
+    request_mission_item(0, mission_count.mission_type);
+}
+
+void AutopilotSimulator::request_mission_item(uint16_t seq, uint8_t mission_type)
+{
+    mavlink_mission_request_int_t request{};
+    request.seq = seq;
+    request.target_system = _peer_system_id;
+    request.target_component = _peer_component_id;
+    request.mission_type = mission_type;
+
+    mavlink_message_t message;
+    mavlink_msg_mission_request_int_encode(
+        _config.system_id, _config.component_id, &message, &request);
+    send(message);
+}
+
+void AutopilotSimulator::process_mission_item_int(const mavlink_message_t& message)
+{
+    mavlink_mission_item_int_t item;
+    mavlink_msg_mission_item_int_decode(&message, &item);
+    if (!is_for_us(item.target_system, item.target_component)) {
+        return;
+    }
+
+    if (!_mission_upload_active) {
+        // The last item again because our ack got lost.
+        std::lock_guard<std::mutex> lock(_data_mutex);
+        const auto& items = _mission_items[item.mission_type];
+        if (!items.empty() && item.seq + 1u == items.size()) {
+            send_mission_ack(MAV_MISSION_ACCEPTED, item.mission_type);
+        }
+        return;
+    }
+
+    if (item.mission_type != _mission_upload_type) {
+        send_mission_ack(MAV_MISSION_ERROR, item.mission_type);
+        return;
+    }
+
+    if (item.seq < _mission_upload.size()) {
+        // Sent again because our request got lost, ask for the next one again.
+        request_mission_item(uint16_t(_mission_upload.size()), _mission_upload_type);
+        return;
+    }
+
+    if (item.seq > _mission_upload.size()) {
+        _mission_upload_active = false;
+        send_mission_ack(MAV_MISSION_INVALID_SEQUENCE, _mission_upload_type);
+        return;
+    }
+
+    _mission_upload.push_back(item);
+
+    if (_mission_upload.size() < _mission_upload_count) {
+        request_mission_item(uint16_t(_mission_upload.size()), _mission_upload_type);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_data_mutex);
+        _mission_items[_mission_upload_type] = _mission_upload;
+    }
+    _mission_upload_active = false;
+    send_mission_ack(MAV_MISSION_ACCEPTED, _mission_upload_type);
+}
+
+void AutopilotSimulator::process_mission_request_list(const mavlink_message_t& message)
+{
+    mavlink_mission_request_list_t request;
+    mavlink_msg_mission_request_list_decode(&message, &request);
+    if (!is_for_us(request.target_system, request.target_component)) {
+        return;
+    }
+
+    mavlink_mission_count_t mission_count{};
+    {
+        std::lock_guard<std::mutex> lock(_data_mutex);
+        mission_count.count = uint16_t(_mission_items[request.mission_type].size());
+    }
+    mission_count.target_system = message.sysid;
+    mission_count.target_component = message.compid;
+    mission_count.mission_type = request.mission_type;
+
+    mavlink_message_t reply;
+    mavlink_msg_mission_count_encode(
+        _config.system_id, _config.component_id, &reply, &mission_count);
+    send(reply);
+}
+
+void AutopilotSimulator::process_mission_request_int(uint16_t seq, uint8_t mission_type)
+{
+    mavlink_mission_item_int_t item{};
+    {
+        std::lock_guard<std::mutex> lock(_data_mutex);
+        const auto& items = _mission_items[mission_type];
+        if (seq >= items.size()) {
+            send_mission_ack(MAV_MISSION_INVALID_SEQUENCE, mission_type);
+            return;
+        }
+        item = items[seq];
+    }
+    item.target_system = _peer_system_id;
+    item.target_component = _peer_component_id;
+    item.current = (seq == _current_mission_item) ? 1 : 0;
+
+    mavlink_message_t message;
+    mavlink_msg_mission_item_int_encode(_config.system_id, _config.component_id, &message, &item);
+    send(message);
+}
+
+void AutopilotSimulator::process_mission_clear_all(const mavlink_message_t& message)
+{
+    mavlink_mission_clear_all_t clear_all;
+    mavlink_msg_mission_clear_all_decode(&message, &clear_all);
+    if (!is_for_us(clear_all.target_system, clear_all.target_component)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_data_mutex);
+        if (clear_all.mission_type == MAV_MISSION_TYPE_ALL) {
+            _mission_items.clear();
+        } else {
+            _mission_items[clear_all.mission_type].clear();
+        }
+    }
+    _current_mission_item = 0;
+    send_mission_ack(MAV_MISSION_ACCEPTED, clear_all.mission_type);
+}
+
+void AutopilotSimulator::process_mission_set_current(const mavlink_message_t& message)
+{
+    mavlink_mission_set_current_t set_current;
+    mavlink_msg_mission_set_current_decode(&message, &set_current);
+    if (!is_for_us(set_current.target_system, set_current.target_component)) {
+        return;
+    }
+
+    _current_mission_item = set_current.seq;
+    send_stream(MAVLINK_MSG_ID_MISSION_CURRENT);
+}
+
+void AutopilotSimulator::send_mission_ack(uint8_t result, uint8_t mission_type)
+{
+    mavlink_mission_ack_t mission_ack{};
+    mission_ack.target_system = _peer_system_id;
+    mission_ack.target_component = _peer_component_id;
+    mission_ack.type = result;
+    mission_ack.mission_type = mission_type;
+
+    mavlink_message_t message;
+    mavlink_msg_mission_ack_encode(_config.system_id, _config.component_id, &message, &mission_ack);
+    send(message);
+}
+
+void AutopilotSimulator::set_link_down(bool down)
+{
+    _link_down = down;
+}
+
+void AutopilotSimulator::add_file(const std::string& path, const std::vector<uint8_t>& content)
+{
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    _files[path] = content;
+}
+
+bool AutopilotSimulator::get_file(const std::string& path, std::vector<uint8_t>& content) const
+{
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    const auto it = _files.find(path);
+    if (it == _files.end()) {
+        return false;
+    }
+    content = it->second;
+    return true;
+}
+
+void AutopilotSimulator::add_log(const std::vector<uint8_t>& content)
+{
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    _logs.push_back(content);
+}
+
+void AutopilotSimulator::set_camera_param(
+    const std::string& id, const MAVLinkParameters::ParamValue& value)
+{
+    std::lock_guard<std::mutex> lock(_data_mutex);
+
+    auto it = std::find_if(
+        _camera_params.begin(), _camera_params.end(), [&id](const CameraParam& param) {
+            return param.id == id;
+        });
+    if (it == _camera_params.end()) {
+        _camera_params.push_back(CameraParam{id, 0, {}});
+        it = _camera_params.end() - 1;
+    }
+    it->type = uint8_t(value.get_mav_param_ext_type());
+    value.get_128_bytes(it->value);
+
+    if (_thread != nullptr) {
+        _changed_camera_params.push_back(std::size_t(it - _camera_params.begin()));
+        // It goes out with whatever wakes the thread next otherwise.
+        _inbox_cv.notify_one();
+    }
+}
+
+std::vector<mavlink_mission_item_int_t>
+AutopilotSimulator::get_mission_items(uint8_t mission_type) const
+{
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    const auto it = _mission_items.find(mission_type);
+    if (it == _mission_items.end()) {
+        return {};
+    }
+    return it->second;
+}
+
+AutopilotSimulator::Statistics AutopilotSimulator::get_statistics() const
+{
+    Statistics statistics{};
+    statistics.num_sent = _num_sent;
+    statistics.num_received = _num_received;
+    statistics.num_lost = _num_lost;
+    return statistics;
+}
+
+void AutopilotSimulator::send_ftp(const uint8_t* payload)
+{
+    mavlink_file_transfer_protocol_t file_transfer_protocol{};
+    file_transfer_protocol.target_network = 0;
+    file_transfer_protocol.target_system = _peer_system_id;
+    file_transfer_protocol.target_component = _peer_component_id;
+    std::memcpy(file_transfer_protocol.payload, payload, ftp::payload_length);
+
+    mavlink_message_t message;
+    mavlink_msg_file_transfer_protocol_encode(
+        _config.system_id, _config.component_id, &message, &file_transfer_protocol);
+    send(message);
+}
+
+void AutopilotSimulator::process_ftp(const mavlink_message_t& message)
+{
+    mavlink_file_transfer_protocol_t file_transfer_protocol;
+    mavlink_msg_file_transfer_protocol_decode(&message, &file_transfer_protocol);
+    if (!is_for_us(
+            file_transfer_protocol.target_system, file_transfer_protocol.target_component)) {
+        return;
+    }
+
+    const uint8_t* request = file_transfer_protocol.payload;
+    const uint8_t opcode = request[ftp::opcode_offset];
+    const uint8_t session = request[ftp::session_offset];
+    const uint32_t offset = ftp::get_u32(request, ftp::offset_offset);
+
+    uint8_t response[ftp::payload_length]{};
+    ftp::set_u16(
+        response, ftp::seq_number_offset, uint16_t(ftp::get_u16(request, ftp::seq_number_offset) + 1));
+    response[ftp::session_offset] = session;
+    response[ftp::opcode_offset] = ftp::RSP_ACK;
+    response[ftp::req_opcode_offset] = opcode;
+    ftp::set_u32(response, ftp::offset_offset, offset);
+
+    auto nak = [&response](ftp::ServerResult result) {
+        response[ftp::opcode_offset] = ftp::RSP_NAK;
+        response[ftp::size_offset] = 1;
+        response[ftp::data_offset] = result;
+    };
+
+    // Returns the file of the session or nullptr.
+    auto session_file = [this, session](bool for_write) -> std::vector<uint8_t>* {
+        const auto it = _ftp_sessions.find(session);
+        if (it == _ftp_sessions.end() || it->second.is_write != for_write) {
+            return nullptr;
+        }
+        const auto file = _files.find(it->second.path);
+        return (file != _files.end()) ? &file->second : nullptr;
+    };
+
+    auto open_session = [this, &response, &nak](const std::string& path, bool is_write) {
+        if (_ftp_sessions.size() >= _config.max_ftp_sessions) {
+            nak(ftp::ERR_NO_SESSIONS_AVAILABLE);
+            return false;
+        }
+        while (_ftp_sessions.find(_next_ftp_session) != _ftp_sessions.end()) {
+            ++_next_ftp_session;
+        }
+        FtpSession new_session{};
+        new_session.path = path;
+        new_session.is_write = is_write;
+        _ftp_sessions[_next_ftp_session] = new_session;
+        response[ftp::session_offset] = _next_ftp_session++;
+        return true;
+    };
+
+    // Files are also accessed from outside.
+    std::lock_guard<std::mutex> lock(_data_mutex);
+
+    switch (opcode) {
+        case ftp::CMD_NONE:
+            break;
+
+        case ftp::CMD_TERMINATE_SESSION:
+            _ftp_sessions.erase(session);
+            break;
+
+        case ftp::CMD_RESET_SESSIONS:
+            _ftp_sessions.clear();
+            break;
+
+        case ftp::CMD_LIST_DIRECTORY: {
+            std::string directory = ftp::get_path(request);
+            while (!directory.empty() && directory.back() == '/') {
+                directory.pop_back();
+            }
+            const std::string prefix = directory + "/";
+
+            std::vector<std::string> entries;
+            for (const auto& file : _files) {
+                if (file.first.compare(0, prefix.size(), prefix) != 0) {
+                    continue;
+                }
+                const std::string rest = file.first.substr(prefix.size());
+                const auto slash = rest.find('/');
+                std::string entry;
+                if (slash == std::string::npos) {
+                    entry = "F" + rest + "\t" + std::to_string(file.second.size());
+                } else {
+                    entry = "D" + rest.substr(0, slash);
+                }
+                if (std::find(entries.begin(), entries.end(), entry) == entries.end()) {
+                    entries.push_back(entry);
+                }
+            }
+
+            if (offset >= entries.size()) {
+                nak(ftp::ERR_EOF);
+                break;
+            }
+
+            std::size_t size = 0;
+            for (std::size_t i = offset; i < entries.size(); ++i) {
+                const auto& entry = entries[i];
+                if (size + entry.size() + 1 > ftp::max_data_length) {
+                    break;
+                }
+                std::memcpy(&response[ftp::data_offset + size], entry.c_str(), entry.size() + 1);
+                size += entry.size() + 1;
+            }
+            response[ftp::size_offset] = uint8_t(size);
+            break;
+        }
+
+        case ftp::CMD_OPEN_FILE_RO: {
+            const std::string path = ftp::get_path(request);
+            const auto file = _files.find(path);
+            if (file == _files.end()) {
+                nak(ftp::ERR_FAIL_FILE_DOES_NOT_EXIST);
+                break;
+            }
+            if (open_session(path, false)) {
+                response[ftp::size_offset] = 4;
+                ftp::set_u32(response, ftp::data_offset, uint32_t(file->second.size()));
+            }
+            break;
+        }
+
+        case ftp::CMD_READ_FILE: {
+            const auto* file = session_file(false);
+            if (file == nullptr) {
+                nak(ftp::ERR_INVALID_SESSION);
+                break;
+            }
+            if (offset >= file->size()) {
+                nak(ftp::ERR_EOF);
+                break;
+            }
+            const std::size_t size = std::min(ftp::max_data_length, file->size() - offset);
+            std::memcpy(&response[ftp::data_offset], &(*file)[offset], size);
+            response[ftp::size_offset] = uint8_t(size);
+            break;
+        }
+
+        case ftp::CMD_BURST_READ_FILE: {
+            const auto* file = session_file(false);
+            if (file == nullptr) {
+                nak(ftp::ERR_INVALID_SESSION);
+                break;
+            }
+            if (offset >= file->size()) {
+                nak(ftp::ERR_EOF);
+                break;
+            }
+            // Everything from the offset to the end, the last one marked.
+            uint16_t seq_number = ftp::get_u16(response, ftp::seq_number_offset);
+            for (std::size_t chunk_offset = offset; chunk_offset < file->size();
+                 chunk_offset += ftp::max_data_length) {
+                const std::size_t size =
+                    std::min(ftp::max_data_length, file->size() - chunk_offset);
+                ftp::set_u16(response, ftp::seq_number_offset, seq_number++);
+                ftp::set_u32(response, ftp::offset_offset, uint32_t(chunk_offset));
+                response[ftp::size_offset] = uint8_t(size);
+                response[ftp::burst_complete_offset] =
+                    (chunk_offset + size >= file->size()) ? 1 : 0;
+                std::memcpy(&response[ftp::data_offset], &(*file)[chunk_offset], size);
+                send_ftp(response);
+            }
+            return;
+        }
+
+        case ftp::CMD_CREATE_FILE: {
+            const std::string path = ftp::get_path(request);
+            if (open_session(path, true)) {
+                _files[path].clear();
+            }
+            break;
+        }
+
+        case ftp::CMD_OPEN_FILE_WO: {
+            const std::string path = ftp::get_path(request);
+            if (open_session(path, true)) {
+                _files[path];
+            }
+            break;
+        }
+
+        case ftp::CMD_WRITE_FILE: {
+            auto* file = session_file(true);
+            if (file == nullptr) {
+                nak(ftp::ERR_INVALID_SESSION);
+                break;
+            }
+            const std::size_t size =
+                std::min<std::size_t>(request[ftp::size_offset], ftp::max_data_length);
+            if (file->size() < offset + size) {
+                file->resize(offset + size);
+            }
+            std::memcpy(&(*file)[offset], &request[ftp::data_offset], size);
+            break;
+        }
+
+        case ftp::CMD_REMOVE_FILE:
+            if (_files.erase(ftp::get_path(request)) == 0) {
+                nak(ftp::ERR_FAIL_FILE_DOES_NOT_EXIST);
+            }
+            break;
+
+        case ftp::CMD_CREATE_DIRECTORY:
+        case ftp::CMD_REMOVE_DIRECTORY:
+            // Directories only exist implicitly through their files.
+            break;
+
+        case ftp::CMD_TRUNCATE_FILE: {
+            const auto file = _files.find(ftp::get_path(request));
+            if (file == _files.end()) {
+                nak(ftp::ERR_FAIL_FILE_DOES_NOT_EXIST);
+                break;
+            }
+            file->second.resize(offset);
+            break;
+        }
+
+        case ftp::CMD_RENAME: {
+            // Both paths, separated by a null character.
+            const char* data = reinterpret_cast<const char*>(&request[ftp::data_offset]);
+            const std::size_t size =
+                std::min<std::size_t>(request[ftp::size_offset], ftp::max_data_length);
+            const std::string from_path(data, strnlen(data, size));
+            const std::size_t to_offset = std::min(from_path.size() + 1, size);
+            const std::string to_path(data + to_offset, strnlen(data + to_offset, size - to_offset));
+
+            const auto file = _files.find(from_path);
+            if (file == _files.end()) {
+                nak(ftp::ERR_FAIL_FILE_DOES_NOT_EXIST);
+                break;
+            }
+            auto content = file->second;
+            _files.erase(file);
+            _files[to_path] = content;
+            break;
+        }
+
+        case ftp::CMD_CALC_FILE_CRC32: {
+            const auto file = _files.find(ftp::get_path(request));
+            if (file == _files.end()) {
+                nak(ftp::ERR_FAIL_FILE_DOES_NOT_EXIST);
+                break;
+            }
+            response[ftp::size_offset] = 4;
+            ftp::set_u32(response, ftp::data_offset, ftp::crc32(file->second));
+            break;
+        }
+
+        default:
+            nak(ftp::ERR_UNKOWN_COMMAND);
+            break;
+    }
+
+    send_ftp(response);
+}
+
+bool AutopilotSimulator::has_camera() const
+{
+    return !_config.camera_model_name.empty();
+}
+
+bool AutopilotSimulator::is_for_camera(uint8_t target_system, uint8_t target_component) const
+{
+    return has_camera() && (target_system == 0 || target_system == _config.system_id) &&
+           target_component == MAV_COMP_ID_CAMERA;
+}
+
+void AutopilotSimulator::send_camera_heartbeat()
+{
+    mavlink_heartbeat_t heartbeat{};
+    heartbeat.type = MAV_TYPE_CAMERA;
+    heartbeat.autopilot = MAV_AUTOPILOT_INVALID;
+    heartbeat.system_status = MAV_STATE_ACTIVE;
+    heartbeat.mavlink_version = 3;
+
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_encode(_config.system_id, MAV_COMP_ID_CAMERA, &message, &heartbeat);
+    send(message);
+}
+
+void AutopilotSimulator::process_camera_command(uint16_t command)
+{
+    // Everything is accepted, only the information is actually sent.
+    send_command_ack(command, MAV_RESULT_ACCEPTED, MAV_COMP_ID_CAMERA);
+
+    if (command == MAV_CMD_REQUEST_CAMERA_INFORMATION) {
+        send_camera_information();
+    }
+}
+
+void AutopilotSimulator::send_camera_information()
+{
+    mavlink_camera_information_t camera_information{};
+    camera_information.time_boot_ms = time_boot_ms();
+    std::strncpy(
+        reinterpret_cast<char*>(camera_information.vendor_name),
+        _config.camera_vendor_name.c_str(),
+        sizeof(camera_information.vendor_name));
+    std::strncpy(
+        reinterpret_cast<char*>(camera_information.model_name),
+        _config.camera_model_name.c_str(),
+        sizeof(camera_information.model_name));
+    std::strncpy(
+        camera_information.cam_definition_uri,
+        _config.camera_definition_uri.c_str(),
+        sizeof(camera_information.cam_definition_uri) - 1);
+    camera_information.cam_definition_version = 1;
+
+    mavlink_message_t message;
+    mavlink_msg_camera_information_encode(
+        _config.system_id, MAV_COMP_ID_CAMERA, &message, &camera_information);
+    send(message);
+}
+
+void AutopilotSimulator::send_param_ext_value(std::size_t index)
+{
+    const auto& param = _camera_params[index];
+
+    mavlink_param_ext_value_t param_ext_value{};
+    param_ext_value.param_count = uint16_t(_camera_params.size());
+    param_ext_value.param_index = uint16_t(index);
+    // Not null-terminated if it uses all 16 characters.
+    std::memcpy(
+        param_ext_value.param_id,
+        param.id.c_str(),
+        std::min(param.id.size(), sizeof(param_ext_value.param_id)));
+    std::memcpy(param_ext_value.param_value, param.value, sizeof(param_ext_value.param_value));
+    param_ext_value.param_type = param.type;
+
+    mavlink_message_t message;
+    mavlink_msg_param_ext_value_encode(
+        _config.system_id, MAV_COMP_ID_CAMERA, &message, &param_ext_value);
+    send(message);
+}
+
+void AutopilotSimulator::process_param_ext_request_list(const mavlink_message_t& message)
+{
+    mavlink_param_ext_request_list_t request;
+    mavlink_msg_param_ext_request_list_decode(&message, &request);
+    if (!is_for_camera(request.target_system, request.target_component) ||
+        !_config.camera_sends_param_list) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    for (std::size_t i = 0; i < _camera_params.size(); ++i) {
+        send_param_ext_value(i);
+    }
+}
+
+void AutopilotSimulator::process_param_ext_request_read(const mavlink_message_t& message)
+{
+    mavlink_param_ext_request_read_t request;
+    mavlink_msg_param_ext_request_read_decode(&message, &request);
+    if (!is_for_camera(request.target_system, request.target_component)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_data_mutex);
+
+    if (request.param_index >= 0) {
+        if (std::size_t(request.param_index) < _camera_params.size()) {
+            send_param_ext_value(std::size_t(request.param_index));
+        }
+        return;
+    }
+
+    const std::string id(request.param_id, strnlen(request.param_id, sizeof(request.param_id)));
+    for (std::size_t i = 0; i < _camera_params.size(); ++i) {
+        if (_camera_params[i].id == id) {
+            send_param_ext_value(i);
+            return;
+        }
+    }
+}
+
+void AutopilotSimulator::process_param_ext_set(const mavlink_message_t& message)
+{
+    mavlink_param_ext_set_t param_ext_set;
+    mavlink_msg_param_ext_set_decode(&message, &param_ext_set);
+    if (!is_for_camera(param_ext_set.target_system, param_ext_set.target_component)) {
+        return;
+    }
+
+    mavlink_param_ext_ack_t param_ext_ack{};
+    std::memcpy(param_ext_ack.param_id, param_ext_set.param_id, sizeof(param_ext_ack.param_id));
+    std::memcpy(
+        param_ext_ack.param_value, param_ext_set.param_value, sizeof(param_ext_ack.param_value));
+    param_ext_ack.param_type = param_ext_set.param_type;
+    param_ext_ack.param_result = PARAM_ACK_VALUE_UNSUPPORTED;
+
+    {
+        std::lock_guard<std::mutex> lock(_data_mutex);
+        const std::string id(
+            param_ext_set.param_id,
+            strnlen(param_ext_set.param_id, sizeof(param_ext_set.param_id)));
+        for (auto& param : _camera_params) {
+            if (param.id == id) {
+                param.type = param_ext_set.param_type;
+                std::memcpy(param.value, param_ext_set.param_value, sizeof(param.value));
+                param_ext_ack.param_result = PARAM_ACK_ACCEPTED;
+                break;
+            }
+        }
+    }
+
+    mavlink_message_t reply;
+    mavlink_msg_param_ext_ack_encode(_config.system_id, MAV_COMP_ID_CAMERA, &reply, &param_ext_ack);
+    send(reply);
+}
+
+void AutopilotSimulator::send_changed_camera_params()
+{
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    for (const auto index : _changed_camera_params) {
+        send_param_ext_value(index);
+    }
+    _changed_camera_params.clear();
+}
+
+void AutopilotSimulator::process_log_request_list(const mavlink_message_t& message)
+{
+    mavlink_log_request_list_t log_request_list;
+    mavlink_msg_log_request_list_decode(&message, &log_request_list);
+    if (!is_for_us(log_request_list.target_system, log_request_list.target_component)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_data_mutex);
+
+    mavlink_log_entry_t log_entry{};
+    log_entry.num_logs = uint16_t(_logs.size());
+    log_entry.last_log_num = uint16_t(_logs.empty() ? 0 : _logs.size() - 1);
+
+    if (_logs.empty()) {
+        // PX4 answers with an empty entry.
+        mavlink_message_t response;
+        mavlink_msg_log_entry_encode(
+            _config.system_id, _config.component_id, &response, &log_entry);
+        send(response);
+        return;
+    }
+
+    for (std::size_t id = log_request_list.start;
+         id <= log_request_list.end && id < _logs.size();
+         ++id) {
+        log_entry.id = uint16_t(id);
+        log_entry.size = uint32_t(_logs[id].size());
+        // One flight a day since 2020-01-01.
+        log_entry.time_utc = uint32_t(1577836800 + id * 86400);
+
+        mavlink_message_t response;
+        mavlink_msg_log_entry_encode(
+            _config.system_id, _config.component_id, &response, &log_entry);
+        send(response);
+    }
+}
+
+void AutopilotSimulator::process_log_request_data(const mavlink_message_t& message)
+{
+    mavlink_log_request_data_t log_request_data;
+    mavlink_msg_log_request_data_decode(&message, &log_request_data);
+    if (!is_for_us(log_request_data.target_system, log_request_data.target_component)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    if (log_request_data.id >= _logs.size()) {
+        _log_request.active = false;
+        return;
+    }
+
+    const uint32_t size = uint32_t(_logs[log_request_data.id].size());
+    _log_request.active = true;
+    _log_request.id = log_request_data.id;
+    _log_request.offset = std::min(log_request_data.ofs, size);
+    // The count is 0xFFFFFFFF for everything.
+    _log_request.end = uint32_t(
+        std::min(uint64_t(log_request_data.ofs) + log_request_data.count, uint64_t(size)));
+    _log_request.next_time = Clock::now();
+}
+
+void AutopilotSimulator::process_log_request_end(const mavlink_message_t& message)
+{
+    mavlink_log_request_end_t log_request_end;
+    mavlink_msg_log_request_end_decode(&message, &log_request_end);
+    if (is_for_us(log_request_end.target_system, log_request_end.target_component)) {
+        _log_request.active = false;
+    }
+}
+
+AutopilotSimulator::Clock::time_point AutopilotSimulator::send_due_log_data()
+{
+    if (!_log_request.active) {
+        return Clock::time_point::max();
+    }
+
+    const auto now = Clock::now();
+    const auto interval = (_config.log_data_rate_bytes_s > 0.0) ?
+                              std::chrono::duration_cast<Clock::duration>(
+                                  std::chrono::duration<double>(
+                                      double(MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN) /
+                                      _config.log_data_rate_bytes_s)) :
+                              Clock::duration::zero();
+
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    const auto& log = _logs[_log_request.id];
+
+    for (unsigned i = 0; i < max_log_data_per_turn && _log_request.next_time <= now; ++i) {
+        // Empty if asked for data at the end of the log.
+        mavlink_log_data_t log_data{};
+        log_data.id = _log_request.id;
+        log_data.ofs = _log_request.offset;
+        log_data.count = uint8_t(std::min<uint32_t>(
+            MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN, _log_request.end - _log_request.offset));
+        std::memcpy(log_data.data, &log[_log_request.offset], log_data.count);
+
+        mavlink_message_t message;
+        mavlink_msg_log_data_encode(_config.system_id, _config.component_id, &message, &log_data);
+        send(message);
+
+        _log_request.offset += log_data.count;
+        _log_request.next_time += interval;
+        if (_log_request.offset >= _log_request.end) {
+            _log_request.active = false;
+            return Clock::time_point::max();
+        }
+    }
+
+    if (_log_request.next_time < now) {
+        // We fell behind, don't try to catch up with a burst.
+        _log_request.next_time = now;
+    }
+    return _log_request.next_time;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,302 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mavlink_include.h"
+#include "mavlink_parameters.h"
+
+namespace mavsdk {
+
+class LoopbackConnection;
+
+// A lightweight autopilot which speaks enough MAVLink to exercise MAVSDK
+// without running PX4 SITL.
+//
+// It sends heartbeats and telemetry at configurable rates, acks commands
+// (including SET_MESSAGE_INTERVAL to change the rates) and serves params,
+// missions (all types), FTP and logs from memory. Latency and message loss can be
+// simulated in both directions. A camera can be added which serves its settings
+// as extended params.
+//
+// Each instance runs its own thread, many of them can run in one process.
+// They can talk to MAVSDK over loopback UDP, over an in-process loopback
+// link, or be connected any other way by passing a function to send with
+// and feeding received messages into receive().
+class AutopilotSimulator {
+public:
+    struct Config {
+        uint8_t system_id{1};
+        uint8_t component_id{MAV_COMP_ID_AUTOPILOT1};
+
+        // Rates of streamed messages by id, changed by MAVSDK requesting
+        // a message interval.
+        std::map<uint32_t, double> telemetry_rates_hz{
+            {MAVLINK_MSG_ID_HEARTBEAT, 1.0},
+            {MAVLINK_MSG_ID_SYS_STATUS, 1.0},
+            {MAVLINK_MSG_ID_EXTENDED_SYS_STATE, 1.0},
+            {MAVLINK_MSG_ID_HOME_POSITION, 0.5},
+            {MAVLINK_MSG_ID_GPS_RAW_INT, 5.0},
+            {MAVLINK_MSG_ID_GLOBAL_POSITION_INT, 10.0},
+            {MAVLINK_MSG_ID_LOCAL_POSITION_NED, 30.0},
+            {MAVLINK_MSG_ID_ATTITUDE, 50.0},
+            {MAVLINK_MSG_ID_ATTITUDE_QUATERNION, 50.0},
+        };
+
+        // Added to every message sent, in both directions.
+        std::chrono::milliseconds latency{0};
+        // Ratio of messages lost, in both directions.
+        double loss_ratio{0.0};
+        // For the loss, so runs can be reproduced.
+        unsigned random_seed{0};
+
+        // Number of params served in addition to a few well known ones.
+        unsigned num_extra_params{0};
+
+        // FTP sessions open at once, PX4 only has one.
+        std::size_t max_ftp_sessions{8};
+
+        // Log data sent per second, like the MAVLink rate limit of PX4. As
+        // fast as the thread goes if 0.
+        double log_data_rate_bytes_s{0.0};
+
+        // A camera is added if the model name is set. MAVSDK has the
+        // definitions of some built in, e.g. of the Yuneec E90, others are
+        // downloaded from the URI.
+        std::string camera_vendor_name{};
+        std::string camera_model_name{};
+        std::string camera_definition_uri{};
+        // Older cameras only answer requests for single params.
+        bool camera_sends_param_list{true};
+    };
+
+    using SendFunction = std::function<void(const mavlink_message_t& message)>;
+
+    explicit AutopilotSimulator(const Config& config);
+    ~AutopilotSimulator();
+
+    // Delete copy and move constructors and assign operators.
+    AutopilotSimulator(AutopilotSimulator const&) = delete;
+    AutopilotSimulator(AutopilotSimulator&&) = delete;
+    AutopilotSimulator& operator=(AutopilotSimulator const&) = delete;
+    AutopilotSimulator& operator=(AutopilotSimulator&&) = delete;
+
+    // Sends to MAVSDK listening on the UDP port given, from an ephemeral
+    // local port.
+    bool start_udp(const std::string& remote_ip, int remote_port);
+
+    // Connects to MAVSDK using loopback://name in the same process.
+    bool start_loopback(const std::string& name);
+
+    // Calls send for every message, from the simulator thread. Messages
+    // received need to be passed to receive().
+    void start(SendFunction send);
+
+    void stop();
+
+    // Thread-safe, can be called from any thread.
+    void receive(const mavlink_message_t& message);
+
+    // Loses every message in both directions while down, like a link which
+    // drops out for a while.
+    void set_link_down(bool down);
+
+    // Files served by FTP, paths are absolute, e.g. "/fs/microsd/log.ulg".
+    void add_file(const std::string& path, const std::vector<uint8_t>& content);
+    bool get_file(const std::string& path, std::vector<uint8_t>& content) const;
+
+    // Logs served by LOG_REQUEST_LIST and LOG_REQUEST_DATA, with ids in the
+    // order they are added.
+    void add_log(const std::vector<uint8_t>& content);
+
+    std::vector<mavlink_mission_item_int_t> get_mission_items(uint8_t mission_type) const;
+
+    // Settings of the camera, served as extended params in the order added.
+    // Changing one while running sends it out, like a camera does when it is
+    // changed on its side.
+    void set_camera_param(const std::string& id, const MAVLinkParameters::ParamValue& value);
+
+    struct Statistics {
+        uint64_t num_sent{0};
+        uint64_t num_received{0};
+        uint64_t num_lost{0};
+    };
+    Statistics get_statistics() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stream {
+        Clock::duration interval{};
+        Clock::time_point next_time{};
+    };
+
+    struct Param {
+        std::string id;
+        uint8_t type;
+        // Bytewise encoded, as PX4 does.
+        uint8_t value[4];
+    };
+
+    struct CameraParam {
+        std::string id;
+        uint8_t type;
+        char value[128];
+    };
+
+    struct DelayedMessage {
+        Clock::time_point due_time;
+        mavlink_message_t message;
+    };
+
+    // Data requested of a log, a new request replaces it as with PX4.
+    struct LogRequest {
+        bool active{false};
+        uint16_t id{0};
+        uint32_t offset{0};
+        uint32_t end{0};
+        Clock::time_point next_time{};
+    };
+
+    struct FtpSession {
+        std::string path{};
+        bool is_write{false};
+    };
+
+    void run();
+    void udp_receive();
+    void send_udp(const mavlink_message_t& message);
+
+    // All of these run on the simulator thread.
+    void process_message(const mavlink_message_t& message);
+    bool is_for_us(uint8_t target_system, uint8_t target_component) const;
+    void send(const mavlink_message_t& message);
+    bool send_stream(uint32_t msgid);
+    Clock::time_point send_due_streams();
+    Clock::time_point flush_due_messages();
+    bool is_lost(std::mt19937& random);
+
+    void process_command_long(const mavlink_message_t& message);
+    void process_command_int(const mavlink_message_t& message);
+    void process_command(uint16_t command, const float (&params)[7]);
+    void send_command_ack(uint16_t command, uint8_t result);
+    void send_command_ack(uint16_t command, uint8_t result, uint8_t component_id);
+    bool set_message_interval(uint32_t msgid, float interval_us);
+    void send_autopilot_version();
+
+    void process_timesync(const mavlink_message_t& message);
+
+    void add_param(const std::string& id, float value);
+    void add_param(const std::string& id, int32_t value);
+    void process_param_request_list(const mavlink_message_t& message);
+    void process_param_request_read(const mavlink_message_t& message);
+    void process_param_set(const mavlink_message_t& message);
+    void send_param_value(std::size_t index);
+
+    void process_mission_count(const mavlink_message_t& message);
+    void process_mission_item_int(const mavlink_message_t& message);
+    void process_mission_request_list(const mavlink_message_t& message);
+    void process_mission_request_int(uint16_t seq, uint8_t mission_type);
+    void process_mission_clear_all(const mavlink_message_t& message);
+    void process_mission_set_current(const mavlink_message_t& message);
+    void request_mission_item(uint16_t seq, uint8_t mission_type);
+    void send_mission_ack(uint8_t result, uint8_t mission_type);
+
+    void process_ftp(const mavlink_message_t& message);
+    void send_ftp(const uint8_t* payload);
+
+    bool has_camera() const;
+    bool is_for_camera(uint8_t target_system, uint8_t target_component) const;
+    void send_camera_heartbeat();
+    void process_camera_command(uint16_t command);
+    void send_camera_information();
+    void process_param_ext_request_list(const mavlink_message_t& message);
+    void process_param_ext_request_read(const mavlink_message_t& message);
+    void process_param_ext_set(const mavlink_message_t& message);
+    void send_param_ext_value(std::size_t index);
+    void send_changed_camera_params();
+
+    void process_log_request_list(const mavlink_message_t& message);
+    void process_log_request_data(const mavlink_message_t& message);
+    void process_log_request_end(const mavlink_message_t& message);
+    Clock::time_point send_due_log_data();
+
+    uint32_t time_boot_ms() const;
+
+    Config _config;
+    SendFunction _send_function{};
+
+    // Messages received, passed from other threads to the simulator thread
+    // and processed once the latency has passed.
+    mutable std::mutex _inbox_mutex{};
+    std::condition_variable _inbox_cv{};
+    std::deque<DelayedMessage> _inbox{};
+    std::mt19937 _receive_random;
+
+    std::deque<DelayedMessage> _outbox{};
+    std::map<uint32_t, Stream> _streams{};
+
+    std::mt19937 _random;
+
+    Clock::time_point _start_time{};
+    bool _armed{false};
+    uint32_t _custom_mode{0};
+    uint16_t _current_mission_item{0};
+
+    // Who we talk to, taken from the last message received.
+    uint8_t _peer_system_id{0};
+    uint8_t _peer_component_id{0};
+
+    std::vector<Param> _params{};
+    std::map<std::string, std::size_t> _param_indices{};
+
+    // Mission, fence and rally points, guarded by _data_mutex like the files
+    // as they can be read from outside.
+    mutable std::mutex _data_mutex{};
+    std::map<uint8_t, std::vector<mavlink_mission_item_int_t>> _mission_items{};
+    std::map<std::string, std::vector<uint8_t>> _files{};
+    std::vector<std::vector<uint8_t>> _logs{};
+    std::vector<CameraParam> _camera_params{};
+    // Changed from outside and still to be sent out.
+    std::vector<std::size_t> _changed_camera_params{};
+
+    // Upload in progress.
+    std::vector<mavlink_mission_item_int_t> _mission_upload{};
+    uint8_t _mission_upload_type{0};
+    uint16_t _mission_upload_count{0};
+    bool _mission_upload_active{false};
+
+    std::map<uint8_t, FtpSession> _ftp_sessions{};
+    uint8_t _next_ftp_session{0};
+
+    LogRequest _log_request{};
+
+    // Loopback UDP.
+    std::string _remote_ip{};
+    int _remote_port{0};
+    int _socket_fd{-1};
+    std::thread* _udp_receive_thread{nullptr};
+
+    std::unique_ptr<LoopbackConnection> _loopback_connection{};
+
+    std::thread* _thread{nullptr};
+    std::atomic<bool> _should_exit{false};
+
+    std::atomic<uint64_t> _num_sent{0};
+    std::atomic<uint64_t> _num_received{0};
+    std::atomic<uint64_t> _num_lost{0};
+    std::atomic<bool> _link_down{false};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,646 @@
+#include "autopilot_simulator.h"
+#include "loopback_connection.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+constexpr uint8_t own_system_id = 245;
+constexpr uint8_t own_component_id = MAV_COMP_ID_MISSIONPLANNER;
+
+// The ground station side, collecting what the simulator sends.
+class GroundStation {
+public:
+    AutopilotSimulator::SendFunction send_function()
+    {
+        return [this](const mavlink_message_t& message) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _messages.push_back(message);
+            _cv.notify_all();
+        };
+    }
+
+    // Waits for the next message of the given id, dropping others.
+    bool wait_for(
+        uint32_t msgid,
+        mavlink_message_t& message,
+        std::chrono::milliseconds timeout = std::chrono::milliseconds(1000))
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true) {
+            while (!_messages.empty()) {
+                const auto front = _messages.front();
+                _messages.pop_front();
+                if (front.msgid == msgid) {
+                    message = front;
+                    return true;
+                }
+            }
+            if (_cv.wait_until(lock, deadline) == std::cv_status::timeout) {
+                return false;
+            }
+        }
+    }
+
+    unsigned count(uint32_t msgid)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        unsigned result = 0;
+        for (const auto& message : _messages) {
+            if (message.msgid == msgid) {
+                ++result;
+            }
+        }
+        return result;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _messages.clear();
+    }
+
+private:
+    std::mutex _mutex{};
+    std::condition_variable _cv{};
+    std::deque<mavlink_message_t> _messages{};
+};
+
+AutopilotSimulator::Config quiet_config()
+{
+    AutopilotSimulator::Config config;
+    config.telemetry_rates_hz.clear();
+    return config;
+}
+
+mavlink_message_t command_long(uint16_t command, float param1, float param2 = 0.0f)
+{
+    mavlink_command_long_t command_long{};
+    command_long.target_system = 1;
+    command_long.target_component = MAV_COMP_ID_AUTOPILOT1;
+    command_long.command = command;
+    command_long.param1 = param1;
+    command_long.param2 = param2;
+
+    mavlink_message_t message;
+    mavlink_msg_command_long_encode(own_system_id, own_component_id, &message, &command_long);
+    return message;
+}
+
+mavlink_message_t ftp_request(
+    uint16_t seq_number, uint8_t session, uint8_t opcode, uint32_t offset, const std::string& data)
+{
+    mavlink_file_transfer_protocol_t file_transfer_protocol{};
+    file_transfer_protocol.target_system = 1;
+    file_transfer_protocol.target_component = MAV_COMP_ID_AUTOPILOT1;
+    uint8_t* payload = file_transfer_protocol.payload;
+    payload[0] = uint8_t(seq_number);
+    payload[1] = uint8_t(seq_number >> 8);
+    payload[2] = session;
+    payload[3] = opcode;
+    payload[4] = uint8_t(data.size());
+    std::memcpy(&payload[8], &offset, sizeof(offset));
+    std::memcpy(&payload[12], data.data(), data.size());
+
+    mavlink_message_t message;
+    mavlink_msg_file_transfer_protocol_encode(
+        own_system_id, own_component_id, &message, &file_transfer_protocol);
+    return message;
+}
+
+} // namespace
+
+TEST(AutopilotSimulator, StreamsTelemetryAtConfiguredRates)
+{
+    AutopilotSimulator::Config config;
+    config.telemetry_rates_hz = {{MAVLINK_MSG_ID_HEARTBEAT, 10.0},
+                                 {MAVLINK_MSG_ID_ATTITUDE, 100.0}};
+    AutopilotSimulator simulator(config);
+    GroundStation ground_station;
+
+    simulator.start(ground_station.send_function());
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    simulator.stop();
+
+    // Loose bounds, the machine running this might be busy.
+    EXPECT_GE(ground_station.count(MAVLINK_MSG_ID_HEARTBEAT), 8u);
+    EXPECT_LE(ground_station.count(MAVLINK_MSG_ID_HEARTBEAT), 12u);
+    EXPECT_GE(ground_station.count(MAVLINK_MSG_ID_ATTITUDE), 50u);
+    EXPECT_LE(ground_station.count(MAVLINK_MSG_ID_ATTITUDE), 110u);
+    EXPECT_EQ(ground_station.count(MAVLINK_MSG_ID_GLOBAL_POSITION_INT), 0u);
+}
+
+TEST(AutopilotSimulator, SetsMessageInterval)
+{
+    AutopilotSimulator simulator(quiet_config());
+    GroundStation ground_station;
+    simulator.start(ground_station.send_function());
+
+    simulator.receive(
+        command_long(MAV_CMD_SET_MESSAGE_INTERVAL, float(MAVLINK_MSG_ID_ATTITUDE), 20000.0f));
+
+    mavlink_message_t message;
+    ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_COMMAND_ACK, message));
+    mavlink_command_ack_t command_ack;
+    mavlink_msg_command_ack_decode(&message, &command_ack);
+    EXPECT_EQ(command_ack.command, MAV_CMD_SET_MESSAGE_INTERVAL);
+    EXPECT_EQ(command_ack.result, MAV_RESULT_ACCEPTED);
+    EXPECT_EQ(command_ack.target_system, own_system_id);
+
+    EXPECT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_ATTITUDE, message));
+
+    // And off again.
+    simulator.receive(
+        command_long(MAV_CMD_SET_MESSAGE_INTERVAL, float(MAVLINK_MSG_ID_ATTITUDE), -1.0f));
+    ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_COMMAND_ACK, message));
+    ground_station.clear();
+    EXPECT_FALSE(ground_station.wait_for(
+        MAVLINK_MSG_ID_ATTITUDE, message, std::chrono::milliseconds(200)));
+
+    // Not something we can stream.
+    simulator.receive(command_long(MAV_CMD_SET_MESSAGE_INTERVAL, 12345.0f, 1000.0f));
+    ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_COMMAND_ACK, message));
+    mavlink_msg_command_ack_decode(&message, &command_ack);
+    EXPECT_EQ(command_ack.result, MAV_RESULT_UNSUPPORTED);
+}
+
+TEST(AutopilotSimulator, ArmsAndReportsCapabilities)
+{
+    AutopilotSimulator::Config config = quiet_config();
+    config.system_id = 42;
+    AutopilotSimulator simulator(config);
+    GroundStation ground_station;
+    simulator.start(ground_station.send_function());
+
+    // Addressed to another system, ignored.
+    simulator.receive(command_long(MAV_CMD_COMPONENT_ARM_DISARM, 1.0f));
+    mavlink_message_t message;
+    EXPECT_FALSE(ground_station.wait_for(
+        MAVLINK_MSG_ID_COMMAND_ACK, message, std::chrono::milliseconds(100)));
+
+    auto arm = command_long(MAV_CMD_COMPONENT_ARM_DISARM, 1.0f);
+    mavlink_command_long_t command;
+    mavlink_msg_command_long_decode(&arm, &command);
+    command.target_system = 42;
+    mavlink_msg_command_long_encode(own_system_id, own_component_id, &arm, &command);
+    simulator.receive(arm);
+
+    ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_COMMAND_ACK, message));
+    EXPECT_EQ(message.sysid, 42);
+
+    command.command = MAV_CMD_REQUEST_MESSAGE;
+    command.param1 = float(MAVLINK_MSG_ID_HEARTBEAT);
+    mavlink_msg_command_long_encode(own_system_id, own_component_id, &arm, &command);
+    simulator.receive(arm);
+
+    ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_HEARTBEAT, message));
+    mavlink_heartbeat_t heartbeat;
+    mavlink_msg_heartbeat_decode(&message, &heartbeat);
+    EXPECT_TRUE(heartbeat.base_mode & MAV_MODE_FLAG_SAFETY_ARMED);
+
+    command.command = MAV_CMD_REQUEST_AUTOPILOT_CAPABILITIES;
+    command.param1 = 1.0f;
+    mavlink_msg_command_long_encode(own_system_id, own_component_id, &arm, &command);
+    simulator.receive(arm);
+
+    ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_AUTOPILOT_VERSION, message));
+    mavlink_autopilot_version_t autopilot_version;
+    mavlink_msg_autopilot_version_decode(&message, &autopilot_version);
+    EXPECT_TRUE(autopilot_version.capabilities & MAV_PROTOCOL_CAPABILITY_MAVLINK2);
+    EXPECT_TRUE(autopilot_version.capabilities & MAV_PROTOCOL_CAPABILITY_FTP);
+    EXPECT_EQ(autopilot_version.uid & 0xff, 42u);
+}
+
+TEST(AutopilotSimulator, ServesParams)
+{
+    AutopilotSimulator::Config config = quiet_config();
+    config.num_extra_params = 100;
+    AutopilotSimulator simulator(config);
+    GroundStation ground_station;
+    simulator.start(ground_station.send_function());
+
+    mavlink_param_request_list_t request_list{};
+    request_list.target_system = 1;
+    request_list.target_component = MAV_COMP_ID_AUTOPILOT1;
+    mavlink_message_t message;
+    mavlink_msg_param_request_list_encode(own_system_id, own_component_id, &message, &request_list);
+    simulator.receive(message);
+
+    std::vector<bool> received;
+    mavlink_param_value_t param_value;
+    while (ground_station.wait_for(
+        MAVLINK_MSG_ID_PARAM_VALUE, message, std::chrono::milliseconds(200))) {
+        mavlink_msg_param_value_decode(&message, &param_value);
+        received.resize(param_value.param_count);
+        received[param_value.param_index] = true;
+    }
+    EXPECT_GT(received.size(), 100u);
+    EXPECT_EQ(std::count(received.begin(), received.end(), true), long(received.size()));
+
+    mavlink_param_set_t param_set{};
+    param_set.target_system = 1;
+    param_set.target_component = MAV_COMP_ID_AUTOPILOT1;
+    std::strncpy(param_set.param_id, "MPC_XY_CRUISE", sizeof(param_set.param_id) - 1);
+    param_set.param_value = 12.5f;
+    param_set.param_type = MAV_PARAM_TYPE_REAL32;
+    mavlink_msg_param_set_encode(own_system_id, own_component_id, &message, &param_set);
+    simulator.receive(message);
+    ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_PARAM_VALUE, message));
+
+    mavlink_param_request_read_t request_read{};
+    request_read.target_system = 1;
+    request_read.target_component = MAV_COMP_ID_AUTOPILOT1;
+    request_read.param_index = -1;
+    std::strncpy(request_read.param_id, "MPC_XY_CRUISE", sizeof(request_read.param_id) - 1);
+    mavlink_msg_param_request_read_encode(own_system_id, own_component_id, &message, &request_read);
+    simulator.receive(message);
+
+    ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_PARAM_VALUE, message));
+    mavlink_msg_param_value_decode(&message, &param_value);
+    EXPECT_STREQ(std::string(param_value.param_id, 13).c_str(), "MPC_XY_CRUISE");
+    EXPECT_FLOAT_EQ(param_value.param_value, 12.5f);
+}
+
+TEST(AutopilotSimulator, ServesCameraParams)
+{
+    AutopilotSimulator::Config config = quiet_config();
+    config.telemetry_rates_hz = {{MAVLINK_MSG_ID_HEARTBEAT, 10.0}};
+    config.camera_vendor_name = "Yuneec";
+    config.camera_model_name = "E90";
+    AutopilotSimulator simulator(config);
+    for (uint32_t i = 0; i < 40; ++i) {
+        MAVLinkParameters::ParamValue value;
+        value.set_uint32(i);
+        simulator.set_camera_param("CAM_PARAM_" + std::to_string(i), value);
+    }
+    GroundStation ground_station;
+    simulator.start(ground_station.send_function());
+
+    mavlink_message_t message;
+    do {
+        ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_HEARTBEAT, message));
+    } while (message.compid != MAV_COMP_ID_CAMERA);
+
+    auto request_information = command_long(MAV_CMD_REQUEST_CAMERA_INFORMATION, 1.0f);
+    mavlink_command_long_t command;
+    mavlink_msg_command_long_decode(&request_information, &command);
+    command.target_component = MAV_COMP_ID_CAMERA;
+    mavlink_msg_command_long_encode(
+        own_system_id, own_component_id, &request_information, &command);
+    simulator.receive(request_information);
+
+    ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_CAMERA_INFORMATION, message));
+    EXPECT_EQ(message.compid, MAV_COMP_ID_CAMERA);
+    mavlink_camera_information_t camera_information;
+    mavlink_msg_camera_information_decode(&message, &camera_information);
+    EXPECT_STREQ(reinterpret_cast<const char*>(camera_information.model_name), "E90");
+
+    mavlink_param_ext_request_list_t request_list{};
+    request_list.target_system = 1;
+    request_list.target_component = MAV_COMP_ID_CAMERA;
+    mavlink_msg_param_ext_request_list_encode(
+        own_system_id, own_component_id, &message, &request_list);
+    simulator.receive(message);
+
+    std::vector<bool> received;
+    mavlink_param_ext_value_t param_ext_value;
+    while (ground_station.wait_for(
+        MAVLINK_MSG_ID_PARAM_EXT_VALUE, message, std::chrono::milliseconds(200))) {
+        mavlink_msg_param_ext_value_decode(&message, &param_ext_value);
+        received.resize(param_ext_value.param_count);
+        received[param_ext_value.param_index] = true;
+    }
+    EXPECT_EQ(received.size(), 40u);
+    EXPECT_EQ(std::count(received.begin(), received.end(), true), long(received.size()));
+
+    mavlink_param_ext_set_t param_ext_set{};
+    param_ext_set.target_system = 1;
+    param_ext_set.target_component = MAV_COMP_ID_CAMERA;
+    std::strncpy(param_ext_set.param_id, "CAM_PARAM_7", sizeof(param_ext_set.param_id) - 1);
+    const uint32_t new_value = 77;
+    std::memcpy(param_ext_set.param_value, &new_value, sizeof(new_value));
+    param_ext_set.param_type = MAV_PARAM_EXT_TYPE_UINT32;
+    mavlink_msg_param_ext_set_encode(own_system_id, own_component_id, &message, &param_ext_set);
+    simulator.receive(message);
+
+    ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_PARAM_EXT_ACK, message));
+    mavlink_param_ext_ack_t param_ext_ack;
+    mavlink_msg_param_ext_ack_decode(&message, &param_ext_ack);
+    EXPECT_EQ(param_ext_ack.param_result, PARAM_ACK_ACCEPTED);
+
+    mavlink_param_ext_request_read_t request_read{};
+    request_read.target_system = 1;
+    request_read.target_component = MAV_COMP_ID_CAMERA;
+    request_read.param_index = -1;
+    std::strncpy(request_read.param_id, "CAM_PARAM_7", sizeof(request_read.param_id) - 1);
+    mavlink_msg_param_ext_request_read_encode(
+        own_system_id, own_component_id, &message, &request_read);
+    simulator.receive(message);
+
+    ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_PARAM_EXT_VALUE, message));
+    mavlink_msg_param_ext_value_decode(&message, &param_ext_value);
+    EXPECT_EQ(param_ext_value.param_index, 7);
+    uint32_t value_read;
+    std::memcpy(&value_read, param_ext_value.param_value, sizeof(value_read));
+    EXPECT_EQ(value_read, 77u);
+
+    // Changed on the camera, it is sent without being asked for.
+    {
+        MAVLinkParameters::ParamValue value;
+        value.set_uint32(99);
+        simulator.set_camera_param("CAM_PARAM_3", value);
+    }
+    ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_PARAM_EXT_VALUE, message));
+    mavlink_msg_param_ext_value_decode(&message, &param_ext_value);
+    EXPECT_EQ(param_ext_value.param_index, 3);
+    std::memcpy(&value_read, param_ext_value.param_value, sizeof(value_read));
+    EXPECT_EQ(value_read, 99u);
+}
+
+TEST(AutopilotSimulator, UploadsAndDownloadsMission)
+{
+    AutopilotSimulator simulator(quiet_config());
+    GroundStation ground_station;
+    simulator.start(ground_station.send_function());
+
+    const uint16_t num_items = 5;
+
+    mavlink_mission_count_t mission_count{};
+    mission_count.target_system = 1;
+    mission_count.target_component = MAV_COMP_ID_AUTOPILOT1;
+    mission_count.count = num_items;
+    mission_count.mission_type = MAV_MISSION_TYPE_FENCE;
+    mavlink_message_t message;
+    mavlink_msg_mission_count_encode(own_system_id, own_component_id, &message, &mission_count);
+    simulator.receive(message);
+
+    for (uint16_t seq = 0; seq < num_items; ++seq) {
+        ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_MISSION_REQUEST_INT, message));
+        mavlink_mission_request_int_t request;
+        mavlink_msg_mission_request_int_decode(&message, &request);
+        EXPECT_EQ(request.seq, seq);
+        EXPECT_EQ(request.mission_type, MAV_MISSION_TYPE_FENCE);
+
+        mavlink_mission_item_int_t item{};
+        item.target_system = 1;
+        item.target_component = MAV_COMP_ID_AUTOPILOT1;
+        item.seq = seq;
+        item.x = 473977420 + seq;
+        item.mission_type = MAV_MISSION_TYPE_FENCE;
+        mavlink_msg_mission_item_int_encode(own_system_id, own_component_id, &message, &item);
+        simulator.receive(message);
+    }
+
+    ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_MISSION_ACK, message));
+    mavlink_mission_ack_t mission_ack;
+    mavlink_msg_mission_ack_decode(&message, &mission_ack);
+    EXPECT_EQ(mission_ack.type, MAV_MISSION_ACCEPTED);
+    EXPECT_EQ(simulator.get_mission_items(MAV_MISSION_TYPE_FENCE).size(), num_items);
+    EXPECT_TRUE(simulator.get_mission_items(MAV_MISSION_TYPE_MISSION).empty());
+
+    mavlink_mission_request_list_t request_list{};
+    request_list.target_system = 1;
+    request_list.target_component = MAV_COMP_ID_AUTOPILOT1;
+    request_list.mission_type = MAV_MISSION_TYPE_FENCE;
+    mavlink_msg_mission_request_list_encode(
+        own_system_id, own_component_id, &message, &request_list);
+    simulator.receive(message);
+
+    ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_MISSION_COUNT, message));
+    mavlink_msg_mission_count_decode(&message, &mission_count);
+    EXPECT_EQ(mission_count.count, num_items);
+
+    mavlink_mission_request_int_t request{};
+    request.target_system = 1;
+    request.target_component = MAV_COMP_ID_AUTOPILOT1;
+    request.seq = 3;
+    request.mission_type = MAV_MISSION_TYPE_FENCE;
+    mavlink_msg_mission_request_int_encode(own_system_id, own_component_id, &message, &request);
+    simulator.receive(message);
+
+    ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_MISSION_ITEM_INT, message));
+    mavlink_mission_item_int_t item;
+    mavlink_msg_mission_item_int_decode(&message, &item);
+    EXPECT_EQ(item.seq, 3);
+    EXPECT_EQ(item.x, 473977423);
+}
+
+TEST(AutopilotSimulator, ServesFtp)
+{
+    AutopilotSimulator simulator(quiet_config());
+    GroundStation ground_station;
+
+    std::vector<uint8_t> content(1000);
+    for (std::size_t i = 0; i < content.size(); ++i) {
+        content[i] = uint8_t(i * 7);
+    }
+    simulator.add_file("/fs/microsd/log/test.ulg", content);
+    simulator.start(ground_station.send_function());
+
+    simulator.receive(ftp_request(1, 0, 4, 0, "/fs/microsd/log/test.ulg"));
+
+    mavlink_message_t message;
+    mavlink_file_transfer_protocol_t ftp;
+    ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, message));
+    mavlink_msg_file_transfer_protocol_decode(&message, &ftp);
+    EXPECT_EQ(ftp.payload[3], 128); // ACK
+    uint32_t file_size;
+    std::memcpy(&file_size, &ftp.payload[12], sizeof(file_size));
+    EXPECT_EQ(file_size, content.size());
+    const uint8_t session = ftp.payload[2];
+
+    // Burst read of everything.
+    simulator.receive(ftp_request(2, session, 15, 0, ""));
+    std::vector<uint8_t> downloaded;
+    bool complete = false;
+    while (!complete) {
+        ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, message));
+        mavlink_msg_file_transfer_protocol_decode(&message, &ftp);
+        ASSERT_EQ(ftp.payload[3], 128);
+        uint32_t offset;
+        std::memcpy(&offset, &ftp.payload[8], sizeof(offset));
+        EXPECT_EQ(offset, downloaded.size());
+        downloaded.insert(downloaded.end(), &ftp.payload[12], &ftp.payload[12] + ftp.payload[4]);
+        complete = (ftp.payload[6] != 0);
+    }
+    EXPECT_EQ(downloaded, content);
+
+    // Reading past the end.
+    simulator.receive(ftp_request(10, session, 5, 1000, ""));
+    ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, message));
+    mavlink_msg_file_transfer_protocol_decode(&message, &ftp);
+    EXPECT_EQ(ftp.payload[3], 129); // NAK
+    EXPECT_EQ(ftp.payload[12], 6); // EOF
+
+    simulator.receive(ftp_request(11, 0, 3, 0, "/fs/microsd"));
+    ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, message));
+    mavlink_msg_file_transfer_protocol_decode(&message, &ftp);
+    EXPECT_STREQ(reinterpret_cast<const char*>(&ftp.payload[12]), "Dlog");
+
+    // Opening something which isn't there.
+    simulator.receive(ftp_request(12, 0, 4, 0, "/fs/microsd/nothing"));
+    ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, message));
+    mavlink_msg_file_transfer_protocol_decode(&message, &ftp);
+    EXPECT_EQ(ftp.payload[3], 129);
+    EXPECT_EQ(ftp.payload[12], 10); // does not exist
+}
+
+TEST(AutopilotSimulator, WritesFtp)
+{
+    AutopilotSimulator simulator(quiet_config());
+    GroundStation ground_station;
+    simulator.start(ground_station.send_function());
+
+    simulator.receive(ftp_request(1, 0, 6, 0, "/fs/microsd/new.txt"));
+    mavlink_message_t message;
+    mavlink_file_transfer_protocol_t ftp;
+    ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, message));
+    mavlink_msg_file_transfer_protocol_decode(&message, &ftp);
+    ASSERT_EQ(ftp.payload[3], 128);
+    const uint8_t session = ftp.payload[2];
+
+    simulator.receive(ftp_request(2, session, 7, 0, "hello "));
+    simulator.receive(ftp_request(3, session, 7, 6, "world"));
+    simulator.receive(ftp_request(4, session, 1, 0, ""));
+    for (unsigned i = 0; i < 3; ++i) {
+        ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, message));
+        mavlink_msg_file_transfer_protocol_decode(&message, &ftp);
+        EXPECT_EQ(ftp.payload[3], 128);
+    }
+
+    std::vector<uint8_t> content;
+    ASSERT_TRUE(simulator.get_file("/fs/microsd/new.txt", content));
+    EXPECT_EQ(std::string(content.begin(), content.end()), "hello world");
+
+    // The CRC32 as PX4 calculates it.
+    simulator.receive(ftp_request(5, 0, 14, 0, "/fs/microsd/new.txt"));
+    ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, message));
+    mavlink_msg_file_transfer_protocol_decode(&message, &ftp);
+    uint32_t crc;
+    std::memcpy(&crc, &ftp.payload[12], sizeof(crc));
+    EXPECT_EQ(crc, 0x66CDA069u);
+}
+
+TEST(AutopilotSimulator, ServesLogs)
+{
+    AutopilotSimulator simulator(quiet_config());
+    GroundStation ground_station;
+
+    std::vector<uint8_t> content(1000);
+    for (std::size_t i = 0; i < content.size(); ++i) {
+        content[i] = uint8_t(i * 7);
+    }
+    simulator.add_log(std::vector<uint8_t>(10));
+    simulator.add_log(content);
+    simulator.start(ground_station.send_function());
+
+    mavlink_message_t message;
+    mavlink_msg_log_request_list_pack(
+        own_system_id, own_component_id, &message, 1, MAV_COMP_ID_AUTOPILOT1, 0, 0xFFFF);
+    simulator.receive(message);
+    mavlink_log_entry_t log_entry;
+    for (uint16_t id = 0; id < 2; ++id) {
+        ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_LOG_ENTRY, message));
+        mavlink_msg_log_entry_decode(&message, &log_entry);
+        EXPECT_EQ(log_entry.id, id);
+        EXPECT_EQ(log_entry.num_logs, 2);
+    }
+    EXPECT_EQ(log_entry.size, content.size());
+
+    // The second request replaces the first one.
+    mavlink_msg_log_request_data_pack(
+        own_system_id, own_component_id, &message, 1, MAV_COMP_ID_AUTOPILOT1, 1, 0, 900);
+    simulator.receive(message);
+    mavlink_msg_log_request_data_pack(
+        own_system_id, own_component_id, &message, 1, MAV_COMP_ID_AUTOPILOT1, 1, 900, 0xFFFFFFFF);
+    simulator.receive(message);
+
+    std::vector<uint8_t> downloaded(content.size());
+    std::size_t bytes_received = 0;
+    while (bytes_received < 100) {
+        ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_LOG_DATA, message));
+        mavlink_log_data_t log_data;
+        mavlink_msg_log_data_decode(&message, &log_data);
+        ASSERT_LE(log_data.ofs + log_data.count, downloaded.size());
+        std::memcpy(&downloaded[log_data.ofs], log_data.data, log_data.count);
+        if (log_data.ofs >= 900) {
+            bytes_received += log_data.count;
+        }
+    }
+    EXPECT_TRUE(std::equal(content.begin() + 900, content.end(), downloaded.begin() + 900));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(ground_station.count(MAVLINK_MSG_ID_LOG_DATA), 0u);
+}
+
+TEST(AutopilotSimulator, AddsLatency)
+{
+    AutopilotSimulator::Config config = quiet_config();
+    config.latency = std::chrono::milliseconds(100);
+    AutopilotSimulator simulator(config);
+    GroundStation ground_station;
+    simulator.start(ground_station.send_function());
+
+    const auto start_time = std::chrono::steady_clock::now();
+    simulator.receive(command_long(MAV_CMD_COMPONENT_ARM_DISARM, 1.0f));
+    mavlink_message_t message;
+    ASSERT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_COMMAND_ACK, message));
+    const auto round_trip = std::chrono::steady_clock::now() - start_time;
+
+    EXPECT_GE(round_trip, std::chrono::milliseconds(200));
+    EXPECT_LT(round_trip, std::chrono::milliseconds(500));
+}
+
+TEST(AutopilotSimulator, LosesMessages)
+{
+    AutopilotSimulator::Config config = quiet_config();
+    config.loss_ratio = 0.5;
+    AutopilotSimulator simulator(config);
+    GroundStation ground_station;
+    simulator.start(ground_station.send_function());
+
+    const unsigned num_requests = 1000;
+    for (unsigned i = 0; i < num_requests; ++i) {
+        simulator.receive(command_long(MAV_CMD_COMPONENT_ARM_DISARM, 1.0f));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    simulator.stop();
+
+    const auto statistics = simulator.get_statistics();
+    EXPECT_EQ(statistics.num_received + statistics.num_sent + statistics.num_lost,
+              num_requests + statistics.num_received);
+    // Roughly a quarter makes it through both ways.
+    EXPECT_GT(ground_station.count(MAVLINK_MSG_ID_COMMAND_ACK), 150u);
+    EXPECT_LT(ground_station.count(MAVLINK_MSG_ID_COMMAND_ACK), 350u);
+}
+
+TEST(AutopilotSimulator, TalksOverLoopback)
+{
+    AutopilotSimulator::Config config = quiet_config();
+    config.telemetry_rates_hz[MAVLINK_MSG_ID_HEARTBEAT] = 10.0;
+    AutopilotSimulator simulator(config);
+    ASSERT_TRUE(simulator.start_loopback("autopilot_simulator_test"));
+
+    GroundStation ground_station;
+    auto send_function = ground_station.send_function();
+    LoopbackConnection connection(
+        [&send_function](mavlink_message_t& message, Connection*) { send_function(message); },
+        "autopilot_simulator_test");
+    ASSERT_EQ(connection.start(), ConnectionResult::Success);
+
+    mavlink_message_t message;
+    EXPECT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_HEARTBEAT, message));
+
+    EXPECT_TRUE(connection.send_message(command_long(MAV_CMD_COMPONENT_ARM_DISARM, 1.0f)));
+    EXPECT_TRUE(ground_station.wait_for(MAVLINK_MSG_ID_COMMAND_ACK, message));
+}
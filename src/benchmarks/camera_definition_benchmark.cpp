@@ -0,0 +1,169 @@
+//
+// Benchmark of loading camera definitions when a camera connects.
+//
+// For each definition that comes with the library, this compares parsing the
+// XML, which happened for every connection before, with loading the binary
+// form that is now built in, and with loading a downloaded definition from the
+// cache on disk. It also reports how much heap each way keeps afterwards and
+// how much the parsed XML document alone takes, which used to be kept as well.
+//
+// Run this from the root of the repository.
+//
+// Usage: camera_definition_benchmark [iterations]
+//
+
+#include "camera_definition.h"
+#include "camera_definition_cache.h"
+#include "camera_definition_files.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+using namespace mavsdk;
+
+namespace {
+
+const std::string definitions_dir = "src/plugins/camera/camera_definition_files/";
+const std::string cache_dir = "camera_definition_benchmark_cache";
+
+struct BuiltIn {
+    std::string name;
+    const char* binary;
+    std::size_t binary_size;
+};
+
+const std::vector<BuiltIn> built_ins{
+    {"cgoet", cgoet_binary, cgoet_binary_size},
+    {"e10t", e10t_binary, e10t_binary_size},
+    {"e50", e50_binary, e50_binary_size},
+    {"e90", e90_binary, e90_binary_size},
+};
+
+// Heap in use, or 0 if that can't be told here.
+std::size_t heap_in_use()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+template<typename Load> double average_ms(unsigned iterations, const Load& load)
+{
+    const auto start_time = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < iterations; ++i) {
+        CameraDefinition camera_definition;
+        load(camera_definition);
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time)
+               .count() /
+           iterations;
+}
+
+template<typename Load> std::size_t kept_bytes(const Load& load)
+{
+    const std::size_t before = heap_in_use();
+    std::unique_ptr<CameraDefinition> camera_definition{new CameraDefinition()};
+    load(*camera_definition);
+    return heap_in_use() - before;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const unsigned iterations = (argc > 1) ? unsigned(std::atoi(argv[1])) : 200;
+
+    CameraDefinitionCache cache(cache_dir);
+
+    // Parsing some of the definitions logs warnings over and over which would drown the results.
+    std::cout.setstate(std::ios::failbit);
+
+    std::printf(
+        "%-6s %8s %8s | %9s %9s %9s | %9s %9s %9s\n",
+        "",
+        "xml",
+        "binary",
+        "xml",
+        "binary",
+        "cache",
+        "xml",
+        "binary",
+        "xml doc");
+    std::printf(
+        "%-6s %8s %8s | %9s %9s %9s | %9s %9s %9s\n",
+        "",
+        "bytes",
+        "bytes",
+        "ms",
+        "ms",
+        "ms",
+        "heap",
+        "heap",
+        "heap");
+
+    for (const auto& built_in : built_ins) {
+        std::ifstream file(definitions_dir + built_in.name + ".xml");
+        if (!file) {
+            std::fprintf(stderr, "Could not open definitions, run this from the root.\n");
+            return 1;
+        }
+        std::stringstream xml_stream;
+        xml_stream << file.rdbuf();
+        const std::string xml = xml_stream.str();
+
+        const std::string uri = "http://camera.local/" + built_in.name + ".xml";
+        CameraDefinition parsed;
+        parsed.load_string(xml);
+        cache.store(uri, 1, parsed);
+
+        const auto load_xml = [&xml](CameraDefinition& cd) { cd.load_string(xml); };
+        const auto load_binary = [&built_in](CameraDefinition& cd) {
+            cd.load_binary(built_in.binary, built_in.binary_size);
+        };
+        const auto load_cached = [&cache, &uri](CameraDefinition& cd) { cache.load(uri, 1, cd); };
+
+        const std::size_t before_doc = heap_in_use();
+        std::size_t doc_bytes;
+        {
+            std::unique_ptr<tinyxml2::XMLDocument> doc{new tinyxml2::XMLDocument()};
+            doc->Parse(xml.c_str());
+            doc_bytes = heap_in_use() - before_doc;
+        }
+
+        std::printf(
+            "%-6s %8zu %8zu | %9.3f %9.3f %9.3f | %9zu %9zu %9zu\n",
+            built_in.name.c_str(),
+            xml.size(),
+            built_in.binary_size,
+            average_ms(iterations, load_xml),
+            average_ms(iterations, load_binary),
+            average_ms(iterations, load_cached),
+            kept_bytes(load_xml),
+            kept_bytes(load_binary),
+            doc_bytes);
+    }
+
+    std::cout.clear();
+    if (heap_in_use() == 0) {
+        std::printf("Heap use can't be measured on this platform.\n");
+    }
+
+    for (const auto& built_in : built_ins) {
+        cache.remove("http://camera.local/" + built_in.name + ".xml", 1);
+    }
+    std::remove(cache_dir.c_str());
+    return 0;
+}
@@ -0,0 +1,170 @@
+//
+// Benchmark of getting the settings of a camera when it connects, over a link
+// with 100 ms round trip time.
+//
+// For each camera with a definition built into the library, a camera is
+// simulated in this process, with 50 ms latency in each direction, serving the
+// default settings. This measures the time from creating the plugin until the
+// current settings include all possible ones, and how many messages the camera
+// got meanwhile. This is done with a camera sending all its params when asked
+// and with one only answering requests for single params.
+//
+// Usage: camera_settings_benchmark [runs]
+//
+
+#include "mavsdk.h"
+#include "plugins/camera/camera.h"
+#include "autopilot_simulator.h"
+#include "camera_definition.h"
+#include "camera_definition_files.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+struct BuiltIn {
+    std::string model_name;
+    const char* binary;
+    std::size_t binary_size;
+};
+
+const std::vector<BuiltIn> built_ins{
+    {"CGOET", cgoet_binary, cgoet_binary_size},
+    {"E10T", e10t_binary, e10t_binary_size},
+    {"E50", e50_binary, e50_binary_size},
+    {"E90", e90_binary, e90_binary_size},
+};
+
+struct Measurement {
+    double elapsed_s{0.0};
+    uint64_t num_received{0};
+};
+
+bool populate(const BuiltIn& built_in, bool sends_param_list, unsigned run, Measurement& result)
+{
+    AutopilotSimulator::Config config;
+    config.latency = std::chrono::milliseconds(50);
+    config.camera_vendor_name = "Yuneec";
+    config.camera_model_name = built_in.model_name;
+    config.camera_sends_param_list = sends_param_list;
+    AutopilotSimulator simulator(config);
+
+    CameraDefinition camera_definition;
+    if (!camera_definition.load_binary(built_in.binary, built_in.binary_size)) {
+        std::cerr << "Could not load definition" << std::endl;
+        return false;
+    }
+    camera_definition.assume_default_settings();
+    std::unordered_map<std::string, MAVLinkParameters::ParamValue> settings{};
+    camera_definition.get_all_settings(settings);
+    for (const auto& setting : settings) {
+        simulator.set_camera_param(setting.first, setting.second);
+    }
+
+    const std::string name = "camera_settings_benchmark_" + built_in.model_name +
+                             (sends_param_list ? "_list_" : "_single_") + std::to_string(run);
+    if (!simulator.start_loopback(name)) {
+        std::cerr << "Could not start simulator" << std::endl;
+        return false;
+    }
+
+    Mavsdk mavsdk;
+    if (mavsdk.add_any_connection("loopback://" + name) != ConnectionResult::Success) {
+        std::cerr << "Could not connect to simulator" << std::endl;
+        return false;
+    }
+    while (!mavsdk.is_connected()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    const uint64_t num_received_before = simulator.get_statistics().num_received;
+    const auto start_time = std::chrono::steady_clock::now();
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+    bool populated = false;
+    auto camera = std::make_shared<Camera>(mavsdk.system());
+    Camera* camera_ptr = camera.get();
+    camera->subscribe_current_settings(
+        [&prom, &populated, camera_ptr](std::vector<Camera::Setting> current_settings) {
+            if (!populated && !current_settings.empty() &&
+                current_settings.size() == camera_ptr->possible_setting_options().size()) {
+                populated = true;
+                prom.set_value();
+            }
+        });
+
+    const bool in_time = fut.wait_for(std::chrono::seconds(60)) == std::future_status::ready;
+    result.elapsed_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    result.num_received = simulator.get_statistics().num_received - num_received_before;
+
+    camera->subscribe_current_settings(nullptr);
+    camera.reset();
+    simulator.stop();
+
+    if (!in_time) {
+        std::cerr << "Settings of " << built_in.model_name << " not populated" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const unsigned runs = (argc > 1) ? unsigned(std::atoi(argv[1])) : 3;
+
+    // MAVSDK logs every param it gets which would drown the results.
+    std::cout.setstate(std::ios::failbit);
+
+    std::printf(
+        "%-6s %6s | %9s %9s | %9s %9s\n", "", "", "list", "list", "single", "single");
+    std::printf("%-6s %6s | %9s %9s | %9s %9s\n", "", "params", "s", "msgs", "s", "msgs");
+
+    for (const auto& built_in : built_ins) {
+        CameraDefinition camera_definition;
+        camera_definition.load_binary(built_in.binary, built_in.binary_size);
+        camera_definition.assume_default_settings();
+        std::unordered_map<std::string, MAVLinkParameters::ParamValue> settings{};
+        camera_definition.get_all_settings(settings);
+
+        Measurement list_total;
+        Measurement single_total;
+        for (unsigned run = 0; run < runs; ++run) {
+            Measurement list;
+            Measurement single;
+            if (!populate(built_in, true, run, list) || !populate(built_in, false, run, single)) {
+                return 1;
+            }
+            list_total.elapsed_s += list.elapsed_s;
+            list_total.num_received += list.num_received;
+            single_total.elapsed_s += single.elapsed_s;
+            single_total.num_received += single.num_received;
+        }
+
+        std::printf(
+            "%-6s %6zu | %9.2f %9llu | %9.2f %9llu\n",
+            built_in.model_name.c_str(),
+            settings.size(),
+            list_total.elapsed_s / runs,
+            static_cast<unsigned long long>(list_total.num_received / runs),
+            single_total.elapsed_s / runs,
+            static_cast<unsigned long long>(single_total.num_received / runs));
+    }
+
+    std::cout.clear();
+    return 0;
+}
@@ -0,0 +1,97 @@
+//
+// Benchmark of the coordinate transformation between global and local
+// coordinates, one point at a time compared to the batch functions.
+//
+// Usage: coordinate_transformation_benchmark [num_points] [spread_m]
+//
+
+#include "geometry.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace mavsdk::geometry;
+
+namespace {
+
+template<typename Function> double points_per_second(std::size_t num_points, Function function)
+{
+    // Repeat until it took long enough to be measured.
+    unsigned rounds = 0;
+    const auto before = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed{};
+    do {
+        function();
+        ++rounds;
+        elapsed = std::chrono::steady_clock::now() - before;
+    } while (elapsed.count() < 0.5);
+
+    return double(num_points) * double(rounds) / elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const std::size_t num_points = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    const double spread_m = (argc > 2) ? std::atof(argv[2]) : 10000.0;
+
+    CoordinateTransformation ct({47.397742, 8.545594});
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> offset_m(-spread_m, spread_m);
+
+    std::vector<double> norths_m(num_points);
+    std::vector<double> easts_m(num_points);
+    std::vector<double> latitudes_deg(num_points);
+    std::vector<double> longitudes_deg(num_points);
+    for (std::size_t i = 0; i < num_points; ++i) {
+        norths_m[i] = offset_m(rng);
+        easts_m[i] = offset_m(rng);
+        const auto global = ct.global_from_local({norths_m[i], easts_m[i]});
+        latitudes_deg[i] = global.latitude_deg;
+        longitudes_deg[i] = global.longitude_deg;
+    }
+
+    std::vector<double> out_a(num_points);
+    std::vector<double> out_b(num_points);
+
+    const double local_scalar = points_per_second(num_points, [&]() {
+        for (std::size_t i = 0; i < num_points; ++i) {
+            const auto local = ct.local_from_global({latitudes_deg[i], longitudes_deg[i]});
+            out_a[i] = local.north_m;
+            out_b[i] = local.east_m;
+        }
+    });
+    const double local_batch = points_per_second(num_points, [&]() {
+        ct.local_from_global(
+            latitudes_deg.data(), longitudes_deg.data(), out_a.data(), out_b.data(), num_points);
+    });
+
+    const double global_scalar = points_per_second(num_points, [&]() {
+        for (std::size_t i = 0; i < num_points; ++i) {
+            const auto global = ct.global_from_local({norths_m[i], easts_m[i]});
+            out_a[i] = global.latitude_deg;
+            out_b[i] = global.longitude_deg;
+        }
+    });
+    const double global_batch = points_per_second(num_points, [&]() {
+        ct.global_from_local(
+            norths_m.data(), easts_m.data(), out_a.data(), out_b.data(), num_points);
+    });
+
+    std::cout << num_points << " points within " << spread_m << " m\n"
+              << "local_from_global:\n"
+              << "  one by one:  " << local_scalar / 1e6 << " M points/s\n"
+              << "  batch:       " << local_batch / 1e6 << " M points/s ("
+              << local_batch / local_scalar << "x)\n"
+              << "global_from_local:\n"
+              << "  one by one:  " << global_scalar / 1e6 << " M points/s\n"
+              << "  batch:       " << global_batch / 1e6 << " M points/s ("
+              << global_batch / global_scalar << "x)\n";
+
+    return 0;
+}
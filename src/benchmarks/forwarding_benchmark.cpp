@@ -0,0 +1,160 @@
+//
+// Throughput of MAVSDK forwarding messages between connections.
+//
+// MAVSDK sits between a vehicle and a ground station, both connected over
+// in-process loopback links, and forwards telemetry from the vehicle to the
+// ground station as well as commands targeted at the vehicle the other way.
+// The loopback links keep the sockets out of the measurement.
+//
+// Usage: forwarding_benchmark [num_messages]
+//
+
+#include "mavsdk.h"
+#include "loopback_connection.h"
+#include "mavlink_include.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+using namespace mavsdk;
+
+namespace {
+
+constexpr uint8_t vehicle_system_id = 1;
+constexpr uint8_t ground_station_system_id = 250;
+
+// Sends num_messages and returns the rate at which they arrived, stops
+// waiting once nothing arrives anymore.
+double measure(
+    Connection& sender,
+    const mavlink_message_t& message,
+    const std::atomic<unsigned>& num_received,
+    unsigned num_messages)
+{
+    const unsigned num_received_before = num_received;
+    const auto start_time = std::chrono::steady_clock::now();
+
+    for (unsigned i = 0; i < num_messages; ++i) {
+        // The link is full if MAVSDK can't keep up, wait for it then.
+        while (!sender.send_message(message)) {
+            std::this_thread::yield();
+        }
+    }
+
+    auto last_progress_time = std::chrono::steady_clock::now();
+    unsigned last_count = num_received;
+    while (num_received - num_received_before < num_messages) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        const unsigned count = num_received;
+        const auto now = std::chrono::steady_clock::now();
+        if (count != last_count) {
+            last_count = count;
+            last_progress_time = now;
+        } else if (now - last_progress_time > std::chrono::seconds(1)) {
+            break;
+        }
+    }
+
+    const unsigned num_forwarded = num_received - num_received_before;
+    const double elapsed_s =
+        std::chrono::duration<double>(last_progress_time - start_time).count();
+    if (num_forwarded < num_messages) {
+        std::printf("  %u of %u messages lost\n", num_messages - num_forwarded, num_messages);
+    }
+    return double(num_forwarded) / elapsed_s;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const unsigned num_messages = (argc > 1) ? unsigned(std::atoi(argv[1])) : 1000000;
+
+    std::atomic<unsigned> num_attitudes{0};
+    std::atomic<unsigned> num_commands{0};
+
+    LoopbackConnection vehicle(
+        [&num_commands](mavlink_message_t& message, Connection*) {
+            if (message.msgid == MAVLINK_MSG_ID_COMMAND_LONG) {
+                ++num_commands;
+            }
+        },
+        "forwarding_benchmark_vehicle");
+    LoopbackConnection ground_station(
+        [&num_attitudes](mavlink_message_t& message, Connection*) {
+            if (message.msgid == MAVLINK_MSG_ID_ATTITUDE) {
+                ++num_attitudes;
+            }
+        },
+        "forwarding_benchmark_ground_station");
+
+    Mavsdk mavsdk;
+    mavsdk.set_message_forwarding(true);
+    if (mavsdk.add_any_connection("loopback://forwarding_benchmark_vehicle") !=
+            ConnectionResult::Success ||
+        mavsdk.add_any_connection("loopback://forwarding_benchmark_ground_station") !=
+            ConnectionResult::Success ||
+        vehicle.start() != ConnectionResult::Success ||
+        ground_station.start() != ConnectionResult::Success) {
+        std::fprintf(stderr, "Could not set up connections\n");
+        return 1;
+    }
+
+    mavlink_message_t heartbeat;
+    mavlink_msg_heartbeat_pack(
+        vehicle_system_id,
+        MAV_COMP_ID_AUTOPILOT1,
+        &heartbeat,
+        MAV_TYPE_QUADROTOR,
+        MAV_AUTOPILOT_PX4,
+        MAV_MODE_FLAG_CUSTOM_MODE_ENABLED,
+        0,
+        MAV_STATE_ACTIVE);
+    vehicle.send_message(heartbeat);
+
+    mavlink_message_t attitude;
+    mavlink_msg_attitude_pack(
+        vehicle_system_id,
+        MAV_COMP_ID_AUTOPILOT1,
+        &attitude,
+        0,
+        0.1f,
+        -0.1f,
+        1.0f,
+        0.0f,
+        0.0f,
+        0.1f);
+
+    mavlink_message_t command;
+    mavlink_msg_command_long_pack(
+        ground_station_system_id,
+        MAV_COMP_ID_MISSIONPLANNER,
+        &command,
+        vehicle_system_id,
+        MAV_COMP_ID_AUTOPILOT1,
+        MAV_CMD_REQUEST_MESSAGE,
+        0,
+        float(MAVLINK_MSG_ID_AUTOPILOT_VERSION),
+        0.0f,
+        0.0f,
+        0.0f,
+        0.0f,
+        0.0f,
+        0.0f);
+
+    // Let the vehicle be discovered, so its link is known.
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    std::printf("Forwarding %u messages each way\n", num_messages);
+    std::printf(
+        "  telemetry to ground station:  %10.0f msgs/s\n",
+        measure(vehicle, attitude, num_attitudes, num_messages));
+    std::printf(
+        "  commands to vehicle:          %10.0f msgs/s\n",
+        measure(ground_station, command, num_commands, num_messages));
+
+    return 0;
+}
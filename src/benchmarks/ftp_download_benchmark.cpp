@@ -0,0 +1,120 @@
+//
+// Benchmark of MAVLink FTP downloads over a link with 100 ms round trip time.
+//
+// The autopilot is simulated in this process, with 50 ms latency in each
+// direction and optionally some messages lost. The same file is downloaded
+// reading one chunk after the other, and using burst reads.
+//
+// Usage: ftp_download_benchmark [file_size_kb] [loss_percent]
+//
+
+#include "mavsdk.h"
+#include "plugins/ftp/ftp.h"
+#include "autopilot_simulator.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+const std::string remote_path = "/fs/microsd/benchmark.bin";
+const std::string local_path = "benchmark.bin";
+
+bool download(Ftp& ftp, const std::vector<uint8_t>& expected, const char* name)
+{
+    std::promise<Ftp::Result> prom;
+    auto fut = prom.get_future();
+
+    const auto start_time = std::chrono::steady_clock::now();
+    ftp.download_async(remote_path, ".", [&prom](Ftp::Result result, Ftp::ProgressData) {
+        if (result != Ftp::Result::Next) {
+            prom.set_value(result);
+        }
+    });
+    const auto result = fut.get();
+    const double elapsed_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    std::ifstream file(local_path, std::ios::binary);
+    const std::vector<uint8_t> content(
+        (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::remove(local_path.c_str());
+
+    if (result != Ftp::Result::Success || content != expected) {
+        std::cerr << name << " download failed: " << result << std::endl;
+        return false;
+    }
+
+    std::printf(
+        "  %-14s %8.2f s %10.1f KiB/s\n",
+        name,
+        elapsed_s,
+        double(expected.size()) / 1024.0 / elapsed_s);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const unsigned file_size_kb = (argc > 1) ? unsigned(std::atoi(argv[1])) : 32;
+    const double loss_percent = (argc > 2) ? std::atof(argv[2]) : 0.0;
+
+    std::mt19937 random(0);
+    std::vector<uint8_t> content(file_size_kb * 1024);
+    for (auto& byte : content) {
+        byte = uint8_t(random());
+    }
+
+    AutopilotSimulator::Config config;
+    config.latency = std::chrono::milliseconds(50);
+    config.loss_ratio = loss_percent / 100.0;
+    AutopilotSimulator simulator(config);
+    simulator.add_file(remote_path, content);
+    if (!simulator.start_loopback("ftp_download_benchmark")) {
+        std::cerr << "Could not start simulator" << std::endl;
+        return 1;
+    }
+
+    Mavsdk mavsdk;
+    if (mavsdk.add_any_connection("loopback://ftp_download_benchmark") !=
+        ConnectionResult::Success) {
+        std::cerr << "Could not connect to simulator" << std::endl;
+        return 1;
+    }
+    while (!mavsdk.is_connected()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    auto ftp = std::make_shared<Ftp>(mavsdk.system());
+
+    std::printf(
+        "Download of %u KiB with 100 ms round trip time, %.1f%% loss\n",
+        file_size_kb,
+        loss_percent);
+
+    ftp->set_burst_download(false);
+    if (!download(*ftp, content, "chunk by chunk")) {
+        return 1;
+    }
+
+    ftp->set_burst_download(true);
+    if (!download(*ftp, content, "burst")) {
+        return 1;
+    }
+
+    simulator.stop();
+    return 0;
+}
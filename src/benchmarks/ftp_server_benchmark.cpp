@@ -0,0 +1,163 @@
+//
+// Benchmark of MAVSDK as MAVLink FTP server.
+//
+// A server and a client are run in this process, connected over UDP on
+// localhost. A file is downloaded chunk by chunk and in bursts, and a
+// directory of files is synced with different numbers of transfers at once,
+// each of which takes a session on the server.
+//
+// Usage: ftp_server_benchmark [num_files] [file_size_kb]
+//
+
+#include "mavsdk.h"
+#include "plugins/ftp/ftp.h"
+#include "fs.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+const std::string root_dir = "ftp_server_benchmark_root";
+const std::string local_dir = "ftp_server_benchmark";
+constexpr int port = 14660;
+
+std::string file_name(unsigned i)
+{
+    return std::to_string(i) + ".ulg";
+}
+
+void remove_files(const std::string& dir, unsigned num_files)
+{
+    for (unsigned i = 0; i < num_files; ++i) {
+        std::remove((dir + "/" + file_name(i)).c_str());
+    }
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start_time)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+void print_result(const std::string& name, double elapsed_s, std::size_t bytes)
+{
+    std::printf(
+        "  %-22s %8.2f s %10.1f KiB/s\n",
+        name.c_str(),
+        elapsed_s,
+        double(bytes) / 1024.0 / elapsed_s);
+}
+
+bool download(Ftp& ftp, bool burst, std::size_t file_size)
+{
+    ftp.set_burst_download(burst);
+
+    std::promise<Ftp::Result> prom;
+    auto fut = prom.get_future();
+    const auto start_time = std::chrono::steady_clock::now();
+    ftp.download_async(
+        "/" + file_name(0), local_dir, [&prom](Ftp::Result result, Ftp::ProgressData) {
+            if (result != Ftp::Result::Next) {
+                prom.set_value(result);
+            }
+        });
+    const auto result = fut.get();
+    if (result != Ftp::Result::Success) {
+        std::cerr << "Download failed: " << result << std::endl;
+        return false;
+    }
+    print_result(burst ? "burst" : "chunk by chunk", seconds_since(start_time), file_size);
+    std::remove((local_dir + "/" + file_name(0)).c_str());
+    return true;
+}
+
+bool sync(Ftp& ftp, uint32_t count, std::size_t bytes)
+{
+    ftp.set_burst_download(true);
+    ftp.set_max_parallel_transfers(count);
+
+    std::promise<Ftp::Result> prom;
+    auto fut = prom.get_future();
+    const auto start_time = std::chrono::steady_clock::now();
+    ftp.sync_directory_async("/", local_dir, [&prom](Ftp::Result result, Ftp::ProgressData) {
+        if (result != Ftp::Result::Next) {
+            prom.set_value(result);
+        }
+    });
+    const auto result = fut.get();
+    if (result != Ftp::Result::Success) {
+        std::cerr << "Sync failed: " << result << std::endl;
+        return false;
+    }
+    print_result(
+        "sync, " + std::to_string(count) + " at once", seconds_since(start_time), bytes);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const unsigned num_files = (argc > 1) ? unsigned(std::atoi(argv[1])) : 8;
+    const unsigned file_size_kb = (argc > 2) ? unsigned(std::atoi(argv[2])) : 1024;
+    const std::size_t file_size = std::size_t(file_size_kb) * 1024;
+
+    fs_create_directory(root_dir);
+    fs_create_directory(local_dir);
+    std::mt19937 random(0);
+    std::vector<char> content(file_size);
+    for (unsigned i = 0; i < num_files; ++i) {
+        for (auto& byte : content) {
+            byte = char(random());
+        }
+        std::ofstream(root_dir + "/" + file_name(i), std::ios::binary)
+            .write(content.data(), content.size());
+    }
+
+    Mavsdk server_mavsdk;
+    server_mavsdk.set_configuration(
+        Mavsdk::Configuration(Mavsdk::Configuration::UsageType::Autopilot));
+    if (server_mavsdk.setup_udp_remote("127.0.0.1", port) != ConnectionResult::Success) {
+        std::cerr << "Could not start server" << std::endl;
+        return 1;
+    }
+    auto server = std::make_shared<Ftp>(server_mavsdk.system());
+    server->set_root_directory(root_dir);
+
+    Mavsdk client_mavsdk;
+    if (client_mavsdk.add_udp_connection(port) != ConnectionResult::Success) {
+        std::cerr << "Could not start client" << std::endl;
+        return 1;
+    }
+    while (!client_mavsdk.is_connected()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    auto client = std::make_shared<Ftp>(client_mavsdk.system());
+
+    std::printf("Download of %u files of %u KiB from a local server\n", num_files, file_size_kb);
+
+    bool success = download(*client, false, file_size) && download(*client, true, file_size);
+    for (const uint32_t count : {1, 4, 8}) {
+        if (!success) {
+            break;
+        }
+        success = sync(*client, count, num_files * file_size);
+        remove_files(local_dir, num_files);
+    }
+
+    std::remove(local_dir.c_str());
+    remove_files(root_dir, num_files);
+    std::remove(root_dir.c_str());
+    return success ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+//
+// Benchmark of retrieving many files over MAVLink FTP with 100 ms round trip time.
+//
+// The autopilot is simulated in this process, with 50 ms latency in each
+// direction. The files of a directory are downloaded one after the other, and
+// synced with different numbers of transfers at once. Finally the directory is
+// synced again without changes, which only lists and compares the files.
+//
+// Usage: ftp_sync_benchmark [num_files] [file_size_kb]
+//
+
+#include "mavsdk.h"
+#include "plugins/ftp/ftp.h"
+#include "autopilot_simulator.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+const std::string remote_dir = "/fs/microsd/log";
+const std::string local_dir = "ftp_sync_benchmark";
+
+std::string file_name(unsigned i)
+{
+    return std::to_string(i) + ".ulg";
+}
+
+void remove_local_files(unsigned num_files)
+{
+    for (unsigned i = 0; i < num_files; ++i) {
+        std::remove((local_dir + "/" + file_name(i)).c_str());
+    }
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start_time)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+bool download_one_by_one(Ftp& ftp, unsigned num_files)
+{
+    const auto start_time = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < num_files; ++i) {
+        std::promise<Ftp::Result> prom;
+        auto fut = prom.get_future();
+        ftp.download_async(
+            remote_dir + "/" + file_name(i),
+            local_dir,
+            [&prom](Ftp::Result result, Ftp::ProgressData) {
+                if (result != Ftp::Result::Next) {
+                    prom.set_value(result);
+                }
+            });
+        const auto result = fut.get();
+        if (result != Ftp::Result::Success) {
+            std::cerr << "Download failed: " << result << std::endl;
+            return false;
+        }
+    }
+    std::printf("  %-22s %8.2f s\n", "one by one", seconds_since(start_time));
+    return true;
+}
+
+bool sync(Ftp& ftp, const std::string& name)
+{
+    std::promise<Ftp::Result> prom;
+    auto fut = prom.get_future();
+    const auto start_time = std::chrono::steady_clock::now();
+    ftp.sync_directory_async(
+        remote_dir, local_dir, [&prom](Ftp::Result result, Ftp::ProgressData) {
+            if (result != Ftp::Result::Next) {
+                prom.set_value(result);
+            }
+        });
+    const auto result = fut.get();
+    if (result != Ftp::Result::Success) {
+        std::cerr << "Sync failed: " << result << std::endl;
+        return false;
+    }
+    std::printf("  %-22s %8.2f s\n", name.c_str(), seconds_since(start_time));
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const unsigned num_files = (argc > 1) ? unsigned(std::atoi(argv[1])) : 50;
+    const unsigned file_size_kb = (argc > 2) ? unsigned(std::atoi(argv[2])) : 8;
+
+    AutopilotSimulator::Config config;
+    config.latency = std::chrono::milliseconds(50);
+    AutopilotSimulator simulator(config);
+
+    std::mt19937 random(0);
+    for (unsigned i = 0; i < num_files; ++i) {
+        std::vector<uint8_t> content(file_size_kb * 1024);
+        for (auto& byte : content) {
+            byte = uint8_t(random());
+        }
+        simulator.add_file(remote_dir + "/" + file_name(i), content);
+    }
+
+    if (!simulator.start_loopback("ftp_sync_benchmark")) {
+        std::cerr << "Could not start simulator" << std::endl;
+        return 1;
+    }
+
+    Mavsdk mavsdk;
+    if (mavsdk.add_any_connection("loopback://ftp_sync_benchmark") != ConnectionResult::Success) {
+        std::cerr << "Could not connect to simulator" << std::endl;
+        return 1;
+    }
+    while (!mavsdk.is_connected()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    auto ftp = std::make_shared<Ftp>(mavsdk.system());
+
+    std::printf(
+        "Retrieval of %u files of %u KiB with 100 ms round trip time\n", num_files, file_size_kb);
+
+    // The directory is created by the first sync.
+    ftp->set_max_parallel_transfers(1);
+    bool success = sync(*ftp, "sync, 1 at once");
+    remove_local_files(num_files);
+
+    success = success && download_one_by_one(*ftp, num_files);
+    remove_local_files(num_files);
+
+    for (const uint32_t count : {2, 4, 8}) {
+        if (!success || ftp->set_max_parallel_transfers(count) != Ftp::Result::Success) {
+            break;
+        }
+        success = sync(*ftp, "sync, " + std::to_string(count) + " at once");
+        if (count != 8) {
+            remove_local_files(num_files);
+        }
+    }
+
+    success = success && sync(*ftp, "sync without changes");
+
+    remove_local_files(num_files);
+    std::remove(local_dir.c_str());
+    simulator.stop();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+//
+// Benchmark of MAVLink FTP uploads with several writes in flight.
+//
+// The autopilot is simulated in this process. For a few round trip times
+// the same file is uploaded with different numbers of writes in flight,
+// optionally with some messages lost.
+//
+// Usage: ftp_upload_benchmark [file_size_kb] [loss_percent]
+//
+
+#include "mavsdk.h"
+#include "plugins/ftp/ftp.h"
+#include "autopilot_simulator.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+const std::string local_path = "ftp_upload_benchmark.bin";
+const std::string remote_path = "/fs/microsd/ftp_upload_benchmark.bin";
+
+// Returns the throughput in KiB/s, or a negative value on failure.
+double upload(unsigned rtt_ms, double loss_ratio, uint32_t window_size, std::size_t file_size)
+{
+    AutopilotSimulator::Config config;
+    config.latency = std::chrono::milliseconds(rtt_ms / 2);
+    config.loss_ratio = loss_ratio;
+    AutopilotSimulator simulator(config);
+
+    const std::string name = "ftp_upload_benchmark_" + std::to_string(rtt_ms) + "_" +
+                             std::to_string(window_size);
+    if (!simulator.start_loopback(name)) {
+        return -1.0;
+    }
+
+    Mavsdk mavsdk;
+    if (mavsdk.add_any_connection("loopback://" + name) != ConnectionResult::Success) {
+        return -1.0;
+    }
+    while (!mavsdk.is_connected()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    auto ftp = std::make_shared<Ftp>(mavsdk.system());
+    ftp->set_upload_window_size(window_size);
+
+    std::promise<Ftp::Result> prom;
+    auto fut = prom.get_future();
+
+    const auto start_time = std::chrono::steady_clock::now();
+    ftp->upload_async(local_path, "/fs/microsd", [&prom](Ftp::Result result, Ftp::ProgressData) {
+        if (result != Ftp::Result::Next) {
+            prom.set_value(result);
+        }
+    });
+    const auto result = fut.get();
+    const double elapsed_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    std::vector<uint8_t> uploaded;
+    const bool complete = simulator.get_file(remote_path, uploaded) && uploaded.size() == file_size;
+    simulator.stop();
+
+    if (result != Ftp::Result::Success || !complete) {
+        std::cerr << "Upload failed: " << result << std::endl;
+        return -1.0;
+    }
+    return double(file_size) / 1024.0 / elapsed_s;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const unsigned file_size_kb = (argc > 1) ? unsigned(std::atoi(argv[1])) : 16;
+    const double loss_percent = (argc > 2) ? std::atof(argv[2]) : 0.0;
+
+    std::mt19937 random(0);
+    std::vector<char> content(file_size_kb * 1024);
+    for (auto& byte : content) {
+        byte = char(random());
+    }
+    std::ofstream(local_path, std::ios::binary).write(content.data(), content.size());
+
+    const unsigned rtts_ms[] = {20, 100, 200};
+    const uint32_t window_sizes[] = {1, 4, 16, 64};
+
+    std::printf("Upload of %u KiB with %.1f%% loss, KiB/s\n", file_size_kb, loss_percent);
+    std::printf("  %8s", "RTT");
+    for (const auto window_size : window_sizes) {
+        std::printf("  window %3u", window_size);
+    }
+    std::printf("\n");
+
+    for (const auto rtt_ms : rtts_ms) {
+        std::printf("  %5u ms", rtt_ms);
+        for (const auto window_size : window_sizes) {
+            const double throughput =
+                upload(rtt_ms, loss_percent / 100.0, window_size, content.size());
+            if (throughput < 0.0) {
+                std::remove(local_path.c_str());
+                return 1;
+            }
+            std::printf("  %10.1f", throughput);
+            std::fflush(stdout);
+        }
+        std::printf("\n");
+    }
+
+    std::remove(local_path.c_str());
+    return 0;
+}
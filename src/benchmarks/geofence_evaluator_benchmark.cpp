@@ -0,0 +1,170 @@
+//
+// Benchmark of the local geofence evaluation.
+//
+// Measures point-in-fence and distance-to-boundary queries per second against
+// polygons with 10k vertices, compared to testing every edge of the polygon.
+//
+// Usage: geofence_evaluator_benchmark [num_vertices] [num_queries]
+//
+
+#include "geofence_evaluator.h"
+#include "geometry.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+using namespace mavsdk;
+using namespace mavsdk::geometry;
+
+namespace {
+
+const CoordinateTransformation::GlobalCoordinate reference{47.397742, 8.545594};
+
+Geofence::Polygon make_polygon(
+    Geofence::Polygon::FenceType fence_type,
+    unsigned num_vertices,
+    double radius_m,
+    double north_m,
+    double east_m)
+{
+    CoordinateTransformation ct(reference);
+
+    Geofence::Polygon polygon{};
+    polygon.fence_type = fence_type;
+    for (unsigned i = 0; i < num_vertices; ++i) {
+        const double angle = 2.0 * M_PI * double(i) / double(num_vertices);
+        const double r =
+            radius_m * (1.0 + 0.3 * std::sin(13.0 * angle) + 0.05 * std::sin(997.0 * angle));
+        const auto global =
+            ct.global_from_local({north_m + r * std::cos(angle), east_m + r * std::sin(angle)});
+        Geofence::Point point{};
+        point.latitude_deg = global.latitude_deg;
+        point.longitude_deg = global.longitude_deg;
+        polygon.points.push_back(point);
+    }
+    return polygon;
+}
+
+// Baseline: every edge of every polygon for every query.
+unsigned naive(
+    const std::vector<std::vector<CoordinateTransformation::LocalCoordinate>>& rings,
+    const std::vector<CoordinateTransformation::LocalCoordinate>& queries)
+{
+    unsigned inside_count = 0;
+    for (const auto& p : queries) {
+        for (const auto& ring : rings) {
+            bool inside = false;
+            for (std::size_t j = 0, k = ring.size() - 1; j < ring.size(); k = j++) {
+                const auto& a = ring[j];
+                const auto& b = ring[k];
+                if ((a.north_m > p.north_m) != (b.north_m > p.north_m) &&
+                    p.east_m < (b.east_m - a.east_m) * (p.north_m - a.north_m) /
+                                       (b.north_m - a.north_m) +
+                                   a.east_m) {
+                    inside = !inside;
+                }
+            }
+            inside_count += inside ? 1 : 0;
+        }
+    }
+    return inside_count;
+}
+
+template<typename F> double queries_per_s(std::size_t num_queries, F&& f)
+{
+    const auto before = std::chrono::steady_clock::now();
+    f();
+    const auto after = std::chrono::steady_clock::now();
+    return double(num_queries) / std::chrono::duration<double>(after - before).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const unsigned num_vertices = (argc > 1) ? unsigned(std::atoi(argv[1])) : 10000;
+    const unsigned num_queries = (argc > 2) ? unsigned(std::atoi(argv[2])) : 200000;
+
+    const std::vector<Geofence::Polygon> polygons{
+        make_polygon(Geofence::Polygon::FenceType::Inclusion, num_vertices, 2000.0, 0.0, 0.0),
+        make_polygon(Geofence::Polygon::FenceType::Exclusion, num_vertices, 300.0, 500.0, 0.0)};
+
+    const auto build_before = std::chrono::steady_clock::now();
+    GeofenceEvaluator evaluator(polygons);
+    const auto build_after = std::chrono::steady_clock::now();
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> position(-3000.0, 3000.0);
+    CoordinateTransformation ct(reference);
+
+    std::vector<Geofence::Point> points;
+    for (unsigned i = 0; i < num_queries; ++i) {
+        const auto global = ct.global_from_local({position(rng), position(rng)});
+        Geofence::Point point{};
+        point.latitude_deg = global.latitude_deg;
+        point.longitude_deg = global.longitude_deg;
+        points.push_back(point);
+    }
+
+    std::vector<CoordinateTransformation::LocalCoordinate> locals;
+    for (const auto& point : points) {
+        locals.push_back(evaluator.to_local(point));
+    }
+
+    std::vector<std::vector<CoordinateTransformation::LocalCoordinate>> rings;
+    for (const auto& polygon : polygons) {
+        rings.emplace_back();
+        for (const auto& point : polygon.points) {
+            rings.back().push_back(evaluator.to_local(point));
+        }
+    }
+
+    unsigned within = 0;
+    double distance_sum = 0.0;
+
+    std::cout << "polygons: " << polygons.size() << " with " << num_vertices << " vertices each"
+              << '\n'
+              << "index build: "
+              << std::chrono::duration<double, std::milli>(build_after - build_before).count()
+              << " ms\n";
+
+    std::cout << "point-in-fence:            "
+              << queries_per_s(
+                     locals.size(),
+                     [&]() {
+                         for (const auto& local : locals) {
+                             within += evaluator.is_within_fence(local) ? 1 : 0;
+                         }
+                     })
+              << " queries/s\n";
+
+    std::cout << "distance-to-boundary:      "
+              << queries_per_s(
+                     locals.size(),
+                     [&]() {
+                         for (const auto& local : locals) {
+                             distance_sum += evaluator.distance_to_boundary_m(local);
+                         }
+                     })
+              << " queries/s\n";
+
+    std::cout << "check (incl. projection):  "
+              << queries_per_s(
+                     points.size(), [&]() { within += unsigned(evaluator.check(points).size()); })
+              << " queries/s\n";
+
+    const std::size_t num_naive = std::min<std::size_t>(locals.size(), 10000);
+    const std::vector<CoordinateTransformation::LocalCoordinate> naive_locals(
+        locals.begin(), locals.begin() + long(num_naive));
+    std::cout << "point-in-fence (all edges): "
+              << queries_per_s(num_naive, [&]() { within += naive(rings, naive_locals); })
+              << " queries/s\n";
+
+    // Print something depending on the results so nothing gets optimized away.
+    std::cout << "(checksum: " << within << ", " << distance_sum << ")\n";
+
+    return 0;
+}
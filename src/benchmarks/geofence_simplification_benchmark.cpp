@@ -0,0 +1,155 @@
+//
+// Benchmark of the geofence polygon simplification.
+//
+// Generates polygons shaped like real-world fence data, a jagged coastline
+// and a district of adjacent parcels sharing their edges, and reports the
+// number of items which need to be uploaded with and without simplification.
+//
+// Every fence vertex is one item in the mission protocol which is requested
+// by the autopilot one by one, so the upload time is estimated as number of
+// items times the round trip time of the link.
+//
+// Usage: geofence_simplification_benchmark [tolerance_m] [round_trip_time_ms]
+//
+
+#include "polygon_simplifier.h"
+#include "geometry.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+using namespace mavsdk;
+using namespace mavsdk::geometry;
+
+namespace {
+
+const CoordinateTransformation::GlobalCoordinate reference{47.397742, 8.545594};
+
+Geofence::Point to_point(const CoordinateTransformation& ct, double north_m, double east_m)
+{
+    const auto global = ct.global_from_local({north_m, east_m});
+    Geofence::Point point{};
+    point.latitude_deg = global.latitude_deg;
+    point.longitude_deg = global.longitude_deg;
+    return point;
+}
+
+// Fractal outline by recursive midpoint displacement, the number of vertices
+// is rounded up to the next power of two.
+Geofence::Polygon make_coastline(unsigned num_vertices, double radius_m, std::mt19937& rng)
+{
+    std::vector<double> radii{radius_m, radius_m, radius_m, radius_m};
+    double amplitude = radius_m * 0.2;
+    while (radii.size() < num_vertices) {
+        std::normal_distribution<double> noise(0.0, amplitude);
+        std::vector<double> refined;
+        for (std::size_t i = 0; i < radii.size(); ++i) {
+            refined.push_back(radii[i]);
+            refined.push_back((radii[i] + radii[(i + 1) % radii.size()]) / 2.0 + noise(rng));
+        }
+        radii = refined;
+        amplitude /= 1.8;
+    }
+
+    CoordinateTransformation ct(reference);
+    Geofence::Polygon polygon{};
+    polygon.fence_type = Geofence::Polygon::FenceType::Inclusion;
+    for (std::size_t i = 0; i < radii.size(); ++i) {
+        const double angle = 2.0 * M_PI * double(i) / double(radii.size());
+        polygon.points.push_back(
+            to_point(ct, radii[i] * std::cos(angle), radii[i] * std::sin(angle)));
+    }
+    return polygon;
+}
+
+// Parcels on a grid, each edge digitized with intermediate vertices like GIS
+// data usually is. Neighbouring parcels share their edge vertices exactly.
+std::vector<Geofence::Polygon>
+make_district(unsigned parcels_per_side, double parcel_size_m, unsigned vertices_per_edge)
+{
+    CoordinateTransformation ct(reference);
+
+    auto corner = [&](unsigned row, unsigned column, unsigned step_north, unsigned step_east) {
+        const double step_m = parcel_size_m / double(vertices_per_edge);
+        const double north_m = double(row) * parcel_size_m + double(step_north) * step_m;
+        const double east_m = double(column) * parcel_size_m + double(step_east) * step_m;
+        // A bit of deterministic wiggle, shared between neighbours.
+        return to_point(
+            ct, north_m + 0.3 * std::sin(east_m * 0.7), east_m + 0.3 * std::sin(north_m * 0.7));
+    };
+
+    std::vector<Geofence::Polygon> polygons;
+    for (unsigned row = 0; row < parcels_per_side; ++row) {
+        for (unsigned column = 0; column < parcels_per_side; ++column) {
+            Geofence::Polygon polygon{};
+            polygon.fence_type = Geofence::Polygon::FenceType::Exclusion;
+            for (unsigned i = 0; i < vertices_per_edge; ++i) {
+                polygon.points.push_back(corner(row, column, 0, i));
+            }
+            for (unsigned i = 0; i < vertices_per_edge; ++i) {
+                polygon.points.push_back(corner(row, column, i, vertices_per_edge));
+            }
+            for (unsigned i = vertices_per_edge; i > 0; --i) {
+                polygon.points.push_back(corner(row, column, vertices_per_edge, i));
+            }
+            for (unsigned i = vertices_per_edge; i > 0; --i) {
+                polygon.points.push_back(corner(row, column, i, 0));
+            }
+            polygons.push_back(polygon);
+        }
+    }
+    return polygons;
+}
+
+void run(
+    const std::string& name,
+    const std::vector<Geofence::Polygon>& polygons,
+    double tolerance_m,
+    double round_trip_time_s)
+{
+    PolygonSimplifier simplifier(tolerance_m, true);
+
+    const auto before = std::chrono::steady_clock::now();
+    const auto result = simplifier.simplify(polygons);
+    const auto after = std::chrono::steady_clock::now();
+
+    const auto& stats = simplifier.get_stats();
+    const double duration_ms =
+        std::chrono::duration<double, std::milli>(after - before).count();
+
+    std::cout << name << ":\n"
+              << "  polygons:           " << stats.polygons_before << " -> "
+              << stats.polygons_after << '\n'
+              << "  items:              " << stats.vertices_before << " -> "
+              << stats.vertices_after << '\n'
+              << "  simplification:     " << duration_ms << " ms\n"
+              << "  est. upload time:   " << double(stats.vertices_before) * round_trip_time_s
+              << " s -> " << double(stats.vertices_after) * round_trip_time_s << " s\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const double tolerance_m = (argc > 1) ? std::atof(argv[1]) : 1.0;
+    const double round_trip_time_s = ((argc > 2) ? std::atof(argv[2]) : 50.0) / 1000.0;
+
+    std::cout << "tolerance: " << tolerance_m << " m, round trip time: "
+              << round_trip_time_s * 1000.0 << " ms\n";
+
+    std::mt19937 rng(42);
+    run("coastline (16k vertices)",
+        {make_coastline(16384, 3000.0, rng)},
+        tolerance_m,
+        round_trip_time_s);
+    run("coastline (32k vertices)",
+        {make_coastline(32768, 6000.0, rng)},
+        tolerance_m,
+        round_trip_time_s);
+    run("district (20x20 parcels)", make_district(20, 100.0, 25), tolerance_m, round_trip_time_s);
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+//
+// Benchmark of downloading a log with LOG_REQUEST_DATA over a link with
+// 100 ms round trip time.
+//
+// The autopilot is simulated in this process, with 50 ms latency in each
+// direction, sending log data at most at the given rate. The log is downloaded
+// without loss, and with some of the messages lost in both directions.
+//
+// Usage: log_download_benchmark [log_size_kb] [rate_kb_s]
+//
+
+#include "mavsdk.h"
+#include "plugins/log_files/log_files.h"
+#include "autopilot_simulator.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+const std::string local_path = "log_download_benchmark.ulg";
+
+bool download(double loss_ratio, const std::vector<uint8_t>& content, double rate_bytes_s)
+{
+    AutopilotSimulator::Config config;
+    config.latency = std::chrono::milliseconds(50);
+    config.loss_ratio = loss_ratio;
+    config.log_data_rate_bytes_s = rate_bytes_s;
+    AutopilotSimulator simulator(config);
+    simulator.add_log(content);
+
+    const std::string name = "log_download_benchmark_" + std::to_string(loss_ratio);
+    if (!simulator.start_loopback(name)) {
+        std::cerr << "Could not start simulator" << std::endl;
+        return false;
+    }
+
+    Mavsdk mavsdk;
+    if (mavsdk.add_any_connection("loopback://" + name) != ConnectionResult::Success) {
+        std::cerr << "Could not connect to simulator" << std::endl;
+        return false;
+    }
+    while (!mavsdk.is_connected()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    auto log_files = std::make_shared<LogFiles>(mavsdk.system());
+    const auto entries = log_files->get_entries();
+    if (entries.first != LogFiles::Result::Success) {
+        std::cerr << "Could not get entries: " << entries.first << std::endl;
+        return false;
+    }
+
+    std::promise<LogFiles::Result> prom;
+    auto fut = prom.get_future();
+    const auto start_time = std::chrono::steady_clock::now();
+    log_files->download_log_file_async(
+        0, local_path, [&prom](LogFiles::Result result, LogFiles::ProgressData) {
+            if (result != LogFiles::Result::Next) {
+                prom.set_value(result);
+            }
+        });
+    const auto result = fut.get();
+    const double elapsed_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    std::remove(local_path.c_str());
+    simulator.stop();
+
+    if (result != LogFiles::Result::Success) {
+        std::cerr << "Download failed: " << result << std::endl;
+        return false;
+    }
+    std::printf(
+        "  %4.1f %% loss %8.2f s %10.1f KiB/s\n",
+        loss_ratio * 100.0,
+        elapsed_s,
+        double(content.size()) / 1024.0 / elapsed_s);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const unsigned log_size_kb = (argc > 1) ? unsigned(std::atoi(argv[1])) : 4096;
+    const unsigned rate_kb_s = (argc > 2) ? unsigned(std::atoi(argv[2])) : 1024;
+
+    std::mt19937 random(0);
+    std::vector<uint8_t> content(std::size_t(log_size_kb) * 1024);
+    for (auto& byte : content) {
+        byte = uint8_t(random());
+    }
+
+    std::printf(
+        "Download of a %u KiB log at up to %u KiB/s with 100 ms round trip time\n",
+        log_size_kb,
+        rate_kb_s);
+
+    bool success = true;
+    for (const double loss_ratio : {0.0, 0.01, 0.05}) {
+        success = success && download(loss_ratio, content, rate_kb_s * 1024.0);
+    }
+    return success ? 0 : 1;
+}
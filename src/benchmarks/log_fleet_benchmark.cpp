@@ -0,0 +1,282 @@
+//
+// Benchmark of pulling all logs from a fleet of vehicles after a flight day.
+//
+// The vehicles are simulated in this process, each sending over loopback UDP
+// to the same port with 50 ms latency in each direction, 1 % loss, and log
+// data at most at 100 KiB/s. The logs are downloaded one after the other, and
+// from all vehicles at once with different limits per link. Then they are
+// pulled again with all of them already there, and once more after the pull
+// was cut short half way.
+//
+// Usage: log_fleet_benchmark [num_vehicles] [logs_per_vehicle] [log_size_kb]
+//
+
+#include "mavsdk.h"
+#include "plugins/log_files/log_files.h"
+#include "autopilot_simulator.h"
+#include "fs.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+const std::string local_dir = "log_fleet_benchmark";
+constexpr int port = 14570;
+
+struct Vehicle {
+    uint64_t uuid{0};
+    std::string directory;
+    std::unique_ptr<LogFiles> log_files;
+    std::vector<LogFiles::Entry> entries;
+};
+
+double seconds_since(std::chrono::steady_clock::time_point start_time)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+void print_result(const std::string& name, double elapsed_s, std::size_t bytes)
+{
+    std::printf(
+        "  %-26s %8.2f s %10.1f KiB/s\n",
+        name.c_str(),
+        elapsed_s,
+        double(bytes) / 1024.0 / elapsed_s);
+}
+
+void remove_logs(const std::vector<Vehicle>& vehicles)
+{
+    for (const auto& vehicle : vehicles) {
+        for (const auto& entry : vehicle.entries) {
+            std::string date = entry.date;
+            for (auto& c : date) {
+                c = (c == ':') ? '-' : c;
+            }
+            const std::string path = vehicle.directory + path_separator + "log_" +
+                                     std::to_string(entry.id) + "_" + date + ".ulg";
+            std::remove(path.c_str());
+            std::remove((path + ".resume").c_str());
+        }
+    }
+}
+
+bool download_one_by_one(std::vector<Vehicle>& vehicles)
+{
+    for (auto& vehicle : vehicles) {
+        for (const auto& entry : vehicle.entries) {
+            std::promise<LogFiles::Result> prom;
+            auto fut = prom.get_future();
+            vehicle.log_files->download_log_file_async(
+                entry.id,
+                vehicle.directory + path_separator + "one_by_one.ulg",
+                [&prom](LogFiles::Result result, LogFiles::ProgressData) {
+                    if (result != LogFiles::Result::Next) {
+                        prom.set_value(result);
+                    }
+                });
+            const auto result = fut.get();
+            if (result != LogFiles::Result::Success) {
+                std::cerr << "Download failed: " << result << std::endl;
+                return false;
+            }
+        }
+        std::remove((vehicle.directory + path_separator + "one_by_one.ulg").c_str());
+    }
+    return true;
+}
+
+// Stops waiting once the given part of all data is there, if less than 1.
+bool download_all(std::vector<Vehicle>& vehicles, float stop_at)
+{
+    // Callbacks of a pull cut short can still come after we are done here.
+    struct Pull {
+        explicit Pull(std::size_t size) : proms(size), progresses(size) {}
+        std::vector<std::promise<LogFiles::Result>> proms;
+        std::vector<std::atomic<float>> progresses;
+    };
+    auto pull = std::make_shared<Pull>(vehicles.size());
+
+    for (std::size_t i = 0; i < vehicles.size(); ++i) {
+        pull->progresses[i] = 0.0f;
+        std::vector<uint32_t> ids;
+        for (const auto& entry : vehicles[i].entries) {
+            ids.push_back(entry.id);
+        }
+        vehicles[i].log_files->download_log_files_async(
+            ids,
+            vehicles[i].directory,
+            [pull, i](LogFiles::Result result, LogFiles::ProgressData data) {
+                pull->progresses[i] = data.progress;
+                if (result != LogFiles::Result::Next) {
+                    pull->proms[i].set_value(result);
+                }
+            });
+    }
+
+    if (stop_at < 1.0f) {
+        while (true) {
+            float sum = 0.0f;
+            for (const auto& progress : pull->progresses) {
+                sum += progress;
+            }
+            if (sum >= stop_at * float(vehicles.size())) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    bool success = true;
+    for (auto& prom : pull->proms) {
+        const auto result = prom.get_future().get();
+        if (result != LogFiles::Result::Success) {
+            std::cerr << "Download failed: " << result << std::endl;
+            success = false;
+        }
+    }
+    return success;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const unsigned num_vehicles = (argc > 1) ? unsigned(std::atoi(argv[1])) : 4;
+    const unsigned logs_per_vehicle = (argc > 2) ? unsigned(std::atoi(argv[2])) : 4;
+    const unsigned log_size_kb = (argc > 3) ? unsigned(std::atoi(argv[3])) : 256;
+    const std::size_t total_bytes =
+        std::size_t(num_vehicles) * logs_per_vehicle * log_size_kb * 1024;
+
+    if (num_vehicles == 0 || num_vehicles > 254) {
+        std::cerr << "Number of vehicles needs to be between 1 and 254" << std::endl;
+        return 1;
+    }
+
+    Mavsdk mavsdk;
+    if (mavsdk.add_udp_connection(port) != ConnectionResult::Success) {
+        std::cerr << "Could not listen on port " << port << std::endl;
+        return 1;
+    }
+
+    std::mt19937 random(0);
+    std::vector<std::unique_ptr<AutopilotSimulator>> simulators;
+    for (unsigned i = 0; i < num_vehicles; ++i) {
+        AutopilotSimulator::Config config;
+        config.system_id = uint8_t(i + 1);
+        config.random_seed = i;
+        config.latency = std::chrono::milliseconds(50);
+        config.loss_ratio = 0.01;
+        config.log_data_rate_bytes_s = 100.0 * 1024.0;
+        simulators.emplace_back(new AutopilotSimulator(config));
+        for (unsigned j = 0; j < logs_per_vehicle; ++j) {
+            std::vector<uint8_t> content(log_size_kb * 1024);
+            for (auto& byte : content) {
+                byte = uint8_t(random());
+            }
+            simulators.back()->add_log(content);
+        }
+        if (!simulators.back()->start_udp("127.0.0.1", port)) {
+            std::cerr << "Could not start simulator " << i + 1 << std::endl;
+            return 1;
+        }
+    }
+
+    while (mavsdk.system_uuids().size() < num_vehicles) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    fs_create_directory(local_dir);
+    std::vector<Vehicle> vehicles(num_vehicles);
+    unsigned index = 0;
+    for (const auto uuid : mavsdk.system_uuids()) {
+        auto& vehicle = vehicles[index++];
+        vehicle.uuid = uuid;
+        vehicle.directory = local_dir + path_separator + std::to_string(index);
+        fs_create_directory(vehicle.directory);
+        vehicle.log_files.reset(new LogFiles(mavsdk.system(uuid)));
+        const auto entries = vehicle.log_files->get_entries();
+        if (entries.first != LogFiles::Result::Success) {
+            std::cerr << "Could not get entries: " << entries.first << std::endl;
+            return 1;
+        }
+        vehicle.entries = entries.second;
+    }
+
+    std::printf(
+        "Pull of %u logs of %u KiB from each of %u vehicles over one link\n",
+        logs_per_vehicle,
+        log_size_kb,
+        num_vehicles);
+
+    auto start_time = std::chrono::steady_clock::now();
+    bool success = download_one_by_one(vehicles);
+    if (success) {
+        print_result("one by one", seconds_since(start_time), total_bytes);
+    }
+
+    for (const uint32_t count : {1, 2, 4}) {
+        if (!success) {
+            break;
+        }
+        vehicles.front().log_files->set_max_downloads_per_link(count);
+        start_time = std::chrono::steady_clock::now();
+        success = download_all(vehicles, 1.0f);
+        if (success) {
+            print_result(
+                "all, " + std::to_string(count) + " per link",
+                seconds_since(start_time),
+                total_bytes);
+        }
+        if (count != 4) {
+            remove_logs(vehicles);
+        }
+    }
+
+    if (success) {
+        start_time = std::chrono::steady_clock::now();
+        success = download_all(vehicles, 1.0f);
+        std::printf("  %-26s %8.2f s\n", "all again, already there", seconds_since(start_time));
+        remove_logs(vehicles);
+    }
+
+    if (success) {
+        // The plugins going away cut the downloads short.
+        download_all(vehicles, 0.5f);
+        for (auto& vehicle : vehicles) {
+            vehicle.log_files.reset();
+        }
+        for (auto& vehicle : vehicles) {
+            vehicle.log_files.reset(new LogFiles(mavsdk.system(vehicle.uuid)));
+            success = success && vehicle.log_files->get_entries().first ==
+                                     LogFiles::Result::Success;
+        }
+        start_time = std::chrono::steady_clock::now();
+        success = success && download_all(vehicles, 1.0f);
+        if (success) {
+            std::printf(
+                "  %-26s %8.2f s\n", "rest after cut half way", seconds_since(start_time));
+        }
+        remove_logs(vehicles);
+    }
+
+    for (const auto& vehicle : vehicles) {
+        std::remove(vehicle.directory.c_str());
+    }
+    std::remove(local_dir.c_str());
+    for (auto& simulator : simulators) {
+        simulator->stop();
+    }
+    return success ? 0 : 1;
+}
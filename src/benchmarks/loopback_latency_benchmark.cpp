@@ -0,0 +1,139 @@
+//
+// Latency of passing messages between two components in the same process,
+// over UDP on the loopback interface and over an in-process loopback link.
+//
+// A message is sent back and forth between two connections and the round
+// trip time is measured, including the receive threads waking up and the
+// callbacks being called.
+//
+// Usage: loopback_latency_benchmark [num_round_trips]
+//
+
+#include "loopback_connection.h"
+#include "udp_connection.h"
+#include "mavlink_include.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+// Bounces every message received back to the sender.
+struct Echo {
+    Connection* connection{nullptr};
+    void receive(mavlink_message_t& message) { connection->send_message(message); }
+};
+
+// Round trip times in microseconds, sorted.
+std::vector<double>
+measure(Connection& connection, std::atomic<unsigned>& num_received, unsigned num)
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(
+        1,
+        MAV_COMP_ID_AUTOPILOT1,
+        &message,
+        MAV_TYPE_QUADROTOR,
+        MAV_AUTOPILOT_PX4,
+        MAV_MODE_FLAG_CUSTOM_MODE_ENABLED,
+        0,
+        MAV_STATE_ACTIVE);
+
+    std::vector<double> round_trips_us;
+    round_trips_us.reserve(num);
+
+    for (unsigned i = 0; i < num; ++i) {
+        const unsigned expected = num_received + 1;
+        const auto start_time = std::chrono::steady_clock::now();
+        if (!connection.send_message(message)) {
+            std::fprintf(stderr, "Sending failed\n");
+            break;
+        }
+        while (num_received < expected) {
+            std::this_thread::yield();
+            if (std::chrono::steady_clock::now() - start_time > std::chrono::seconds(1)) {
+                std::fprintf(stderr, "Message lost\n");
+                break;
+            }
+        }
+        round_trips_us.push_back(
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time)
+                .count());
+    }
+
+    std::sort(round_trips_us.begin(), round_trips_us.end());
+    return round_trips_us;
+}
+
+void print(const char* name, const std::vector<double>& round_trips_us)
+{
+    if (round_trips_us.empty()) {
+        return;
+    }
+    double sum = 0.0;
+    for (const auto round_trip : round_trips_us) {
+        sum += round_trip;
+    }
+    std::printf(
+        "%-10s round trip: mean %8.2f us, median %8.2f us, p99 %8.2f us\n",
+        name,
+        sum / double(round_trips_us.size()),
+        round_trips_us[round_trips_us.size() / 2],
+        round_trips_us[round_trips_us.size() * 99 / 100]);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const unsigned num_round_trips = (argc > 1) ? unsigned(std::atoi(argv[1])) : 10000;
+
+    std::atomic<unsigned> num_received{0};
+    auto count = [&num_received](mavlink_message_t&, Connection*) { ++num_received; };
+
+    {
+        Echo echo;
+        UdpConnection pinger(count, "127.0.0.1", 14601);
+        UdpConnection echoer(
+            [&echo](mavlink_message_t& message, Connection*) { echo.receive(message); },
+            "127.0.0.1",
+            14602);
+        echo.connection = &echoer;
+        if (pinger.start() != ConnectionResult::Success ||
+            echoer.start() != ConnectionResult::Success) {
+            std::fprintf(stderr, "Could not open UDP ports\n");
+            return 1;
+        }
+        pinger.add_remote("127.0.0.1", 14602);
+
+        // Warm up, which also lets the echoer learn where to send to.
+        measure(pinger, num_received, 100);
+        print("udp", measure(pinger, num_received, num_round_trips));
+    }
+
+    {
+        Echo echo;
+        LoopbackConnection pinger(count, "loopback_latency_benchmark");
+        LoopbackConnection echoer(
+            [&echo](mavlink_message_t& message, Connection*) { echo.receive(message); },
+            "loopback_latency_benchmark");
+        echo.connection = &echoer;
+        if (pinger.start() != ConnectionResult::Success ||
+            echoer.start() != ConnectionResult::Success) {
+            std::fprintf(stderr, "Could not set up loopback link\n");
+            return 1;
+        }
+
+        measure(pinger, num_received, 100);
+        print("loopback", measure(pinger, num_received, num_round_trips));
+    }
+
+    return 0;
+}
@@ -0,0 +1,131 @@
+//
+// Benchmark of many vehicles connected to one Mavsdk instance.
+//
+// The vehicles are simulated in this process, each sending typical PX4
+// telemetry over loopback UDP to the same port. This measures how long it
+// takes to discover all of them and whether the telemetry of all of them
+// makes it to the user callbacks at the rates sent.
+//
+// Usage: multi_vehicle_benchmark [num_vehicles] [duration_s]
+//
+
+#include "mavsdk.h"
+#include "plugins/telemetry/telemetry.h"
+#include "autopilot_simulator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+int main(int argc, char** argv)
+{
+    const unsigned num_vehicles = (argc > 1) ? unsigned(std::atoi(argv[1])) : 100;
+    const unsigned duration_s = (argc > 2) ? unsigned(std::atoi(argv[2])) : 10;
+    const int port = 14540;
+
+    if (num_vehicles == 0 || num_vehicles > 254) {
+        std::cerr << "Number of vehicles needs to be between 1 and 254" << std::endl;
+        return 1;
+    }
+
+    Mavsdk mavsdk;
+    if (mavsdk.add_udp_connection(port) != ConnectionResult::Success) {
+        std::cerr << "Could not listen on port " << port << std::endl;
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<AutopilotSimulator>> simulators;
+    const auto start_time = std::chrono::steady_clock::now();
+
+    for (unsigned i = 0; i < num_vehicles; ++i) {
+        AutopilotSimulator::Config config;
+        config.system_id = uint8_t(i + 1);
+        config.random_seed = i;
+        simulators.emplace_back(new AutopilotSimulator(config));
+        if (!simulators.back()->start_udp("127.0.0.1", port)) {
+            std::cerr << "Could not start simulator " << i + 1 << std::endl;
+            return 1;
+        }
+    }
+
+    while (mavsdk.system_uuids().size() < num_vehicles) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if (std::chrono::steady_clock::now() - start_time > std::chrono::seconds(60)) {
+            std::cerr << "Only discovered " << mavsdk.system_uuids().size() << " of "
+                      << num_vehicles << " vehicles" << std::endl;
+            return 1;
+        }
+    }
+    const double discovery_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    std::vector<std::unique_ptr<Telemetry>> telemetries;
+    std::vector<std::atomic<unsigned>> num_attitudes(num_vehicles);
+    std::vector<std::atomic<unsigned>> num_positions(num_vehicles);
+
+    for (unsigned i = 0; i < num_vehicles; ++i) {
+        num_attitudes[i] = 0;
+        num_positions[i] = 0;
+    }
+
+    unsigned index = 0;
+    for (const auto uuid : mavsdk.system_uuids()) {
+        telemetries.emplace_back(new Telemetry(mavsdk.system(uuid)));
+        auto& num_attitude = num_attitudes[index];
+        auto& num_position = num_positions[index];
+        telemetries.back()->subscribe_attitude_euler(
+            [&num_attitude](Telemetry::EulerAngle) { ++num_attitude; });
+        telemetries.back()->subscribe_position(
+            [&num_position](Telemetry::Position) { ++num_position; });
+        ++index;
+    }
+
+    // Let the rates settle after the plugins requested them.
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    for (unsigned i = 0; i < num_vehicles; ++i) {
+        num_attitudes[i] = 0;
+        num_positions[i] = 0;
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(duration_s));
+
+    unsigned total_attitudes = 0;
+    unsigned total_positions = 0;
+    unsigned min_attitudes = num_attitudes[0];
+    for (unsigned i = 0; i < num_vehicles; ++i) {
+        total_attitudes += num_attitudes[i];
+        total_positions += num_positions[i];
+        min_attitudes = std::min(min_attitudes, num_attitudes[i].load());
+    }
+
+    uint64_t num_sent = 0;
+    for (auto& simulator : simulators) {
+        num_sent += simulator->get_statistics().num_sent;
+        simulator->stop();
+    }
+
+    const double elapsed_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    std::printf("%u vehicles discovered in %.3f s\n", num_vehicles, discovery_s);
+    std::printf("  sent by vehicles:    %10.0f msgs/s\n", double(num_sent) / elapsed_s);
+    std::printf(
+        "  attitude callbacks:  %10.0f /s (%.1f Hz per vehicle, slowest %.1f Hz)\n",
+        double(total_attitudes) / duration_s,
+        double(total_attitudes) / duration_s / num_vehicles,
+        double(min_attitudes) / duration_s);
+    std::printf(
+        "  position callbacks:  %10.0f /s (%.1f Hz per vehicle)\n",
+        double(total_positions) / duration_s,
+        double(total_positions) / duration_s / num_vehicles);
+
+    return 0;
+}
@@ -0,0 +1,221 @@
+//
+// End-to-end benchmark of receiving telemetry by replaying a recorded log.
+//
+// The log is replayed as fast as possible through a replay:// connection, so
+// this measures the whole path of parsing, dispatching to the system and the
+// telemetry plugin, and calling the user callbacks, on real traffic.
+//
+// Without a log given, a synthetic one with typical PX4 message rates is
+// generated first.
+//
+// Usage: replay_benchmark [log.tlog]
+//
+
+#include "mavsdk.h"
+#include "plugins/telemetry/telemetry.h"
+#include "mavlink_include.h"
+#include "tlog_reader.h"
+#include "tlog_recorder.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace mavsdk;
+
+namespace {
+
+// The messages of a flight of the given duration. They are timestamped when
+// they are generated rather than with the flight time, which doesn't matter
+// for replaying as fast as possible.
+void generate_log(const std::string& path, unsigned duration_s)
+{
+    TlogRecorder recorder;
+    if (!recorder.start(path)) {
+        return;
+    }
+
+    struct Stream {
+        unsigned rate_hz;
+        void (*pack)(mavlink_message_t&, uint32_t time_ms);
+    };
+
+    const Stream streams[] = {
+        {1,
+         [](mavlink_message_t& message, uint32_t) {
+             mavlink_msg_heartbeat_pack(
+                 1,
+                 MAV_COMP_ID_AUTOPILOT1,
+                 &message,
+                 MAV_TYPE_QUADROTOR,
+                 MAV_AUTOPILOT_PX4,
+                 MAV_MODE_FLAG_CUSTOM_MODE_ENABLED,
+                 0,
+                 MAV_STATE_ACTIVE);
+         }},
+        {50,
+         [](mavlink_message_t& message, uint32_t time_ms) {
+             const float t = float(time_ms) / 1000.0f;
+             mavlink_msg_attitude_pack(
+                 1, MAV_COMP_ID_AUTOPILOT1, &message, time_ms, 0.1f, -0.1f, t, 0.0f, 0.0f, 0.1f);
+         }},
+        {30,
+         [](mavlink_message_t& message, uint32_t time_ms) {
+             const float t = float(time_ms) / 1000.0f;
+             mavlink_msg_local_position_ned_pack(
+                 1, MAV_COMP_ID_AUTOPILOT1, &message, time_ms, t, t, -10.0f, 1.0f, 1.0f, 0.0f);
+         }},
+        {10,
+         [](mavlink_message_t& message, uint32_t time_ms) {
+             mavlink_msg_global_position_int_pack(
+                 1,
+                 MAV_COMP_ID_AUTOPILOT1,
+                 &message,
+                 time_ms,
+                 473977418 + int32_t(time_ms / 100),
+                 85455939,
+                 500000,
+                 10000,
+                 100,
+                 100,
+                 0,
+                 9000);
+         }},
+    };
+
+    // Go through the flight in steps of 1 ms.
+    for (uint32_t time_ms = 0; time_ms < duration_s * 1000; ++time_ms) {
+        for (const auto& stream : streams) {
+            if (time_ms % (1000 / stream.rate_hz) != 0) {
+                continue;
+            }
+            mavlink_message_t message;
+            stream.pack(message, time_ms);
+            while (!recorder.record(TlogRecorder::Direction::Incoming, [&message](uint8_t* data) {
+                return mavlink_msg_to_send_buffer(data, &message);
+            })) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    recorder.stop();
+}
+
+// Number of messages in the log, overall and of one type.
+void count_messages(
+    const std::string& path, uint32_t msgid, unsigned& num_messages, unsigned& num_of_type)
+{
+    num_messages = 0;
+    num_of_type = 0;
+
+    TlogReader reader;
+    if (!reader.open(path)) {
+        return;
+    }
+
+    TlogReader::Frame frame{};
+    while (reader.next(frame)) {
+        ++num_messages;
+        const uint32_t frame_msgid =
+            (frame.data[0] == MAVLINK_STX) ?
+                (uint32_t(frame.data[7]) | (uint32_t(frame.data[8]) << 8) |
+                 (uint32_t(frame.data[9]) << 16)) :
+                frame.data[5];
+        if (frame_msgid == msgid) {
+            ++num_of_type;
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string path;
+    if (argc > 1) {
+        path = argv[1];
+    } else {
+        path = "replay_benchmark.tlog";
+        std::cout << "Generating synthetic log..." << std::endl;
+        generate_log(path, 3600);
+    }
+
+    unsigned num_messages;
+    unsigned num_attitudes;
+    count_messages(path, MAVLINK_MSG_ID_ATTITUDE, num_messages, num_attitudes);
+    std::cout << "Log has " << num_messages << " messages, " << num_attitudes << " ATTITUDE"
+              << std::endl;
+    if (num_attitudes == 0) {
+        std::cerr << "Need ATTITUDE messages to know when the replay is done." << std::endl;
+        return 1;
+    }
+
+    Mavsdk mavsdk;
+    const std::string url = "replay://" + path + "?speed=max";
+
+    // A first replay to discover the system so the plugin is there from the
+    // start of the measured replay, it also warms things up.
+    if (mavsdk.add_any_connection(url) != ConnectionResult::Success) {
+        std::cerr << "Could not replay " << path << std::endl;
+        return 1;
+    }
+    while (!mavsdk.is_connected()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    Telemetry telemetry{mavsdk.system()};
+
+    std::atomic<unsigned> num_attitude_callbacks{0};
+    std::atomic<unsigned> num_position_callbacks{0};
+    telemetry.subscribe_attitude_euler(
+        [&num_attitude_callbacks](Telemetry::EulerAngle) { ++num_attitude_callbacks; });
+    telemetry.subscribe_position(
+        [&num_position_callbacks](Telemetry::Position) { ++num_position_callbacks; });
+
+    // Let the first replay finish.
+    unsigned last_count = 0;
+    do {
+        last_count = num_attitude_callbacks;
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    } while (num_attitude_callbacks != last_count);
+    num_attitude_callbacks = 0;
+    num_position_callbacks = 0;
+
+    const auto start_time = std::chrono::steady_clock::now();
+    mavsdk.add_any_connection(url);
+
+    // Done once all attitudes made it to the callback, or no more arrive,
+    // in case some were lost.
+    auto last_progress_time = start_time;
+    last_count = 0;
+    while (num_attitude_callbacks < num_attitudes) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        const unsigned count = num_attitude_callbacks;
+        const auto now = std::chrono::steady_clock::now();
+        if (count != last_count) {
+            last_count = count;
+            last_progress_time = now;
+        } else if (now - last_progress_time > std::chrono::seconds(1)) {
+            break;
+        }
+    }
+    const auto end_time = (num_attitude_callbacks < num_attitudes) ?
+                              last_progress_time :
+                              std::chrono::steady_clock::now();
+    const double elapsed_s = std::chrono::duration<double>(end_time - start_time).count();
+
+    std::printf("Replayed in %.3f s\n", elapsed_s);
+    std::printf("  messages:            %10.0f msgs/s\n", double(num_messages) / elapsed_s);
+    std::printf(
+        "  attitude callbacks:  %10.0f /s (%u of %u)\n",
+        double(num_attitude_callbacks) / elapsed_s,
+        num_attitude_callbacks.load(),
+        num_attitudes);
+    std::printf("  position callbacks:  %10.0f /s\n", double(num_position_callbacks) / elapsed_s);
+
+    return 0;
+}
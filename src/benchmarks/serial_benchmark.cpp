@@ -0,0 +1,212 @@
+//
+// Throughput and CPU time of SerialConnection over a pseudo-terminal pair.
+//
+// The connection is opened on the pty side while the benchmark plays the
+// autopilot on the other end, sending telemetry as fast as it can and
+// reading what the connection writes. Writing is measured with a few
+// flush latencies, sending small bursts of messages like a ground station
+// does. The number of reads on the other end shows how many writes the
+// messages were combined into.
+//
+// Usage: serial_benchmark [num_messages]
+//
+
+#include "serial_connection.h"
+#include "mavlink_include.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+mavlink_message_t make_message(uint8_t sysid)
+{
+    mavlink_attitude_t attitude{};
+    attitude.roll = 0.1f;
+    attitude.pitch = -0.1f;
+    attitude.yaw = 1.0f;
+
+    mavlink_message_t message;
+    mavlink_msg_attitude_encode(sysid, MAV_COMP_ID_AUTOPILOT1, &message, &attitude);
+    return message;
+}
+
+double cpu_us_per_message(std::clock_t start, unsigned num_messages)
+{
+    return double(std::clock() - start) * 1e6 / CLOCKS_PER_SEC / double(num_messages);
+}
+
+// Waits until count reaches expected, or nothing more arrives for a second.
+void wait_for(const std::atomic<unsigned>& count, unsigned expected)
+{
+    unsigned last_count = count;
+    auto last_progress_time = std::chrono::steady_clock::now();
+    while (count < expected) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        const auto now = std::chrono::steady_clock::now();
+        if (count != last_count) {
+            last_count = count;
+            last_progress_time = now;
+        } else if (now - last_progress_time > std::chrono::seconds(1)) {
+            break;
+        }
+    }
+}
+
+void measure_receiving(int master_fd, const std::string& slave_path, unsigned num_messages)
+{
+    std::atomic<unsigned> num_received{0};
+    SerialConnection connection(
+        [&num_received](mavlink_message_t&, Connection*) { ++num_received; },
+        slave_path,
+        921600,
+        false);
+    if (connection.start() != ConnectionResult::Success) {
+        std::fprintf(stderr, "Could not open %s\n", slave_path.c_str());
+        return;
+    }
+
+    std::vector<uint8_t> bytes;
+    for (unsigned i = 0; i < num_messages; ++i) {
+        const auto message = make_message(1);
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        const uint16_t length = mavlink_msg_to_send_buffer(buffer, &message);
+        bytes.insert(bytes.end(), buffer, buffer + length);
+    }
+
+    const auto start_time = std::chrono::steady_clock::now();
+    const std::clock_t start = std::clock();
+
+    std::size_t offset = 0;
+    while (offset < bytes.size()) {
+        struct pollfd fds[1];
+        fds[0].fd = master_fd;
+        fds[0].events = POLLOUT;
+        fds[0].revents = 0;
+        poll(fds, 1, 100);
+        const auto written = write(master_fd, &bytes[offset], bytes.size() - offset);
+        if (written > 0) {
+            offset += std::size_t(written);
+        }
+    }
+    wait_for(num_received, num_messages);
+
+    const double elapsed_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    std::printf(
+        "  receiving:              %9.0f msgs/s, %6.2f us CPU per message, %u lost\n",
+        double(num_received) / elapsed_s,
+        cpu_us_per_message(start, num_messages),
+        num_messages - num_received);
+
+    connection.stop();
+}
+
+void measure_sending(
+    int master_fd,
+    const std::string& slave_path,
+    unsigned num_messages,
+    std::chrono::milliseconds flush_latency)
+{
+    constexpr unsigned burst_size = 4;
+
+    SerialConnection connection([](mavlink_message_t&, Connection*) {}, slave_path, 921600, false);
+    if (connection.start() != ConnectionResult::Success) {
+        std::fprintf(stderr, "Could not open %s\n", slave_path.c_str());
+        return;
+    }
+    connection.set_flush_latency(flush_latency);
+
+    const auto message = make_message(245);
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const unsigned message_length = mavlink_msg_to_send_buffer(buffer, &message);
+
+    std::atomic<unsigned> num_bytes_read{0};
+    std::atomic<unsigned> num_reads{0};
+    std::atomic<bool> should_exit{false};
+    std::thread reader([&]() {
+        char chunk[16384];
+        while (!should_exit) {
+            struct pollfd fds[1];
+            fds[0].fd = master_fd;
+            fds[0].events = POLLIN;
+            fds[0].revents = 0;
+            if (poll(fds, 1, 100) <= 0) {
+                continue;
+            }
+            const auto num_read = read(master_fd, chunk, sizeof(chunk));
+            if (num_read > 0) {
+                num_bytes_read += unsigned(num_read);
+                ++num_reads;
+            }
+        }
+    });
+
+    const std::clock_t start = std::clock();
+    unsigned num_sent = 0;
+    for (unsigned i = 0; i < num_messages; i += burst_size) {
+        for (unsigned j = 0; j < burst_size; ++j) {
+            if (connection.send_message(message)) {
+                ++num_sent;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    for (unsigned i = 0; i < 2000 && num_bytes_read < num_sent * message_length; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const unsigned num_messages_read = num_bytes_read / message_length;
+    const double cpu_us = cpu_us_per_message(start, num_messages);
+
+    should_exit = true;
+    reader.join();
+
+    std::printf(
+        "  sending, flush latency %2d ms: %6.2f us CPU per message, %5.1f messages per write, "
+        "%u dropped\n",
+        int(flush_latency.count()),
+        cpu_us,
+        double(num_messages_read) / double(num_reads == 0 ? 1 : unsigned(num_reads)),
+        num_messages - num_messages_read);
+
+    connection.stop();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const unsigned num_messages = (argc > 1) ? unsigned(std::atoi(argv[1])) : 100000;
+
+    const int master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master_fd < 0 || grantpt(master_fd) != 0 || unlockpt(master_fd) != 0) {
+        std::fprintf(stderr, "Could not open a pseudo-terminal\n");
+        return 1;
+    }
+    const std::string slave_path = ptsname(master_fd);
+    fcntl(master_fd, F_SETFL, O_NONBLOCK);
+
+    std::printf("Serial over %s, %u messages\n", slave_path.c_str(), num_messages);
+    measure_receiving(master_fd, slave_path, num_messages);
+    for (const int flush_latency_ms : {0, 1, 5}) {
+        measure_sending(
+            master_fd, slave_path, num_messages, std::chrono::milliseconds(flush_latency_ms));
+    }
+
+    close(master_fd);
+    return 0;
+}
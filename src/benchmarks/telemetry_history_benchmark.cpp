@@ -0,0 +1,105 @@
+//
+// Benchmark of recording and querying telemetry history.
+//
+// Reports the cost of recording one sample, including the autopilot
+// timestamp as done by TelemetryImpl, the memory used per field and the cost
+// of queries and aggregates over the full history.
+//
+// Usage: telemetry_history_benchmark [capacity]
+//
+
+#include "telemetry_history.h"
+#include "global_include.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+using namespace mavsdk;
+
+namespace {
+
+template<typename Function> double ns_per_call(unsigned num_calls, Function function)
+{
+    const auto before = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < num_calls; ++i) {
+        function(i);
+    }
+    const auto after = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(after - before).count() / num_calls;
+}
+
+uint64_t now_us(AutopilotTime& autopilot_time)
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                     autopilot_time.now().time_since_epoch())
+                                     .count());
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const unsigned capacity = (argc > 1) ? std::atoi(argv[1]) : 36000;
+    constexpr unsigned num_records = 1000000;
+
+    AutopilotTime autopilot_time{};
+    TelemetryHistory history{};
+
+    const auto field = Telemetry::HistoryField::Imu;
+    double values[10] = {};
+
+    const double disabled_ns = ns_per_call(num_records, [&](unsigned i) {
+        values[0] = double(i);
+        if (history.is_enabled(field)) {
+            history.record(field, now_us(autopilot_time), values);
+        }
+    });
+
+    history.set_capacity(field, capacity);
+
+    const double enabled_ns = ns_per_call(num_records, [&](unsigned i) {
+        values[0] = double(i);
+        if (history.is_enabled(field)) {
+            history.record(field, now_us(autopilot_time), values);
+        }
+    });
+
+    const double timestamp_ns =
+        ns_per_call(num_records, [&](unsigned i) { values[0] = double(now_us(autopilot_time) + i); });
+
+    const uint64_t all_time_us = std::numeric_limits<uint64_t>::max();
+    std::size_t checksum = 0;
+
+    const double query_ns = ns_per_call(100, [&](unsigned) {
+        checksum += history.query(field, 0, all_time_us, 0).time_us.size();
+    });
+    const double downsampled_query_ns = ns_per_call(100, [&](unsigned) {
+        checksum += history.query(field, 0, all_time_us, 1000).time_us.size();
+    });
+    const double statistics_ns = ns_per_call(
+        100, [&](unsigned) { checksum += history.statistics(field, 0, all_time_us).count; });
+
+    std::cout << "capacity: " << capacity << " samples\n"
+              << "memory per field:\n";
+    for (unsigned i = 0; i <= static_cast<unsigned>(Telemetry::HistoryField::GroundTruth); ++i) {
+        const auto f = static_cast<Telemetry::HistoryField>(i);
+        std::cout << "  " << f << " (" << TelemetryHistory::num_components(f) << "): "
+                  << double(TimeSeries::memory_bytes(
+                         capacity, TelemetryHistory::num_components(f))) /
+                         1e6
+                  << " MB\n";
+    }
+    std::cout << "record (imu, 10 components):\n"
+              << "  disabled:                " << disabled_ns << " ns\n"
+              << "  enabled:                 " << enabled_ns << " ns\n"
+              << "  of which timestamp:      " << timestamp_ns << " ns\n"
+              << "query of full history:\n"
+              << "  all samples:             " << query_ns / 1e3 << " us\n"
+              << "  downsampled to 1000:     " << downsampled_query_ns / 1e3 << " us\n"
+              << "  min/max/mean:            " << statistics_ns / 1e3 << " us\n"
+              << "(checksum: " << checksum << ")\n";
+
+    return 0;
+}
@@ -0,0 +1,199 @@
+//
+// Benchmark of reading telemetry while it is being updated.
+//
+// One thread plays the receive thread and updates telemetry fields as fast
+// as it can, while a number of reader threads poll 20 fields each, like a UI
+// does. This compares a mutex per field, as previously used in TelemetryImpl,
+// with the seqlock which is used now, reading the fields one by one as well
+// as getting them all at once with a snapshot.
+//
+// Usage: telemetry_snapshot_benchmark [num_readers] [duration_s]
+//
+
+#include "plugins/telemetry/telemetry.h"
+#include "seqlock.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+// Telemetry guarded by a mutex per field.
+struct MutexTelemetry {
+    mutable std::mutex position_mutex{};
+    Telemetry::Position position{};
+    mutable std::mutex attitude_quaternion_mutex{};
+    Telemetry::Quaternion attitude_quaternion{};
+    mutable std::mutex velocity_ned_mutex{};
+    Telemetry::VelocityNed velocity_ned{};
+    mutable std::mutex imu_mutex{};
+    Telemetry::Imu imu{};
+    mutable std::mutex battery_mutex{};
+    Telemetry::Battery battery{};
+
+    template<typename T> static T get(std::mutex& mutex, const T& value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return value;
+    }
+
+    template<typename T> static void set(std::mutex& mutex, T& value, const T& new_value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        value = new_value;
+    }
+};
+
+struct Result {
+    double reads_per_s;
+    double updates_per_s;
+};
+
+template<typename Update, typename Read>
+Result run(unsigned num_readers, double duration_s, Update update, Read read)
+{
+    std::atomic<bool> should_exit{false};
+    std::atomic<uint64_t> num_reads{0};
+    uint64_t num_updates = 0;
+
+    std::thread writer([&]() {
+        while (!should_exit) {
+            update(num_updates++);
+        }
+    });
+
+    std::vector<std::thread> readers;
+    for (unsigned i = 0; i < num_readers; ++i) {
+        readers.emplace_back([&]() {
+            uint64_t reads = 0;
+            float checksum = 0.0f;
+            while (!should_exit) {
+                checksum += read();
+                ++reads;
+            }
+            num_reads += reads;
+            // Make sure the reads are not optimized away.
+            if (checksum == 42.0f) {
+                std::cout << "";
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(duration_s));
+    should_exit = true;
+
+    writer.join();
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    return Result{double(num_reads) / duration_s, double(num_updates) / duration_s};
+}
+
+void print(const std::string& name, const Result& result, unsigned fields_per_read)
+{
+    std::cout << name << ":\n"
+              << "  field reads:  " << result.reads_per_s * fields_per_read / 1e6 << " M/s\n"
+              << "  updates:      " << result.updates_per_s / 1e6 << " M/s\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const unsigned num_readers = (argc > 1) ? std::atoi(argv[1]) : 4;
+    const double duration_s = (argc > 2) ? std::atof(argv[2]) : 2.0;
+
+    std::cout << num_readers << " readers polling 20 fields, " << duration_s << " s each\n";
+
+    // Each read polls 4 rounds of 5 fields.
+    constexpr unsigned fields_per_read = 20;
+
+    MutexTelemetry mutex_telemetry{};
+    print(
+        "mutex per field",
+        run(num_readers,
+            duration_s,
+            [&](uint64_t i) {
+                Telemetry::Position position{};
+                position.latitude_deg = double(i);
+                MutexTelemetry::set(
+                    mutex_telemetry.position_mutex, mutex_telemetry.position, position);
+                Telemetry::Battery battery{};
+                battery.voltage_v = float(i);
+                MutexTelemetry::set(
+                    mutex_telemetry.battery_mutex, mutex_telemetry.battery, battery);
+            },
+            [&]() {
+                float sum = 0.0f;
+                for (unsigned round = 0; round < fields_per_read / 5; ++round) {
+                    sum += float(MutexTelemetry::get(
+                                     mutex_telemetry.position_mutex, mutex_telemetry.position)
+                                     .latitude_deg);
+                    sum += MutexTelemetry::get(
+                               mutex_telemetry.attitude_quaternion_mutex,
+                               mutex_telemetry.attitude_quaternion)
+                               .w;
+                    sum += MutexTelemetry::get(
+                               mutex_telemetry.velocity_ned_mutex, mutex_telemetry.velocity_ned)
+                               .north_m_s;
+                    sum += MutexTelemetry::get(mutex_telemetry.imu_mutex, mutex_telemetry.imu)
+                               .temperature_degc;
+                    sum += MutexTelemetry::get(
+                               mutex_telemetry.battery_mutex, mutex_telemetry.battery)
+                               .voltage_v;
+                }
+                return sum;
+            }),
+        fields_per_read);
+
+    Seqlock<Telemetry::Snapshot> state{};
+    auto update_state = [&](uint64_t i) {
+        Telemetry::Position position{};
+        position.latitude_deg = double(i);
+        state.store(&Telemetry::Snapshot::position, position);
+        Telemetry::Battery battery{};
+        battery.voltage_v = float(i);
+        state.store(&Telemetry::Snapshot::battery, battery);
+    };
+
+    print(
+        "seqlock, field by field",
+        run(num_readers,
+            duration_s,
+            update_state,
+            [&]() {
+                float sum = 0.0f;
+                for (unsigned round = 0; round < fields_per_read / 5; ++round) {
+                    sum += float(state.load(&Telemetry::Snapshot::position).latitude_deg);
+                    sum += state.load(&Telemetry::Snapshot::attitude_quaternion).w;
+                    sum += state.load(&Telemetry::Snapshot::velocity_ned).north_m_s;
+                    sum += state.load(&Telemetry::Snapshot::imu).temperature_degc;
+                    sum += state.load(&Telemetry::Snapshot::battery).voltage_v;
+                }
+                return sum;
+            }),
+        fields_per_read);
+
+    print(
+        "seqlock, snapshot",
+        run(num_readers,
+            duration_s,
+            update_state,
+            [&]() {
+                const auto snapshot = state.load();
+                return float(snapshot.position.latitude_deg) + snapshot.attitude_quaternion.w +
+                       snapshot.velocity_ned.north_m_s + snapshot.imu.temperature_degc +
+                       snapshot.battery.voltage_v;
+            }),
+        fields_per_read);
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+//
+// Benchmark of how long recording a message to a tlog holds up the thread
+// sending or receiving it.
+//
+// Incoming and outgoing messages of 40 bytes are each recorded from their own
+// thread at the given rate for 2 seconds, and the time each call to record()
+// takes is measured.
+//
+// Usage: tlog_recorder_benchmark [messages_per_second_per_direction]
+//
+
+#include "tlog_recorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+void produce(
+    TlogRecorder& recorder,
+    TlogRecorder::Direction direction,
+    unsigned rate,
+    std::vector<double>& latencies_us)
+{
+    const unsigned num = 2 * rate;
+    latencies_us.reserve(num);
+    const auto period = std::chrono::microseconds(1000000 / rate);
+    auto next = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < num; ++i) {
+        const auto before = std::chrono::steady_clock::now();
+        recorder.record(direction, [i](uint8_t* data) {
+            data[0] = 0xFD;
+            std::memcpy(&data[1], &i, sizeof(i));
+            std::memset(&data[5], 0x55, 35);
+            return std::size_t(40);
+        });
+        const auto after = std::chrono::steady_clock::now();
+        latencies_us.push_back(std::chrono::duration<double, std::micro>(after - before).count());
+
+        next += period;
+        std::this_thread::sleep_until(next);
+    }
+}
+
+void print_latencies(const char* name, std::vector<double>& latencies_us)
+{
+    std::sort(latencies_us.begin(), latencies_us.end());
+    std::printf(
+        "  %-10s median %6.2f us, p99 %7.2f us, max %8.2f us\n",
+        name,
+        latencies_us[latencies_us.size() / 2],
+        latencies_us[latencies_us.size() * 99 / 100],
+        latencies_us.back());
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const unsigned rate = (argc > 1) ? unsigned(std::atoi(argv[1])) : 5000;
+    const char* path = "tlog_recorder_benchmark.tlog";
+
+    TlogRecorder recorder;
+    if (!recorder.start(path)) {
+        std::fprintf(stderr, "Could not open %s\n", path);
+        return 1;
+    }
+
+    std::vector<double> incoming_latencies_us;
+    std::vector<double> outgoing_latencies_us;
+    std::thread incoming(
+        produce,
+        std::ref(recorder),
+        TlogRecorder::Direction::Incoming,
+        rate,
+        std::ref(incoming_latencies_us));
+    std::thread outgoing(
+        produce,
+        std::ref(recorder),
+        TlogRecorder::Direction::Outgoing,
+        rate,
+        std::ref(outgoing_latencies_us));
+    incoming.join();
+    outgoing.join();
+    recorder.stop();
+
+    std::printf("Recording %u messages per second in each direction\n", rate);
+    print_latencies("incoming", incoming_latencies_us);
+    print_latencies("outgoing", outgoing_latencies_us);
+    std::printf(
+        "  written %llu, dropped %llu\n",
+        static_cast<unsigned long long>(recorder.num_written()),
+        static_cast<unsigned long long>(recorder.num_dropped()));
+
+    std::remove(path);
+    return 0;
+}
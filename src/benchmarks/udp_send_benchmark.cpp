@@ -0,0 +1,135 @@
+//
+// CPU time spent per message sent to several UDP remotes.
+//
+// Compares packing the message again for every remote and sending it with
+// one sendto each, which is what UdpConnection used to do, against
+// UdpConnection packing it once and handing all remotes to the kernel
+// together. The remotes are sockets on the loopback interface which are
+// never read, the kernel drops what doesn't fit.
+//
+// Usage: udp_send_benchmark [num_messages]
+//
+
+#include "udp_connection.h"
+#include "mavlink_include.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+constexpr int first_remote_port = 14700;
+constexpr int local_port = 14699;
+
+mavlink_message_t make_message()
+{
+    mavlink_attitude_t attitude{};
+    attitude.roll = 0.1f;
+    attitude.pitch = -0.1f;
+    attitude.yaw = 1.0f;
+
+    mavlink_message_t message;
+    mavlink_msg_attitude_encode(245, MAV_COMP_ID_MISSIONPLANNER, &message, &attitude);
+    return message;
+}
+
+double cpu_us_per_message(std::clock_t start, unsigned num_messages)
+{
+    return double(std::clock() - start) * 1e6 / CLOCKS_PER_SEC / double(num_messages);
+}
+
+// What UdpConnection did before, for comparison.
+double measure_per_remote(unsigned num_remotes, unsigned num_messages)
+{
+    const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    const auto message = make_message();
+
+    const std::clock_t start = std::clock();
+    for (unsigned i = 0; i < num_messages; ++i) {
+        for (unsigned remote = 0; remote < num_remotes; ++remote) {
+            struct sockaddr_in dest_addr {};
+            dest_addr.sin_family = AF_INET;
+            inet_pton(AF_INET, "127.0.0.1", &dest_addr.sin_addr.s_addr);
+            dest_addr.sin_port = htons(uint16_t(first_remote_port + int(remote)));
+
+            uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+            const uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+
+            sendto(
+                fd,
+                buffer,
+                buffer_len,
+                0,
+                reinterpret_cast<const sockaddr*>(&dest_addr),
+                sizeof(dest_addr));
+        }
+    }
+    const double result = cpu_us_per_message(start, num_messages);
+
+    close(fd);
+    return result;
+}
+
+double measure_connection(unsigned num_remotes, unsigned num_messages)
+{
+    UdpConnection connection([](mavlink_message_t&, Connection*) {}, "127.0.0.1", local_port);
+    if (connection.start() != ConnectionResult::Success) {
+        std::fprintf(stderr, "Could not open UDP port %d\n", local_port);
+        std::exit(1);
+    }
+    for (unsigned remote = 0; remote < num_remotes; ++remote) {
+        connection.add_remote("127.0.0.1", first_remote_port + int(remote));
+    }
+    const auto message = make_message();
+
+    const std::clock_t start = std::clock();
+    for (unsigned i = 0; i < num_messages; ++i) {
+        connection.send_message(message);
+    }
+    return cpu_us_per_message(start, num_messages);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const unsigned num_messages = (argc > 1) ? unsigned(std::atoi(argv[1])) : 100000;
+
+    // The remotes, nobody reads from them.
+    std::vector<int> remote_fds;
+    for (unsigned remote = 0; remote < 16; ++remote) {
+        const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        struct sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr.s_addr);
+        addr.sin_port = htons(uint16_t(first_remote_port + int(remote)));
+        if (bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+            std::fprintf(stderr, "Could not bind UDP port %d\n", first_remote_port + int(remote));
+            return 1;
+        }
+        remote_fds.push_back(fd);
+    }
+
+    std::printf("CPU time per message sent, %u messages\n", num_messages);
+    std::printf("  remotes   packed per remote   packed once\n");
+    for (const unsigned num_remotes : {1u, 4u, 16u}) {
+        const double per_remote_us = measure_per_remote(num_remotes, num_messages);
+        const double connection_us = measure_connection(num_remotes, num_messages);
+        std::printf(
+            "  %7u   %14.2f us   %8.2f us\n", num_remotes, per_remote_us, connection_us);
+    }
+
+    for (const int fd : remote_fds) {
+        close(fd);
+    }
+    return 0;
+}
@@ -0,0 +1,189 @@
+//
+// Benchmark of reading battery and GPS data out of a large ULog file.
+//
+// A log with topics at typical PX4 rates is written first, hours of flight for
+// the default size. It is then opened and indexed, out of the page cache if it
+// can be dropped and again with the file cached, and the battery and GPS series
+// are extracted one topic after the other and all at once.
+//
+// Usage: ulog_reader_benchmark [size_mb]
+//
+
+#include "plugins/log_files/ulog_reader.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(LINUX)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace mavsdk;
+
+namespace {
+
+const std::string path = "ulog_reader_benchmark.ulg";
+
+struct Topic {
+    std::string name;
+    std::string format;
+    // Size of the fields after the timestamp.
+    unsigned size;
+    unsigned rate_hz;
+};
+
+// Roughly what PX4 logs by default, sizes as of the message definitions.
+const std::vector<Topic> topics{
+    {"sensor_combined", "float[3] gyro_rad;float[3] accelerometer_m_s2;uint32_t[10] rest;", 64,
+     200},
+    {"vehicle_attitude", "float[4] q;float[4] delta_q_reset;uint8_t quat_reset_counter;", 33, 100},
+    {"actuator_outputs", "uint32_t noutputs;float[16] output;", 68, 100},
+    {"vehicle_local_position", "float x;float y;float z;float vx;float vy;float vz;float[30] rest;",
+     144, 50},
+    {"battery_status", "float voltage_v;float current_a;float remaining;float[10] voltage_cell_v;",
+     52, 10},
+    {"vehicle_gps_position", "int32_t lat;int32_t lon;int32_t alt;float[16] rest;", 76, 10},
+};
+
+double seconds_since(std::chrono::steady_clock::time_point start_time)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+void append_message(std::vector<char>& buffer, char type, const void* payload, uint16_t size)
+{
+    const char header[3] = {char(size & 0xff), char(size >> 8), type};
+    buffer.insert(buffer.end(), header, header + sizeof(header));
+    buffer.insert(
+        buffer.end(), static_cast<const char*>(payload), static_cast<const char*>(payload) + size);
+}
+
+uint64_t write_log(uint64_t size_bytes)
+{
+    std::ofstream file(path, std::ios::binary);
+    std::vector<char> buffer;
+
+    const char header[16] = {'U', 'L', 'o', 'g', 0x01, 0x12, 0x35, 0x01};
+    buffer.insert(buffer.end(), header, header + sizeof(header));
+    const std::vector<char> flags(40, 0);
+    append_message(buffer, 'B', flags.data(), uint16_t(flags.size()));
+
+    for (std::size_t i = 0; i < topics.size(); ++i) {
+        const std::string format = topics[i].name + ":uint64_t timestamp;" + topics[i].format;
+        append_message(buffer, 'F', format.data(), uint16_t(format.size()));
+    }
+    for (std::size_t i = 0; i < topics.size(); ++i) {
+        std::vector<char> payload{0, char(i), 0};
+        payload.insert(payload.end(), topics[i].name.begin(), topics[i].name.end());
+        append_message(buffer, 'A', payload.data(), uint16_t(payload.size()));
+    }
+
+    // Each topic at its rate, a ms at a time.
+    uint64_t written = 0;
+    std::vector<char> payload(256, 0);
+    for (uint64_t time_ms = 0; written < size_bytes; ++time_ms) {
+        for (std::size_t i = 0; i < topics.size(); ++i) {
+            if ((time_ms * topics[i].rate_hz) % 1000 >= topics[i].rate_hz) {
+                continue;
+            }
+            const uint16_t msg_id = uint16_t(i);
+            const uint64_t timestamp = time_ms * 1000;
+            std::memcpy(&payload[0], &msg_id, sizeof(msg_id));
+            std::memcpy(&payload[2], &timestamp, sizeof(timestamp));
+            // Something that changes in the first fields.
+            const int32_t value = int32_t(time_ms);
+            std::memcpy(&payload[10], &value, sizeof(value));
+            append_message(buffer, 'D', payload.data(), uint16_t(10 + topics[i].size));
+        }
+        if (buffer.size() > (1 << 20)) {
+            file.write(buffer.data(), buffer.size());
+            written += buffer.size();
+            buffer.clear();
+        }
+    }
+    file.write(buffer.data(), buffer.size());
+    return written + buffer.size();
+}
+
+void drop_from_page_cache()
+{
+#if defined(LINUX)
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+#endif
+}
+
+bool open_log(ULogReader& reader, const std::string& name)
+{
+    const auto start_time = std::chrono::steady_clock::now();
+    const auto result = reader.open(path);
+    if (result != ULogReader::Result::Success) {
+        std::cerr << "Could not open log: " << result << std::endl;
+        return false;
+    }
+    std::printf("  %-32s %8.3f s\n", name.c_str(), seconds_since(start_time));
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const unsigned size_mb = (argc > 1) ? unsigned(std::atoi(argv[1])) : 1024;
+
+    const uint64_t size = write_log(uint64_t(size_mb) * 1024 * 1024);
+    std::printf("Reading a ULog file of %.0f MiB\n", double(size) / 1024.0 / 1024.0);
+
+    std::vector<ULogReader::Request> requests(2);
+    requests[0].topic = "battery_status";
+    requests[0].fields = {"voltage_v", "current_a", "remaining", "voltage_cell_v[0]"};
+    requests[1].topic = "vehicle_gps_position";
+    requests[1].fields = {"lat", "lon", "alt"};
+
+    bool success = true;
+    {
+        drop_from_page_cache();
+        ULogReader reader;
+        success = open_log(reader, "open and index, not cached");
+    }
+
+    ULogReader reader;
+    success = success && open_log(reader, "open and index, cached");
+
+    std::size_t num_messages = 0;
+    if (success) {
+        const auto start_time = std::chrono::steady_clock::now();
+        for (const auto& request : requests) {
+            ULogReader::Series series;
+            success = success && reader.extract(request, series) == ULogReader::Result::Success;
+            num_messages += series.timestamps_us.size();
+        }
+        std::printf(
+            "  %-32s %8.3f s (%zu messages)\n",
+            "battery and GPS, one by one",
+            seconds_since(start_time),
+            num_messages);
+    }
+
+    if (success) {
+        const auto start_time = std::chrono::steady_clock::now();
+        std::vector<ULogReader::Series> series;
+        success = reader.extract(requests, series) == ULogReader::Result::Success;
+        std::printf("  %-32s %8.3f s\n", "battery and GPS, at once", seconds_since(start_time));
+    }
+
+    reader.close();
+    std::remove(path.c_str());
+    return success ? 0 : 1;
+}
@@ -18,7 +18,11 @@ target_link_libraries(unit_tests_runner
     mavsdk_mission
     mavsdk_camera
     mavsdk_calibration
+    mavsdk_geofence
     mavsdk_telemetry
+    mavsdk_ftp
+    mavsdk_log_files
+    mavsdk_autopilot_simulator
     CURL::libcurl
     JsonCpp::jsoncpp
     gtest
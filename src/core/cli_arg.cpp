@@ -4,6 +4,7 @@
 #include <vector>
 #include <cctype>
 #include <climits>
+#include <cstdlib>
 
 namespace mavsdk {
 
@@ -13,6 +14,8 @@ void CliArg::reset()
     _path.clear();
     _baudrate = 0;
     _port = 0;
+    _flush_latency_ms = 0;
+    _replay_speed = 1.0;
 }
 
 bool CliArg::parse(const std::string& uri)
@@ -24,6 +27,20 @@ bool CliArg::parse(const std::string& uri)
         return false;
     }
 
+    if (_protocol == Protocol::Replay) {
+        // The path is a file which can contain ':', options come after '?'.
+        return find_replay_path(rest) && find_replay_speed(rest);
+    }
+
+    if (_protocol == Protocol::Loopback) {
+        return find_loopback_name(rest);
+    }
+
+    // Options come after '?', before splitting off the baudrate.
+    if (_protocol == Protocol::Serial && !find_serial_options(rest)) {
+        return false;
+    }
+
     if (!find_path(rest)) {
         return false;
     }
@@ -38,6 +55,11 @@ bool CliArg::parse(const std::string& uri)
         }
     }
 
+    if (_protocol == Protocol::Tcp && _path.empty() && _port != 0) {
+        // Without a host to connect to but with a port, e.g. tcp://:5760, we listen.
+        _protocol = Protocol::TcpServer;
+    }
+
     return true;
 }
 
@@ -47,6 +69,8 @@ bool CliArg::find_protocol(std::string& rest)
     const std::string tcp = "tcp";
     const std::string serial = "serial";
     const std::string serial_flowcontrol = "serial_flowcontrol";
+    const std::string replay = "replay";
+    const std::string loopback = "loopback";
     const std::string delimiter = "://";
 
     if (rest.find(udp + delimiter) == 0) {
@@ -67,6 +91,14 @@ bool CliArg::find_protocol(std::string& rest)
         _flow_control_enabled = true;
         rest.erase(0, serial_flowcontrol.length() + delimiter.length());
         return true;
+    } else if (rest.find(replay + delimiter) == 0) {
+        _protocol = Protocol::Replay;
+        rest.erase(0, replay.length() + delimiter.length());
+        return true;
+    } else if (rest.find(loopback + delimiter) == 0) {
+        _protocol = Protocol::Loopback;
+        rest.erase(0, loopback.length() + delimiter.length());
+        return true;
     } else {
         LogWarn() << "Unknown protocol";
         return false;
@@ -165,4 +197,105 @@ bool CliArg::find_baudrate(std::string& rest)
     return true;
 }
 
+bool CliArg::find_serial_options(std::string& rest)
+{
+    const std::string delimiter = "?";
+    size_t pos = rest.find(delimiter);
+    if (pos == rest.npos) {
+        return true;
+    }
+    std::string options = rest.substr(pos + delimiter.length());
+    rest.erase(pos);
+
+    const std::string flush_latency_ms = "flush_latency_ms=";
+    if (options.find(flush_latency_ms) != 0) {
+        LogWarn() << "Unknown serial option";
+        return false;
+    }
+    options.erase(0, flush_latency_ms.length());
+
+    if (options.empty() || options.length() > 5) {
+        LogWarn() << "Invalid flush latency";
+        return false;
+    }
+    for (const auto& digit : options) {
+        if (!std::isdigit(digit)) {
+            LogWarn() << "Non-numeric char found in flush latency";
+            return false;
+        }
+    }
+    _flush_latency_ms = std::stoi(options);
+    return true;
+}
+
+bool CliArg::find_replay_path(std::string& rest)
+{
+    const std::string delimiter = "?";
+    size_t pos = rest.find(delimiter);
+    if (pos != rest.npos) {
+        _path = rest.substr(0, pos);
+        rest.erase(0, pos + delimiter.length());
+    } else {
+        _path = rest;
+        rest = "";
+    }
+
+    if (_path.empty()) {
+        LogWarn() << "Path for replay log required.";
+        return false;
+    }
+    return true;
+}
+
+bool CliArg::find_replay_speed(std::string& rest)
+{
+    if (rest.length() == 0) {
+        return true;
+    }
+
+    const std::string speed = "speed=";
+    if (rest.find(speed) != 0) {
+        LogWarn() << "Unknown replay option";
+        return false;
+    }
+    rest.erase(0, speed.length());
+
+    if (rest == "max") {
+        _replay_speed = 0.0;
+        return true;
+    }
+
+    // Only digits and at most one decimal point.
+    bool found_point = false;
+    for (const auto& c : rest) {
+        if (c == '.' && !found_point) {
+            found_point = true;
+        } else if (!std::isdigit(c)) {
+            LogWarn() << "Invalid replay speed";
+            return false;
+        }
+    }
+
+    _replay_speed = std::strtod(rest.c_str(), nullptr);
+    if (!(_replay_speed > 0.0)) {
+        LogWarn() << "Replay speed needs to be positive";
+        _replay_speed = 1.0;
+        return false;
+    }
+    return true;
+}
+
+bool CliArg::find_loopback_name(std::string& rest)
+{
+    // The name only needs to match the one of the other side.
+    _path = rest;
+    rest = "";
+
+    if (_path.empty()) {
+        LogWarn() << "Name for loopback link required.";
+        return false;
+    }
+    return true;
+}
+
 } // namespace mavsdk
@@ -6,7 +6,7 @@ namespace mavsdk {
 
 class CliArg {
 public:
-    enum class Protocol { None, Udp, Tcp, Serial };
+    enum class Protocol { None, Udp, Tcp, TcpServer, Serial, Replay, Loopback };
 
     bool parse(const std::string& uri);
 
@@ -18,20 +18,32 @@ public:
 
     bool get_flow_control() const { return _flow_control_enabled; }
 
+    // How long outgoing serial messages may wait to be written together.
+    int get_flush_latency_ms() const { return _flush_latency_ms; }
+
     std::string get_path() const { return _path; }
 
+    // Speed factor for replaying a log, 0 means as fast as possible.
+    double get_replay_speed() const { return _replay_speed; }
+
 private:
     void reset();
     bool find_protocol(std::string& rest);
     bool find_path(std::string& rest);
     bool find_port(std::string& rest);
     bool find_baudrate(std::string& rest);
+    bool find_serial_options(std::string& rest);
+    bool find_replay_path(std::string& rest);
+    bool find_replay_speed(std::string& rest);
+    bool find_loopback_name(std::string& rest);
 
     Protocol _protocol{Protocol::None};
     std::string _path{};
     int _port{0};
     int _baudrate{0};
     bool _flow_control_enabled{false};
+    int _flush_latency_ms{0};
+    double _replay_speed{1.0};
 };
 
 } // namespace mavsdk
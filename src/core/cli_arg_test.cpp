@@ -77,7 +77,7 @@ TEST(CliArg, TCPConnections)
     EXPECT_EQ(0, ca.get_port());
 
     ca.parse("tcp://:8");
-    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::Tcp);
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::TcpServer);
     EXPECT_STREQ(ca.get_path().c_str(), "");
     EXPECT_EQ(8, ca.get_port());
 
@@ -147,6 +147,21 @@ TEST(CliArg, SerialConnections)
     EXPECT_STREQ(ca.get_path().c_str(), "COM3");
     EXPECT_EQ(0, ca.get_baudrate());
     EXPECT_EQ(false, ca.get_flow_control());
+    EXPECT_EQ(0, ca.get_flush_latency_ms());
+
+    EXPECT_TRUE(ca.parse("serial:///dev/ttyUSB0:921600?flush_latency_ms=5"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::Serial);
+    EXPECT_STREQ(ca.get_path().c_str(), "/dev/ttyUSB0");
+    EXPECT_EQ(921600, ca.get_baudrate());
+    EXPECT_EQ(5, ca.get_flush_latency_ms());
+
+    EXPECT_TRUE(ca.parse("serial:///dev/ttyUSB0?flush_latency_ms=2"));
+    EXPECT_STREQ(ca.get_path().c_str(), "/dev/ttyUSB0");
+    EXPECT_EQ(0, ca.get_baudrate());
+    EXPECT_EQ(2, ca.get_flush_latency_ms());
+
+    EXPECT_TRUE(ca.parse("serial:///dev/ttyS0"));
+    EXPECT_EQ(0, ca.get_flush_latency_ms());
 
     // All the wrong combinations.
     EXPECT_FALSE(ca.parse(""));
@@ -163,4 +178,56 @@ TEST(CliArg, SerialConnections)
     EXPECT_FALSE(ca.parse("serial://SOM3"));
     EXPECT_FALSE(ca.parse("serial://SOM3:57600"));
     EXPECT_FALSE(ca.parse("serial://COM3:-1"));
+    EXPECT_FALSE(ca.parse("serial:///dev/ttyS0:57600?flush_latency_ms="));
+    EXPECT_FALSE(ca.parse("serial:///dev/ttyS0:57600?flush_latency_ms=-1"));
+    EXPECT_FALSE(ca.parse("serial:///dev/ttyS0:57600?flush_latency_ms=999999"));
+    EXPECT_FALSE(ca.parse("serial:///dev/ttyS0:57600?latency=5"));
+}
+
+TEST(CliArg, ReplayConnections)
+{
+    CliArg ca;
+
+    EXPECT_TRUE(ca.parse("replay://flight.tlog"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::Replay);
+    EXPECT_STREQ(ca.get_path().c_str(), "flight.tlog");
+    EXPECT_EQ(1.0, ca.get_replay_speed());
+
+    EXPECT_TRUE(ca.parse("replay:///tmp/logs/flight.tlog?speed=2.5"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::Replay);
+    EXPECT_STREQ(ca.get_path().c_str(), "/tmp/logs/flight.tlog");
+    EXPECT_EQ(2.5, ca.get_replay_speed());
+
+    EXPECT_TRUE(ca.parse("replay://C:\\logs\\flight.tlog?speed=max"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::Replay);
+    EXPECT_STREQ(ca.get_path().c_str(), "C:\\logs\\flight.tlog");
+    EXPECT_EQ(0.0, ca.get_replay_speed());
+
+    EXPECT_TRUE(ca.parse("replay://flight.tlog?speed=0.5"));
+    EXPECT_EQ(0.5, ca.get_replay_speed());
+
+    // All the wrong combinations.
+    EXPECT_FALSE(ca.parse("replay://"));
+    EXPECT_FALSE(ca.parse("replay://?speed=1"));
+    EXPECT_FALSE(ca.parse("replay:/flight.tlog"));
+    EXPECT_FALSE(ca.parse("replay://flight.tlog?speed="));
+    EXPECT_FALSE(ca.parse("replay://flight.tlog?speed=0"));
+    EXPECT_FALSE(ca.parse("replay://flight.tlog?speed=-1"));
+    EXPECT_FALSE(ca.parse("replay://flight.tlog?speed=1.2.3"));
+    EXPECT_FALSE(ca.parse("replay://flight.tlog?rate=1"));
+}
+
+TEST(CliArg, LoopbackConnections)
+{
+    CliArg ca;
+
+    EXPECT_TRUE(ca.parse("loopback://camera"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::Loopback);
+    EXPECT_STREQ(ca.get_path().c_str(), "camera");
+
+    EXPECT_TRUE(ca.parse("loopback://vehicle:1"));
+    EXPECT_STREQ(ca.get_path().c_str(), "vehicle:1");
+
+    EXPECT_FALSE(ca.parse("loopback://"));
+    EXPECT_FALSE(ca.parse("loopback:/camera"));
 }
@@ -1,6 +1,5 @@
 #include "connection.h"
 #include "mavsdk_impl.h"
-#include "mavlink_channels.h"
 #include "global_include.h"
 
 namespace mavsdk {
@@ -17,30 +16,19 @@ Connection::~Connection()
     _receiver_callback = {};
 }
 
-bool Connection::start_mavlink_receiver()
+void Connection::start_mavlink_receiver()
 {
-    uint8_t channel;
-    if (!MAVLinkChannels::Instance().checkout_free_channel(channel)) {
-        return false;
-    }
-
-    _mavlink_receiver.reset(new MAVLinkReceiver(channel));
-    return true;
+    _mavlink_receiver.reset(new MAVLinkReceiver());
 }
 
 void Connection::stop_mavlink_receiver()
 {
-    if (_mavlink_receiver) {
-        uint8_t used_channel = _mavlink_receiver->get_channel();
-        // Destroy receiver before giving the channel back.
-        _mavlink_receiver.reset();
-        MAVLinkChannels::Instance().checkin_used_channel(used_channel);
-    }
+    _mavlink_receiver.reset();
 }
 
 void Connection::receive_message(mavlink_message_t& message)
 {
-    _receiver_callback(message);
+    _receiver_callback(message, this);
 }
 
 } // namespace mavsdk
@@ -2,13 +2,16 @@
 
 #include "mavsdk.h"
 #include "mavlink_receiver.h"
+#include "serialized_message.h"
 #include <memory>
 
 namespace mavsdk {
 
 class Connection {
 public:
-    typedef std::function<void(mavlink_message_t& message)> receiver_callback_t;
+    // Called with every message received and the connection it came in on.
+    typedef std::function<void(mavlink_message_t& message, Connection* connection)>
+        receiver_callback_t;
 
     Connection(receiver_callback_t receiver_callback);
     virtual ~Connection();
@@ -18,12 +21,20 @@ public:
 
     virtual bool send_message(const mavlink_message_t& message) = 0;
 
+    // Sends a message which was serialized already because it goes out on
+    // several connections. Connections writing bytes should override this
+    // to use the buffer as it is.
+    virtual bool send_serialized(const std::shared_ptr<const SerializedMessage>& serialized)
+    {
+        return send_message(serialized->message());
+    }
+
     // Non-copyable
     Connection(const Connection&) = delete;
     const Connection& operator=(const Connection&) = delete;
 
 protected:
-    bool start_mavlink_receiver();
+    void start_mavlink_receiver();
     void stop_mavlink_receiver();
     void receive_message(mavlink_message_t& message);
 
@@ -1,13 +1,88 @@
 #include "geometry.h"
 #include "global_include.h"
+#include <algorithm>
 #include <cmath>
 
 namespace mavsdk {
 namespace geometry {
 
+namespace {
+
+// Sine and cosine without branches or library calls, so that loops using it
+// can be vectorized. This is the Cephes implementation: reduction to
+// [-pi/4, pi/4] with pi/4 split into three parts, then a polynomial.
+inline void sin_cos(double x, double& sin_x, double& cos_x)
+{
+    constexpr double four_over_pi = 1.27323954473516268615;
+    constexpr double dp1 = 7.85398125648498535156e-1;
+    constexpr double dp2 = 3.77489470793079817668e-8;
+    constexpr double dp3 = 2.69515142907905952645e-15;
+
+    const double sign = (x < 0.0) ? -1.0 : 1.0;
+    const double abs_x = std::fabs(x);
+
+    // Octant, rounded up to an even one.
+    int j = static_cast<int>(abs_x * four_over_pi);
+    j += j & 1;
+    const double y = double(j);
+    const double z = ((abs_x - y * dp1) - y * dp2) - y * dp3;
+    const double zz = z * z;
+
+    const double sin_poly =
+        z + z * zz *
+                (((((1.58962301576546568060e-10 * zz - 2.50507477628578072866e-8) * zz +
+                    2.75573136213857245213e-6) *
+                       zz -
+                   1.98412698295895385996e-4) *
+                      zz +
+                  8.33333333332211858878e-3) *
+                     zz -
+                 1.66666666666666307295e-1);
+    const double cos_poly =
+        1.0 - 0.5 * zz +
+        zz * zz *
+            (((((-1.13585365213876817300e-11 * zz + 2.08757008419747316778e-9) * zz -
+                2.75573141792967388112e-7) *
+                   zz +
+               2.48015872888517045348e-5) *
+                  zz -
+              1.38888888888730564116e-3) *
+                 zz +
+             4.16666666666665929218e-2);
+
+    const bool swap = (j & 2) != 0;
+    const double sin_sign = (j & 4) ? -1.0 : 1.0;
+    const double cos_sign = ((j + 2) & 4) ? -1.0 : 1.0;
+
+    sin_x = sign * sin_sign * (swap ? cos_poly : sin_poly);
+    cos_x = cos_sign * (swap ? sin_poly : cos_poly);
+}
+
+// Series of asin(s)/s in s^2, used for c/sin(c) with sin(c) = s. Accurate to
+// double precision for s^2 below max_series_s2 which is an angle of ~0.1 rad,
+// or ~600 km.
+constexpr double max_series_s2 = 0.01;
+
+inline double asin_over_x(double s2)
+{
+    return 1.0 +
+           s2 * (1.0 / 6.0 +
+                 s2 * (3.0 / 40.0 +
+                       s2 * (5.0 / 112.0 +
+                             s2 * (35.0 / 1152.0 +
+                                   s2 * (63.0 / 2816.0 +
+                                         s2 * (231.0 / 13312.0 +
+                                               s2 * (143.0 / 10240.0 +
+                                                     s2 * (6435.0 / 557056.0))))))));
+}
+
+} // namespace
+
 CoordinateTransformation::CoordinateTransformation(GlobalCoordinate reference) :
     _ref_lat_rad(rad(reference.latitude_deg)),
-    _ref_lon_rad(rad(reference.longitude_deg))
+    _ref_lon_rad(rad(reference.longitude_deg)),
+    _ref_sin_lat(sin(_ref_lat_rad)),
+    _ref_cos_lat(cos(_ref_lat_rad))
 {}
 
 CoordinateTransformation::LocalCoordinate
@@ -21,8 +96,8 @@ CoordinateTransformation::local_from_global(GlobalCoordinate global_coordinate)
 
     const double cos_d_lon = cos(lon_rad - _ref_lon_rad);
 
-    const double ref_sin_lat = sin(_ref_lat_rad);
-    const double ref_cos_lat = cos(_ref_lat_rad);
+    const double ref_sin_lat = _ref_sin_lat;
+    const double ref_cos_lat = _ref_cos_lat;
 
     const double arg =
         constrain(ref_sin_lat * sin_lat + ref_cos_lat * cos_lat * cos_d_lon, -1.0, 1.0);
@@ -48,8 +123,8 @@ CoordinateTransformation::global_from_local(LocalCoordinate local_coordinate) co
         const double sin_c = sin(c);
         const double cos_c = cos(c);
 
-        const double ref_sin_lat = sin(_ref_lat_rad);
-        const double ref_cos_lat = cos(_ref_lat_rad);
+        const double ref_sin_lat = _ref_sin_lat;
+        const double ref_cos_lat = _ref_cos_lat;
 
         const double lat_rad = asin(cos_c * ref_sin_lat + (x_rad * sin_c * ref_cos_lat) / c);
         const double lon_rad =
@@ -67,6 +142,102 @@ CoordinateTransformation::global_from_local(LocalCoordinate local_coordinate) co
     return global;
 }
 
+void CoordinateTransformation::local_from_global(
+    const double* latitude_deg,
+    const double* longitude_deg,
+    double* north_m,
+    double* east_m,
+    std::size_t count) const
+{
+    const double ref_sin_lat = _ref_sin_lat;
+    const double ref_cos_lat = _ref_cos_lat;
+    const double ref_lon_rad = _ref_lon_rad;
+
+    // This loop has no calls or branches so it can be vectorized. Instead of
+    // c = acos(arg) and k = c / sin(c) it uses sin(c) = sqrt(1 - arg^2) and a
+    // series for k which only holds for points close to the reference.
+    bool all_close = true;
+    for (std::size_t i = 0; i < count; ++i) {
+        double sin_lat, cos_lat;
+        sin_cos(rad(latitude_deg[i]), sin_lat, cos_lat);
+        double sin_d_lon, cos_d_lon;
+        sin_cos(rad(longitude_deg[i]) - ref_lon_rad, sin_d_lon, cos_d_lon);
+
+        const double arg =
+            constrain(ref_sin_lat * sin_lat + ref_cos_lat * cos_lat * cos_d_lon, -1.0, 1.0);
+        const double s2 = 1.0 - arg * arg;
+        const double k = asin_over_x(s2);
+
+        north_m[i] = k * (ref_cos_lat * sin_lat - ref_sin_lat * cos_lat * cos_d_lon) *
+                     world_radius_m;
+        east_m[i] = k * cos_lat * sin_d_lon * world_radius_m;
+
+        all_close &= (arg > 0.0) & (s2 < max_series_s2);
+    }
+
+    if (all_close) {
+        return;
+    }
+
+    // Points far away are redone one by one.
+    for (std::size_t i = 0; i < count; ++i) {
+        const double lat_rad = rad(latitude_deg[i]);
+        const double cos_d_lon = cos(rad(longitude_deg[i]) - ref_lon_rad);
+        const double arg = constrain(
+            ref_sin_lat * sin(lat_rad) + ref_cos_lat * cos(lat_rad) * cos_d_lon, -1.0, 1.0);
+        if (arg > 0.0 && 1.0 - arg * arg < max_series_s2) {
+            continue;
+        }
+
+        const auto local = local_from_global(GlobalCoordinate{latitude_deg[i], longitude_deg[i]});
+        north_m[i] = local.north_m;
+        east_m[i] = local.east_m;
+    }
+}
+
+void CoordinateTransformation::global_from_local(
+    const double* north_m,
+    const double* east_m,
+    double* latitude_deg,
+    double* longitude_deg,
+    std::size_t count) const
+{
+    const double ref_sin_lat = _ref_sin_lat;
+    const double ref_cos_lat = _ref_cos_lat;
+
+    // The inverse functions asin and atan2 have to be called one by one, so
+    // everything else is done in a vectorizable loop first, a chunk at a time.
+    constexpr std::size_t chunk_size = 64;
+    double asin_arg[chunk_size];
+    double atan2_y[chunk_size];
+    double atan2_x[chunk_size];
+
+    for (std::size_t start = 0; start < count; start += chunk_size) {
+        const std::size_t size = std::min(chunk_size, count - start);
+
+        for (std::size_t i = 0; i < size; ++i) {
+            const double x_rad = north_m[start + i] / world_radius_m;
+            const double y_rad = east_m[start + i] / world_radius_m;
+            const double c = sqrt(x_rad * x_rad + y_rad * y_rad);
+
+            double sin_c, cos_c;
+            sin_cos(c, sin_c, cos_c);
+            // sin(c) / c, which goes to 1 for the reference itself.
+            const double sin_c_over_c = (c > 0.0) ? sin_c / c : 1.0;
+
+            asin_arg[i] =
+                constrain(cos_c * ref_sin_lat + x_rad * sin_c_over_c * ref_cos_lat, -1.0, 1.0);
+            atan2_y[i] = y_rad * sin_c_over_c;
+            atan2_x[i] = ref_cos_lat * cos_c - x_rad * ref_sin_lat * sin_c_over_c;
+        }
+
+        for (std::size_t i = 0; i < size; ++i) {
+            latitude_deg[start + i] = deg(asin(asin_arg[i]));
+            longitude_deg[start + i] = deg(_ref_lon_rad + atan2(atan2_y[i], atan2_x[i]));
+        }
+    }
+}
+
 constexpr double CoordinateTransformation::rad(double deg)
 {
     return M_PI / 180.0 * deg;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 namespace mavsdk {
 namespace geometry {
 
@@ -56,6 +58,46 @@ public:
      */
     GlobalCoordinate global_from_local(LocalCoordinate local_coordinate) const;
 
+    /**
+     * @brief Calculate local coordinates for a batch of global coordinates.
+     *
+     * The coordinates are passed as separate arrays (structure of arrays) which
+     * allows the calculation to be vectorized. The results are within 1e-6 m
+     * of `local_from_global`. Input and output arrays must not overlap.
+     *
+     * @param latitude_deg Array of `count` latitudes in degrees.
+     * @param longitude_deg Array of `count` longitudes in degrees.
+     * @param north_m Array of `count` to write the North positions in meters to.
+     * @param east_m Array of `count` to write the East positions in meters to.
+     * @param count Number of coordinates.
+     */
+    void local_from_global(
+        const double* latitude_deg,
+        const double* longitude_deg,
+        double* north_m,
+        double* east_m,
+        std::size_t count) const;
+
+    /**
+     * @brief Calculate global coordinates for a batch of local coordinates.
+     *
+     * The coordinates are passed as separate arrays (structure of arrays).
+     * The results are within 1e-9 degrees of `global_from_local`. Input and
+     * output arrays must not overlap.
+     *
+     * @param north_m Array of `count` North positions in meters.
+     * @param east_m Array of `count` East positions in meters.
+     * @param latitude_deg Array of `count` to write the latitudes in degrees to.
+     * @param longitude_deg Array of `count` to write the longitudes in degrees to.
+     * @param count Number of coordinates.
+     */
+    void global_from_local(
+        const double* north_m,
+        const double* east_m,
+        double* latitude_deg,
+        double* longitude_deg,
+        std::size_t count) const;
+
     /**
      * @brief Destructor.
      */
@@ -68,6 +110,8 @@ private:
 
     double _ref_lat_rad;
     double _ref_lon_rad;
+    double _ref_sin_lat;
+    double _ref_cos_lat;
     static constexpr double world_radius_m{6371000.0};
 };
 
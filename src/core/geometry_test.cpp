@@ -1,5 +1,7 @@
 #include "geometry.h"
 #include <gtest/gtest.h>
+#include <random>
+#include <vector>
 
 using namespace mavsdk::geometry;
 
@@ -47,4 +49,85 @@ TEST(Geoemtry, LocalToGlobalAndBack)
 
     EXPECT_NEAR(location.north_m, location_again.north_m, 1e-9);
     EXPECT_NEAR(location.east_m, location_again.east_m, 1e-9);
-}
\ No newline at end of file
+}
+
+TEST(Geometry, GlobalToLocalBatch)
+{
+    CoordinateTransformation ct({47.397742, 8.545594});
+
+    std::mt19937 rng(1);
+    // Mostly close by, with some far away ones which are not vectorized.
+    std::uniform_real_distribution<double> close_offset(-0.5, 0.5);
+    std::uniform_real_distribution<double> far_offset(-60.0, 60.0);
+
+    std::vector<double> latitudes_deg;
+    std::vector<double> longitudes_deg;
+    for (unsigned i = 0; i < 1000; ++i) {
+        auto& offset = (i % 100 == 0) ? far_offset : close_offset;
+        latitudes_deg.push_back(47.397742 + offset(rng) / 2.0);
+        longitudes_deg.push_back(8.545594 + offset(rng));
+    }
+    // Exactly on the reference.
+    latitudes_deg.push_back(47.397742);
+    longitudes_deg.push_back(8.545594);
+
+    std::vector<double> norths_m(latitudes_deg.size());
+    std::vector<double> easts_m(latitudes_deg.size());
+    ct.local_from_global(
+        latitudes_deg.data(),
+        longitudes_deg.data(),
+        norths_m.data(),
+        easts_m.data(),
+        latitudes_deg.size());
+
+    for (std::size_t i = 0; i < latitudes_deg.size(); ++i) {
+        const auto local = ct.local_from_global({latitudes_deg[i], longitudes_deg[i]});
+        EXPECT_NEAR(norths_m[i], local.north_m, 1e-6);
+        EXPECT_NEAR(easts_m[i], local.east_m, 1e-6);
+    }
+}
+
+TEST(Geometry, LocalToGlobalBatch)
+{
+    CoordinateTransformation ct({-38.227562, 176.506076});
+
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<double> offset_m(-100000.0, 100000.0);
+
+    std::vector<double> norths_m{0.0};
+    std::vector<double> easts_m{0.0};
+    for (unsigned i = 0; i < 1000; ++i) {
+        norths_m.push_back(offset_m(rng));
+        easts_m.push_back(offset_m(rng));
+    }
+
+    std::vector<double> latitudes_deg(norths_m.size());
+    std::vector<double> longitudes_deg(norths_m.size());
+    ct.global_from_local(
+        norths_m.data(),
+        easts_m.data(),
+        latitudes_deg.data(),
+        longitudes_deg.data(),
+        norths_m.size());
+
+    for (std::size_t i = 0; i < norths_m.size(); ++i) {
+        const auto global = ct.global_from_local({norths_m[i], easts_m[i]});
+        EXPECT_NEAR(latitudes_deg[i], global.latitude_deg, 1e-9);
+        EXPECT_NEAR(longitudes_deg[i], global.longitude_deg, 1e-9);
+    }
+
+    // And back again.
+    std::vector<double> norths_again_m(norths_m.size());
+    std::vector<double> easts_again_m(norths_m.size());
+    ct.local_from_global(
+        latitudes_deg.data(),
+        longitudes_deg.data(),
+        norths_again_m.data(),
+        easts_again_m.data(),
+        norths_m.size());
+
+    for (std::size_t i = 0; i < norths_m.size(); ++i) {
+        EXPECT_NEAR(norths_again_m[i], norths_m[i], 1e-6);
+        EXPECT_NEAR(easts_again_m[i], easts_m[i], 1e-6);
+    }
+}
@@ -0,0 +1,218 @@
+#include "loopback_connection.h"
+#include "global_include.h"
+#include "log.h"
+#include "spsc_queue.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+
+namespace mavsdk {
+
+// The two directions of a link, each received by one side.
+class LoopbackLink {
+public:
+    struct Direction {
+        explicit Direction(std::size_t queue_capacity) : queue(queue_capacity) {}
+
+        SpscQueue<mavlink_message_t> queue;
+
+        // Only used to wake up the receiver once it ran out of work.
+        std::mutex mutex{};
+        std::condition_variable cv{};
+        std::atomic<bool> is_waiting{false};
+
+        std::atomic<bool> is_attached{false};
+    };
+
+    explicit LoopbackLink(std::size_t queue_capacity) :
+        _directions{std::unique_ptr<Direction>(new Direction(queue_capacity)),
+                    std::unique_ptr<Direction>(new Direction(queue_capacity))}
+    {}
+
+    // Delete copy and move constructors and assign operators.
+    LoopbackLink(LoopbackLink const&) = delete;
+    LoopbackLink(LoopbackLink&&) = delete;
+    LoopbackLink& operator=(LoopbackLink const&) = delete;
+    LoopbackLink& operator=(LoopbackLink&&) = delete;
+
+    Direction& direction(unsigned side) { return *_directions[side]; }
+
+private:
+    std::unique_ptr<Direction> _directions[2];
+};
+
+namespace {
+
+// Links by name, a link goes away once both sides are gone.
+std::mutex& links_mutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::map<std::string, std::weak_ptr<LoopbackLink>>& links()
+{
+    static std::map<std::string, std::weak_ptr<LoopbackLink>> links;
+    return links;
+}
+
+// Polls a few times before going to sleep, which keeps the latency low while
+// messages come in quickly.
+constexpr unsigned num_polls_before_waiting = 64;
+
+} // namespace
+
+LoopbackConnection::LoopbackConnection(
+    Connection::receiver_callback_t receiver_callback,
+    const std::string& name,
+    std::size_t queue_capacity) :
+    Connection(receiver_callback),
+    _name(name),
+    _queue_capacity(queue_capacity)
+{}
+
+LoopbackConnection::~LoopbackConnection()
+{
+    // If no one explicitly called stop before, we should at least do it.
+    stop();
+}
+
+ConnectionResult LoopbackConnection::start()
+{
+    // No MAVLink channel is needed because nothing is parsed.
+    std::lock_guard<std::mutex> lock(links_mutex());
+
+    auto link = links()[_name].lock();
+    if (!link) {
+        // The capacity of the side creating the link is used.
+        link = std::make_shared<LoopbackLink>(_queue_capacity);
+        links()[_name] = link;
+    }
+
+    if (!link->direction(0).is_attached) {
+        _side = 0;
+    } else if (!link->direction(1).is_attached) {
+        _side = 1;
+    } else {
+        LogErr() << "Loopback link " << _name << " already has two connections";
+        return ConnectionResult::ConnectionError;
+    }
+
+    {
+        std::lock_guard<std::mutex> send_lock(_send_mutex);
+        _link = link;
+    }
+    _link->direction(_side).is_attached = true;
+
+    _should_exit = false;
+    _recv_thread = new std::thread(&LoopbackConnection::receive, this);
+
+    return ConnectionResult::Success;
+}
+
+ConnectionResult LoopbackConnection::stop()
+{
+    _should_exit = true;
+
+    if (_recv_thread) {
+        {
+            auto& direction = _link->direction(_side);
+            std::lock_guard<std::mutex> lock(direction.mutex);
+            direction.cv.notify_all();
+        }
+        _recv_thread->join();
+        delete _recv_thread;
+        _recv_thread = nullptr;
+    }
+
+    std::shared_ptr<LoopbackLink> link;
+    {
+        std::lock_guard<std::mutex> send_lock(_send_mutex);
+        link = _link;
+        _link.reset();
+    }
+
+    if (link) {
+        std::lock_guard<std::mutex> lock(links_mutex());
+        auto& direction = link->direction(_side);
+        direction.is_attached = false;
+
+        // Whoever connects next should not get what was meant for us.
+        while (direction.queue.front() != nullptr) {
+            direction.queue.pop();
+        }
+
+        link.reset();
+        auto it = links().find(_name);
+        if (it != links().end() && it->second.expired()) {
+            links().erase(it);
+        }
+    }
+
+    return ConnectionResult::Success;
+}
+
+bool LoopbackConnection::send_message(const mavlink_message_t& message)
+{
+    std::lock_guard<std::mutex> lock(_send_mutex);
+
+    if (!_link) {
+        return false;
+    }
+
+    auto& direction = _link->direction(1 - _side);
+    if (!direction.is_attached) {
+        return false;
+    }
+
+    auto* slot = direction.queue.try_reserve();
+    if (slot == nullptr) {
+        return false;
+    }
+    *slot = message;
+    direction.queue.commit();
+
+    // Pairs with the fence in receive(): either the receiver sees the message
+    // before going to sleep or we see that it sleeps.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (direction.is_waiting.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> wakeup_lock(direction.mutex);
+        direction.cv.notify_one();
+    }
+
+    return true;
+}
+
+void LoopbackConnection::receive()
+{
+    auto& direction = _link->direction(_side);
+    unsigned num_polls = 0;
+
+    while (!_should_exit) {
+        auto* message = direction.queue.front();
+        if (message != nullptr) {
+            receive_message(*message);
+            direction.queue.pop();
+            num_polls = 0;
+            continue;
+        }
+
+        if (++num_polls < num_polls_before_waiting) {
+            std::this_thread::yield();
+            continue;
+        }
+        num_polls = 0;
+
+        std::unique_lock<std::mutex> lock(direction.mutex);
+        direction.is_waiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (direction.queue.front() == nullptr && !_should_exit) {
+            // The timeout is just a safety net.
+            direction.cv.wait_for(lock, std::chrono::milliseconds(100));
+        }
+        direction.is_waiting.store(false, std::memory_order_relaxed);
+    }
+}
+
+} // namespace mavsdk
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "connection.h"
+
+namespace mavsdk {
+
+class LoopbackLink;
+
+// Connects two components in the same process without going through
+// sockets, e.g. MAVSDK used as ground station and as camera server.
+//
+// The two connections of a link are paired by name: the first one started
+// with a name creates the link, the second one joins it. Messages are passed
+// as mavlink_message_t through a lock-free ring per direction, so they are
+// neither serialized nor parsed. Messages sent while the other side is not
+// connected, or while its ring is full, are dropped.
+class LoopbackConnection : public Connection {
+public:
+    explicit LoopbackConnection(
+        Connection::receiver_callback_t receiver_callback,
+        const std::string& name,
+        std::size_t queue_capacity = default_queue_capacity);
+    ~LoopbackConnection();
+    ConnectionResult start() override;
+    ConnectionResult stop() override;
+
+    bool send_message(const mavlink_message_t& message) override;
+
+    static constexpr std::size_t default_queue_capacity = 1024;
+
+    // Non-copyable
+    LoopbackConnection(const LoopbackConnection&) = delete;
+    const LoopbackConnection& operator=(const LoopbackConnection&) = delete;
+
+private:
+    void receive();
+
+    std::string _name;
+    std::size_t _queue_capacity;
+
+    std::shared_ptr<LoopbackLink> _link{};
+    unsigned _side{0};
+
+    // The ring takes one producer at a time.
+    std::mutex _send_mutex{};
+
+    std::thread* _recv_thread{nullptr};
+    std::atomic_bool _should_exit{false};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,151 @@
+#include "loopback_connection.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+// Collects the sequence numbers of what was received.
+struct Receiver {
+    void receive(mavlink_message_t& message)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        seqs.push_back(message.seq);
+        sysids.push_back(message.sysid);
+    }
+
+    std::size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return seqs.size();
+    }
+
+    bool wait_for(std::size_t num_messages)
+    {
+        for (unsigned i = 0; i < 1000 && size() < num_messages; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return size() >= num_messages;
+    }
+
+    std::mutex mutex{};
+    std::vector<uint8_t> seqs{};
+    std::vector<uint8_t> sysids{};
+};
+
+mavlink_message_t make_message(uint8_t sysid, uint8_t seq)
+{
+    mavlink_message_t message{};
+    message.magic = MAVLINK_STX;
+    message.sysid = sysid;
+    message.compid = 1;
+    message.seq = seq;
+    return message;
+}
+
+} // namespace
+
+TEST(LoopbackConnection, PassesMessagesBothWays)
+{
+    Receiver receiver_a;
+    Receiver receiver_b;
+    LoopbackConnection a(
+        [&receiver_a](mavlink_message_t& message, Connection*) { receiver_a.receive(message); },
+        "both_ways");
+    LoopbackConnection b(
+        [&receiver_b](mavlink_message_t& message, Connection*) { receiver_b.receive(message); },
+        "both_ways");
+
+    ASSERT_EQ(a.start(), ConnectionResult::Success);
+    // Nobody on the other side yet.
+    EXPECT_FALSE(a.send_message(make_message(1, 0)));
+    ASSERT_EQ(b.start(), ConnectionResult::Success);
+
+    for (uint8_t i = 0; i < 200; ++i) {
+        EXPECT_TRUE(a.send_message(make_message(1, i)));
+        EXPECT_TRUE(b.send_message(make_message(2, i)));
+    }
+
+    ASSERT_TRUE(receiver_a.wait_for(200));
+    ASSERT_TRUE(receiver_b.wait_for(200));
+    for (uint8_t i = 0; i < 200; ++i) {
+        EXPECT_EQ(receiver_a.seqs[i], i);
+        EXPECT_EQ(receiver_a.sysids[i], 2);
+        EXPECT_EQ(receiver_b.seqs[i], i);
+        EXPECT_EQ(receiver_b.sysids[i], 1);
+    }
+
+    b.stop();
+    EXPECT_FALSE(a.send_message(make_message(1, 0)));
+    a.stop();
+}
+
+TEST(LoopbackConnection, PairsByName)
+{
+    Receiver receiver;
+    auto callback = [&receiver](mavlink_message_t& message, Connection*) {
+        receiver.receive(message);
+    };
+
+    LoopbackConnection a(callback, "pair_1");
+    LoopbackConnection b(callback, "pair_2");
+    LoopbackConnection c(callback, "pair_1");
+    LoopbackConnection d(callback, "pair_1");
+
+    ASSERT_EQ(a.start(), ConnectionResult::Success);
+    ASSERT_EQ(b.start(), ConnectionResult::Success);
+    EXPECT_FALSE(b.send_message(make_message(2, 0)));
+
+    ASSERT_EQ(c.start(), ConnectionResult::Success);
+    // Only two sides to a link.
+    EXPECT_EQ(d.start(), ConnectionResult::ConnectionError);
+
+    EXPECT_TRUE(c.send_message(make_message(3, 0)));
+    ASSERT_TRUE(receiver.wait_for(1));
+    EXPECT_EQ(receiver.sysids[0], 3);
+
+    // Once a side is free again, it can be taken.
+    c.stop();
+    EXPECT_EQ(d.start(), ConnectionResult::Success);
+    EXPECT_TRUE(a.send_message(make_message(1, 0)));
+    ASSERT_TRUE(receiver.wait_for(2));
+    EXPECT_EQ(receiver.sysids[1], 1);
+}
+
+TEST(LoopbackConnection, DropsWhenFull)
+{
+    std::atomic<bool> is_blocked{true};
+    std::atomic<unsigned> num_received{0};
+    LoopbackConnection a([](mavlink_message_t&, Connection*) {}, "full", 16);
+    LoopbackConnection b(
+        [&is_blocked, &num_received](mavlink_message_t&, Connection*) {
+            while (is_blocked) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            ++num_received;
+        },
+        "full");
+
+    ASSERT_EQ(a.start(), ConnectionResult::Success);
+    ASSERT_EQ(b.start(), ConnectionResult::Success);
+
+    unsigned num_sent = 0;
+    for (uint8_t i = 0; i < 100; ++i) {
+        if (a.send_message(make_message(1, i))) {
+            ++num_sent;
+        }
+    }
+    // The one being received takes its slot until done.
+    EXPECT_EQ(num_sent, 16u);
+
+    is_blocked = false;
+    for (unsigned i = 0; i < 1000 && num_received < num_sent; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(num_received, num_sent);
+}
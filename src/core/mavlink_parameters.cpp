@@ -120,6 +120,24 @@ MAVLinkParameters::get_param(const std::string& name, ParamValue value_type, boo
     return res.get();
 }
 
+void MAVLinkParameters::get_all_params_async(
+    get_all_params_callback_t callback,
+    const void* cookie,
+    uint8_t component_id,
+    bool extended)
+{
+    auto new_work = std::make_shared<WorkItem>();
+    new_work->type = WorkItem::Type::GetAll;
+    new_work->get_all_params_callback = callback;
+    new_work->target_component_id = component_id;
+    new_work->extended = extended;
+    new_work->cookie = cookie;
+    // Not all cameras answer the request, so we don't keep them waiting long for it.
+    new_work->retries_to_do = 1;
+
+    _work_queue.push_back(new_work);
+}
+
 void MAVLinkParameters::cancel_all_param(const void* cookie)
 {
     LockedQueue<WorkItem>::Guard work_queue_guard(_work_queue);
@@ -279,6 +297,43 @@ void MAVLinkParameters::do_work()
                 &_timeout_cookie);
 
         } break;
+
+        case WorkItem::Type::GetAll: {
+            if (work->extended) {
+                mavlink_msg_param_ext_request_list_pack(
+                    _parent.get_own_system_id(),
+                    _parent.get_own_component_id(),
+                    &work->mavlink_message,
+                    _parent.get_system_id(),
+                    work->target_component_id);
+            } else {
+                mavlink_msg_param_request_list_pack(
+                    _parent.get_own_system_id(),
+                    _parent.get_own_component_id(),
+                    &work->mavlink_message,
+                    _parent.get_system_id(),
+                    work->target_component_id);
+            }
+
+            if (!_parent.send_message(work->mavlink_message)) {
+                LogErr() << "Error: Send message failed";
+                if (work->get_all_params_callback) {
+                    work->get_all_params_callback(
+                        MAVLinkParameters::Result::ConnectionError, work->all_params);
+                }
+                work_queue_guard.pop_front();
+                return;
+            }
+
+            work->already_requested = true;
+
+            // The timeout is refreshed with every param that arrives.
+            _parent.register_timeout_handler(
+                std::bind(&MAVLinkParameters::receive_timeout, this),
+                work->timeout_s,
+                &_timeout_cookie);
+
+        } break;
     }
 }
 
@@ -302,6 +357,19 @@ void MAVLinkParameters::process_param_value(const mavlink_message_t& message)
         return;
     }
 
+    if (work->type == WorkItem::Type::GetAll) {
+        if (!work->extended && message.compid == work->target_component_id) {
+            ParamValue value;
+            value.set_from_mavlink_param_value(param_value);
+            receive_param_of_all(
+                work_queue_guard,
+                extract_safe_param_id(param_value.param_id),
+                value,
+                param_value.param_count);
+        }
+        return;
+    }
+
     if (work->param_name.compare(extract_safe_param_id(param_value.param_id)) != 0) {
         // No match, let's just return the borrowed work item.
         return;
@@ -338,6 +406,33 @@ void MAVLinkParameters::process_param_value(const mavlink_message_t& message)
             // _parent.get_time().elapsed_since_s(_last_request_time);
             work_queue_guard.pop_front();
         } break;
+        case WorkItem::Type::GetAll:
+            // Handled above.
+            break;
+    }
+}
+
+void MAVLinkParameters::receive_param_of_all(
+    LockedQueue<WorkItem>::Guard& work_queue_guard,
+    const std::string& name,
+    const ParamValue& value,
+    uint16_t param_count)
+{
+    auto work = work_queue_guard.get_front();
+
+    work->all_params[name] = value;
+    work->param_count = param_count;
+
+    if (work->all_params.size() < param_count) {
+        // More are on the way, the timeout is for the gaps between them.
+        _parent.refresh_timeout_handler(_timeout_cookie);
+        return;
+    }
+
+    _parent.unregister_timeout_handler(_timeout_cookie);
+    work_queue_guard.pop_front();
+    if (work->get_all_params_callback) {
+        work->get_all_params_callback(MAVLinkParameters::Result::Success, work->all_params);
     }
 }
 
@@ -379,6 +474,19 @@ void MAVLinkParameters::process_param_ext_value(const mavlink_message_t& message
         return;
     }
 
+    if (work->type == WorkItem::Type::GetAll) {
+        if (work->extended && message.compid == work->target_component_id) {
+            ParamValue value;
+            value.set_from_mavlink_param_ext_value(param_ext_value);
+            receive_param_of_all(
+                work_queue_guard,
+                extract_safe_param_id(param_ext_value.param_id),
+                value,
+                param_ext_value.param_count);
+        }
+        return;
+    }
+
     if (work->param_name.compare(extract_safe_param_id(param_ext_value.param_id)) != 0) {
         return;
     }
@@ -423,6 +531,10 @@ void MAVLinkParameters::process_param_ext_value(const mavlink_message_t& message
         case WorkItem::Type::Set:
             LogWarn() << "Unexpected ParamExtValue response";
             break;
+
+        case WorkItem::Type::GetAll:
+            // Handled above.
+            break;
     }
 }
 
@@ -450,7 +562,8 @@ void MAVLinkParameters::process_param_ext_ack(const mavlink_message_t& message)
     }
 
     switch (work->type) {
-        case WorkItem::Type::Get: {
+        case WorkItem::Type::Get:
+        case WorkItem::Type::GetAll: {
             LogWarn() << "Unexpected ParamExtAck response.";
         } break;
 
@@ -553,6 +666,37 @@ void MAVLinkParameters::receive_timeout()
                 work->set_param_callback(MAVLinkParameters::Result::Timeout);
             }
         } break;
+        case WorkItem::Type::GetAll: {
+            if (work->all_params.empty() && work->retries_to_do > 0) {
+                // Nothing arrived, the request might have been lost.
+                LogWarn() << "sending again, retries to do: " << work->retries_to_do
+                          << "  (all params).";
+                if (!_parent.send_message(work->mavlink_message)) {
+                    LogErr() << "connection send error in retransmit (all params).";
+                    work_queue_guard.pop_front();
+                    if (work->get_all_params_callback) {
+                        work->get_all_params_callback(
+                            MAVLinkParameters::Result::ConnectionError, work->all_params);
+                    }
+                } else {
+                    --work->retries_to_do;
+                    _parent.register_timeout_handler(
+                        std::bind(&MAVLinkParameters::receive_timeout, this),
+                        work->timeout_s,
+                        &_timeout_cookie);
+                }
+            } else {
+                // Those which went missing on the way are up to the caller to get one by one.
+                LogWarn() << "Timeout getting all params, got " << work->all_params.size()
+                          << " of " << work->param_count << ".";
+
+                work_queue_guard.pop_front();
+                if (work->get_all_params_callback) {
+                    work->get_all_params_callback(
+                        MAVLinkParameters::Result::Timeout, work->all_params);
+                }
+            }
+        } break;
     }
 }
 
@@ -9,6 +9,7 @@
 #include <string>
 #include <functional>
 #include <cassert>
+#include <map>
 #include <vector>
 
 namespace mavsdk {
@@ -601,6 +602,16 @@ public:
         const void* cookie,
         bool extended = false);
 
+    // Requests all params of a component at once, they are streamed back by it. If not all
+    // of them arrive, the callback gets a timeout together with those that did.
+    typedef std::function<void(Result, std::map<std::string, ParamValue> params)>
+        get_all_params_callback_t;
+    void get_all_params_async(
+        get_all_params_callback_t callback,
+        const void* cookie,
+        uint8_t component_id,
+        bool extended = false);
+
     using ParamChangedCallback = std::function<void(ParamValue value)>;
     void subscribe_param_changed(
         const std::string& name,
@@ -634,10 +645,16 @@ private:
     static constexpr size_t PARAM_ID_LEN = 16;
 
     struct WorkItem {
-        enum class Type { Get, Set } type{Type::Get};
+        enum class Type { Get, Set, GetAll } type{Type::Get};
         // TODO: a union would be nicer for the callback
         get_param_callback_t get_param_callback{nullptr};
         set_param_callback_t set_param_callback{nullptr};
+        get_all_params_callback_t get_all_params_callback{nullptr};
+        // Received so far for GetAll, and how many the other side has.
+        std::map<std::string, ParamValue> all_params{};
+        uint16_t param_count{0};
+        // Component asked for GetAll, params other components send meanwhile don't count.
+        uint8_t target_component_id{0};
         std::string param_name{};
         ParamValue param_value{};
         bool extended{false};
@@ -650,6 +667,12 @@ private:
     };
     LockedQueue<WorkItem> _work_queue{};
 
+    void receive_param_of_all(
+        LockedQueue<WorkItem>::Guard& work_queue_guard,
+        const std::string& name,
+        const ParamValue& value,
+        uint16_t param_count);
+
     void* _timeout_cookie = nullptr;
 
     struct ParamChangedSubscription {
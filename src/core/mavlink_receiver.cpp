@@ -7,10 +7,9 @@
 
 namespace mavsdk {
 
-MAVLinkReceiver::MAVLinkReceiver(uint8_t channel) :
-    _channel(channel)
+MAVLinkReceiver::MAVLinkReceiver()
 #if DROP_DEBUG == 1
-    ,
+    :
     _last_time()
 #endif
 {}
@@ -29,7 +28,7 @@ bool MAVLinkReceiver::parse_message()
 {
     // Note that one datagram can contain multiple mavlink messages.
     for (unsigned i = 0; i < _datagram_len; ++i) {
-        if (mavlink_parse_char(_channel, _datagram[i], &_last_message, &_status) == 1) {
+        if (parse_char(static_cast<uint8_t>(_datagram[i]))) {
             // Move the pointer to the datagram forward by the amount parsed.
             _datagram += (i + 1);
             // And decrease the length, so we don't overshoot in the next round.
@@ -50,6 +49,31 @@ bool MAVLinkReceiver::parse_message()
     return false;
 }
 
+// Same as mavlink_parse_char() but with our own state instead of the one of a channel.
+bool MAVLinkReceiver::parse_char(uint8_t c)
+{
+    const uint8_t result =
+        mavlink_frame_char_buffer(&_rx_buffer, &_rx_status, c, &_last_message, &_status);
+
+    if (result == MAVLINK_FRAMING_OK) {
+        return true;
+    }
+
+    if (result == MAVLINK_FRAMING_BAD_CRC || result == MAVLINK_FRAMING_BAD_SIGNATURE) {
+        // Counted as parse error, it shows up as drop count with the next byte.
+        _mav_parse_error(&_rx_status);
+        // Start over, the byte might already be the start of the next message.
+        _rx_status.msg_received = MAVLINK_FRAMING_INCOMPLETE;
+        _rx_status.parse_state = MAVLINK_PARSE_STATE_IDLE;
+        if (c == MAVLINK_STX) {
+            _rx_status.parse_state = MAVLINK_PARSE_STATE_GOT_STX;
+            _rx_buffer.len = 0;
+            mavlink_start_checksum(&_rx_buffer);
+        }
+    }
+    return false;
+}
+
 #if DROP_DEBUG == 1
 void MAVLinkReceiver::debug_drop_rate()
 {
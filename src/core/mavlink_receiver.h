@@ -6,11 +6,12 @@
 
 namespace mavsdk {
 
+// Parses the bytes of one stream. The parser state is kept here rather than
+// in one of the global MAVLink channels, so there can be as many receivers
+// as there are connections.
 class MAVLinkReceiver {
 public:
-    explicit MAVLinkReceiver(uint8_t channel);
-
-    uint8_t get_channel() { return _channel; }
+    MAVLinkReceiver();
 
     mavlink_message_t& get_last_message() { return _last_message; }
 
@@ -31,7 +32,12 @@ public:
 #endif
 
 private:
-    uint8_t _channel;
+    bool parse_char(uint8_t c);
+
+    // What mavlink_parse_char() would keep for a channel.
+    mavlink_message_t _rx_buffer = {};
+    mavlink_status_t _rx_status = {};
+
     mavlink_message_t _last_message = {};
     mavlink_status_t _status = {};
     char* _datagram = nullptr;
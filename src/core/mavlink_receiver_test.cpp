@@ -0,0 +1,127 @@
+#include "mavlink_receiver.h"
+#include "udp_connection.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+mavlink_message_t make_heartbeat(uint8_t sysid)
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(
+        sysid, MAV_COMP_ID_AUTOPILOT1, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, 0);
+    return message;
+}
+
+std::vector<char> make_heartbeat_bytes(uint8_t sysid)
+{
+    const auto message = make_heartbeat(sysid);
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t length = mavlink_msg_to_send_buffer(buffer, &message);
+    return std::vector<char>(buffer, buffer + length);
+}
+
+} // namespace
+
+TEST(MAVLinkReceiver, KeepsStreamsApart)
+{
+    // Two streams arriving in pieces, one piece of each in turn.
+    MAVLinkReceiver receiver_a;
+    MAVLinkReceiver receiver_b;
+    auto bytes_a = make_heartbeat_bytes(1);
+    auto bytes_b = make_heartbeat_bytes(2);
+    const unsigned length = static_cast<unsigned>(bytes_a.size());
+    const unsigned half = length / 2;
+
+    receiver_a.set_new_datagram(bytes_a.data(), half);
+    EXPECT_FALSE(receiver_a.parse_message());
+    receiver_b.set_new_datagram(bytes_b.data(), half);
+    EXPECT_FALSE(receiver_b.parse_message());
+
+    receiver_a.set_new_datagram(bytes_a.data() + half, length - half);
+    ASSERT_TRUE(receiver_a.parse_message());
+    EXPECT_EQ(receiver_a.get_last_message().sysid, 1);
+
+    receiver_b.set_new_datagram(bytes_b.data() + half, length - half);
+    ASSERT_TRUE(receiver_b.parse_message());
+    EXPECT_EQ(receiver_b.get_last_message().sysid, 2);
+}
+
+TEST(MAVLinkReceiver, ParsesSeveralMessagesInOneDatagram)
+{
+    MAVLinkReceiver receiver;
+    std::vector<char> bytes;
+    for (uint8_t sysid = 1; sysid <= 3; ++sysid) {
+        const auto message_bytes = make_heartbeat_bytes(sysid);
+        bytes.insert(bytes.end(), message_bytes.begin(), message_bytes.end());
+    }
+
+    receiver.set_new_datagram(bytes.data(), static_cast<unsigned>(bytes.size()));
+    for (uint8_t sysid = 1; sysid <= 3; ++sysid) {
+        ASSERT_TRUE(receiver.parse_message());
+        EXPECT_EQ(receiver.get_last_message().sysid, sysid);
+    }
+    EXPECT_FALSE(receiver.parse_message());
+}
+
+TEST(MAVLinkReceiver, CountsBadCrcAsParseError)
+{
+    MAVLinkReceiver receiver;
+    auto bytes = make_heartbeat_bytes(1);
+    bytes.back() = static_cast<char>(bytes.back() ^ 0xFF);
+    // Like mavlink_parse_char(), the error is reported with the next byte.
+    const unsigned bad_length = static_cast<unsigned>(bytes.size()) + 1;
+    const auto good_bytes = make_heartbeat_bytes(2);
+    bytes.insert(bytes.end(), good_bytes.begin(), good_bytes.end());
+
+    receiver.set_new_datagram(bytes.data(), bad_length);
+    EXPECT_FALSE(receiver.parse_message());
+    EXPECT_EQ(receiver.get_status().packet_rx_drop_count, 1);
+
+    // And the message after it is still parsed.
+    receiver.set_new_datagram(
+        bytes.data() + bad_length, static_cast<unsigned>(bytes.size()) - bad_length);
+    ASSERT_TRUE(receiver.parse_message());
+    EXPECT_EQ(receiver.get_last_message().sysid, 2);
+}
+
+TEST(MAVLinkReceiver, HundredsOfConnections)
+{
+    // Like a bridge with a UDP port per vehicle.
+    constexpr unsigned num_connections = 256;
+    constexpr int first_port = 24550;
+
+    std::atomic<unsigned> num_received{0};
+    std::vector<std::unique_ptr<UdpConnection>> connections;
+    for (unsigned i = 0; i < num_connections; ++i) {
+        connections.emplace_back(new UdpConnection(
+            [&num_received](mavlink_message_t&, Connection*) { ++num_received; },
+            "127.0.0.1",
+            first_port + static_cast<int>(i)));
+        ASSERT_EQ(connections.back()->start(), ConnectionResult::Success);
+    }
+
+    UdpConnection sender([](mavlink_message_t&, Connection*) {}, "127.0.0.1", first_port - 1);
+    ASSERT_EQ(sender.start(), ConnectionResult::Success);
+    for (unsigned i = 0; i < num_connections; ++i) {
+        sender.add_remote("127.0.0.1", first_port + static_cast<int>(i));
+    }
+
+    EXPECT_TRUE(sender.send_message(make_heartbeat(1)));
+
+    for (unsigned i = 0; i < 1000 && num_received < num_connections; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(num_received, num_connections);
+
+    sender.stop();
+    for (auto& connection : connections) {
+        connection->stop();
+    }
+}
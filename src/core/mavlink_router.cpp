@@ -0,0 +1,157 @@
+#include "mavlink_router.h"
+#include "connection.h"
+
+#include <algorithm>
+
+namespace mavsdk {
+
+void MAVLinkRouter::learn(const mavlink_message_t& message, Connection* connection)
+{
+    if (message.sysid == 0) {
+        return;
+    }
+
+    auto& routes = _routes[message.sysid];
+    for (auto& route : routes) {
+        if (route.component_id == message.compid) {
+            // It might have moved to another link.
+            route.connection = connection;
+            return;
+        }
+    }
+
+    Route route{};
+    route.component_id = message.compid;
+    route.connection = connection;
+    routes.push_back(route);
+}
+
+void MAVLinkRouter::forget(const Connection* connection)
+{
+    for (auto& routes : _routes) {
+        routes.erase(
+            std::remove_if(
+                routes.begin(),
+                routes.end(),
+                [connection](const Route& route) { return route.connection == connection; }),
+            routes.end());
+    }
+}
+
+void MAVLinkRouter::get_forward_destinations(
+    const mavlink_message_t& message,
+    const Connection* source,
+    const std::vector<std::shared_ptr<Connection>>& connections,
+    std::vector<std::shared_ptr<Connection>>& destinations) const
+{
+    destinations.clear();
+
+    uint8_t target_system;
+    uint8_t target_component;
+    get_target(message, target_system, target_component);
+
+    if (target_system == 0) {
+        for (const auto& connection : connections) {
+            if (connection.get() != source) {
+                destinations.push_back(connection);
+            }
+        }
+        return;
+    }
+
+    // Targets which were never heard from are not forwarded anywhere.
+    get_routes(target_system, target_component, source, connections, destinations);
+}
+
+void MAVLinkRouter::get_send_destinations(
+    const mavlink_message_t& message,
+    const std::vector<std::shared_ptr<Connection>>& connections,
+    std::vector<std::shared_ptr<Connection>>& destinations) const
+{
+    destinations.clear();
+
+    uint8_t target_system;
+    uint8_t target_component;
+    get_target(message, target_system, target_component);
+
+    if (target_system != 0) {
+        get_routes(target_system, target_component, nullptr, connections, destinations);
+    }
+
+    // We might be the first to talk, e.g. to a system configured but not
+    // heard yet, so try everywhere then.
+    if (destinations.empty()) {
+        destinations = connections;
+    }
+}
+
+const Connection* MAVLinkRouter::get_connection(uint8_t system_id) const
+{
+    const auto& routes = _routes[system_id];
+    if (routes.empty()) {
+        return nullptr;
+    }
+    for (const auto& route : routes) {
+        if (route.component_id == MAV_COMP_ID_AUTOPILOT1) {
+            return route.connection;
+        }
+    }
+    return routes.front().connection;
+}
+
+void MAVLinkRouter::get_routes(
+    uint8_t target_system,
+    uint8_t target_component,
+    const Connection* source,
+    const std::vector<std::shared_ptr<Connection>>& connections,
+    std::vector<std::shared_ptr<Connection>>& destinations) const
+{
+    const auto& routes = _routes[target_system];
+
+    // A component which hasn't sent anything yet, e.g. a camera behind
+    // the autopilot, is most likely reachable wherever its system is.
+    const bool is_component_known =
+        target_component == 0 ||
+        std::any_of(routes.begin(), routes.end(), [target_component](const Route& route) {
+            return route.component_id == target_component;
+        });
+
+    for (const auto& connection : connections) {
+        if (connection.get() == source) {
+            continue;
+        }
+        for (const auto& route : routes) {
+            if (route.connection == connection.get() &&
+                (!is_component_known || target_component == 0 ||
+                 route.component_id == target_component)) {
+                destinations.push_back(connection);
+                break;
+            }
+        }
+    }
+}
+
+void MAVLinkRouter::get_target(
+    const mavlink_message_t& message, uint8_t& target_system, uint8_t& target_component)
+{
+    target_system = 0;
+    target_component = 0;
+
+    const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(message.msgid);
+    if (entry == nullptr) {
+        return;
+    }
+
+    // MAVLink 2 truncates trailing zeros, so anything beyond the length is 0.
+    const uint8_t* payload = reinterpret_cast<const uint8_t*>(message.payload64);
+    if ((entry->flags & MAV_MSG_ENTRY_FLAG_HAVE_TARGET_SYSTEM) &&
+        entry->target_system_ofs < message.len) {
+        target_system = payload[entry->target_system_ofs];
+    }
+    if ((entry->flags & MAV_MSG_ENTRY_FLAG_HAVE_TARGET_COMPONENT) &&
+        entry->target_component_ofs < message.len) {
+        target_component = payload[entry->target_component_ofs];
+    }
+}
+
+} // namespace mavsdk
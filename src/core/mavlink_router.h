@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "mavlink_include.h"
+
+namespace mavsdk {
+
+class Connection;
+
+// Keeps track of which connection each system and component was heard on,
+// to decide where messages need to go as described in
+// https://mavlink.io/en/guide/routing.html
+//
+// Not thread-safe, the caller needs to serialize access.
+class MAVLinkRouter {
+public:
+    MAVLinkRouter() = default;
+    ~MAVLinkRouter() = default;
+
+    // Remembers that the sender of the message is reachable over the connection.
+    void learn(const mavlink_message_t& message, Connection* connection);
+
+    // Forgets everything reachable over the connection.
+    void forget(const Connection* connection);
+
+    // Connections a message received on source needs to be forwarded to: all
+    // others for broadcasts, only the ones the target was heard on otherwise.
+    void get_forward_destinations(
+        const mavlink_message_t& message,
+        const Connection* source,
+        const std::vector<std::shared_ptr<Connection>>& connections,
+        std::vector<std::shared_ptr<Connection>>& destinations) const;
+
+    // Connections a message of our own needs to be sent on: only the ones the
+    // target was heard on, all of them for broadcasts and unknown targets.
+    void get_send_destinations(
+        const mavlink_message_t& message,
+        const std::vector<std::shared_ptr<Connection>>& connections,
+        std::vector<std::shared_ptr<Connection>>& destinations) const;
+
+    // Connection the system was heard on, the one of its autopilot if it has
+    // several, nullptr if it was never heard.
+    const Connection* get_connection(uint8_t system_id) const;
+
+    // Target of the message, 0 for broadcast or messages without a target.
+    static void
+    get_target(const mavlink_message_t& message, uint8_t& target_system, uint8_t& target_component);
+
+    // Delete copy and move constructors and assign operators.
+    MAVLinkRouter(MAVLinkRouter const&) = delete;
+    MAVLinkRouter(MAVLinkRouter&&) = delete;
+    MAVLinkRouter& operator=(MAVLinkRouter const&) = delete;
+    MAVLinkRouter& operator=(MAVLinkRouter&&) = delete;
+
+private:
+    // Connections the target was heard on except source, in the order of
+    // connections.
+    void get_routes(
+        uint8_t target_system,
+        uint8_t target_component,
+        const Connection* source,
+        const std::vector<std::shared_ptr<Connection>>& connections,
+        std::vector<std::shared_ptr<Connection>>& destinations) const;
+
+    struct Route {
+        uint8_t component_id;
+        Connection* connection;
+    };
+
+    // By system id, there are usually only a few components per system.
+    std::vector<Route> _routes[256]{};
+};
+
+} // namespace mavsdk
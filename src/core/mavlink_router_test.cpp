@@ -0,0 +1,164 @@
+#include "mavlink_router.h"
+#include "connection.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+
+class FakeConnection : public Connection {
+public:
+    FakeConnection() : Connection([](mavlink_message_t&, Connection*) {}) {}
+    ConnectionResult start() override { return ConnectionResult::Success; }
+    ConnectionResult stop() override { return ConnectionResult::Success; }
+    bool send_message(const mavlink_message_t&) override { return true; }
+};
+
+mavlink_message_t heartbeat(uint8_t sysid, uint8_t compid)
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(
+        sysid,
+        compid,
+        &message,
+        MAV_TYPE_QUADROTOR,
+        MAV_AUTOPILOT_PX4,
+        MAV_MODE_FLAG_CUSTOM_MODE_ENABLED,
+        0,
+        MAV_STATE_ACTIVE);
+    return message;
+}
+
+mavlink_message_t command(uint8_t target_system, uint8_t target_component)
+{
+    mavlink_command_long_t command_long{};
+    command_long.target_system = target_system;
+    command_long.target_component = target_component;
+    command_long.command = MAV_CMD_COMPONENT_ARM_DISARM;
+
+    mavlink_message_t message;
+    mavlink_msg_command_long_encode(245, MAV_COMP_ID_MISSIONPLANNER, &message, &command_long);
+    return message;
+}
+
+} // namespace
+
+class MAVLinkRouterTest : public ::testing::Test {
+protected:
+    std::vector<Connection*> destinations(const mavlink_message_t& message, Connection* source)
+    {
+        std::vector<std::shared_ptr<Connection>> result;
+        router.get_forward_destinations(message, source, connections, result);
+        return to_pointers(result);
+    }
+
+    std::vector<Connection*> send_destinations(const mavlink_message_t& message)
+    {
+        std::vector<std::shared_ptr<Connection>> result;
+        router.get_send_destinations(message, connections, result);
+        return to_pointers(result);
+    }
+
+    static std::vector<Connection*>
+    to_pointers(const std::vector<std::shared_ptr<Connection>>& connections)
+    {
+        std::vector<Connection*> result;
+        for (const auto& connection : connections) {
+            result.push_back(connection.get());
+        }
+        return result;
+    }
+
+    Connection* connection(std::size_t index) { return connections[index].get(); }
+
+    MAVLinkRouter router{};
+    std::vector<std::shared_ptr<Connection>> connections{std::make_shared<FakeConnection>(),
+                                                         std::make_shared<FakeConnection>(),
+                                                         std::make_shared<FakeConnection>()};
+};
+
+TEST_F(MAVLinkRouterTest, BroadcastsToAllButSource)
+{
+    EXPECT_EQ(
+        destinations(heartbeat(1, 1), connection(0)),
+        (std::vector<Connection*>{connection(1), connection(2)}));
+    EXPECT_EQ(
+        destinations(command(0, 0), connection(2)),
+        (std::vector<Connection*>{connection(0), connection(1)}));
+}
+
+TEST_F(MAVLinkRouterTest, SendsTargetedOnlyWhereHeard)
+{
+    router.learn(heartbeat(1, MAV_COMP_ID_AUTOPILOT1), connection(0));
+    router.learn(heartbeat(2, MAV_COMP_ID_AUTOPILOT1), connection(1));
+    router.learn(heartbeat(2, MAV_COMP_ID_CAMERA), connection(2));
+
+    EXPECT_EQ(
+        destinations(command(1, 0), connection(2)), (std::vector<Connection*>{connection(0)}));
+    EXPECT_EQ(
+        destinations(command(1, MAV_COMP_ID_AUTOPILOT1), connection(2)),
+        (std::vector<Connection*>{connection(0)}));
+
+    // All links of a system, or the one of the component.
+    EXPECT_EQ(
+        destinations(command(2, 0), nullptr),
+        (std::vector<Connection*>{connection(1), connection(2)}));
+    EXPECT_EQ(
+        destinations(command(2, MAV_COMP_ID_CAMERA), nullptr),
+        (std::vector<Connection*>{connection(2)}));
+
+    // A component not heard yet is tried where its system is.
+    EXPECT_EQ(
+        destinations(command(1, MAV_COMP_ID_CAMERA), connection(2)),
+        (std::vector<Connection*>{connection(0)}));
+
+    // Unknown systems are not reachable.
+    EXPECT_TRUE(destinations(command(3, 0), connection(2)).empty());
+
+    // Never back where it came from.
+    EXPECT_TRUE(destinations(command(1, 0), connection(0)).empty());
+}
+
+TEST_F(MAVLinkRouterTest, FollowsSystemsAndForgets)
+{
+    router.learn(heartbeat(1, MAV_COMP_ID_AUTOPILOT1), connection(0));
+    router.learn(heartbeat(1, MAV_COMP_ID_AUTOPILOT1), connection(1));
+    EXPECT_EQ(destinations(command(1, 0), nullptr), (std::vector<Connection*>{connection(1)}));
+
+    router.forget(connection(1));
+    EXPECT_TRUE(destinations(command(1, 0), nullptr).empty());
+}
+
+TEST_F(MAVLinkRouterTest, SendsOwnMessagesOnlyWhereTargetIsKnown)
+{
+    const std::vector<Connection*> all{connection(0), connection(1), connection(2)};
+
+    // Nothing heard yet, so everywhere.
+    EXPECT_EQ(send_destinations(command(1, 0)), all);
+
+    router.learn(heartbeat(1, MAV_COMP_ID_AUTOPILOT1), connection(0));
+    router.learn(heartbeat(2, MAV_COMP_ID_AUTOPILOT1), connection(2));
+
+    EXPECT_EQ(send_destinations(command(1, 0)), (std::vector<Connection*>{connection(0)}));
+    EXPECT_EQ(
+        send_destinations(command(2, MAV_COMP_ID_CAMERA)),
+        (std::vector<Connection*>{connection(2)}));
+
+    // Broadcasts and unknown systems still go everywhere.
+    EXPECT_EQ(send_destinations(command(0, 0)), all);
+    EXPECT_EQ(send_destinations(heartbeat(245, MAV_COMP_ID_MISSIONPLANNER)), all);
+    EXPECT_EQ(send_destinations(command(3, 0)), all);
+}
+
+TEST_F(MAVLinkRouterTest, TellsConnectionOfSystem)
+{
+    EXPECT_EQ(router.get_connection(1), nullptr);
+
+    router.learn(heartbeat(1, MAV_COMP_ID_CAMERA), connection(1));
+    EXPECT_EQ(router.get_connection(1), connection(1));
+
+    // The autopilot is what counts if the components are on different links.
+    router.learn(heartbeat(1, MAV_COMP_ID_AUTOPILOT1), connection(0));
+    EXPECT_EQ(router.get_connection(1), connection(0));
+    EXPECT_EQ(router.get_connection(2), nullptr);
+}
@@ -39,10 +39,25 @@ ConnectionResult Mavsdk::add_tcp_connection(const std::string& remote_ip, const
     return _impl->add_tcp_connection(remote_ip, remote_port);
 }
 
-ConnectionResult
-Mavsdk::add_serial_connection(const std::string& dev_path, const int baudrate, bool flow_control)
+ConnectionResult Mavsdk::add_serial_connection(
+    const std::string& dev_path, const int baudrate, bool flow_control, int flush_latency_ms)
 {
-    return _impl->add_serial_connection(dev_path, baudrate, flow_control);
+    return _impl->add_serial_connection(dev_path, baudrate, flow_control, flush_latency_ms);
+}
+
+bool Mavsdk::start_recording(const std::string& path)
+{
+    return _impl->start_recording(path);
+}
+
+void Mavsdk::stop_recording()
+{
+    _impl->stop_recording();
+}
+
+void Mavsdk::set_message_forwarding(bool enabled)
+{
+    _impl->set_message_forwarding(enabled);
 }
 
 void Mavsdk::set_configuration(Configuration configuration)
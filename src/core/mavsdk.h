@@ -58,11 +58,15 @@ public:
     /**
      * @brief Adds Connection via URL
      *
-     * Supports connection: Serial, TCP or UDP.
+     * Supports connection: Serial, TCP, UDP, replaying a recorded log or a loopback
+     * link to another component in the same process.
      * Connection URL format should be:
      * - UDP - udp://[Bind_host][:Bind_port]
      * - TCP - tcp://[Remote_host][:Remote_port]
-     * - Serial - serial://Dev_Node[:Baudrate]
+     * - TCP server - tcp://:Local_port (accepts any number of clients)
+     * - Serial - serial://Dev_Node[:Baudrate][?flush_latency_ms=Milliseconds]
+     * - Replay of a tlog - replay://Path[?speed=Factor|max]
+     * - Loopback - loopback://Name (connects to the other side using the same name)
      *
      * @param connection_url connection URL string.
      * @return The result of adding the connection.
@@ -127,12 +131,51 @@ public:
      * @param dev_path COM or UART dev node name/path (e.g. "/dev/ttyS0", or "COM3" on Windows).
      * @param baudrate Baudrate of the serial port (defaults to 57600).
      * @param flow_control enable/disable flow control
+     * @param flush_latency_ms How long outgoing messages may wait to be written together with the
+     * ones following, which saves writes on busy links (defaults to 0, written right away).
      * @return The result of adding the connection.
      */
     ConnectionResult add_serial_connection(
         const std::string& dev_path,
         int baudrate = DEFAULT_SERIAL_BAUDRATE,
-        bool flow_control = false);
+        bool flow_control = false,
+        int flush_latency_ms = 0);
+
+    /**
+     * @brief Starts recording all MAVLink messages received and sent to a file.
+     *
+     * The file uses the telemetry log (tlog) format which can be replayed by
+     * QGroundControl or MAVProxy. Recording does not block sending or receiving,
+     * if the file cannot be written fast enough, messages are dropped from the
+     * recording. A recording already in progress is stopped.
+     *
+     * @param path Path of the file to record to, it is overwritten if it exists.
+     * @return `true` if the file could be opened.
+     */
+    bool start_recording(const std::string& path);
+
+    /**
+     * @brief Stops recording and closes the file.
+     *
+     * Messages recorded so far are written before this returns.
+     */
+    void stop_recording();
+
+    /**
+     * @brief Enables forwarding of messages between connections.
+     *
+     * With forwarding on, MAVSDK routes messages like mavlink-router would: a
+     * message received on one connection is passed on to the other connections,
+     * a broadcast to all of them and a message with a target only to the
+     * connections where the target system was heard. Messages are never sent
+     * back on the connection they came in on. Remotes sharing one UDP port
+     * count as one connection.
+     *
+     * Forwarding is off by default.
+     *
+     * @param enabled `true` to forward messages.
+     */
+    void set_message_forwarding(bool enabled);
 
     /**
      * @brief Stores the configured system id and component id of the MAVSDK instance
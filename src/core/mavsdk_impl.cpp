@@ -5,10 +5,13 @@
 #include "connection.h"
 #include "global_include.h"
 #include "tcp_connection.h"
+#include "tcp_server_connection.h"
 #include "udp_connection.h"
 #include "system.h"
 #include "system_impl.h"
 #include "serial_connection.h"
+#include "replay_connection.h"
+#include "loopback_connection.h"
 #include "cli_arg.h"
 #include "version.h"
 
@@ -67,6 +70,8 @@ MavsdkImpl::~MavsdkImpl()
         std::lock_guard<std::mutex> lock(_connections_mutex);
         _connections.clear();
     }
+
+    stop_recording();
 }
 
 std::string MavsdkImpl::version() const
@@ -97,15 +102,44 @@ std::string MavsdkImpl::version() const
     }
 }
 
-void MavsdkImpl::receive_message(mavlink_message_t& message)
+void MavsdkImpl::receive_message(mavlink_message_t& message, Connection* connection)
 {
+    // Remember where each system is so that what we send to it only takes
+    // up the link it's on.
+    std::vector<std::shared_ptr<Connection>> forward_destinations;
+    {
+        std::lock_guard<std::mutex> lock(_connections_mutex);
+        _router.learn(message, connection);
+        if (_is_forwarding_enabled) {
+            _router.get_forward_destinations(
+                message, connection, _connections, forward_destinations);
+        }
+
+        // What is forwarded goes out again, so it's recorded like what we send.
+        if (_recorder && !forward_destinations.empty()) {
+            _recorder->record(TlogRecorder::Direction::Outgoing, [&message](uint8_t* data) {
+                return mavlink_msg_to_send_buffer(data, &message);
+            });
+        }
+    }
+
+    // Like a router we drop what can't be sent, the sender retries if needed.
+    send_on(forward_destinations, message);
+
+    std::lock_guard<std::recursive_mutex> lock(_systems_mutex);
+
+    // Everything received is recorded, also what no system is created for.
+    if (_recorder) {
+        _recorder->record(TlogRecorder::Direction::Incoming, [&message](uint8_t* data) {
+            return mavlink_msg_to_send_buffer(data, &message);
+        });
+    }
+
     // Don't ever create a system with sysid 0.
     if (message.sysid == 0) {
         return;
     }
 
-    std::lock_guard<std::recursive_mutex> lock(_systems_mutex);
-
     // Change system id of null system
     if (_systems.find(0) != _systems.end()) {
         auto null_system = _systems[0];
@@ -140,16 +174,63 @@ void MavsdkImpl::receive_message(mavlink_message_t& message)
 
 bool MavsdkImpl::send_message(mavlink_message_t& message)
 {
-    std::lock_guard<std::mutex> lock(_connections_mutex);
+    std::vector<std::shared_ptr<Connection>> destinations;
+    {
+        std::lock_guard<std::mutex> lock(_connections_mutex);
 
-    for (auto it = _connections.begin(); it != _connections.end(); ++it) {
-        if (!(**it).send_message(message)) {
-            LogErr() << "send fail";
-            return false;
+        if (_recorder) {
+            _recorder->record(TlogRecorder::Direction::Outgoing, [&message](uint8_t* data) {
+                return mavlink_msg_to_send_buffer(data, &message);
+            });
         }
+
+        _router.get_send_destinations(message, _connections, destinations);
     }
 
-    return true;
+    // The sockets are written without the lock held so a slow link doesn't
+    // hold up the others, and one failing link doesn't keep the message
+    // from going out on the rest.
+    if (destinations.empty()) {
+        // Nothing connected yet is not an error.
+        return true;
+    }
+
+    const unsigned num_sent = send_on(destinations, message);
+    if (num_sent < destinations.size()) {
+        LogErr() << "send fail on " << destinations.size() - num_sent << " of "
+                 << destinations.size() << " connections";
+    }
+
+    return num_sent > 0;
+}
+
+unsigned MavsdkImpl::send_on(
+    const std::vector<std::shared_ptr<Connection>>& destinations, const mavlink_message_t& message)
+{
+    if (destinations.empty()) {
+        return 0;
+    }
+
+    if (destinations.size() == 1) {
+        return destinations.front()->send_message(message) ? 1 : 0;
+    }
+
+    // Packed only once for all connections instead of by each of them.
+    const std::shared_ptr<const SerializedMessage> serialized =
+        std::make_shared<SerializedMessage>(message);
+
+    unsigned num_sent = 0;
+    for (const auto& destination : destinations) {
+        if (destination->send_serialized(serialized)) {
+            ++num_sent;
+        }
+    }
+    return num_sent;
+}
+
+void MavsdkImpl::set_message_forwarding(bool enabled)
+{
+    _is_forwarding_enabled = enabled;
 }
 
 ConnectionResult MavsdkImpl::add_any_connection(const std::string& connection_url)
@@ -184,15 +265,25 @@ ConnectionResult MavsdkImpl::add_any_connection(const std::string& connection_ur
             return add_tcp_connection(path, port);
         }
 
+        case CliArg::Protocol::TcpServer:
+            return add_tcp_server_connection(cli_arg.get_path(), cli_arg.get_port());
+
         case CliArg::Protocol::Serial: {
             int baudrate = Mavsdk::DEFAULT_SERIAL_BAUDRATE;
             if (cli_arg.get_baudrate()) {
                 baudrate = cli_arg.get_baudrate();
             }
             bool flow_control = cli_arg.get_flow_control();
-            return add_serial_connection(cli_arg.get_path(), baudrate, flow_control);
+            return add_serial_connection(
+                cli_arg.get_path(), baudrate, flow_control, cli_arg.get_flush_latency_ms());
         }
 
+        case CliArg::Protocol::Replay:
+            return add_replay_connection(cli_arg.get_path(), cli_arg.get_replay_speed());
+
+        case CliArg::Protocol::Loopback:
+            return add_loopback_connection(cli_arg.get_path());
+
         default:
             return ConnectionResult::ConnectionError;
     }
@@ -201,7 +292,10 @@ ConnectionResult MavsdkImpl::add_any_connection(const std::string& connection_ur
 ConnectionResult MavsdkImpl::add_udp_connection(const std::string& local_ip, const int local_port)
 {
     auto new_conn = std::make_shared<UdpConnection>(
-        std::bind(&MavsdkImpl::receive_message, this, std::placeholders::_1), local_ip, local_port);
+        std::bind(
+            &MavsdkImpl::receive_message, this, std::placeholders::_1, std::placeholders::_2),
+        local_ip,
+        local_port);
     if (!new_conn) {
         return ConnectionResult::ConnectionError;
     }
@@ -215,7 +309,10 @@ ConnectionResult MavsdkImpl::add_udp_connection(const std::string& local_ip, con
 ConnectionResult MavsdkImpl::setup_udp_remote(const std::string& remote_ip, int remote_port)
 {
     auto new_conn = std::make_shared<UdpConnection>(
-        std::bind(&MavsdkImpl::receive_message, this, std::placeholders::_1), "0.0.0.0", 0);
+        std::bind(
+            &MavsdkImpl::receive_message, this, std::placeholders::_1, std::placeholders::_2),
+        "0.0.0.0",
+        0);
     if (!new_conn) {
         return ConnectionResult::ConnectionError;
     }
@@ -232,7 +329,8 @@ ConnectionResult MavsdkImpl::setup_udp_remote(const std::string& remote_ip, int
 ConnectionResult MavsdkImpl::add_tcp_connection(const std::string& remote_ip, int remote_port)
 {
     auto new_conn = std::make_shared<TcpConnection>(
-        std::bind(&MavsdkImpl::receive_message, this, std::placeholders::_1),
+        std::bind(
+            &MavsdkImpl::receive_message, this, std::placeholders::_1, std::placeholders::_2),
         remote_ip,
         remote_port);
     if (!new_conn) {
@@ -245,17 +343,106 @@ ConnectionResult MavsdkImpl::add_tcp_connection(const std::string& remote_ip, in
     return ret;
 }
 
-ConnectionResult
-MavsdkImpl::add_serial_connection(const std::string& dev_path, int baudrate, bool flow_control)
+ConnectionResult MavsdkImpl::add_tcp_server_connection(const std::string& local_ip, int local_port)
+{
+    auto new_conn = std::make_shared<TcpServerConnection>(
+        std::bind(
+            &MavsdkImpl::receive_message, this, std::placeholders::_1, std::placeholders::_2),
+        local_ip,
+        local_port);
+    if (!new_conn) {
+        return ConnectionResult::ConnectionError;
+    }
+    ConnectionResult ret = new_conn->start();
+    if (ret == ConnectionResult::Success) {
+        add_connection(new_conn);
+    }
+    return ret;
+}
+
+ConnectionResult MavsdkImpl::add_serial_connection(
+    const std::string& dev_path, int baudrate, bool flow_control, int flush_latency_ms)
 {
     auto new_conn = std::make_shared<SerialConnection>(
-        std::bind(&MavsdkImpl::receive_message, this, std::placeholders::_1),
+        std::bind(
+            &MavsdkImpl::receive_message, this, std::placeholders::_1, std::placeholders::_2),
         dev_path,
         baudrate,
         flow_control);
     if (!new_conn) {
         return ConnectionResult::ConnectionError;
     }
+    new_conn->set_flush_latency(std::chrono::milliseconds(flush_latency_ms));
+    ConnectionResult ret = new_conn->start();
+    if (ret == ConnectionResult::Success) {
+        add_connection(new_conn);
+    }
+    return ret;
+}
+
+bool MavsdkImpl::start_recording(const std::string& path)
+{
+    auto recorder = std::make_shared<TlogRecorder>();
+    if (!recorder->start(path)) {
+        return false;
+    }
+
+    std::shared_ptr<TlogRecorder> previous_recorder;
+    {
+        std::lock_guard<std::recursive_mutex> systems_lock(_systems_mutex);
+        std::lock_guard<std::mutex> connections_lock(_connections_mutex);
+        previous_recorder = _recorder;
+        _recorder = recorder;
+    }
+
+    if (previous_recorder) {
+        previous_recorder->stop();
+    }
+    return true;
+}
+
+void MavsdkImpl::stop_recording()
+{
+    std::shared_ptr<TlogRecorder> recorder;
+    {
+        std::lock_guard<std::recursive_mutex> systems_lock(_systems_mutex);
+        std::lock_guard<std::mutex> connections_lock(_connections_mutex);
+        recorder = _recorder;
+        _recorder.reset();
+    }
+
+    // Writing the rest of the recording must not hold up sending or receiving.
+    if (recorder) {
+        recorder->stop();
+    }
+}
+
+ConnectionResult MavsdkImpl::add_replay_connection(const std::string& path, double speed)
+{
+    auto new_conn = std::make_shared<ReplayConnection>(
+        std::bind(
+            &MavsdkImpl::receive_message, this, std::placeholders::_1, std::placeholders::_2),
+        path,
+        speed);
+    if (!new_conn) {
+        return ConnectionResult::ConnectionError;
+    }
+    ConnectionResult ret = new_conn->start();
+    if (ret == ConnectionResult::Success) {
+        add_connection(new_conn);
+    }
+    return ret;
+}
+
+ConnectionResult MavsdkImpl::add_loopback_connection(const std::string& name)
+{
+    auto new_conn = std::make_shared<LoopbackConnection>(
+        std::bind(
+            &MavsdkImpl::receive_message, this, std::placeholders::_1, std::placeholders::_2),
+        name);
+    if (!new_conn) {
+        return ConnectionResult::ConnectionError;
+    }
     ConnectionResult ret = new_conn->start();
     if (ret == ConnectionResult::Success) {
         add_connection(new_conn);
@@ -348,6 +535,12 @@ uint8_t MavsdkImpl::get_own_component_id() const
     return own_address.component_id;
 }
 
+const Connection* MavsdkImpl::get_link(uint8_t system_id)
+{
+    std::lock_guard<std::mutex> lock(_connections_mutex);
+    return _router.get_connection(system_id);
+}
+
 uint8_t MavsdkImpl::get_mav_type() const
 {
     switch (_configuration.get_usage_type()) {
@@ -9,9 +9,11 @@
 #include "mavsdk.h"
 #include "mavlink_include.h"
 #include "mavlink_address.h"
+#include "mavlink_router.h"
 #include "safe_queue.h"
 #include "system.h"
 #include "timeout_handler.h"
+#include "tlog_recorder.h"
 
 namespace mavsdk {
 
@@ -37,7 +39,7 @@ public:
 
     std::string version() const;
 
-    void receive_message(mavlink_message_t& message);
+    void receive_message(mavlink_message_t& message, Connection* connection);
     bool send_message(mavlink_message_t& message);
 
     ConnectionResult add_any_connection(const std::string& connection_url);
@@ -45,9 +47,17 @@ public:
     add_link_connection(const std::string& protocol, const std::string& ip, int port);
     ConnectionResult add_udp_connection(const std::string& local_ip, int local_port_number);
     ConnectionResult add_tcp_connection(const std::string& remote_ip, int remote_port);
-    ConnectionResult
-    add_serial_connection(const std::string& dev_path, int baudrate, bool flow_control);
+    ConnectionResult add_tcp_server_connection(const std::string& local_ip, int local_port);
+    ConnectionResult add_serial_connection(
+        const std::string& dev_path, int baudrate, bool flow_control, int flush_latency_ms);
     ConnectionResult setup_udp_remote(const std::string& remote_ip, int remote_port);
+    ConnectionResult add_replay_connection(const std::string& path, double speed);
+    ConnectionResult add_loopback_connection(const std::string& name);
+
+    bool start_recording(const std::string& path);
+    void stop_recording();
+
+    void set_message_forwarding(bool enabled);
 
     void set_configuration(Mavsdk::Configuration configuration);
 
@@ -59,6 +69,10 @@ public:
     uint8_t get_own_component_id() const;
     uint8_t get_mav_type() const;
 
+    // Connection the system was heard on, nullptr if none. Only to tell which
+    // systems share a link, it might be gone by the time it is used.
+    const Connection* get_link(uint8_t system_id);
+
     bool is_connected() const;
     bool is_connected(uint64_t uuid) const;
 
@@ -77,6 +91,10 @@ public:
 
 private:
     void add_connection(std::shared_ptr<Connection>);
+    // Returns on how many of the connections the message went out.
+    unsigned send_on(
+        const std::vector<std::shared_ptr<Connection>>& destinations,
+        const mavlink_message_t& message);
     void make_system_with_component(uint8_t system_id, uint8_t component_id);
     bool does_system_exist(uint8_t system_id);
 
@@ -88,9 +106,19 @@ private:
     std::mutex _connections_mutex;
     std::vector<std::shared_ptr<Connection>> _connections;
 
+    // Where systems were heard, guarded by _connections_mutex. The mutex is
+    // never held while sending, the connections do their own locking.
+    MAVLinkRouter _router{};
+    std::atomic<bool> _is_forwarding_enabled{false};
+
     mutable std::recursive_mutex _systems_mutex;
     std::unordered_map<uint8_t, std::shared_ptr<System>> _systems;
 
+    // Incoming messages are recorded with _systems_mutex locked and outgoing
+    // ones with _connections_mutex locked, so each direction only ever has
+    // one thread recording. Replacing it requires both locks.
+    std::shared_ptr<TlogRecorder> _recorder{};
+
     Mavsdk::event_callback_t _on_discover_callback;
     Mavsdk::event_callback_t _on_timeout_callback;
 
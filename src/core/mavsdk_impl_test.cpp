@@ -0,0 +1,287 @@
+#include "mavsdk_impl.h"
+#include "loopback_connection.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+constexpr unsigned num_radios = 3;
+constexpr unsigned num_vehicles_per_radio = 10;
+
+uint8_t vehicle_system_id(unsigned radio, unsigned vehicle)
+{
+    return uint8_t(1 + radio * num_vehicles_per_radio + vehicle);
+}
+
+// The far end of a radio link with a few vehicles behind it, adding up the
+// bytes sent over it.
+struct Radio {
+    explicit Radio(unsigned radio_index) :
+        index(radio_index),
+        connection(
+            [this](mavlink_message_t& message, Connection*) { receive(message); },
+            "mavsdk_impl_test_radio_" + std::to_string(radio_index))
+    {}
+
+    void receive(mavlink_message_t& message)
+    {
+        if (message.msgid != MAVLINK_MSG_ID_COMMAND_LONG) {
+            return;
+        }
+        mavlink_command_long_t command_long;
+        mavlink_msg_command_long_decode(&message, &command_long);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        const unsigned num_bytes = MAVLINK_NUM_NON_PAYLOAD_BYTES + message.len;
+        if (is_behind(command_long.target_system)) {
+            num_bytes_needed += num_bytes;
+        } else {
+            num_bytes_wasted += num_bytes;
+        }
+        if (command_long.command == MAV_CMD_USER_1) {
+            ++num_user_commands;
+        }
+    }
+
+    bool is_behind(uint8_t system_id) const
+    {
+        return system_id >= vehicle_system_id(index, 0) &&
+               system_id < vehicle_system_id(index, num_vehicles_per_radio);
+    }
+
+    void send_heartbeats()
+    {
+        for (unsigned i = 0; i < num_vehicles_per_radio; ++i) {
+            mavlink_message_t message;
+            mavlink_msg_heartbeat_pack(
+                vehicle_system_id(index, i),
+                MAV_COMP_ID_AUTOPILOT1,
+                &message,
+                MAV_TYPE_QUADROTOR,
+                MAV_AUTOPILOT_PX4,
+                MAV_MODE_FLAG_CUSTOM_MODE_ENABLED,
+                0,
+                MAV_STATE_ACTIVE);
+            connection.send_message(message);
+        }
+    }
+
+    unsigned user_commands()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return num_user_commands;
+    }
+
+    const unsigned index;
+    LoopbackConnection connection;
+
+    std::mutex mutex{};
+    unsigned num_bytes_needed{0};
+    unsigned num_bytes_wasted{0};
+    unsigned num_user_commands{0};
+};
+
+mavlink_message_t user_command(uint8_t target_system)
+{
+    mavlink_command_long_t command_long{};
+    command_long.target_system = target_system;
+    command_long.target_component = MAV_COMP_ID_AUTOPILOT1;
+    command_long.command = MAV_CMD_USER_1;
+
+    mavlink_message_t message;
+    mavlink_msg_command_long_encode(245, MAV_COMP_ID_MISSIONPLANNER, &message, &command_long);
+    return message;
+}
+
+bool wait_for(const std::function<bool()>& condition)
+{
+    for (unsigned i = 0; i < 1000 && !condition(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return condition();
+}
+
+// A file in the temp directory, removed again when done with it, so the
+// tests don't leave anything behind where they're run.
+struct TempFile {
+    explicit TempFile(const std::string& name) : path(temp_directory() + "/" + name) {}
+    ~TempFile() { std::remove(path.c_str()); }
+
+    static std::string temp_directory()
+    {
+#if defined(WINDOWS)
+        const char* directory = std::getenv("TEMP");
+        return (directory != nullptr) ? directory : ".";
+#else
+        const char* directory = std::getenv("TMPDIR");
+        return (directory != nullptr) ? directory : "/tmp";
+#endif
+    }
+
+    const std::string path;
+};
+
+// Counts the frames of a message from a system in a tlog, in which each
+// record is a timestamp followed by a MAVLink 2 frame.
+unsigned count_in_tlog(const std::string& path, uint8_t system_id, uint32_t message_id)
+{
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    EXPECT_NE(file, nullptr);
+    if (file == nullptr) {
+        return 0;
+    }
+
+    unsigned count = 0;
+    uint64_t time_us;
+    uint8_t frame[MAVLINK_MAX_PACKET_LEN];
+    while (std::fread(&time_us, sizeof(time_us), 1, file) == 1 &&
+           std::fread(frame, 1, MAVLINK_NUM_HEADER_BYTES, file) == MAVLINK_NUM_HEADER_BYTES) {
+        EXPECT_EQ(frame[0], MAVLINK_STX);
+        const bool is_signed = (frame[2] & MAVLINK_IFLAG_SIGNED) != 0;
+        const std::size_t rest = frame[1] + MAVLINK_NUM_CHECKSUM_BYTES +
+                                 (is_signed ? MAVLINK_SIGNATURE_BLOCK_LEN : 0);
+        if (std::fread(&frame[MAVLINK_NUM_HEADER_BYTES], 1, rest, file) != rest) {
+            ADD_FAILURE() << "Truncated frame in " << path;
+            break;
+        }
+        const uint32_t msgid = frame[7] | (frame[8] << 8) | (frame[9] << 16);
+        if (frame[5] == system_id && msgid == message_id) {
+            ++count;
+        }
+    }
+    std::fclose(file);
+    return count;
+}
+
+} // namespace
+
+TEST(MavsdkImpl, SendsOnlyOnLinkOfTarget)
+{
+    constexpr unsigned num_commands_per_vehicle = 20;
+
+    MavsdkImpl mavsdk;
+
+    std::vector<std::unique_ptr<Radio>> radios;
+    for (unsigned i = 0; i < num_radios; ++i) {
+        radios.emplace_back(new Radio(i));
+        ASSERT_EQ(radios.back()->connection.start(), ConnectionResult::Success);
+        ASSERT_EQ(
+            mavsdk.add_any_connection("loopback://mavsdk_impl_test_radio_" + std::to_string(i)),
+            ConnectionResult::Success);
+    }
+
+    // Nobody heard yet, so it has to go everywhere.
+    auto unknown = user_command(200);
+    EXPECT_TRUE(mavsdk.send_message(unknown));
+    for (auto& radio : radios) {
+        EXPECT_TRUE(wait_for([&radio]() { return radio->user_commands() == 1; }));
+    }
+
+    for (auto& radio : radios) {
+        radio->send_heartbeats();
+    }
+    // Give MAVSDK time to hear all vehicles.
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    for (auto& radio : radios) {
+        std::lock_guard<std::mutex> lock(radio->mutex);
+        radio->num_bytes_needed = 0;
+        radio->num_bytes_wasted = 0;
+    }
+
+    unsigned num_bytes_sent = 0;
+    for (unsigned i = 0; i < num_commands_per_vehicle; ++i) {
+        for (unsigned radio = 0; radio < num_radios; ++radio) {
+            for (unsigned vehicle = 0; vehicle < num_vehicles_per_radio; ++vehicle) {
+                auto message = user_command(vehicle_system_id(radio, vehicle));
+                EXPECT_TRUE(mavsdk.send_message(message));
+                num_bytes_sent += MAVLINK_NUM_NON_PAYLOAD_BYTES + message.len;
+            }
+        }
+    }
+
+    unsigned num_bytes_on_air = 0;
+    for (auto& radio : radios) {
+        EXPECT_TRUE(wait_for([&radio]() {
+            return radio->user_commands() == 1 + num_commands_per_vehicle * num_vehicles_per_radio;
+        }));
+
+        std::lock_guard<std::mutex> lock(radio->mutex);
+        // Also what MAVSDK sends to the vehicles by itself is targeted.
+        EXPECT_EQ(radio->num_bytes_wasted, 0u);
+        num_bytes_on_air += radio->num_bytes_needed + radio->num_bytes_wasted;
+    }
+
+    // Broadcasting would have put every byte on every radio.
+    EXPECT_GE(num_bytes_on_air, num_bytes_sent);
+    EXPECT_LT(num_bytes_on_air, num_bytes_sent * num_radios);
+}
+
+TEST(MavsdkImpl, RecordsMessagesFromSystemIdZero)
+{
+    const TempFile tlog("mavsdk_impl_test_sysid_zero.tlog");
+
+    MavsdkImpl mavsdk;
+    Radio radio(0);
+    ASSERT_EQ(radio.connection.start(), ConnectionResult::Success);
+    ASSERT_EQ(
+        mavsdk.add_any_connection("loopback://mavsdk_impl_test_radio_0"),
+        ConnectionResult::Success);
+    ASSERT_TRUE(mavsdk.start_recording(tlog.path));
+
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(
+        0,
+        MAV_COMP_ID_AUTOPILOT1,
+        &message,
+        MAV_TYPE_QUADROTOR,
+        MAV_AUTOPILOT_PX4,
+        MAV_MODE_FLAG_CUSTOM_MODE_ENABLED,
+        0,
+        MAV_STATE_ACTIVE);
+    ASSERT_TRUE(radio.connection.send_message(message));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    mavsdk.stop_recording();
+
+    EXPECT_EQ(count_in_tlog(tlog.path, 0, MAVLINK_MSG_ID_HEARTBEAT), 1u);
+}
+
+TEST(MavsdkImpl, RecordsForwardedMessages)
+{
+    const TempFile tlog("mavsdk_impl_test_forwarded.tlog");
+
+    MavsdkImpl mavsdk;
+    mavsdk.set_message_forwarding(true);
+    std::vector<std::unique_ptr<Radio>> radios;
+    for (unsigned i = 0; i < 2; ++i) {
+        radios.emplace_back(new Radio(i));
+        ASSERT_EQ(radios.back()->connection.start(), ConnectionResult::Success);
+        ASSERT_EQ(
+            mavsdk.add_any_connection("loopback://mavsdk_impl_test_radio_" + std::to_string(i)),
+            ConnectionResult::Success);
+    }
+    ASSERT_TRUE(mavsdk.start_recording(tlog.path));
+
+    // Broadcast by a vehicle behind the first radio, so forwarded to the second.
+    mavlink_command_long_t command_long{};
+    command_long.command = MAV_CMD_USER_1;
+    mavlink_message_t message;
+    mavlink_msg_command_long_encode(
+        vehicle_system_id(0, 0), MAV_COMP_ID_AUTOPILOT1, &message, &command_long);
+    ASSERT_TRUE(radios[0]->connection.send_message(message));
+    EXPECT_TRUE(wait_for([&radios]() { return radios[1]->user_commands() == 1; }));
+    mavsdk.stop_recording();
+
+    // Once as received and once as sent on.
+    EXPECT_EQ(count_in_tlog(tlog.path, vehicle_system_id(0, 0), MAVLINK_MSG_ID_COMMAND_LONG), 2u);
+}
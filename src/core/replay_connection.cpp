@@ -0,0 +1,110 @@
+#include "replay_connection.h"
+#include "global_include.h"
+#include "log.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace mavsdk {
+
+ReplayConnection::ReplayConnection(
+    Connection::receiver_callback_t receiver_callback, const std::string& path, double speed) :
+    Connection(receiver_callback),
+    _path(path),
+    _speed(speed)
+{}
+
+ReplayConnection::~ReplayConnection()
+{
+    // If no one explicitly called stop before, we should at least do it.
+    stop();
+}
+
+ConnectionResult ReplayConnection::start()
+{
+    start_mavlink_receiver();
+
+    if (!_reader.open(_path)) {
+        return ConnectionResult::ConnectionError;
+    }
+
+    _should_exit = false;
+    _is_finished = false;
+    _replay_thread = new std::thread(&ReplayConnection::replay, this);
+
+    return ConnectionResult::Success;
+}
+
+ConnectionResult ReplayConnection::stop()
+{
+    _should_exit = true;
+
+    if (_replay_thread) {
+        _replay_thread->join();
+        delete _replay_thread;
+        _replay_thread = nullptr;
+    }
+
+    _reader.close();
+
+    // We need to stop this after stopping the replay thread, otherwise
+    // it can happen that we interfere with the parsing of a message.
+    stop_mavlink_receiver();
+
+    return ConnectionResult::Success;
+}
+
+bool ReplayConnection::send_message(const mavlink_message_t& message)
+{
+    UNUSED(message);
+    // There is nobody to receive it, but that's not an error.
+    return true;
+}
+
+void ReplayConnection::replay()
+{
+    const auto start_time = std::chrono::steady_clock::now();
+    uint64_t first_time_us = 0;
+    bool is_first = true;
+    unsigned num_messages = 0;
+
+    TlogReader::Frame frame{};
+    while (!_should_exit && _reader.next(frame)) {
+        if (_speed > 0.0) {
+            if (is_first) {
+                first_time_us = frame.time_us;
+                is_first = false;
+            }
+            // Wait until the (scaled) time since the first message has passed.
+            const auto elapsed_us =
+                (frame.time_us > first_time_us) ? frame.time_us - first_time_us : 0;
+            const auto due =
+                start_time + std::chrono::microseconds(uint64_t(double(elapsed_us) / _speed));
+            while (!_should_exit && std::chrono::steady_clock::now() < due) {
+                // Sleep in short steps to be able to stop quickly.
+                std::this_thread::sleep_until(std::min(
+                    due, std::chrono::steady_clock::now() + std::chrono::milliseconds(100)));
+            }
+        }
+
+        // The parser takes a char* but does not modify the data.
+        _mavlink_receiver->set_new_datagram(
+            reinterpret_cast<char*>(const_cast<uint8_t*>(frame.data)), unsigned(frame.length));
+
+        while (_mavlink_receiver->parse_message()) {
+            receive_message(_mavlink_receiver->get_last_message());
+            ++num_messages;
+        }
+    }
+
+    if (!_should_exit) {
+        const double elapsed_s = std::chrono::duration<double>(
+                                     std::chrono::steady_clock::now() - start_time)
+                                     .count();
+        LogInfo() << "Replay of " << _path << " finished: " << num_messages << " messages in "
+                  << elapsed_s << " s";
+    }
+    _is_finished = true;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include "connection.h"
+#include "tlog_reader.h"
+
+namespace mavsdk {
+
+// Feeds the messages of a recorded telemetry log (tlog) into MAVSDK as if
+// they were received from a vehicle.
+//
+// The messages are replayed with the timing they were recorded with, scaled
+// by the speed factor, or as fast as possible with a speed of 0. Messages
+// sent are dropped.
+class ReplayConnection : public Connection {
+public:
+    explicit ReplayConnection(
+        Connection::receiver_callback_t receiver_callback, const std::string& path, double speed);
+    ~ReplayConnection();
+    ConnectionResult start() override;
+    ConnectionResult stop() override;
+
+    bool send_message(const mavlink_message_t& message) override;
+
+    bool is_finished() const { return _is_finished; }
+
+    // Non-copyable
+    ReplayConnection(const ReplayConnection&) = delete;
+    const ReplayConnection& operator=(const ReplayConnection&) = delete;
+
+private:
+    void replay();
+
+    std::string _path;
+    double _speed;
+
+    TlogReader _reader{};
+
+    std::thread* _replay_thread{nullptr};
+    std::atomic_bool _should_exit{false};
+    std::atomic_bool _is_finished{false};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace mavsdk {
+
+/*
+ * Sequence lock for data which is read a lot more often than it is written.
+ *
+ * Readers never lock and never block writers: they copy the data and retry
+ * if a write happened in the meantime, detected by an odd or changed sequence
+ * number. Writers are serialized among each other.
+ *
+ * The data is kept as an array of atomic words accessed with relaxed memory
+ * order, so concurrent reads and writes are not a data race, see
+ * "Can seqlocks get along with programming language memory models?" by
+ * Hans-J. Boehm. Therefore, T needs to be trivially copyable.
+ *
+ * Single members can be read and written without copying all of T, and
+ * reading all of T always gives a consistent copy.
+ */
+
+template<class T> class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "T needs to be trivially copyable");
+
+public:
+    Seqlock() : Seqlock(T{}) {}
+
+    explicit Seqlock(const T& value)
+    {
+        uint64_t buffer[num_words]{};
+        std::memcpy(buffer, &value, sizeof(T));
+        for (std::size_t i = 0; i < num_words; ++i) {
+            _words[i].store(buffer[i], std::memory_order_relaxed);
+        }
+    }
+
+    ~Seqlock() = default;
+
+    // Delete copy and move constructors and assign operators.
+    Seqlock(Seqlock const&) = delete;
+    Seqlock(Seqlock&&) = delete;
+    Seqlock& operator=(Seqlock const&) = delete;
+    Seqlock& operator=(Seqlock&&) = delete;
+
+    T load() const
+    {
+        T value;
+        read_bytes(0, sizeof(T), &value);
+        return value;
+    }
+
+    template<class M> M load(M T::*member) const
+    {
+        M value;
+        read_bytes(offset_of(member), sizeof(M), &value);
+        return value;
+    }
+
+    void store(const T& value)
+    {
+        const uint32_t sequence = begin_write();
+        write_bytes(0, sizeof(T), &value);
+        end_write(sequence);
+    }
+
+    template<class M> void store(M T::*member, const M& value)
+    {
+        const uint32_t sequence = begin_write();
+        write_bytes(offset_of(member), sizeof(M), &value);
+        end_write(sequence);
+    }
+
+    // Read-modify-write of one member, the function gets a reference to
+    // the current value which it can change.
+    template<class M, class F> void modify(M T::*member, F function)
+    {
+        const std::size_t offset = offset_of(member);
+
+        const uint32_t sequence = begin_write();
+        // The other writers are excluded, so this reads the current value.
+        M value;
+        copy_from_words(offset, sizeof(M), &value);
+        function(value);
+        write_bytes(offset, sizeof(M), &value);
+        end_write(sequence);
+    }
+
+private:
+    static constexpr std::size_t word_size = sizeof(uint64_t);
+    static constexpr std::size_t num_words = (sizeof(T) + word_size - 1) / word_size;
+
+    template<class M> static std::size_t offset_of(M T::*member)
+    {
+        static const T probe{};
+        return static_cast<std::size_t>(
+            reinterpret_cast<const char*>(&(probe.*member)) -
+            reinterpret_cast<const char*>(&probe));
+    }
+
+    void copy_from_words(std::size_t offset, std::size_t size, void* out) const
+    {
+        const std::size_t first = offset / word_size;
+        const std::size_t last = (offset + size + word_size - 1) / word_size;
+
+        uint64_t buffer[num_words];
+        for (std::size_t i = first; i < last; ++i) {
+            buffer[i - first] = _words[i].load(std::memory_order_relaxed);
+        }
+        std::memcpy(out, reinterpret_cast<const char*>(buffer) + offset % word_size, size);
+    }
+
+    void read_bytes(std::size_t offset, std::size_t size, void* out) const
+    {
+        while (true) {
+            const uint32_t before = _sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                // A write is in progress.
+                std::this_thread::yield();
+                continue;
+            }
+
+            copy_from_words(offset, size, out);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_sequence.load(std::memory_order_relaxed) == before) {
+                return;
+            }
+        }
+    }
+
+    void write_bytes(std::size_t offset, std::size_t size, const void* in)
+    {
+        const std::size_t first = offset / word_size;
+        const std::size_t last = (offset + size + word_size - 1) / word_size;
+
+        // The words at the border can be shared with other members.
+        uint64_t buffer[num_words];
+        buffer[0] = _words[first].load(std::memory_order_relaxed);
+        buffer[last - first - 1] = _words[last - 1].load(std::memory_order_relaxed);
+        std::memcpy(reinterpret_cast<char*>(buffer) + offset % word_size, in, size);
+
+        for (std::size_t i = first; i < last; ++i) {
+            _words[i].store(buffer[i - first], std::memory_order_relaxed);
+        }
+    }
+
+    uint32_t begin_write()
+    {
+        uint32_t sequence = _sequence.load(std::memory_order_relaxed);
+        while ((sequence & 1) || !_sequence.compare_exchange_weak(
+                                     sequence, sequence + 1, std::memory_order_acquire)) {
+            if (sequence & 1) {
+                // Another writer is busy.
+                std::this_thread::yield();
+                sequence = _sequence.load(std::memory_order_relaxed);
+            }
+        }
+        // The odd sequence needs to be visible before any of the data changes.
+        std::atomic_thread_fence(std::memory_order_release);
+        return sequence + 1;
+    }
+
+    void end_write(uint32_t sequence) { _sequence.store(sequence + 1, std::memory_order_release); }
+
+    std::atomic<uint32_t> _sequence{0};
+    std::atomic<uint64_t> _words[num_words]{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,110 @@
+#include "seqlock.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+struct Data {
+    uint8_t flag{0};
+    double value{1.0};
+    // Odd size to test members which share words with others.
+    uint8_t bytes[13]{};
+    uint32_t counter{0};
+};
+
+} // namespace
+
+TEST(Seqlock, LoadAndStore)
+{
+    Seqlock<Data> seqlock{};
+    EXPECT_EQ(seqlock.load().value, 1.0);
+
+    Data data{};
+    data.flag = 3;
+    data.value = 42.0;
+    data.bytes[12] = 7;
+    data.counter = 5;
+    seqlock.store(data);
+
+    const auto loaded = seqlock.load();
+    EXPECT_EQ(loaded.flag, 3);
+    EXPECT_EQ(loaded.value, 42.0);
+    EXPECT_EQ(loaded.bytes[12], 7);
+    EXPECT_EQ(loaded.counter, 5);
+}
+
+TEST(Seqlock, Members)
+{
+    Seqlock<Data> seqlock{};
+
+    seqlock.store(&Data::counter, uint32_t(12345));
+    seqlock.store(&Data::flag, uint8_t(1));
+    EXPECT_EQ(seqlock.load(&Data::counter), 12345);
+    EXPECT_EQ(seqlock.load(&Data::flag), 1);
+    EXPECT_EQ(seqlock.load(&Data::value), 1.0);
+
+    seqlock.modify(&Data::counter, [](uint32_t& counter) { counter += 5; });
+    EXPECT_EQ(seqlock.load(&Data::counter), 12350);
+
+    // The neighbours are untouched.
+    const auto loaded = seqlock.load();
+    EXPECT_EQ(loaded.flag, 1);
+    EXPECT_EQ(loaded.value, 1.0);
+    for (const auto byte : loaded.bytes) {
+        EXPECT_EQ(byte, 0);
+    }
+}
+
+TEST(Seqlock, ConsistentUnderContention)
+{
+    // Writers keep all members of the data equal, readers must never see
+    // them differ.
+    struct Block {
+        uint64_t values[32];
+    };
+    Seqlock<Block> seqlock{};
+
+    std::atomic<bool> should_exit{false};
+    std::vector<std::thread> writers;
+    for (unsigned w = 0; w < 2; ++w) {
+        writers.emplace_back([&, w]() {
+            Block block{};
+            for (uint64_t i = 0; !should_exit; ++i) {
+                for (auto& value : block.values) {
+                    value = i * 2 + w;
+                }
+                seqlock.store(block);
+            }
+        });
+    }
+
+    std::atomic<unsigned> inconsistent{0};
+    std::vector<std::thread> readers;
+    for (unsigned r = 0; r < 2; ++r) {
+        readers.emplace_back([&]() {
+            for (unsigned i = 0; i < 100000; ++i) {
+                const auto block = seqlock.load();
+                for (const auto value : block.values) {
+                    if (value != block.values[0]) {
+                        ++inconsistent;
+                        break;
+                    }
+                }
+            }
+        });
+    }
+
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    should_exit = true;
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    EXPECT_EQ(inconsistent, 0);
+}
@@ -9,8 +9,30 @@
 #include <poll.h>
 #endif
 
+#if defined(LINUX)
+#include <sys/ioctl.h>
+#include <linux/serial.h>
+#endif
+
+#include <algorithm>
+#include <initializer_list>
+#include <thread>
+
 namespace mavsdk {
 
+namespace {
+
+#if !defined(WINDOWS)
+// Written right away once this much is waiting, whatever the flush latency.
+constexpr std::size_t flush_size = 1024;
+
+// If the port can't keep up, messages are dropped beyond this rather than
+// piling up ever more delay.
+constexpr std::size_t max_tx_buffer_size = 32 * 1024;
+#endif
+
+} // namespace
+
 #ifndef WINDOWS
 #define GET_ERROR() strerror(errno)
 #else
@@ -63,9 +85,7 @@ SerialConnection::~SerialConnection()
 
 ConnectionResult SerialConnection::start()
 {
-    if (!start_mavlink_receiver()) {
-        return ConnectionResult::ConnectionsExhausted;
-    }
+    start_mavlink_receiver();
 
     ConnectionResult ret = setup_port();
     if (ret != ConnectionResult::Success) {
@@ -86,10 +106,12 @@ ConnectionResult SerialConnection::setup_port()
         LogErr() << "open failed: " << GET_ERROR();
         return ConnectionResult::ConnectionError;
     }
-    // We need to clear the O_NONBLOCK again because we can block while reading
-    // as we do it in a separate thread.
-    if (fcntl(_fd, F_SETFL, 0) == -1) {
-        LogErr() << "fcntl failed: " << GET_ERROR();
+    // It stays non-blocking, the receive thread waits in poll() for both
+    // reading and writing, so neither holds up the other.
+    if (pipe(_wake_up_pipe) != 0 || fcntl(_wake_up_pipe[0], F_SETFL, O_NONBLOCK) == -1 ||
+        fcntl(_wake_up_pipe[1], F_SETFL, O_NONBLOCK) == -1) {
+        LogErr() << "pipe failed: " << GET_ERROR();
+        close_port();
         return ConnectionResult::ConnectionError;
     }
 #elif defined(WINDOWS)
@@ -114,7 +136,7 @@ ConnectionResult SerialConnection::setup_port()
 
     if (tcgetattr(_fd, &tc) != 0) {
         LogErr() << "tcgetattr failed: " << GET_ERROR();
-        close(_fd);
+        close_port();
         return ConnectionResult::ConnectionError;
     }
 #endif
@@ -126,8 +148,10 @@ ConnectionResult SerialConnection::setup_port()
     tc.c_cflag &= ~(CSIZE | PARENB | CRTSCTS);
     tc.c_cflag |= CS8;
 
-    tc.c_cc[VMIN] = 0; // We are ok with 0 bytes.
-    tc.c_cc[VTIME] = 10; // Timeout after 1 second.
+    // Return whatever is there without waiting for more, poll() does the
+    // waiting and we read as much as is available at once.
+    tc.c_cc[VMIN] = 0;
+    tc.c_cc[VTIME] = 0;
 
     if (_flow_control) {
         tc.c_cflag |= CRTSCTS;
@@ -144,28 +168,40 @@ ConnectionResult SerialConnection::setup_port()
 #endif
 
     if (baudrate_or_define == -1) {
+        close_port();
         return ConnectionResult::BaudrateUnknown;
     }
 
     if (cfsetispeed(&tc, baudrate_or_define) != 0) {
         LogErr() << "cfsetispeed failed: " << GET_ERROR();
-        close(_fd);
+        close_port();
         return ConnectionResult::ConnectionError;
     }
 
     if (cfsetospeed(&tc, baudrate_or_define) != 0) {
         LogErr() << "cfsetospeed failed: " << GET_ERROR();
-        close(_fd);
+        close_port();
         return ConnectionResult::ConnectionError;
     }
 
     if (tcsetattr(_fd, TCSANOW, &tc) != 0) {
         LogErr() << "tcsetattr failed: " << GET_ERROR();
-        close(_fd);
+        close_port();
         return ConnectionResult::ConnectionError;
     }
 #endif
 
+#if defined(LINUX)
+    // Ask the driver to pass on received bytes right away instead of
+    // batching them, e.g. for 16 ms in FTDI adapters. Not every driver
+    // supports this, which is fine.
+    struct serial_struct serial_info {};
+    if (ioctl(_fd, TIOCGSERIAL, &serial_info) == 0) {
+        serial_info.flags |= ASYNC_LOW_LATENCY;
+        ioctl(_fd, TIOCSSERIAL, &serial_info);
+    }
+#endif
+
 #if defined(WINDOWS)
     DCB dcb;
     SecureZeroMemory(&dcb, sizeof(DCB));
@@ -226,6 +262,10 @@ ConnectionResult SerialConnection::stop()
 {
     _should_exit = true;
 
+#if !defined(WINDOWS)
+    wake_up_receive_thread();
+#endif
+
     if (_recv_thread) {
         _recv_thread->join();
         delete _recv_thread;
@@ -233,7 +273,7 @@ ConnectionResult SerialConnection::stop()
     }
 
 #if defined(LINUX) || defined(APPLE)
-    close(_fd);
+    close_port();
 #elif defined(WINDOWS)
     CloseHandle(_handle);
 #endif
@@ -246,6 +286,19 @@ ConnectionResult SerialConnection::stop()
 }
 
 bool SerialConnection::send_message(const mavlink_message_t& message)
+{
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+
+    return send_buffer(buffer, buffer_len);
+}
+
+bool SerialConnection::send_serialized(const std::shared_ptr<const SerializedMessage>& serialized)
+{
+    return send_buffer(serialized->data(), serialized->length());
+}
+
+bool SerialConnection::send_buffer(const uint8_t* buffer, uint16_t buffer_len)
 {
     if (_serial_node.empty()) {
         LogErr() << "Dev Path unknown";
@@ -257,18 +310,40 @@ bool SerialConnection::send_message(const mavlink_message_t& message)
         return false;
     }
 
-    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
-    uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+    // Messages can be sent from several threads at once, they must not interleave.
+    std::lock_guard<std::mutex> lock(_mutex);
 
-    int send_len;
 #if defined(LINUX) || defined(APPLE)
-    send_len = static_cast<int>(write(_fd, buffer, buffer_len));
+    if (_tx_buffer.size() + buffer_len > max_tx_buffer_size) {
+        return false;
+    }
+
+    const bool was_empty = _tx_buffer.empty();
+    _tx_buffer.insert(_tx_buffer.end(), buffer, buffer + buffer_len);
+
+    if (was_empty) {
+        if (_flush_latency.count() == 0) {
+            // Nothing is waiting, so it can go out from here without a
+            // detour through the receive thread.
+            write_tx_buffer();
+            if (_tx_buffer.empty()) {
+                return true;
+            }
+        } else {
+            _tx_buffer_since = std::chrono::steady_clock::now();
+        }
+        wake_up_receive_thread();
+    } else if (_tx_buffer.size() >= flush_size && _tx_buffer.size() - buffer_len < flush_size) {
+        wake_up_receive_thread();
+    }
+
+    return true;
 #else
+    int send_len;
     if (!WriteFile(_handle, buffer, buffer_len, LPDWORD(&send_len), NULL)) {
         LogErr() << "WriteFile failure: " << GET_ERROR();
         return false;
     }
-#endif
 
     if (send_len != buffer_len) {
         LogErr() << "write failure: " << GET_ERROR();
@@ -276,39 +351,99 @@ bool SerialConnection::send_message(const mavlink_message_t& message)
     }
 
     return true;
+#endif
 }
 
-void SerialConnection::receive()
+#if defined(LINUX) || defined(APPLE)
+void SerialConnection::close_port()
 {
-    // Enough for MTU 1500 bytes.
-    char buffer[2048];
+    // Also used when setting up the port fails half way, before stop().
+    for (int* fd : {&_fd, &_wake_up_pipe[0], &_wake_up_pipe[1]}) {
+        if (*fd != -1) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+}
+#endif
 
-#if defined(LINUX) || defined(APPLE)
-    struct pollfd fds[1];
-    fds[0].fd = _fd;
-    fds[0].events = POLLIN;
+void SerialConnection::set_flush_latency(std::chrono::milliseconds flush_latency)
+{
+#if !defined(WINDOWS)
+    std::lock_guard<std::mutex> lock(_mutex);
+    _flush_latency = flush_latency;
+#else
+    UNUSED(flush_latency);
 #endif
+}
 
-    while (!_should_exit) {
-        int recv_len;
+void SerialConnection::receive()
+{
 #if defined(LINUX) || defined(APPLE)
-        int pollrc = poll(fds, 1, 1000);
-        if (pollrc == 0 || !(fds[0].revents & POLLIN)) {
+    while (!_should_exit) {
+        struct pollfd fds[2];
+        fds[0].fd = _fd;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        fds[1].fd = _wake_up_pipe[0];
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+
+        int timeout_ms = 1000;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_tx_buffer.empty()) {
+                const auto now = std::chrono::steady_clock::now();
+                const auto due = _tx_buffer_since + _flush_latency;
+                if (now >= due || _tx_buffer.size() >= flush_size) {
+                    fds[0].events |= POLLOUT;
+                } else {
+                    // Rounded up, waking up too early would only spin.
+                    timeout_ms =
+                        static_cast<int>(
+                            std::chrono::duration_cast<std::chrono::milliseconds>(due - now)
+                                .count()) +
+                        1;
+                }
+            }
+        }
+
+        const int pollrc = poll(fds, 2, timeout_ms);
+        if (pollrc == -1) {
+            if (errno != EINTR) {
+                LogErr() << "poll failure: " << GET_ERROR();
+            }
             continue;
-        } else if (pollrc == -1) {
-            LogErr() << "read poll failure: " << GET_ERROR();
         }
-        // We enter here if (fds[0].revents & POLLIN) == true
-        recv_len = static_cast<int>(read(_fd, buffer, sizeof(buffer)));
-        if (recv_len < -1) {
-            LogErr() << "read failure: " << GET_ERROR();
+
+        if (fds[1].revents & POLLIN) {
+            char drain[64];
+            while (read(_wake_up_pipe[0], drain, sizeof(drain)) > 0) {
+            }
+        }
+
+        if (fds[0].revents & POLLOUT) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            write_tx_buffer();
+        }
+
+        if (fds[0].revents & POLLIN) {
+            receive_available();
+        } else if (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            // E.g. the adapter was unplugged, poll() would return right away again.
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
         }
+    }
 #else
+    // Enough for MTU 1500 bytes.
+    char buffer[2048];
+
+    while (!_should_exit) {
+        int recv_len;
         if (!ReadFile(_handle, buffer, sizeof(buffer), LPDWORD(&recv_len), NULL)) {
             LogErr() << "ReadFile failure: " << GET_ERROR();
             continue;
         }
-#endif
         if (recv_len > static_cast<int>(sizeof(buffer)) || recv_len == 0) {
             continue;
         }
@@ -318,7 +453,69 @@ void SerialConnection::receive()
             receive_message(_mavlink_receiver->get_last_message());
         }
     }
+#endif
+}
+
+#if !defined(WINDOWS)
+void SerialConnection::receive_available()
+{
+    // Several milliseconds worth at the highest baudrates, so a busy link is
+    // read with few calls.
+    char buffer[16384];
+
+    while (true) {
+        const auto recv_len = read(_fd, buffer, sizeof(buffer));
+        if (recv_len < 0) {
+            if (errno != EAGAIN && errno != EINTR) {
+                LogErr() << "read failure: " << GET_ERROR();
+            }
+            return;
+        }
+        if (recv_len == 0) {
+            return;
+        }
+
+        _mavlink_receiver->set_new_datagram(buffer, static_cast<unsigned>(recv_len));
+        // Parse all mavlink messages in one data packet. Once exhausted, we'll exit while.
+        while (_mavlink_receiver->parse_message()) {
+            receive_message(_mavlink_receiver->get_last_message());
+        }
+
+        if (static_cast<std::size_t>(recv_len) < sizeof(buffer)) {
+            // That was all there was.
+            return;
+        }
+    }
+}
+
+void SerialConnection::write_tx_buffer()
+{
+    const auto send_len = write(_fd, _tx_buffer.data(), _tx_buffer.size());
+    if (send_len < 0) {
+        if (errno == EAGAIN || errno == EINTR) {
+            // Busy, the receive thread tries again once it can be written.
+            return;
+        }
+        LogErr() << "write failure: " << GET_ERROR();
+        // Retrying wouldn't help, but it would keep the receive thread busy.
+        _tx_buffer.clear();
+        return;
+    }
+
+    _tx_buffer.erase(_tx_buffer.begin(), _tx_buffer.begin() + send_len);
+}
+
+void SerialConnection::wake_up_receive_thread()
+{
+    if (_wake_up_pipe[1] == -1) {
+        return;
+    }
+    const char wake_up = 0;
+    if (write(_wake_up_pipe[1], &wake_up, 1) != 1) {
+        // The pipe is full, so there are plenty of wake ups waiting already.
+    }
 }
+#endif
 
 #if defined(LINUX)
 int SerialConnection::define_from_baudrate(int baudrate)
@@ -2,6 +2,8 @@
 
 #include <mutex>
 #include <atomic>
+#include <chrono>
+#include <vector>
 #include "connection.h"
 
 #if defined(WINDOWS)
@@ -22,6 +24,13 @@ public:
     ~SerialConnection();
 
     bool send_message(const mavlink_message_t& message) override;
+    bool send_serialized(const std::shared_ptr<const SerializedMessage>& serialized) override;
+
+    // How long outgoing messages may wait to be written together with the
+    // ones following, rounded up to milliseconds. With 0, the default, they
+    // are written right away and only combined if the port is busy. Set
+    // through add_serial_connection() or the flush_latency_ms URL option.
+    void set_flush_latency(std::chrono::milliseconds flush_latency);
 
     // Non-copyable
     SerialConnection(const SerialConnection&) = delete;
@@ -31,6 +40,17 @@ private:
     ConnectionResult setup_port();
     void start_recv_thread();
     void receive();
+    bool send_buffer(const uint8_t* buffer, uint16_t buffer_len);
+
+#if defined(LINUX) || defined(APPLE)
+    void close_port();
+#endif
+
+#if !defined(WINDOWS)
+    void receive_available();
+    void write_tx_buffer();
+    void wake_up_receive_thread();
+#endif
 
 #if defined(LINUX)
     static int define_from_baudrate(int baudrate);
@@ -43,6 +63,15 @@ private:
     std::mutex _mutex = {};
 #if !defined(WINDOWS)
     int _fd = -1;
+
+    // The receive thread also writes, it is woken up through this pipe when
+    // there is something new to write.
+    int _wake_up_pipe[2] = {-1, -1};
+
+    // Written as a whole once due, guarded by _mutex.
+    std::vector<uint8_t> _tx_buffer{};
+    std::chrono::steady_clock::time_point _tx_buffer_since{};
+    std::chrono::milliseconds _flush_latency{0};
 #else
     HANDLE _handle;
 #endif
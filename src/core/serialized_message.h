@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include "mavlink_include.h"
+
+namespace mavsdk {
+
+// A message together with the bytes it goes out as, so it only needs to be
+// packed once however many connections and remotes it is sent to. It is
+// passed around as std::shared_ptr<const SerializedMessage> so connections
+// can queue it without copying.
+class SerializedMessage {
+public:
+    explicit SerializedMessage(const mavlink_message_t& message) :
+        _message(message),
+        _buffer(),
+        _length(mavlink_msg_to_send_buffer(_buffer, &message))
+    {}
+    ~SerializedMessage() = default;
+
+    const mavlink_message_t& message() const { return _message; }
+    const uint8_t* data() const { return _buffer; }
+    uint16_t length() const { return _length; }
+
+    // Delete copy and move constructors and assign operators.
+    SerializedMessage(SerializedMessage const&) = delete;
+    SerializedMessage(SerializedMessage&&) = delete;
+    SerializedMessage& operator=(SerializedMessage const&) = delete;
+    SerializedMessage& operator=(SerializedMessage&&) = delete;
+
+private:
+    const mavlink_message_t _message;
+    uint8_t _buffer[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t _length;
+};
+
+} // namespace mavsdk
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace mavsdk {
+
+/*
+ * Bounded lock-free queue for one producer and one consumer thread.
+ *
+ * Items are constructed once and reused: the producer reserves the next free
+ * slot, fills it in place and commits it, the consumer looks at the oldest
+ * item and pops it when done. Neither side ever blocks; reserving fails if
+ * the queue is full.
+ *
+ * If there are several producer threads, they need to be serialized, e.g.
+ * by a mutex, the same for consumers.
+ */
+
+template<class T> class SpscQueue {
+public:
+    // The capacity is rounded up to the next power of two.
+    explicit SpscQueue(std::size_t capacity) :
+        _slots(round_up_to_power_of_two(capacity)),
+        _mask(_slots.size() - 1)
+    {}
+
+    ~SpscQueue() = default;
+
+    // Delete copy and move constructors and assign operators.
+    SpscQueue(SpscQueue const&) = delete;
+    SpscQueue(SpscQueue&&) = delete;
+    SpscQueue& operator=(SpscQueue const&) = delete;
+    SpscQueue& operator=(SpscQueue&&) = delete;
+
+    // Producer: returns the next free slot or nullptr if full.
+    T* try_reserve()
+    {
+        const std::size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _cached_head == _slots.size()) {
+            _cached_head = _head.load(std::memory_order_acquire);
+            if (tail - _cached_head == _slots.size()) {
+                return nullptr;
+            }
+        }
+        return &_slots[tail & _mask];
+    }
+
+    // Producer: publishes the slot returned by try_reserve().
+    void commit()
+    {
+        _tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Consumer: returns the oldest item or nullptr if empty.
+    T* front()
+    {
+        const std::size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _cached_tail) {
+            _cached_tail = _tail.load(std::memory_order_acquire);
+            if (head == _cached_tail) {
+                return nullptr;
+            }
+        }
+        return &_slots[head & _mask];
+    }
+
+    // Consumer: releases the item returned by front().
+    void pop()
+    {
+        _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    std::size_t capacity() const { return _slots.size(); }
+
+private:
+    static std::size_t round_up_to_power_of_two(std::size_t value)
+    {
+        std::size_t result = 1;
+        while (result < value) {
+            result *= 2;
+        }
+        return result;
+    }
+
+    std::vector<T> _slots;
+    const std::size_t _mask;
+
+    // Producer and consumer side are kept on separate cache lines, each with
+    // a cached copy of the other side's index to avoid touching it.
+    static constexpr std::size_t cache_line_size = 64;
+
+    char _padding0[cache_line_size]{};
+    std::atomic<std::size_t> _tail{0};
+    std::size_t _cached_head{0};
+
+    char _padding1[cache_line_size]{};
+    std::atomic<std::size_t> _head{0};
+    std::size_t _cached_tail{0};
+
+    char _padding2[cache_line_size]{};
+};
+
+} // namespace mavsdk
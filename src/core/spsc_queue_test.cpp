@@ -0,0 +1,61 @@
+#include "spsc_queue.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace mavsdk;
+
+TEST(SpscQueue, FillAndEmpty)
+{
+    SpscQueue<int> queue(3);
+    EXPECT_EQ(queue.capacity(), 4);
+    EXPECT_EQ(queue.front(), nullptr);
+
+    for (int i = 0; i < 4; ++i) {
+        int* slot = queue.try_reserve();
+        ASSERT_NE(slot, nullptr);
+        *slot = i;
+        queue.commit();
+    }
+    EXPECT_EQ(queue.try_reserve(), nullptr);
+
+    for (int i = 0; i < 4; ++i) {
+        int* item = queue.front();
+        ASSERT_NE(item, nullptr);
+        EXPECT_EQ(*item, i);
+        queue.pop();
+    }
+    EXPECT_EQ(queue.front(), nullptr);
+    EXPECT_NE(queue.try_reserve(), nullptr);
+}
+
+TEST(SpscQueue, ProducerAndConsumerThread)
+{
+    SpscQueue<uint64_t> queue(64);
+    const uint64_t num_items = 1000000;
+
+    std::thread producer([&queue, num_items]() {
+        for (uint64_t i = 0; i < num_items; ++i) {
+            uint64_t* slot;
+            while ((slot = queue.try_reserve()) == nullptr) {
+                std::this_thread::yield();
+            }
+            *slot = i;
+            queue.commit();
+        }
+    });
+
+    uint64_t expected = 0;
+    while (expected < num_items) {
+        uint64_t* item = queue.front();
+        if (item == nullptr) {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(*item, expected);
+        queue.pop();
+        ++expected;
+    }
+
+    producer.join();
+    EXPECT_EQ(queue.front(), nullptr);
+}
@@ -594,6 +594,11 @@ uint8_t SystemImpl::get_own_mav_type() const
     return _parent.get_mav_type();
 }
 
+const Connection* SystemImpl::get_link() const
+{
+    return _parent.get_link(get_system_id());
+}
+
 MAVLinkParameters::Result SystemImpl::set_param_float(const std::string& name, float value)
 {
     MAVLinkParameters::ParamValue param_value;
@@ -826,6 +831,15 @@ void SystemImpl::get_param_async(
     _params.get_param_async(name, value_type, callback, cookie, extended);
 }
 
+void SystemImpl::get_all_params_async(
+    MAVLinkParameters::get_all_params_callback_t callback,
+    const void* cookie,
+    uint8_t component_id,
+    bool extended)
+{
+    _params.get_all_params_async(callback, cookie, component_id, extended);
+}
+
 void SystemImpl::cancel_all_param(const void* cookie)
 {
     _params.cancel_all_param(cookie);
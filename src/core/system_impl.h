@@ -24,6 +24,7 @@
 
 namespace mavsdk {
 
+class Connection;
 class MavsdkImpl;
 class PluginImplBase;
 
@@ -120,6 +121,9 @@ public:
     uint8_t get_own_component_id() const;
     uint8_t get_own_mav_type() const;
 
+    // Connection the system is reached over, to tell which systems share a link.
+    const Connection* get_link() const;
+
     bool does_support_mission_int() const { return _supports_mission_int; }
 
     bool is_armed() const { return _armed; }
@@ -198,6 +202,12 @@ public:
         const void* cookie,
         bool extended);
 
+    void get_all_params_async(
+        MAVLinkParameters::get_all_params_callback_t callback,
+        const void* cookie,
+        uint8_t component_id,
+        bool extended = false);
+
     void cancel_all_param(const void* cookie);
 
     void param_changed(const std::string& name);
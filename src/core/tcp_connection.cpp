@@ -8,12 +8,14 @@
 #endif
 #else
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <errno.h>
 #include <unistd.h> // for close()
 #endif
 
+#include <algorithm>
 #include <cassert>
 
 #ifndef WINDOWS
@@ -24,6 +26,15 @@
 
 namespace mavsdk {
 
+namespace {
+
+// Retrying quickly at first gets us back soon after a short glitch, backing
+// off avoids hammering a server which is down for longer.
+constexpr std::chrono::milliseconds first_reconnect_delay{100};
+constexpr std::chrono::milliseconds max_reconnect_delay{5000};
+
+} // namespace
+
 /* change to remote_ip and remote_port */
 TcpConnection::TcpConnection(
     Connection::receiver_callback_t receiver_callback,
@@ -43,9 +54,7 @@ TcpConnection::~TcpConnection()
 
 ConnectionResult TcpConnection::start()
 {
-    if (!start_mavlink_receiver()) {
-        return ConnectionResult::ConnectionsExhausted;
-    }
+    start_mavlink_receiver();
 
     ConnectionResult ret = setup_port();
     if (ret != ConnectionResult::Success) {
@@ -68,14 +77,39 @@ ConnectionResult TcpConnection::setup_port()
     }
 #endif
 
-    _socket_fd = socket(AF_INET, SOCK_STREAM, 0);
+    const int socket_fd = socket(AF_INET, SOCK_STREAM, 0);
 
-    if (_socket_fd < 0) {
+    if (socket_fd < 0) {
         LogErr() << "socket error" << GET_ERROR(errno);
         _is_ok = false;
         return ConnectionResult::SocketError;
     }
 
+    // Messages are small and each should go out right away instead of
+    // waiting for more to fill a segment.
+    const int enable = 1;
+    setsockopt(
+        socket_fd,
+        IPPROTO_TCP,
+        TCP_NODELAY,
+        reinterpret_cast<const char*>(&enable),
+        sizeof(enable));
+
+    {
+        // The socket of a previous attempt is not used anymore.
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_socket_fd != -1) {
+            close_socket();
+        }
+        _socket_fd = socket_fd;
+
+        // Once stop() has shut down the previous socket, don't connect anew.
+        if (_should_exit) {
+            _is_ok = false;
+            return ConnectionResult::SocketConnectionError;
+        }
+    }
+
     struct sockaddr_in remote_addr {};
     remote_addr.sin_family = AF_INET;
     remote_addr.sin_port = htons(_remote_port_number);
@@ -89,9 +123,31 @@ ConnectionResult TcpConnection::setup_port()
     }
 
     _is_ok = true;
+    _reconnect_delay = first_reconnect_delay;
     return ConnectionResult::Success;
 }
 
+void TcpConnection::close_socket()
+{
+#ifndef WINDOWS
+    close(_socket_fd);
+#else
+    closesocket(_socket_fd);
+#endif
+    _socket_fd = -1;
+}
+
+void TcpConnection::wait_before_reconnect()
+{
+    // In steps, so stop() doesn't have to wait for all of it.
+    const auto until = std::chrono::steady_clock::now() + _reconnect_delay;
+    while (!_should_exit && std::chrono::steady_clock::now() < until) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    _reconnect_delay = std::min(_reconnect_delay * 2, max_reconnect_delay);
+}
+
 void TcpConnection::start_recv_thread()
 {
     _recv_thread = new std::thread(&TcpConnection::receive, this);
@@ -101,19 +157,19 @@ ConnectionResult TcpConnection::stop()
 {
     _should_exit = true;
 
+    {
+        // The receive thread replaces the socket when reconnecting, it is
+        // only closed once the thread is done with it.
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_socket_fd != -1) {
+            // This interrupts a blocking connect or recv call.
 #ifndef WINDOWS
-    // This should interrupt a recv/recvfrom call.
-    shutdown(_socket_fd, SHUT_RDWR);
-
-    // But on Mac, closing is also needed to stop blocking recv/recvfrom.
-    close(_socket_fd);
+            shutdown(_socket_fd, SHUT_RDWR);
 #else
-    shutdown(_socket_fd, SD_BOTH);
-
-    closesocket(_socket_fd);
-
-    WSACleanup();
+            shutdown(_socket_fd, SD_BOTH);
 #endif
+        }
+    }
 
     if (_recv_thread) {
         _recv_thread->join();
@@ -121,6 +177,17 @@ ConnectionResult TcpConnection::stop()
         _recv_thread = nullptr;
     }
 
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_socket_fd != -1) {
+            close_socket();
+        }
+    }
+
+#ifdef WINDOWS
+    WSACleanup();
+#endif
+
     // We need to stop this after stopping the receive thread, otherwise
     // it can happen that we interfere with the parsing of a message.
     stop_mavlink_receiver();
@@ -129,6 +196,22 @@ ConnectionResult TcpConnection::stop()
 }
 
 bool TcpConnection::send_message(const mavlink_message_t& message)
+{
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+
+    // TODO: remove this assert again
+    assert(buffer_len <= MAVLINK_MAX_PACKET_LEN);
+
+    return send_buffer(buffer, buffer_len);
+}
+
+bool TcpConnection::send_serialized(const std::shared_ptr<const SerializedMessage>& serialized)
+{
+    return send_buffer(serialized->data(), serialized->length());
+}
+
+bool TcpConnection::send_buffer(const uint8_t* buffer, uint16_t buffer_len)
 {
     if (_remote_ip.empty()) {
         LogErr() << "Remote IP unknown";
@@ -147,15 +230,12 @@ bool TcpConnection::send_message(const mavlink_message_t& message)
 
     dest_addr.sin_port = htons(_remote_port_number);
 
-    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
-    uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
-
-    // TODO: remove this assert again
-    assert(buffer_len <= MAVLINK_MAX_PACKET_LEN);
+    // Messages can be sent from several threads at once, they must not interleave.
+    std::lock_guard<std::mutex> lock(_mutex);
 
     const auto send_len = sendto(
         _socket_fd,
-        reinterpret_cast<char*>(buffer),
+        reinterpret_cast<const char*>(buffer),
         buffer_len,
         0,
         reinterpret_cast<const sockaddr*>(&dest_addr),
@@ -176,9 +256,12 @@ void TcpConnection::receive()
 
     while (!_should_exit) {
         if (!_is_ok) {
-            LogErr() << "TCP receive error, trying to reconnect...";
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-            setup_port();
+            LogErr() << "TCP receive error, trying to reconnect in "
+                     << _reconnect_delay.count() << " ms...";
+            wait_before_reconnect();
+            if (_should_exit || setup_port() != ConnectionResult::Success) {
+                continue;
+            }
         }
 
         const auto recv_len = recv(_socket_fd, buffer, sizeof(buffer), 0);
@@ -191,8 +274,8 @@ void TcpConnection::receive()
         }
 
         if (recv_len < 0) {
-            // This happens on desctruction when close(_socket_fd) is called,
-            // therefore be quiet.
+            // This happens on destruction when shutdown is called on the
+            // socket, therefore be quiet.
             // LogErr() << "recvfrom error: " << GET_ERROR(errno);
             // Something went wrong, we should try to re-connect in next iteration.
             _is_ok = false;
@@ -2,6 +2,7 @@
 
 #include <mutex>
 #include <atomic>
+#include <chrono>
 #include "connection.h"
 #include <sys/types.h>
 #ifndef WINDOWS
@@ -26,6 +27,7 @@ public:
     ConnectionResult stop() override;
 
     bool send_message(const mavlink_message_t& message) override;
+    bool send_serialized(const std::shared_ptr<const SerializedMessage>& serialized) override;
 
     // Non-copyable
     TcpConnection(const TcpConnection&) = delete;
@@ -36,16 +38,24 @@ private:
     void start_recv_thread();
     int resolve_address(const std::string& ip_address, int port, struct sockaddr_in* addr);
     void receive();
+    void close_socket();
+    void wait_before_reconnect();
+    bool send_buffer(const uint8_t* buffer, uint16_t buffer_len);
 
     std::string _remote_ip = {};
     int _remote_port_number;
 
     std::mutex _mutex = {};
+    // Guarded by _mutex. Once started, only the receive thread replaces it,
+    // so that thread can use it without the lock.
     int _socket_fd = -1;
 
     std::thread* _recv_thread = nullptr;
     std::atomic_bool _should_exit;
     std::atomic_bool _is_ok{false};
+
+    // Only used by the receive thread once started.
+    std::chrono::milliseconds _reconnect_delay{100};
 };
 
 } // namespace mavsdk
@@ -0,0 +1,492 @@
+#include "tcp_server_connection.h"
+#include "global_include.h"
+#include "log.h"
+
+#ifdef WINDOWS
+#include <winsock2.h>
+#include <Ws2tcpip.h>
+#undef SOCKET_ERROR // conflicts with ConnectionResult::SocketError
+#ifndef MINGW
+#pragma comment(lib, "Ws2_32.lib") // Without this, Ws2_32.lib is not included in static library.
+#endif
+#else
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h> // for close()
+#endif
+
+#include <algorithm>
+#include <deque>
+
+#ifdef WINDOWS
+#define GET_ERROR() WSAGetLastError()
+#else
+#define GET_ERROR() strerror(errno)
+#endif
+
+namespace mavsdk {
+
+namespace {
+
+// Roughly a second of telemetry for a busy vehicle. Once a client is that
+// far behind, new messages for it are dropped.
+constexpr std::size_t max_queued_bytes_per_client = 256 * 1024;
+
+#if defined(MSG_NOSIGNAL)
+// A client going away must not kill us with SIGPIPE.
+constexpr int send_flags = MSG_NOSIGNAL;
+#else
+constexpr int send_flags = 0;
+#endif
+
+bool set_non_blocking(int fd)
+{
+#ifdef WINDOWS
+    u_long mode = 1;
+    return ioctlsocket(fd, FIONBIO, &mode) == 0;
+#else
+    const int flags = fcntl(fd, F_GETFL, 0);
+    return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1;
+#endif
+}
+
+void close_socket(int fd)
+{
+#ifdef WINDOWS
+    closesocket(fd);
+#else
+    close(fd);
+#endif
+}
+
+bool would_block()
+{
+#ifdef WINDOWS
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EINTR;
+#endif
+}
+
+int poll_sockets(std::vector<struct pollfd>& fds, int timeout_ms)
+{
+#ifdef WINDOWS
+    return WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), timeout_ms);
+#else
+    return poll(fds.data(), fds.size(), timeout_ms);
+#endif
+}
+
+} // namespace
+
+struct TcpServerConnection::Client {
+    int fd{-1};
+    std::string address{};
+
+    // Every client is a stream of its own, so it can't share the parser
+    // state with the others.
+    MAVLinkReceiver receiver{};
+
+    // Guarded by _clients_mutex, tx_offset is how much of the first
+    // message was written already.
+    std::deque<std::shared_ptr<const SerializedMessage>> tx_queue{};
+    std::size_t tx_offset{0};
+    std::size_t tx_queued_bytes{0};
+    unsigned num_dropped{0};
+};
+
+TcpServerConnection::TcpServerConnection(
+    Connection::receiver_callback_t receiver_callback,
+    const std::string& local_ip,
+    int local_port) :
+    Connection(receiver_callback),
+    _local_ip(local_ip),
+    _local_port_number(local_port)
+{}
+
+TcpServerConnection::~TcpServerConnection()
+{
+    // If no one explicitly called stop before, we should at least do it.
+    stop();
+}
+
+ConnectionResult TcpServerConnection::start()
+{
+    // The clients have a receiver each, the one of the connection is not used.
+    ConnectionResult ret = setup_port();
+    if (ret != ConnectionResult::Success) {
+        return ret;
+    }
+
+    start_io_thread();
+
+    return ConnectionResult::Success;
+}
+
+ConnectionResult TcpServerConnection::setup_port()
+{
+#ifdef WINDOWS
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        LogErr() << "Error: Winsock failed, error: " << WSAGetLastError();
+        return ConnectionResult::SocketError;
+    }
+#endif
+
+    _listen_fd = static_cast<int>(socket(AF_INET, SOCK_STREAM, 0));
+    if (_listen_fd < 0) {
+        LogErr() << "socket error: " << GET_ERROR();
+        return ConnectionResult::SocketError;
+    }
+
+    // Otherwise a restart has to wait until the connections of before timed out.
+    const int enable = 1;
+    setsockopt(
+        _listen_fd,
+        SOL_SOCKET,
+        SO_REUSEADDR,
+        reinterpret_cast<const char*>(&enable),
+        sizeof(enable));
+
+    struct sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(_local_port_number));
+    if (_local_ip.empty()) {
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    } else {
+        inet_pton(AF_INET, _local_ip.c_str(), &addr.sin_addr);
+    }
+
+    if (bind(_listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        LogErr() << "bind error: " << GET_ERROR();
+        return ConnectionResult::BindError;
+    }
+
+    if (listen(_listen_fd, SOMAXCONN) != 0 || !set_non_blocking(_listen_fd)) {
+        LogErr() << "listen error: " << GET_ERROR();
+        return ConnectionResult::SocketError;
+    }
+
+    socklen_t addr_len = sizeof(addr);
+    if (getsockname(_listen_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len) == 0) {
+        _local_port_number = ntohs(addr.sin_port);
+    }
+
+    _wake_up_fd = static_cast<int>(socket(AF_INET, SOCK_DGRAM, 0));
+    struct sockaddr_in wake_up_addr {};
+    wake_up_addr.sin_family = AF_INET;
+    wake_up_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t wake_up_addr_len = sizeof(wake_up_addr);
+    if (_wake_up_fd < 0 ||
+        bind(_wake_up_fd, reinterpret_cast<sockaddr*>(&wake_up_addr), sizeof(wake_up_addr)) !=
+            0 ||
+        getsockname(_wake_up_fd, reinterpret_cast<sockaddr*>(&wake_up_addr), &wake_up_addr_len) !=
+            0 ||
+        connect(_wake_up_fd, reinterpret_cast<sockaddr*>(&wake_up_addr), wake_up_addr_len) != 0 ||
+        !set_non_blocking(_wake_up_fd)) {
+        LogErr() << "wake up socket error: " << GET_ERROR();
+        return ConnectionResult::SocketError;
+    }
+
+    LogInfo() << "Waiting for TCP clients on port " << _local_port_number;
+    return ConnectionResult::Success;
+}
+
+void TcpServerConnection::start_io_thread()
+{
+    _io_thread = new std::thread(&TcpServerConnection::process_io, this);
+}
+
+ConnectionResult TcpServerConnection::stop()
+{
+    _should_exit = true;
+    wake_up_io_thread();
+
+    if (_io_thread) {
+        _io_thread->join();
+        delete _io_thread;
+        _io_thread = nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_clients_mutex);
+        for (auto& client : _clients) {
+            close_socket(client->fd);
+        }
+        _clients.clear();
+    }
+
+    for (int* fd : {&_listen_fd, &_wake_up_fd}) {
+        if (*fd != -1) {
+            close_socket(*fd);
+            *fd = -1;
+        }
+    }
+
+#ifdef WINDOWS
+    WSACleanup();
+#endif
+
+    return ConnectionResult::Success;
+}
+
+unsigned TcpServerConnection::get_num_clients() const
+{
+    std::lock_guard<std::mutex> lock(_clients_mutex);
+    return static_cast<unsigned>(_clients.size());
+}
+
+bool TcpServerConnection::send_message(const mavlink_message_t& message)
+{
+    // The clients queue it, so it's packed once and shared.
+    return send_serialized(std::make_shared<SerializedMessage>(message));
+}
+
+bool TcpServerConnection::send_serialized(
+    const std::shared_ptr<const SerializedMessage>& serialized)
+{
+    bool should_wake_up = false;
+    {
+        std::lock_guard<std::mutex> lock(_clients_mutex);
+
+        for (auto& client : _clients) {
+            if (client->tx_queued_bytes + serialized->length() > max_queued_bytes_per_client) {
+                if (client->num_dropped++ == 0) {
+                    LogWarn() << "TCP client " << client->address
+                              << " can't keep up, dropping messages";
+                }
+                continue;
+            }
+
+            std::size_t num_sent = 0;
+            if (client->tx_queue.empty()) {
+                // Nothing waiting, so it can go out right away.
+                const auto send_len = send(
+                    client->fd,
+                    reinterpret_cast<const char*>(serialized->data()),
+                    serialized->length(),
+                    send_flags);
+                num_sent = send_len > 0 ? static_cast<std::size_t>(send_len) : 0;
+                if (num_sent == serialized->length()) {
+                    continue;
+                }
+                // The rest is written by the I/O thread once possible. If the
+                // client is gone, the I/O thread finds out when reading.
+                should_wake_up = true;
+            }
+
+            client->tx_queue.push_back(serialized);
+            client->tx_offset += num_sent;
+            client->tx_queued_bytes += serialized->length() - num_sent;
+        }
+    }
+
+    if (should_wake_up) {
+        wake_up_io_thread();
+    }
+
+    // Nobody being connected is not an error, that's the normal state of a server.
+    return true;
+}
+
+void TcpServerConnection::wake_up_io_thread()
+{
+    if (_wake_up_fd == -1) {
+        return;
+    }
+    const char wake_up = 0;
+    // If this fails, there are plenty of wake ups waiting already.
+    send(_wake_up_fd, &wake_up, 1, 0);
+}
+
+void TcpServerConnection::process_io()
+{
+    std::vector<struct pollfd> fds;
+
+    while (!_should_exit) {
+        fds.resize(2);
+        fds[0].fd = _listen_fd;
+        fds[0].events = POLLIN;
+        fds[1].fd = _wake_up_fd;
+        fds[1].events = POLLIN;
+        {
+            std::lock_guard<std::mutex> lock(_clients_mutex);
+            for (const auto& client : _clients) {
+                struct pollfd client_fd {};
+                client_fd.fd = client->fd;
+                client_fd.events = POLLIN;
+                if (!client->tx_queue.empty()) {
+                    client_fd.events |= POLLOUT;
+                }
+                fds.push_back(client_fd);
+            }
+        }
+        for (auto& fd : fds) {
+            fd.revents = 0;
+        }
+
+        if (poll_sockets(fds, 1000) < 0) {
+            if (!would_block()) {
+                LogErr() << "poll failure: " << GET_ERROR();
+            }
+            continue;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            char drain[64];
+            while (recv(_wake_up_fd, drain, sizeof(drain), 0) > 0) {
+            }
+        }
+
+        // Only this thread changes the clients, so they still match the fds.
+        std::vector<std::size_t> gone;
+        for (std::size_t i = 2; i < fds.size(); ++i) {
+            Client& client = *_clients[i - 2];
+            bool is_ok = true;
+
+            if (fds[i].revents & POLLOUT) {
+                std::lock_guard<std::mutex> lock(_clients_mutex);
+                is_ok = write_queued(client);
+            }
+            if (is_ok && (fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                is_ok = receive_from(client);
+            }
+            if (!is_ok) {
+                gone.push_back(i - 2);
+            }
+        }
+
+        if (!gone.empty()) {
+            std::lock_guard<std::mutex> lock(_clients_mutex);
+            // From the back, so the indices stay valid.
+            for (auto it = gone.rbegin(); it != gone.rend(); ++it) {
+                LogInfo() << "TCP client " << _clients[*it]->address << " disconnected";
+                close_socket(_clients[*it]->fd);
+                _clients.erase(_clients.begin() + static_cast<std::ptrdiff_t>(*it));
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            accept_clients();
+        }
+    }
+}
+
+void TcpServerConnection::accept_clients()
+{
+    while (true) {
+        struct sockaddr_in addr {};
+        socklen_t addr_len = sizeof(addr);
+        const int fd =
+            static_cast<int>(accept(_listen_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len));
+        if (fd < 0) {
+            if (!would_block()) {
+                LogErr() << "accept error: " << GET_ERROR();
+            }
+            return;
+        }
+
+        // Messages are small and each should go out right away instead of
+        // waiting for more to fill a segment.
+        const int enable = 1;
+        setsockopt(
+            fd, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&enable), sizeof(enable));
+#if defined(SO_NOSIGPIPE)
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif
+        if (!set_non_blocking(fd)) {
+            LogErr() << "Could not make TCP client non-blocking: " << GET_ERROR();
+            close_socket(fd);
+            continue;
+        }
+
+        std::unique_ptr<Client> client{new Client()};
+        client->fd = fd;
+        char ip[INET_ADDRSTRLEN]{};
+        inet_ntop(AF_INET, &addr.sin_addr, ip, sizeof(ip));
+        client->address = std::string(ip) + ":" + std::to_string(ntohs(addr.sin_port));
+        LogInfo() << "TCP client connected from " << client->address;
+
+        std::lock_guard<std::mutex> lock(_clients_mutex);
+        _clients.push_back(std::move(client));
+    }
+}
+
+bool TcpServerConnection::receive_from(Client& client)
+{
+    char buffer[4096];
+    const auto recv_len = recv(client.fd, buffer, sizeof(buffer), 0);
+
+    if (recv_len == 0) {
+        return false;
+    }
+    if (recv_len < 0) {
+        return would_block();
+    }
+
+    client.receiver.set_new_datagram(buffer, static_cast<unsigned>(recv_len));
+    while (client.receiver.parse_message()) {
+        receive_message(client.receiver.get_last_message());
+    }
+    return true;
+}
+
+bool TcpServerConnection::write_queued(Client& client)
+{
+    while (!client.tx_queue.empty()) {
+#ifdef WINDOWS
+        const auto& front = client.tx_queue.front();
+        const auto send_len = send(
+            client.fd,
+            reinterpret_cast<const char*>(front->data()) + client.tx_offset,
+            static_cast<int>(front->length() - client.tx_offset),
+            send_flags);
+#else
+        // Everything queued goes out with one call.
+        constexpr std::size_t max_iovecs = 64;
+        struct iovec iov[max_iovecs];
+        std::size_t num_iovecs = 0;
+        for (const auto& serialized : client.tx_queue) {
+            if (num_iovecs == max_iovecs) {
+                break;
+            }
+            const std::size_t offset = (num_iovecs == 0) ? client.tx_offset : 0;
+            iov[num_iovecs].iov_base = const_cast<uint8_t*>(serialized->data()) + offset;
+            iov[num_iovecs].iov_len = serialized->length() - offset;
+            ++num_iovecs;
+        }
+
+        struct msghdr msg {};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = num_iovecs;
+        const auto send_len = sendmsg(client.fd, &msg, send_flags);
+#endif
+
+        if (send_len < 0) {
+            return would_block();
+        }
+
+        // Drop what was written completely and remember how far the next one got.
+        std::size_t num_written = static_cast<std::size_t>(send_len);
+        client.tx_queued_bytes -= num_written;
+        while (num_written > 0) {
+            const std::size_t remaining = client.tx_queue.front()->length() - client.tx_offset;
+            if (num_written < remaining) {
+                client.tx_offset += num_written;
+                return true;
+            }
+            num_written -= remaining;
+            client.tx_offset = 0;
+            client.tx_queue.pop_front();
+        }
+    }
+    return true;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "connection.h"
+
+namespace mavsdk {
+
+// Listens for TCP clients, e.g. ground stations or analysis tools, and
+// talks to all of them at once. Everything sent goes out to every client,
+// each with a queue of its own so a slow client doesn't hold up the others.
+// Messages for a client which can't keep up are dropped once its queue is
+// full.
+class TcpServerConnection : public Connection {
+public:
+    explicit TcpServerConnection(
+        Connection::receiver_callback_t receiver_callback,
+        const std::string& local_ip,
+        int local_port);
+    ~TcpServerConnection();
+    ConnectionResult start() override;
+    ConnectionResult stop() override;
+
+    bool send_message(const mavlink_message_t& message) override;
+    bool send_serialized(const std::shared_ptr<const SerializedMessage>& serialized) override;
+
+    // The port listened on, which is picked by the system if started with 0.
+    int get_local_port() const { return _local_port_number; }
+
+    unsigned get_num_clients() const;
+
+    // Non-copyable
+    TcpServerConnection(const TcpServerConnection&) = delete;
+    const TcpServerConnection& operator=(const TcpServerConnection&) = delete;
+
+private:
+    struct Client;
+
+    ConnectionResult setup_port();
+    void start_io_thread();
+    void process_io();
+    void accept_clients();
+    bool receive_from(Client& client);
+    bool write_queued(Client& client);
+    void wake_up_io_thread();
+
+    const std::string _local_ip;
+    std::atomic<int> _local_port_number;
+
+    int _listen_fd{-1};
+    // A UDP socket sending to itself, to wake up poll() when there is
+    // something new to write.
+    int _wake_up_fd{-1};
+
+    mutable std::mutex _clients_mutex{};
+    // Only the I/O thread adds and removes clients, and only it reads from them.
+    std::vector<std::unique_ptr<Client>> _clients{};
+
+    std::thread* _io_thread{nullptr};
+    std::atomic_bool _should_exit{false};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,220 @@
+#include "tcp_server_connection.h"
+#include "tcp_connection.h"
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+mavlink_message_t make_heartbeat(uint8_t sysid)
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(
+        sysid, MAV_COMP_ID_AUTOPILOT1, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, 0);
+    return message;
+}
+
+int connect_client(int port)
+{
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    return fd;
+}
+
+template<typename Predicate> bool wait_until(Predicate predicate)
+{
+    for (unsigned i = 0; i < 5000 && !predicate(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return predicate();
+}
+
+} // namespace
+
+TEST(TcpServerConnection, FansOutToManyClients)
+{
+    constexpr unsigned num_clients = 100;
+    constexpr unsigned num_rounds = 200;
+
+    std::atomic<unsigned> num_received{0};
+    TcpServerConnection server(
+        [&num_received](mavlink_message_t&, Connection*) { ++num_received; }, "127.0.0.1", 0);
+    ASSERT_EQ(server.start(), ConnectionResult::Success);
+    ASSERT_NE(server.get_local_port(), 0);
+
+    std::vector<int> clients;
+    for (unsigned i = 0; i < num_clients; ++i) {
+        const int fd = connect_client(server.get_local_port());
+        ASSERT_GE(fd, 0);
+        clients.push_back(fd);
+    }
+    ASSERT_TRUE(wait_until([&]() { return server.get_num_clients() == num_clients; }));
+
+    // Every client talks to us.
+    for (unsigned i = 0; i < num_clients; ++i) {
+        const auto message = make_heartbeat(static_cast<uint8_t>(i + 1));
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        const auto length = mavlink_msg_to_send_buffer(buffer, &message);
+        ASSERT_EQ(send(clients[i], buffer, length, 0), static_cast<ssize_t>(length));
+    }
+    EXPECT_TRUE(wait_until([&]() { return num_received == num_clients; }));
+
+    // And we talk to every client, each gets every message whole.
+    const auto message = make_heartbeat(245);
+    uint8_t expected[MAVLINK_MAX_PACKET_LEN];
+    const std::size_t length = mavlink_msg_to_send_buffer(expected, &message);
+
+    std::vector<struct pollfd> fds(num_clients);
+    for (unsigned round = 0; round < num_rounds; ++round) {
+        std::vector<std::size_t> num_read(num_clients, 0);
+        unsigned num_complete = 0;
+
+        ASSERT_TRUE(server.send_message(message));
+
+        while (num_complete < num_clients) {
+            for (unsigned i = 0; i < num_clients; ++i) {
+                fds[i].fd = (num_read[i] < length) ? clients[i] : -1;
+                fds[i].events = POLLIN;
+                fds[i].revents = 0;
+            }
+            ASSERT_GT(poll(fds.data(), fds.size(), 1000), 0);
+
+            for (unsigned i = 0; i < num_clients; ++i) {
+                if (!(fds[i].revents & POLLIN)) {
+                    continue;
+                }
+                uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+                const auto recv_len = recv(clients[i], buffer, length - num_read[i], 0);
+                ASSERT_GT(recv_len, 0);
+                EXPECT_TRUE(std::equal(buffer, buffer + recv_len, expected + num_read[i]));
+                num_read[i] += static_cast<std::size_t>(recv_len);
+                if (num_read[i] == length) {
+                    ++num_complete;
+                }
+            }
+        }
+    }
+
+    for (const int fd : clients) {
+        close(fd);
+    }
+    EXPECT_TRUE(wait_until([&]() { return server.get_num_clients() == 0; }));
+    server.stop();
+}
+
+TEST(TcpServerConnection, SlowClientDoesNotHoldUpOthers)
+{
+    constexpr unsigned num_messages = 100000;
+
+    TcpServerConnection server([](mavlink_message_t&, Connection*) {}, "127.0.0.1", 0);
+    ASSERT_EQ(server.start(), ConnectionResult::Success);
+
+    // Never reads anything.
+    const int slow_client = connect_client(server.get_local_port());
+    const int client = connect_client(server.get_local_port());
+    ASSERT_GE(slow_client, 0);
+    ASSERT_GE(client, 0);
+    ASSERT_TRUE(wait_until([&]() { return server.get_num_clients() == 2; }));
+
+    const auto message = make_heartbeat(245);
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const std::size_t length = mavlink_msg_to_send_buffer(buffer, &message);
+
+    std::atomic<std::size_t> num_bytes_read{0};
+    std::atomic<bool> should_exit{false};
+    std::thread reader([&]() {
+        char chunk[16384];
+        while (!should_exit) {
+            struct pollfd fds[1];
+            fds[0].fd = client;
+            fds[0].events = POLLIN;
+            fds[0].revents = 0;
+            if (poll(fds, 1, 100) > 0) {
+                const auto recv_len = recv(client, chunk, sizeof(chunk), 0);
+                if (recv_len > 0) {
+                    num_bytes_read += static_cast<std::size_t>(recv_len);
+                }
+            }
+        }
+    });
+
+    // Far more than the slow client can take, it runs full while the other
+    // one gets everything.
+    for (unsigned i = 0; i < num_messages; ++i) {
+        EXPECT_TRUE(server.send_message(message));
+        if (i % 100 == 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+    EXPECT_TRUE(wait_until([&]() { return num_bytes_read == num_messages * length; }));
+    EXPECT_EQ(num_bytes_read, num_messages * length);
+
+    should_exit = true;
+    reader.join();
+
+    // What was queued for the slow client is capped, the rest was dropped
+    // for it. Reading now only gets what made it into its queue and socket.
+    std::size_t num_bytes_read_slowly = 0;
+    for (;;) {
+        struct pollfd fds[1];
+        fds[0].fd = slow_client;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        if (poll(fds, 1, 200) <= 0) {
+            break;
+        }
+        char chunk[16384];
+        const auto recv_len = recv(slow_client, chunk, sizeof(chunk), 0);
+        if (recv_len <= 0) {
+            break;
+        }
+        num_bytes_read_slowly += static_cast<std::size_t>(recv_len);
+    }
+    EXPECT_GT(num_bytes_read_slowly, 0u);
+    EXPECT_LT(num_bytes_read_slowly, num_messages * length);
+    close(client);
+    close(slow_client);
+    server.stop();
+}
+
+TEST(TcpServerConnection, ClientReconnectsWhenServerIsBack)
+{
+    auto server = std::make_shared<TcpServerConnection>(
+        [](mavlink_message_t&, Connection*) {}, "127.0.0.1", 0);
+    ASSERT_EQ(server->start(), ConnectionResult::Success);
+    const int port = server->get_local_port();
+
+    TcpConnection client([](mavlink_message_t&, Connection*) {}, "127.0.0.1", port);
+    ASSERT_EQ(client.start(), ConnectionResult::Success);
+    ASSERT_TRUE(wait_until([&]() { return server->get_num_clients() == 1; }));
+
+    server->stop();
+    server = std::make_shared<TcpServerConnection>(
+        [](mavlink_message_t&, Connection*) {}, "127.0.0.1", port);
+    ASSERT_EQ(server->start(), ConnectionResult::Success);
+    EXPECT_TRUE(wait_until([&]() { return server->get_num_clients() == 1; }));
+
+    client.stop();
+    server->stop();
+}
@@ -0,0 +1,133 @@
+#include "tlog_reader.h"
+#include "log.h"
+#include "mavlink_include.h"
+
+#include <fstream>
+#include <iterator>
+
+#ifndef WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mavsdk {
+
+// The frame length is not stored in a tlog, so it has to be taken from the
+// MAVLink header. A MAVLink 1 frame is the magic byte, its core header and
+// the checksum.
+static constexpr std::size_t mavlink1_num_non_payload_bytes =
+    1 + MAVLINK_CORE_HEADER_MAVLINK1_LEN + MAVLINK_NUM_CHECKSUM_BYTES;
+
+TlogReader::~TlogReader()
+{
+    close();
+}
+
+bool TlogReader::open(const std::string& path)
+{
+    close();
+
+#ifndef WINDOWS
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LogErr() << "Could not open " << path;
+        return false;
+    }
+
+    struct stat file_stat {};
+    if (fstat(fd, &file_stat) != 0) {
+        LogErr() << "Could not get size of " << path;
+        ::close(fd);
+        return false;
+    }
+
+    _size = std::size_t(file_stat.st_size);
+    if (_size > 0) {
+        void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            LogErr() << "Could not map " << path;
+            ::close(fd);
+            _size = 0;
+            return false;
+        }
+        // We read it from start to end.
+        madvise(data, _size, MADV_SEQUENTIAL);
+        _data = static_cast<const uint8_t*>(data);
+        _is_mapped = true;
+    }
+    // The mapping stays valid without the file descriptor.
+    ::close(fd);
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        LogErr() << "Could not open " << path;
+        return false;
+    }
+    _contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    _data = _contents.data();
+    _size = _contents.size();
+#endif
+
+    _offset = 0;
+    return true;
+}
+
+void TlogReader::close()
+{
+#ifndef WINDOWS
+    if (_is_mapped) {
+        munmap(const_cast<uint8_t*>(_data), _size);
+        _is_mapped = false;
+    }
+#endif
+    _contents.clear();
+    _data = nullptr;
+    _size = 0;
+    _offset = 0;
+}
+
+bool TlogReader::next(Frame& frame)
+{
+    // Timestamp plus at least the first three bytes of the header.
+    if (_offset + sizeof(uint64_t) + 3 > _size) {
+        return false;
+    }
+
+    const uint8_t* p = _data + _offset;
+
+    uint64_t time_us = 0;
+    for (std::size_t i = 0; i < sizeof(uint64_t); ++i) {
+        time_us = (time_us << 8) | p[i];
+    }
+    p += sizeof(uint64_t);
+
+    const std::size_t payload_length = p[1];
+    std::size_t length;
+    if (p[0] == MAVLINK_STX) {
+        length = payload_length + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+        if (p[2] & MAVLINK_IFLAG_SIGNED) {
+            length += MAVLINK_SIGNATURE_BLOCK_LEN;
+        }
+    } else if (p[0] == MAVLINK_STX_MAVLINK1) {
+        length = payload_length + mavlink1_num_non_payload_bytes;
+    } else {
+        LogErr() << "Invalid frame in log at offset " << _offset;
+        return false;
+    }
+
+    if (_offset + sizeof(uint64_t) + length > _size) {
+        // Truncated at the end, e.g. because the recording was not stopped.
+        return false;
+    }
+
+    frame.time_us = time_us;
+    frame.data = p;
+    frame.length = length;
+
+    _offset += sizeof(uint64_t) + length;
+    return true;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mavsdk {
+
+// Reads raw MAVLink frames from a telemetry log (tlog) as written by
+// TlogRecorder, QGroundControl or MAVProxy.
+//
+// The file is memory mapped where possible, so frames are returned in place
+// without copying.
+class TlogReader {
+public:
+    TlogReader() = default;
+    ~TlogReader();
+
+    // Delete copy and move constructors and assign operators.
+    TlogReader(TlogReader const&) = delete;
+    TlogReader(TlogReader&&) = delete;
+    TlogReader& operator=(TlogReader const&) = delete;
+    TlogReader& operator=(TlogReader&&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    struct Frame {
+        uint64_t time_us;
+        const uint8_t* data;
+        std::size_t length;
+    };
+
+    // Returns false at the end of the log or if the rest is not valid.
+    bool next(Frame& frame);
+
+    // Goes back to the first frame.
+    void rewind() { _offset = 0; }
+
+    std::size_t size() const { return _size; }
+
+private:
+    const uint8_t* _data{nullptr};
+    std::size_t _size{0};
+    std::size_t _offset{0};
+
+    bool _is_mapped{false};
+    // Used instead if mapping is not available.
+    std::vector<uint8_t> _contents{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,100 @@
+#include "tlog_reader.h"
+#include "tlog_recorder.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+
+using namespace mavsdk;
+
+namespace {
+
+// Minimal MAVLink 2 frame: header, payload of the given length and checksum,
+// the content does not matter for the reader.
+std::size_t make_frame(uint8_t* data, uint8_t payload_length, bool is_signed, uint8_t fill)
+{
+    const std::size_t length = 12 + payload_length + (is_signed ? 13 : 0);
+    std::memset(data, fill, length);
+    data[0] = 0xFD;
+    data[1] = payload_length;
+    data[2] = is_signed ? 0x01 : 0x00;
+    return length;
+}
+
+} // namespace
+
+TEST(TlogReader, ReadsWhatWasRecorded)
+{
+    const std::string path = "tlog_reader_test.tlog";
+
+    {
+        TlogRecorder recorder;
+        ASSERT_TRUE(recorder.start(path));
+        for (uint8_t i = 0; i < 50; ++i) {
+            recorder.record(TlogRecorder::Direction::Incoming, [i](uint8_t* data) {
+                return make_frame(data, i, i % 5 == 0, i);
+            });
+        }
+        recorder.stop();
+    }
+
+    TlogReader reader;
+    ASSERT_TRUE(reader.open(path));
+
+    for (int pass = 0; pass < 2; ++pass) {
+        TlogReader::Frame frame{};
+        uint64_t last_time_us = 0;
+        for (uint8_t i = 0; i < 50; ++i) {
+            ASSERT_TRUE(reader.next(frame));
+            EXPECT_EQ(frame.length, 12 + i + ((i % 5 == 0) ? 13 : 0));
+            EXPECT_EQ(frame.data[0], 0xFD);
+            EXPECT_EQ(frame.data[1], i);
+            EXPECT_EQ(frame.data[frame.length - 1], i);
+            EXPECT_GE(frame.time_us, last_time_us);
+            last_time_us = frame.time_us;
+        }
+        EXPECT_FALSE(reader.next(frame));
+        reader.rewind();
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST(TlogReader, StopsAtTruncatedOrInvalidFrame)
+{
+    const std::string path = "tlog_reader_test_truncated.tlog";
+
+    uint8_t frame_data[64];
+    const std::size_t length = make_frame(frame_data, 20, false, 0x42);
+    const uint8_t timestamp[8] = {0, 0, 0, 0, 0, 0, 0x01, 0x00};
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    std::fwrite(timestamp, 1, sizeof(timestamp), file);
+    std::fwrite(frame_data, 1, length, file);
+    std::fwrite(timestamp, 1, sizeof(timestamp), file);
+    std::fwrite(frame_data, 1, length - 1, file);
+    std::fclose(file);
+
+    TlogReader reader;
+    ASSERT_TRUE(reader.open(path));
+    TlogReader::Frame frame{};
+    ASSERT_TRUE(reader.next(frame));
+    EXPECT_EQ(frame.time_us, 256);
+    EXPECT_EQ(frame.length, length);
+    EXPECT_FALSE(reader.next(frame));
+
+    // Garbage instead of a start byte.
+    file = std::fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    frame_data[0] = 0x00;
+    std::fwrite(timestamp, 1, sizeof(timestamp), file);
+    std::fwrite(frame_data, 1, length, file);
+    std::fclose(file);
+
+    ASSERT_TRUE(reader.open(path));
+    EXPECT_FALSE(reader.next(frame));
+
+    EXPECT_FALSE(reader.open("does_not_exist.tlog"));
+
+    std::remove(path.c_str());
+}
@@ -0,0 +1,145 @@
+#include "tlog_recorder.h"
+#include "log.h"
+
+#include <chrono>
+
+namespace mavsdk {
+
+// Writing in large chunks keeps the number of syscalls low, however, the
+// file should not lag behind too much either in case we crash.
+static constexpr std::size_t write_chunk_size = 1 << 20;
+static constexpr auto max_flush_interval = std::chrono::milliseconds(100);
+static constexpr auto idle_interval = std::chrono::milliseconds(1);
+
+TlogRecorder::TlogRecorder(std::size_t queue_capacity) :
+    _incoming(queue_capacity),
+    _outgoing(queue_capacity)
+{}
+
+TlogRecorder::~TlogRecorder()
+{
+    stop();
+}
+
+uint64_t TlogRecorder::now_us()
+{
+    return uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::system_clock::now().time_since_epoch())
+                        .count());
+}
+
+bool TlogRecorder::start(const std::string& path)
+{
+    if (_file != nullptr) {
+        LogErr() << "Already recording";
+        return false;
+    }
+
+    _file = std::fopen(path.c_str(), "wb");
+    if (_file == nullptr) {
+        LogErr() << "Could not open " << path << " for recording";
+        return false;
+    }
+    // We do our own buffering.
+    std::setvbuf(_file, nullptr, _IONBF, 0);
+
+    _buffer.reserve(write_chunk_size + sizeof(uint64_t) + max_frame_length);
+    _should_exit = false;
+    _write_thread = new std::thread(&TlogRecorder::write_thread, this);
+    return true;
+}
+
+void TlogRecorder::stop()
+{
+    if (_write_thread == nullptr) {
+        return;
+    }
+
+    _should_exit = true;
+    _write_thread->join();
+    delete _write_thread;
+    _write_thread = nullptr;
+
+    std::fclose(_file);
+    _file = nullptr;
+
+    if (_num_dropped > 0) {
+        LogWarn() << "Recording dropped " << num_dropped() << " messages";
+    }
+}
+
+void TlogRecorder::write_thread()
+{
+    auto last_flush = std::chrono::steady_clock::now();
+
+    while (!_should_exit) {
+        const bool got_frames = drain_queues();
+
+        const auto now = std::chrono::steady_clock::now();
+        if (_buffer.size() >= write_chunk_size ||
+            (!_buffer.empty() && now - last_flush >= max_flush_interval)) {
+            flush();
+            last_flush = now;
+        }
+
+        if (!got_frames) {
+            std::this_thread::sleep_for(idle_interval);
+        }
+    }
+
+    // Whatever was recorded before stop() is still written.
+    while (drain_queues()) {
+        if (_buffer.size() >= write_chunk_size) {
+            flush();
+        }
+    }
+    flush();
+}
+
+bool TlogRecorder::drain_queues()
+{
+    bool got_frames = false;
+
+    while (_buffer.size() < write_chunk_size) {
+        Frame* incoming = _incoming.front();
+        Frame* outgoing = _outgoing.front();
+
+        SpscQueue<Frame>* queue;
+        Frame* frame;
+        if (incoming != nullptr &&
+            (outgoing == nullptr || incoming->time_us <= outgoing->time_us)) {
+            queue = &_incoming;
+            frame = incoming;
+        } else if (outgoing != nullptr) {
+            queue = &_outgoing;
+            frame = outgoing;
+        } else {
+            break;
+        }
+
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            _buffer.push_back(uint8_t(frame->time_us >> shift));
+        }
+        _buffer.insert(_buffer.end(), frame->data, frame->data + frame->length);
+
+        queue->pop();
+        ++_num_written;
+        got_frames = true;
+    }
+
+    return got_frames;
+}
+
+void TlogRecorder::flush()
+{
+    if (_buffer.empty()) {
+        return;
+    }
+
+    if (std::fwrite(_buffer.data(), 1, _buffer.size(), _file) != _buffer.size()) {
+        LogErr() << "Writing recording failed";
+    }
+    _buffer.clear();
+}
+
+} // namespace mavsdk
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "spsc_queue.h"
+
+namespace mavsdk {
+
+// Records raw MAVLink frames to a file in the telemetry log (tlog) format
+// used by QGroundControl and MAVProxy: each frame is preceded by its time
+// as microseconds since the Unix epoch, as big-endian uint64.
+//
+// Frames are timestamped and copied into a lock-free queue per direction,
+// which is all that happens on the thread recording them. A writer thread
+// merges both queues by time and writes them to the file in large chunks.
+// If a queue is full, the frame is dropped and counted rather than blocking.
+//
+// Each queue must only be used by one thread at a time.
+class TlogRecorder {
+public:
+    enum class Direction { Incoming, Outgoing };
+
+    // Same as MAVLINK_MAX_PACKET_LEN, without depending on MAVLink here.
+    static constexpr std::size_t max_frame_length = 280;
+
+    struct Frame {
+        uint64_t time_us;
+        uint16_t length;
+        uint8_t data[max_frame_length];
+    };
+
+    explicit TlogRecorder(std::size_t queue_capacity = 8192);
+    ~TlogRecorder();
+
+    // Delete copy and move constructors and assign operators.
+    TlogRecorder(TlogRecorder const&) = delete;
+    TlogRecorder(TlogRecorder&&) = delete;
+    TlogRecorder& operator=(TlogRecorder const&) = delete;
+    TlogRecorder& operator=(TlogRecorder&&) = delete;
+
+    bool start(const std::string& path);
+    // Writes everything recorded so far and closes the file.
+    void stop();
+
+    // Records a frame which the function writes into the buffer it is given
+    // (of max_frame_length) and returns the length of. Returns false if the
+    // frame was dropped.
+    template<typename SerializeFunction>
+    bool record(Direction direction, SerializeFunction serialize)
+    {
+        auto& queue = (direction == Direction::Incoming) ? _incoming : _outgoing;
+        Frame* frame = queue.try_reserve();
+        if (frame == nullptr) {
+            _num_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        frame->time_us = now_us();
+        frame->length = static_cast<uint16_t>(serialize(frame->data));
+        queue.commit();
+        return true;
+    }
+
+    uint64_t num_written() const { return _num_written.load(std::memory_order_relaxed); }
+    uint64_t num_dropped() const { return _num_dropped.load(std::memory_order_relaxed); }
+
+private:
+    static uint64_t now_us();
+
+    void write_thread();
+    // Moves frames from the queues into the buffer, returns false if there
+    // were none.
+    bool drain_queues();
+    void flush();
+
+    SpscQueue<Frame> _incoming;
+    SpscQueue<Frame> _outgoing;
+
+    std::FILE* _file{nullptr};
+    std::vector<uint8_t> _buffer{};
+    std::thread* _write_thread{nullptr};
+    std::atomic<bool> _should_exit{false};
+
+    std::atomic<uint64_t> _num_written{0};
+    std::atomic<uint64_t> _num_dropped{0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,157 @@
+#include "tlog_recorder.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+struct Record {
+    uint64_t time_us;
+    std::vector<uint8_t> frame;
+};
+
+// Reads back a tlog with frames of the length given.
+std::vector<Record> read_tlog(const std::string& path, std::size_t frame_length)
+{
+    std::vector<Record> records;
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return records;
+    }
+
+    std::vector<uint8_t> bytes(sizeof(uint64_t) + frame_length);
+    while (std::fread(bytes.data(), 1, bytes.size(), file) == bytes.size()) {
+        Record record{};
+        record.time_us = 0;
+        for (std::size_t i = 0; i < sizeof(uint64_t); ++i) {
+            record.time_us = (record.time_us << 8) | bytes[i];
+        }
+        record.frame.assign(bytes.begin() + sizeof(uint64_t), bytes.end());
+        records.push_back(record);
+    }
+    std::fclose(file);
+    return records;
+}
+
+std::size_t serialize_counter(uint8_t* data, uint32_t counter, uint8_t direction)
+{
+    data[0] = 0xFD;
+    data[1] = direction;
+    std::memcpy(&data[2], &counter, sizeof(counter));
+    return 6;
+}
+
+} // namespace
+
+TEST(TlogRecorder, WritesFramesInOrder)
+{
+    const std::string path = "tlog_recorder_test_order.tlog";
+
+    TlogRecorder recorder;
+    ASSERT_TRUE(recorder.start(path));
+
+    for (uint32_t i = 0; i < 100; ++i) {
+        const auto direction =
+            (i % 2 == 0) ? TlogRecorder::Direction::Incoming : TlogRecorder::Direction::Outgoing;
+        EXPECT_TRUE(recorder.record(direction, [i, direction](uint8_t* data) {
+            return serialize_counter(data, i, uint8_t(direction));
+        }));
+    }
+    recorder.stop();
+
+    EXPECT_EQ(recorder.num_written(), 100);
+    EXPECT_EQ(recorder.num_dropped(), 0);
+
+    const auto records = read_tlog(path, 6);
+    ASSERT_EQ(records.size(), 100);
+    for (uint32_t i = 0; i < records.size(); ++i) {
+        EXPECT_EQ(records[i].frame[0], 0xFD);
+        if (i > 0) {
+            EXPECT_GE(records[i].time_us, records[i - 1].time_us);
+        }
+    }
+    // Both directions are merged by time, each keeps its own order.
+    uint32_t next_counter[2] = {0, 1};
+    for (const auto& record : records) {
+        uint32_t counter;
+        std::memcpy(&counter, &record.frame[2], sizeof(counter));
+        auto& expected = next_counter[record.frame[1]];
+        EXPECT_EQ(counter, expected);
+        expected += 2;
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST(TlogRecorder, DropsWhenFullWithoutBlocking)
+{
+    TlogRecorder recorder(4);
+
+    // Not started, so nothing drains the queue.
+    for (uint32_t i = 0; i < 10; ++i) {
+        recorder.record(TlogRecorder::Direction::Incoming, [i](uint8_t* data) {
+            return serialize_counter(data, i, 0);
+        });
+    }
+    EXPECT_EQ(recorder.num_dropped(), 6);
+}
+
+TEST(TlogRecorder, StressTenThousandPerSecond)
+{
+    const std::string path = "tlog_recorder_test_stress.tlog";
+
+    TlogRecorder recorder;
+    ASSERT_TRUE(recorder.start(path));
+
+    // Incoming and outgoing each at 5k messages per second for 2 seconds.
+    const unsigned rate_per_direction = 5000;
+    const unsigned num_per_direction = 2 * rate_per_direction;
+
+    auto produce = [&](TlogRecorder::Direction direction) {
+        const auto period = std::chrono::microseconds(1000000 / rate_per_direction);
+        auto next = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < num_per_direction; ++i) {
+            recorder.record(direction, [i, direction](uint8_t* data) {
+                const std::size_t length = serialize_counter(data, i, uint8_t(direction));
+                // Pad it to the size of a typical telemetry message.
+                std::memset(&data[length], 0x55, 40 - length);
+                return std::size_t(40);
+            });
+
+            next += period;
+            std::this_thread::sleep_until(next);
+        }
+    };
+
+    std::thread incoming(produce, TlogRecorder::Direction::Incoming);
+    std::thread outgoing(produce, TlogRecorder::Direction::Outgoing);
+    incoming.join();
+    outgoing.join();
+    recorder.stop();
+
+    EXPECT_EQ(recorder.num_dropped(), 0);
+    EXPECT_EQ(recorder.num_written(), 2 * num_per_direction);
+
+    // Every frame is read back as recorded, each direction in its own order.
+    const auto records = read_tlog(path, 40);
+    ASSERT_EQ(records.size(), 2 * num_per_direction);
+    uint32_t next_counter[2] = {0, 0};
+    for (const auto& record : records) {
+        ASSERT_EQ(record.frame[0], 0xFD);
+        ASSERT_LT(record.frame[1], 2);
+        uint32_t counter;
+        std::memcpy(&counter, &record.frame[2], sizeof(counter));
+        EXPECT_EQ(counter, next_counter[record.frame[1]]++);
+        EXPECT_EQ(std::count(record.frame.begin() + 6, record.frame.end(), 0x55), 34);
+    }
+    EXPECT_EQ(next_counter[0], num_per_direction);
+    EXPECT_EQ(next_counter[1], num_per_direction);
+
+    std::remove(path.c_str());
+}
@@ -1,6 +1,7 @@
 #include "udp_connection.h"
 #include "global_include.h"
 #include "log.h"
+#include "mavlink_router.h"
 
 #ifdef WINDOWS
 #include <winsock2.h>
@@ -45,9 +46,7 @@ UdpConnection::~UdpConnection()
 
 ConnectionResult UdpConnection::start()
 {
-    if (!start_mavlink_receiver()) {
-        return ConnectionResult::ConnectionsExhausted;
-    }
+    start_mavlink_receiver();
 
     ConnectionResult ret = setup_port();
     if (ret != ConnectionResult::Success) {
@@ -126,6 +125,16 @@ ConnectionResult UdpConnection::stop()
 }
 
 bool UdpConnection::send_message(const mavlink_message_t& message)
+{
+    return send_to_remotes(SerializedMessage(message));
+}
+
+bool UdpConnection::send_serialized(const std::shared_ptr<const SerializedMessage>& serialized)
+{
+    return send_to_remotes(*serialized);
+}
+
+bool UdpConnection::send_to_remotes(const SerializedMessage& serialized)
 {
     std::lock_guard<std::mutex> lock(_remote_mutex);
 
@@ -136,13 +145,58 @@ bool UdpConnection::send_message(const mavlink_message_t& message)
 
     // Some messages have a target system set which allows to send it only
     // on the matching link.
-    const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(message.msgid);
-    const uint8_t target_system_id =
-        (entry && (entry->flags & MAV_MSG_ENTRY_FLAG_HAVE_TARGET_SYSTEM) ?
-             reinterpret_cast<const uint8_t*>(message.payload64)[entry->target_system_ofs] :
-             0);
+    uint8_t target_system_id;
+    uint8_t target_component_id;
+    MAVLinkRouter::get_target(serialized.message(), target_system_id, target_component_id);
 
     bool send_successful = true;
+
+#if defined(LINUX)
+    // All remotes get the same bytes, so they are handed to the kernel in
+    // batches with one system call each instead of one per remote.
+    constexpr unsigned max_batch_size = 32;
+    struct sockaddr_in dest_addrs[max_batch_size];
+    struct mmsghdr messages[max_batch_size];
+    struct iovec iov {};
+    iov.iov_base = const_cast<uint8_t*>(serialized.data());
+    iov.iov_len = serialized.length();
+
+    auto remote = _remotes.begin();
+    while (remote != _remotes.end()) {
+        unsigned batch_size = 0;
+        for (; remote != _remotes.end() && batch_size < max_batch_size; ++remote) {
+            if (target_system_id != 0 && remote->system_id != target_system_id) {
+                continue;
+            }
+
+            dest_addrs[batch_size] = {};
+            dest_addrs[batch_size].sin_family = AF_INET;
+            dest_addrs[batch_size].sin_addr.s_addr = remote->address;
+            dest_addrs[batch_size].sin_port = htons(remote->port_number);
+
+            messages[batch_size] = {};
+            messages[batch_size].msg_hdr.msg_name = &dest_addrs[batch_size];
+            messages[batch_size].msg_hdr.msg_namelen = sizeof(dest_addrs[batch_size]);
+            messages[batch_size].msg_hdr.msg_iov = &iov;
+            messages[batch_size].msg_hdr.msg_iovlen = 1;
+            ++batch_size;
+        }
+
+        unsigned num_done = 0;
+        while (num_done < batch_size) {
+            const int num_sent =
+                sendmmsg(_socket_fd, &messages[num_done], batch_size - num_done, 0);
+            if (num_sent <= 0) {
+                // Skip the remote which failed, the others might still work.
+                LogErr() << "sendmmsg failure: " << GET_ERROR(errno);
+                send_successful = false;
+                ++num_done;
+                continue;
+            }
+            num_done += static_cast<unsigned>(num_sent);
+        }
+    }
+#else
     for (auto& remote : _remotes) {
         if (target_system_id != 0 && remote.system_id != target_system_id) {
             continue;
@@ -150,27 +204,24 @@ bool UdpConnection::send_message(const mavlink_message_t& message)
 
         struct sockaddr_in dest_addr {};
         dest_addr.sin_family = AF_INET;
-
-        inet_pton(AF_INET, remote.ip.c_str(), &dest_addr.sin_addr.s_addr);
+        dest_addr.sin_addr.s_addr = remote.address;
         dest_addr.sin_port = htons(remote.port_number);
 
-        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
-        uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
-
         const auto send_len = sendto(
             _socket_fd,
-            reinterpret_cast<char*>(buffer),
-            buffer_len,
+            reinterpret_cast<const char*>(serialized.data()),
+            serialized.length(),
             0,
             reinterpret_cast<const sockaddr*>(&dest_addr),
             sizeof(dest_addr));
 
-        if (send_len != buffer_len) {
+        if (send_len != serialized.length()) {
             LogErr() << "sendto failure: " << GET_ERROR(errno);
             send_successful = false;
             continue;
         }
     }
+#endif
 
     return send_successful;
 }
@@ -188,6 +239,7 @@ void UdpConnection::add_remote_with_remote_sysid(
     new_remote.ip = remote_ip;
     new_remote.port_number = remote_port;
     new_remote.system_id = remote_sysid;
+    inet_pton(AF_INET, remote_ip.c_str(), &new_remote.address);
 
     auto existing_remote =
         std::find_if(_remotes.begin(), _remotes.end(), [&new_remote](Remote& remote) {
@@ -246,6 +298,7 @@ void UdpConnection::receive()
                     new_remote.ip = inet_ntoa(src_addr.sin_addr);
                     new_remote.port_number = ntohs(src_addr.sin_port);
                     new_remote.system_id = sysid;
+                    new_remote.address = src_addr.sin_addr.s_addr;
 
                     auto existing_remote = std::find_if(
                         _remotes.begin(), _remotes.end(), [&new_remote](Remote& remote) {
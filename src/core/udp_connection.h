@@ -21,6 +21,7 @@ public:
     ConnectionResult stop() override;
 
     bool send_message(const mavlink_message_t& message) override;
+    bool send_serialized(const std::shared_ptr<const SerializedMessage>& serialized) override;
 
     void add_remote(const std::string& remote_ip, const int remote_port);
 
@@ -34,6 +35,8 @@ private:
 
     void receive();
 
+    bool send_to_remotes(const SerializedMessage& serialized);
+
     void add_remote_with_remote_sysid(
         const std::string& remote_ip, const int remote_port, const uint8_t remote_sysid);
 
@@ -44,6 +47,8 @@ private:
     struct Remote {
         std::string ip{};
         int port_number{0};
+        // Resolved once instead of for every message, in network byte order.
+        uint32_t address{0};
 
         bool operator==(const UdpConnection::Remote& other)
         {
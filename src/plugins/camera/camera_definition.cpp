@@ -1,33 +1,385 @@
 #include "global_include.h"
 #include "log.h"
 #include "camera_definition.h"
+#include <algorithm>
 
 namespace mavsdk {
 
+namespace {
+
+const char binary_magic[] = {'M', 'C', 'D', 'B'};
+// Bump whenever the binary layout changes so that cached files are parsed again.
+constexpr uint8_t binary_version = 2;
+
+// Values are kept in host byte order, in the binary they are little-endian like its framing.
+bool is_host_little_endian()
+{
+    const uint16_t one = 1;
+    uint8_t first_byte;
+    memcpy(&first_byte, &one, 1);
+    return first_byte == 1;
+}
+
+class BinaryWriter {
+public:
+    explicit BinaryWriter(std::string& binary) : _binary(binary) {}
+
+    void write_uint8(uint8_t value) { _binary.push_back(char(value)); }
+
+    void write_uint16(uint16_t value)
+    {
+        write_uint8(uint8_t(value & 0xff));
+        write_uint8(uint8_t(value >> 8));
+    }
+
+    void write_string(const std::string& value)
+    {
+        write_uint16(uint16_t(value.size()));
+        _binary.append(value);
+    }
+
+    void write_value(const MAVLinkParameters::ParamValue& value)
+    {
+        const uint8_t size = value_size(value);
+        if (size == 0) {
+            // Values without a type are kept that way.
+            write_uint8(0);
+            return;
+        }
+        write_uint8(uint8_t(value.get_mav_param_ext_type()));
+        char bytes[sizeof(MAVLinkParameters::ParamValue::custom_type_t)]{};
+        value.get_128_bytes(bytes);
+        if (!is_host_little_endian()) {
+            std::reverse(bytes, bytes + size);
+        }
+        _binary.append(bytes, size);
+    }
+
+private:
+    static uint8_t value_size(const MAVLinkParameters::ParamValue& value)
+    {
+        if (value.is_uint8() || value.is_int8()) {
+            return 1;
+        } else if (value.is_uint16() || value.is_int16()) {
+            return 2;
+        } else if (value.is_uint32() || value.is_int32() || value.is_float()) {
+            return 4;
+        } else if (value.is_uint64() || value.is_int64() || value.is_double()) {
+            return 8;
+        }
+        return 0;
+    }
+
+    std::string& _binary;
+};
+
+class BinaryReader {
+public:
+    BinaryReader(const char* data, std::size_t size) : _data(data), _size(size) {}
+
+    bool read_uint8(uint8_t& value)
+    {
+        if (_size < 1) {
+            return false;
+        }
+        value = uint8_t(_data[0]);
+        skip(1);
+        return true;
+    }
+
+    bool read_uint16(uint16_t& value)
+    {
+        uint8_t low;
+        uint8_t high;
+        if (!read_uint8(low) || !read_uint8(high)) {
+            return false;
+        }
+        value = uint16_t(low | (high << 8));
+        return true;
+    }
+
+    bool read_string(std::string& value)
+    {
+        uint16_t length;
+        if (!read_uint16(length) || _size < length) {
+            return false;
+        }
+        value.assign(_data, length);
+        skip(length);
+        return true;
+    }
+
+    bool read_value(MAVLinkParameters::ParamValue& value)
+    {
+        uint8_t type;
+        if (!read_uint8(type)) {
+            return false;
+        }
+        if (type == 0) {
+            value = MAVLinkParameters::ParamValue{};
+            return true;
+        }
+
+        std::size_t size;
+        switch (type) {
+            case MAV_PARAM_EXT_TYPE_UINT8:
+            case MAV_PARAM_EXT_TYPE_INT8:
+                size = 1;
+                break;
+            case MAV_PARAM_EXT_TYPE_UINT16:
+            case MAV_PARAM_EXT_TYPE_INT16:
+                size = 2;
+                break;
+            case MAV_PARAM_EXT_TYPE_UINT32:
+            case MAV_PARAM_EXT_TYPE_INT32:
+            case MAV_PARAM_EXT_TYPE_REAL32:
+                size = 4;
+                break;
+            case MAV_PARAM_EXT_TYPE_UINT64:
+            case MAV_PARAM_EXT_TYPE_INT64:
+            case MAV_PARAM_EXT_TYPE_REAL64:
+                size = 8;
+                break;
+            default:
+                return false;
+        }
+        if (_size < size) {
+            return false;
+        }
+
+        mavlink_param_ext_value_t ext_value{};
+        ext_value.param_type = type;
+        memcpy(ext_value.param_value, _data, size);
+        if (!is_host_little_endian()) {
+            std::reverse(ext_value.param_value, ext_value.param_value + size);
+        }
+        value.set_from_mavlink_param_ext_value(ext_value);
+        skip(size);
+        return true;
+    }
+
+    bool read_magic()
+    {
+        if (_size < sizeof(binary_magic) || memcmp(_data, binary_magic, sizeof(binary_magic))) {
+            return false;
+        }
+        skip(sizeof(binary_magic));
+        uint8_t version;
+        return read_uint8(version) && version == binary_version;
+    }
+
+    bool at_end() const { return _size == 0; }
+
+private:
+    void skip(std::size_t size)
+    {
+        _data += size;
+        _size -= size;
+    }
+
+    const char* _data;
+    std::size_t _size;
+};
+
+template<typename Map> std::vector<std::string> sorted_keys(const Map& map)
+{
+    std::vector<std::string> keys;
+    keys.reserve(map.size());
+    for (const auto& entry : map) {
+        keys.push_back(entry.first);
+    }
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+} // namespace
+
 CameraDefinition::CameraDefinition() {}
 
 CameraDefinition::~CameraDefinition() {}
 
 bool CameraDefinition::load_file(const std::string& filepath)
 {
-    tinyxml2::XMLError xml_error = _doc.LoadFile(filepath.c_str());
+    // The document is only needed while parsing, it takes more memory than what is kept of it.
+    tinyxml2::XMLDocument doc;
+    tinyxml2::XMLError xml_error = doc.LoadFile(filepath.c_str());
     if (xml_error != tinyxml2::XML_SUCCESS) {
-        LogErr() << "tinyxml2::LoadFile failed: " << _doc.ErrorStr();
+        LogErr() << "tinyxml2::LoadFile failed: " << doc.ErrorStr();
         return false;
     }
 
-    return parse_xml();
+    return parse_xml(doc);
 }
 
 bool CameraDefinition::load_string(const std::string& content)
 {
-    tinyxml2::XMLError xml_error = _doc.Parse(content.c_str());
+    tinyxml2::XMLDocument doc;
+    tinyxml2::XMLError xml_error = doc.Parse(content.c_str());
     if (xml_error != tinyxml2::XML_SUCCESS) {
-        LogErr() << "tinyxml2::Parse failed: " << _doc.ErrorStr();
+        LogErr() << "tinyxml2::Parse failed: " << doc.ErrorStr();
+        return false;
+    }
+
+    return parse_xml(doc);
+}
+
+bool CameraDefinition::save_binary(std::string& binary) const
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+    binary.clear();
+    BinaryWriter writer(binary);
+
+    const auto write_option = [&writer](const Option& option) {
+        writer.write_string(option.name);
+        writer.write_value(option.value);
+        writer.write_uint16(uint16_t(option.exclusions.size()));
+        for (const auto& exclusion : option.exclusions) {
+            writer.write_string(exclusion);
+        }
+        writer.write_uint16(uint16_t(option.parameter_ranges.size()));
+        for (const auto& range_name : sorted_keys(option.parameter_ranges)) {
+            const auto& range = option.parameter_ranges.at(range_name);
+            writer.write_string(range_name);
+            writer.write_uint16(uint16_t(range.size()));
+            for (const auto& roption_name : sorted_keys(range)) {
+                writer.write_string(roption_name);
+                writer.write_value(range.at(roption_name));
+            }
+        }
+    };
+
+    binary.append(binary_magic, sizeof(binary_magic));
+    writer.write_uint8(binary_version);
+    writer.write_string(_vendor);
+    writer.write_string(_model);
+
+    // Sorted so that the same definition always gives the same bytes.
+    writer.write_uint16(uint16_t(_parameter_map.size()));
+    for (const auto& name : sorted_keys(_parameter_map)) {
+        const auto& parameter = *_parameter_map.at(name);
+        writer.write_string(name);
+        writer.write_string(parameter.description);
+        writer.write_uint8(
+            uint8_t(parameter.is_control) | uint8_t(parameter.is_readonly << 1) |
+            uint8_t(parameter.is_writeonly << 2) | uint8_t(parameter.is_range << 3));
+        writer.write_value(parameter.type);
+        writer.write_uint16(uint16_t(parameter.updates.size()));
+        for (const auto& update : parameter.updates) {
+            writer.write_string(update);
+        }
+        writer.write_uint16(uint16_t(parameter.options.size()));
+        for (const auto& option : parameter.options) {
+            write_option(*option);
+        }
+        write_option(parameter.default_option);
+    }
+
+    return true;
+}
+
+bool CameraDefinition::load_binary(const char* data, std::size_t size)
+{
+    BinaryReader reader(data, size);
+
+    const auto read_option = [&reader](Option& option) {
+        uint16_t num_exclusions;
+        if (!reader.read_string(option.name) || !reader.read_value(option.value) ||
+            !reader.read_uint16(num_exclusions)) {
+            return false;
+        }
+        option.exclusions.resize(num_exclusions);
+        for (auto& exclusion : option.exclusions) {
+            if (!reader.read_string(exclusion)) {
+                return false;
+            }
+        }
+        uint16_t num_ranges;
+        if (!reader.read_uint16(num_ranges)) {
+            return false;
+        }
+        for (uint16_t i = 0; i < num_ranges; ++i) {
+            std::string range_name;
+            uint16_t num_roptions;
+            if (!reader.read_string(range_name) || !reader.read_uint16(num_roptions)) {
+                return false;
+            }
+            auto& range = option.parameter_ranges[range_name];
+            for (uint16_t j = 0; j < num_roptions; ++j) {
+                std::string roption_name;
+                if (!reader.read_string(roption_name) ||
+                    !reader.read_value(range[roption_name])) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    std::string vendor;
+    std::string model;
+    uint16_t num_parameters;
+    if (!reader.read_magic() || !reader.read_string(vendor) || !reader.read_string(model) ||
+        !reader.read_uint16(num_parameters)) {
+        LogErr() << "Camera definition binary invalid";
+        return false;
+    }
+
+    std::unordered_map<std::string, std::shared_ptr<Parameter>> parameter_map;
+    for (uint16_t i = 0; i < num_parameters; ++i) {
+        auto new_parameter = std::make_shared<Parameter>();
+        std::string name;
+        uint8_t flags;
+        uint16_t num_updates;
+        if (!reader.read_string(name) || !reader.read_string(new_parameter->description) ||
+            !reader.read_uint8(flags) || !reader.read_value(new_parameter->type) ||
+            !reader.read_uint16(num_updates)) {
+            LogErr() << "Camera definition binary invalid";
+            return false;
+        }
+        new_parameter->is_control = (flags & (1 << 0)) != 0;
+        new_parameter->is_readonly = (flags & (1 << 1)) != 0;
+        new_parameter->is_writeonly = (flags & (1 << 2)) != 0;
+        new_parameter->is_range = (flags & (1 << 3)) != 0;
+
+        new_parameter->updates.resize(num_updates);
+        bool success = true;
+        for (auto& update : new_parameter->updates) {
+            success = success && reader.read_string(update);
+        }
+        uint16_t num_options = 0;
+        success = success && reader.read_uint16(num_options);
+        for (uint16_t j = 0; success && j < num_options; ++j) {
+            auto new_option = std::make_shared<Option>();
+            success = read_option(*new_option);
+            new_parameter->options.push_back(new_option);
+        }
+        if (!success || !read_option(new_parameter->default_option)) {
+            LogErr() << "Camera definition binary invalid";
+            return false;
+        }
+
+        parameter_map[name] = new_parameter;
+    }
+
+    if (!reader.at_end()) {
+        LogErr() << "Camera definition binary invalid";
         return false;
     }
 
-    return parse_xml();
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+    _vendor = vendor;
+    _model = model;
+    _parameter_map = std::move(parameter_map);
+    _current_settings.clear();
+    for (const auto& parameter : _parameter_map) {
+        InternalCurrentSetting empty_setting{};
+        empty_setting.needs_updating = true;
+        _current_settings[parameter.first] = empty_setting;
+    }
+
+    return true;
 }
 
 std::string CameraDefinition::get_model() const
@@ -44,11 +396,11 @@ std::string CameraDefinition::get_vendor() const
     return _vendor;
 }
 
-bool CameraDefinition::parse_xml()
+bool CameraDefinition::parse_xml(const tinyxml2::XMLDocument& doc)
 {
     std::lock_guard<std::recursive_mutex> lock(_mutex);
 
-    auto e_mavlinkcamera = _doc.FirstChildElement("mavlinkcamera");
+    auto e_mavlinkcamera = doc.FirstChildElement("mavlinkcamera");
     if (!e_mavlinkcamera) {
         LogErr() << "Tag mavlinkcamera not found";
         return false;
@@ -127,6 +479,11 @@ bool CameraDefinition::parse_xml()
             continue;
         }
 
+        // Booleans are sent as uint8, e.g. CAM_IRLOCKST of the CGOET.
+        if (strcmp(type_str, "bool") == 0) {
+            type_str = "uint8";
+        }
+
         if (!new_parameter->type.set_empty_type_from_xml(type_str)) {
             LogErr() << "unknown type attribute";
             return false;
@@ -577,6 +934,60 @@ bool CameraDefinition::set_setting(
     return true;
 }
 
+bool CameraDefinition::update_settings(
+    const std::map<std::string, MAVLinkParameters::ParamValue>& values)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+    std::vector<std::string> changed{};
+    bool learned = false;
+
+    for (const auto& value : values) {
+        const auto parameter = _parameter_map.find(value.first);
+        if (parameter == _parameter_map.end()) {
+            continue;
+        }
+
+        // FIXME: the same workaround as for single params in MAVLinkParameters, some params
+        //        come as uint8_t from the camera but are uint16_t or uint32_t.
+        MAVLinkParameters::ParamValue new_value = value.second;
+        if (new_value.is_uint8() && parameter->second->type.is_uint16()) {
+            new_value.set_uint16(uint16_t(value.second.get_uint8()));
+        } else if (new_value.is_uint8() && parameter->second->type.is_uint32()) {
+            new_value.set_uint32(uint32_t(value.second.get_uint8()));
+        }
+
+        if (!new_value.is_same_type(parameter->second->type)) {
+            LogWarn() << "Ignoring " << value.first << " of type " << new_value.typestr();
+            continue;
+        }
+
+        auto& current_setting = _current_settings[value.first];
+        if (current_setting.needs_updating) {
+            learned = true;
+        } else if (current_setting.value == new_value) {
+            continue;
+        } else {
+            changed.push_back(value.first);
+        }
+        current_setting.value = new_value;
+        current_setting.needs_updating = false;
+    }
+
+    // Like in set_setting, except for those that came along.
+    for (const auto& name : changed) {
+        for (const auto& update : _parameter_map[name]->updates) {
+            if (values.find(update) != values.end() ||
+                _current_settings.find(update) == _current_settings.end()) {
+                continue;
+            }
+            _current_settings[update].needs_updating = true;
+        }
+    }
+
+    return learned || !changed.empty();
+}
+
 bool CameraDefinition::get_setting(const std::string& name, MAVLinkParameters::ParamValue& value)
 {
     std::lock_guard<std::recursive_mutex> lock(_mutex);
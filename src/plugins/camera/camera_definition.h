@@ -2,6 +2,8 @@
 
 #include "mavlink_parameters.h"
 #include <tinyxml2.h>
+#include <cstddef>
+#include <map>
 #include <vector>
 #include <memory>
 #include <unordered_map>
@@ -20,6 +22,10 @@ public:
     bool load_file(const std::string& filepath);
     bool load_string(const std::string& content);
 
+    // A compact binary form of the parsed definition which loads without parsing XML.
+    bool load_binary(const char* data, std::size_t size);
+    bool save_binary(std::string& binary) const;
+
     std::string get_vendor() const;
     std::string get_model() const;
 
@@ -31,6 +37,12 @@ public:
     };
 
     bool set_setting(const std::string& name, const MAVLinkParameters::ParamValue& value);
+
+    // Takes values the camera sent, all of them at once or single ones which changed. Unlike
+    // set_setting, they don't mark each other as needing an update since they are current
+    // together. Values of params not in the definition are ignored. Returns whether any of
+    // the settings changed or were not known before.
+    bool update_settings(const std::map<std::string, MAVLinkParameters::ParamValue>& values);
     bool get_setting(const std::string& name, MAVLinkParameters::ParamValue& value);
     bool get_all_settings(std::unordered_map<std::string, MAVLinkParameters::ParamValue>& settings);
     bool
@@ -81,7 +93,7 @@ private:
         bool is_range{false};
     };
 
-    bool parse_xml();
+    bool parse_xml(const tinyxml2::XMLDocument& doc);
 
     // Until we have std::optional we need to use std::pair to return something that might be
     // nothing.
@@ -98,8 +110,6 @@ private:
 
     mutable std::recursive_mutex _mutex{};
 
-    tinyxml2::XMLDocument _doc{};
-
     std::unordered_map<std::string, std::shared_ptr<Parameter>> _parameter_map{};
 
     struct InternalCurrentSetting {
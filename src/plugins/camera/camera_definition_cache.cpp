@@ -0,0 +1,179 @@
+#if defined(WINDOWS)
+#include <direct.h>
+#define mkdir(D, M) _mkdir(D)
+#endif
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "camera_definition_cache.h"
+#include "log.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace mavsdk {
+
+namespace {
+
+#if defined(WINDOWS)
+const char path_separator = '\\';
+#else
+const char path_separator = '/';
+#endif
+
+// The file name needs to stay the same between runs and builds, which std::hash doesn't
+// promise, so this is FNV-1a.
+uint64_t stable_hash(const std::string& text)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (const char c : text) {
+        hash ^= uint8_t(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// In front of the definition, to tell a different URI with the same hash apart.
+std::string file_header(const std::string& uri, uint16_t version)
+{
+    std::string header;
+    header.push_back(char(version & 0xff));
+    header.push_back(char(version >> 8));
+    header.push_back(char(uri.size() & 0xff));
+    header.push_back(char(uri.size() >> 8));
+    header.append(uri);
+    return header;
+}
+
+} // namespace
+
+CameraDefinitionCache::CameraDefinitionCache(const std::string& directory) :
+    _directory(directory)
+{}
+
+CameraDefinitionCache::~CameraDefinitionCache() {}
+
+std::string CameraDefinitionCache::default_directory()
+{
+    if (const char* env_p = std::getenv("MAVSDK_CAMERA_DEFINITION_CACHE")) {
+        return env_p;
+    }
+
+    const std::string subdirectory =
+        std::string("mavsdk") + path_separator + "camera_definitions";
+#if defined(WINDOWS)
+    if (const char* local_app_data = std::getenv("LOCALAPPDATA")) {
+        return std::string(local_app_data) + path_separator + subdirectory;
+    }
+#else
+    if (const char* xdg_cache_home = std::getenv("XDG_CACHE_HOME")) {
+        return std::string(xdg_cache_home) + path_separator + subdirectory;
+    }
+    if (const char* home = std::getenv("HOME")) {
+        return std::string(home) + path_separator + ".cache" + path_separator + subdirectory;
+    }
+#endif
+    return "";
+}
+
+bool CameraDefinitionCache::load(
+    const std::string& uri, uint16_t version, CameraDefinition& camera_definition) const
+{
+    if (_directory.empty()) {
+        return false;
+    }
+
+    std::ifstream file(file_path(uri, version), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::stringstream content;
+    content << file.rdbuf();
+    const std::string data = content.str();
+
+    const std::string header = file_header(uri, version);
+    if (data.compare(0, header.size(), header) != 0) {
+        return false;
+    }
+
+    if (!camera_definition.load_binary(
+            data.data() + header.size(), data.size() - header.size())) {
+        // Broken or from another version of the library, it gets downloaded again.
+        std::remove(file_path(uri, version).c_str());
+        return false;
+    }
+    return true;
+}
+
+bool CameraDefinitionCache::store(
+    const std::string& uri, uint16_t version, const CameraDefinition& camera_definition)
+{
+    if (_directory.empty()) {
+        return false;
+    }
+
+    std::string binary;
+    if (!camera_definition.save_binary(binary) || !create_directories()) {
+        return false;
+    }
+
+    // Written next to it first so that nobody reads half a file.
+    const std::string path = file_path(uri, version);
+    const std::string temp_path = path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary);
+        const std::string header = file_header(uri, version);
+        file.write(header.data(), header.size());
+        file.write(binary.data(), binary.size());
+        if (!file) {
+            LogWarn() << "Could not write camera definition to " << temp_path;
+            std::remove(temp_path.c_str());
+            return false;
+        }
+    }
+
+#if defined(WINDOWS)
+    // Renaming doesn't replace files on Windows.
+    std::remove(path.c_str());
+#endif
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+void CameraDefinitionCache::remove(const std::string& uri, uint16_t version)
+{
+    if (!_directory.empty()) {
+        std::remove(file_path(uri, version).c_str());
+    }
+}
+
+std::string CameraDefinitionCache::file_path(const std::string& uri, uint16_t version) const
+{
+    char name[32];
+    snprintf(
+        name,
+        sizeof(name),
+        "%016llx.bin",
+        static_cast<unsigned long long>(stable_hash(uri + '\n' + std::to_string(version))));
+    return _directory + path_separator + name;
+}
+
+bool CameraDefinitionCache::create_directories() const
+{
+    // Each level in turn, those which exist already fail which is fine.
+    for (std::size_t pos = _directory.find(path_separator, 1); pos != std::string::npos;
+         pos = _directory.find(path_separator, pos + 1)) {
+        mkdir(_directory.substr(0, pos).c_str(), 0755);
+    }
+    mkdir(_directory.c_str(), 0755);
+
+    struct stat info;
+    return stat(_directory.c_str(), &info) == 0 && (info.st_mode & S_IFDIR);
+}
+
+} // namespace mavsdk
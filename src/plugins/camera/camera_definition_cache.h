@@ -0,0 +1,36 @@
+#pragma once
+
+#include "camera_definition.h"
+#include <cstdint>
+#include <string>
+
+namespace mavsdk {
+
+// Keeps downloaded camera definitions on disk in their binary form, by URI and version, so
+// that they neither need to be downloaded nor parsed again the next time a camera connects.
+class CameraDefinitionCache {
+public:
+    // Nothing is cached if the directory is empty.
+    explicit CameraDefinitionCache(const std::string& directory = default_directory());
+    ~CameraDefinitionCache();
+
+    bool load(const std::string& uri, uint16_t version, CameraDefinition& camera_definition) const;
+    bool
+    store(const std::string& uri, uint16_t version, const CameraDefinition& camera_definition);
+    void remove(const std::string& uri, uint16_t version);
+
+    // Set MAVSDK_CAMERA_DEFINITION_CACHE to use another directory, or to nothing to not cache.
+    static std::string default_directory();
+
+    // Non-copyable
+    CameraDefinitionCache(const CameraDefinitionCache&) = delete;
+    const CameraDefinitionCache& operator=(const CameraDefinitionCache&) = delete;
+
+private:
+    std::string file_path(const std::string& uri, uint16_t version) const;
+    bool create_directories() const;
+
+    const std::string _directory;
+};
+
+} // namespace mavsdk
@@ -0,0 +1,81 @@
+#include "camera_definition_cache.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using namespace mavsdk;
+
+static const std::string cache_e90_unit_test_file = "src/plugins/camera/e90_unit_test.xml";
+static const std::string cache_directory = "camera_definition_cache_test";
+static const std::string e90_uri = "http://camera.local/e90.xml";
+// The name must not change between builds or the cache would be lost with every update.
+static const std::string e90_cache_file = cache_directory + "/24f0395b549e785c.bin";
+
+static void remove_cache_directory()
+{
+    std::remove(e90_cache_file.c_str());
+    std::remove(cache_directory.c_str());
+}
+
+TEST(CameraDefinitionCache, StoresAndLoads)
+{
+    remove_cache_directory();
+    CameraDefinitionCache cache(cache_directory);
+
+    CameraDefinition parsed;
+    ASSERT_TRUE(parsed.load_file(cache_e90_unit_test_file));
+
+    CameraDefinition cd;
+    EXPECT_FALSE(cache.load(e90_uri, 3, cd));
+    ASSERT_TRUE(cache.store(e90_uri, 3, parsed));
+    ASSERT_TRUE(cache.load(e90_uri, 3, cd));
+    EXPECT_STREQ(cd.get_model().c_str(), "E90");
+
+    std::string binary;
+    std::string cached_binary;
+    ASSERT_TRUE(parsed.save_binary(binary));
+    ASSERT_TRUE(cd.save_binary(cached_binary));
+    EXPECT_EQ(binary, cached_binary);
+
+    // Other versions and URIs are downloaded again.
+    EXPECT_FALSE(cache.load(e90_uri, 4, cd));
+    EXPECT_FALSE(cache.load("http://camera.local/e50.xml", 3, cd));
+
+    // And it is still there the next time.
+    CameraDefinitionCache other_cache(cache_directory);
+    EXPECT_TRUE(other_cache.load(e90_uri, 3, cd));
+
+    remove_cache_directory();
+}
+
+TEST(CameraDefinitionCache, IgnoresBrokenFiles)
+{
+    remove_cache_directory();
+    CameraDefinitionCache cache(cache_directory);
+
+    CameraDefinition parsed;
+    ASSERT_TRUE(parsed.load_file(cache_e90_unit_test_file));
+    ASSERT_TRUE(cache.store(e90_uri, 3, parsed));
+
+    // Overwrite what was stored with something cut short.
+    ASSERT_TRUE(std::ifstream(e90_cache_file).good());
+    std::ofstream(e90_cache_file, std::ios::binary) << "MCDB";
+
+    CameraDefinition cd;
+    EXPECT_FALSE(cache.load(e90_uri, 3, cd));
+
+    remove_cache_directory();
+}
+
+TEST(CameraDefinitionCache, DoesNothingWithoutDirectory)
+{
+    CameraDefinitionCache cache("");
+
+    CameraDefinition parsed;
+    ASSERT_TRUE(parsed.load_file(cache_e90_unit_test_file));
+    EXPECT_FALSE(cache.store(e90_uri, 3, parsed));
+
+    CameraDefinition cd;
+    EXPECT_FALSE(cache.load(e90_uri, 3, cd));
+}
@@ -0,0 +1,96 @@
+//
+// Parses the camera definitions that come with the library and writes them out in their
+// binary form as C++ arrays, so they don't need to be parsed at runtime.
+//
+// Run through tools/generate_camera_definitions.sh.
+//
+// If any of them doesn't parse completely, nothing is written and it fails.
+//
+// Usage: camera_definition_compiler <output_dir> <definition.xml>...
+//
+
+#include "camera_definition.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace mavsdk;
+
+namespace {
+
+const std::string output_name = "camera_definition_files";
+
+// "path/to/e90.xml" becomes "e90".
+std::string variable_name(const std::string& path)
+{
+    const auto slash_pos = path.find_last_of("/\\");
+    std::string name = path.substr(slash_pos == std::string::npos ? 0 : slash_pos + 1);
+    const auto dot_pos = name.rfind('.');
+    if (dot_pos != std::string::npos) {
+        name.erase(dot_pos);
+    }
+    return name;
+}
+
+void write_array(std::ostream& str, const std::string& name, const std::string& binary)
+{
+    str << "const char " << name << "_binary[] = {";
+    for (std::size_t i = 0; i < binary.size(); ++i) {
+        char hex[8];
+        std::snprintf(hex, sizeof(hex), "'\\x%02x',", unsigned(uint8_t(binary[i])));
+        str << ((i % 12 == 0) ? "\n    " : " ") << hex;
+    }
+    str << "\n};\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <output_dir> <definition.xml>..." << std::endl;
+        return 1;
+    }
+
+    // Only written once everything compiled, so a failure leaves the previous files alone.
+    std::ostringstream header;
+    std::ostringstream source;
+
+    const std::string note =
+        "// Automatically generated by camera_definition_compiler, DO NOT EDIT.\n"
+        "// Run tools/generate_camera_definitions.sh to update it.\n\n";
+    header << note << "#pragma once\n\n#include <cstddef>\n";
+    source << note << "#include \"" << output_name << ".h\"\n";
+
+    for (int i = 2; i < argc; ++i) {
+        CameraDefinition camera_definition;
+        if (!camera_definition.load_file(argv[i])) {
+            std::cerr << "Could not parse " << argv[i] << std::endl;
+            return 1;
+        }
+        std::string binary;
+        if (!camera_definition.save_binary(binary)) {
+            std::cerr << "Could not compile " << argv[i] << std::endl;
+            return 1;
+        }
+
+        const auto name = variable_name(argv[i]);
+        header << "\nextern const char " << name << "_binary[];\n"
+               << "const std::size_t " << name << "_binary_size = " << binary.size() << ";\n";
+        source << "\n";
+        write_array(source, name, binary);
+
+        std::cout << argv[i] << ": " << binary.size() << " bytes" << std::endl;
+    }
+
+    const std::string output_dir = argv[1];
+    std::ofstream header_file(output_dir + "/" + output_name + ".h");
+    std::ofstream source_file(output_dir + "/" + output_name + ".cpp");
+    header_file << header.str();
+    source_file << source.str();
+
+    return (header_file.good() && source_file.good()) ? 0 : 1;
+}
@@ -1,25 +1,18 @@
-/* Automatic generated file. DO NOT EDIT.
-   The file was generated by cpp_rsc program
-   https://github.com/orex/cpp_rsc
-   This is a header file*/
+// Automatically generated by camera_definition_compiler, DO NOT EDIT.
+// Run tools/generate_camera_definitions.sh to update it.
 
+#pragma once
 
-#ifndef CAMERA_DEFINITION_FILES_H
-#define CAMERA_DEFINITION_FILES_H
-  extern const char cgoetxml[];
-  
-  const int cgoetxml_size = 16097; 
+#include <cstddef>
 
-  extern const char e10txml[];
-  
-  const int e10txml_size = 13781; 
+extern const char cgoet_binary[];
+const std::size_t cgoet_binary_size = 1986;
 
-  extern const char e50xml[];
-  
-  const int e50xml_size = 30430; 
+extern const char e10t_binary[];
+const std::size_t e10t_binary_size = 2280;
 
-  extern const char e90xml[];
-  
-  const int e90xml_size = 63539; 
+extern const char e50_binary[];
+const std::size_t e50_binary_size = 4712;
 
-#endif /*CAMERA_DEFINITION_FILES_H */
+extern const char e90_binary[];
+const std::size_t e90_binary_size = 10769;
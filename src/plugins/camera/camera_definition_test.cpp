@@ -1,6 +1,8 @@
 #include "camera_definition.h"
+#include "camera_definition_files/generated/camera_definition_files.h"
 #include "log.h"
 #include <gtest/gtest.h>
+#include <map>
 #include <vector>
 #include <unordered_map>
 #include <memory>
@@ -372,6 +374,66 @@ TEST(CameraDefinition, E90SettingsCauseUpdates)
     }
 }
 
+TEST(CameraDefinition, E90UpdateSettings)
+{
+    // Run this from root.
+    CameraDefinition defaults;
+    ASSERT_TRUE(defaults.load_file(e90_unit_test_file));
+    defaults.assume_default_settings();
+    std::unordered_map<std::string, MAVLinkParameters::ParamValue> default_settings{};
+    ASSERT_TRUE(defaults.get_all_settings(default_settings));
+    std::map<std::string, MAVLinkParameters::ParamValue> all_params(
+        default_settings.begin(), default_settings.end());
+
+    CameraDefinition cd;
+    ASSERT_TRUE(cd.load_file(e90_unit_test_file));
+
+    // All of them at once, as the camera sends them when asked for all params.
+    EXPECT_TRUE(cd.update_settings(all_params));
+    {
+        std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>> params;
+        cd.get_unknown_params(params);
+        EXPECT_EQ(params.size(), 0);
+    }
+
+    // Nothing new.
+    EXPECT_FALSE(cd.update_settings(all_params));
+
+    {
+        // A single one which changed, coming from the camera as uint8_t.
+        MAVLinkParameters::ParamValue value;
+        value.set_uint8(0);
+        EXPECT_TRUE(cd.update_settings({{"CAM_MODE", value}}));
+        EXPECT_FALSE(cd.update_settings({{"CAM_MODE", value}}));
+
+        MAVLinkParameters::ParamValue mode;
+        EXPECT_TRUE(cd.get_setting("CAM_MODE", mode));
+        EXPECT_EQ(mode.get_uint32(), 0);
+    }
+
+    // Those depending on it need an update.
+    {
+        std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>> params;
+        cd.get_unknown_params(params);
+        EXPECT_EQ(params.size(), 4);
+    }
+
+    // Unless they come along.
+    EXPECT_TRUE(cd.update_settings(all_params));
+    {
+        std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>> params;
+        cd.get_unknown_params(params);
+        EXPECT_EQ(params.size(), 0);
+    }
+
+    {
+        // Params the definition doesn't have are ignored.
+        MAVLinkParameters::ParamValue value;
+        value.set_uint32(1);
+        EXPECT_FALSE(cd.update_settings({{"CAM_UNKNOWN", value}}));
+    }
+}
+
 TEST(CameraDefinition, E90OptionValues)
 {
     // Run this from root.
@@ -641,3 +703,95 @@ TEST(CameraDefinition, UVCCheckOptionHumanReadable)
     EXPECT_TRUE(cd.get_option_str("exp-priority", "1", description));
     EXPECT_STREQ(description.c_str(), "ON");
 }
+
+TEST(CameraDefinition, E90LoadBinary)
+{
+    // Run this from root.
+    CameraDefinition parsed;
+    ASSERT_TRUE(parsed.load_file(e90_unit_test_file));
+    std::string binary;
+    ASSERT_TRUE(parsed.save_binary(binary));
+
+    CameraDefinition cd;
+    ASSERT_TRUE(cd.load_binary(binary.data(), binary.size()));
+    EXPECT_STREQ(cd.get_vendor().c_str(), "Yuneec");
+    EXPECT_STREQ(cd.get_model().c_str(), "E90");
+
+    // Everything that was parsed comes back.
+    std::string binary_again;
+    ASSERT_TRUE(cd.save_binary(binary_again));
+    EXPECT_EQ(binary, binary_again);
+
+    std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>> unknown_params{};
+    cd.get_unknown_params(unknown_params);
+    EXPECT_EQ(unknown_params.size(), 17);
+
+    cd.assume_default_settings();
+    std::unordered_map<std::string, MAVLinkParameters::ParamValue> settings{};
+    EXPECT_TRUE(cd.get_all_settings(settings));
+    EXPECT_EQ(settings["CAM_MODE"].get_uint32(), 1);
+    EXPECT_FLOAT_EQ(settings["CAM_SHUTTERSPD"].get_float(), 0.016666f);
+    EXPECT_EQ(settings["CAM_CUSTOMWB"].get_uint16(), 5500);
+
+    MAVLinkParameters::ParamValue value;
+    value.set_uint32(0);
+    EXPECT_TRUE(cd.set_setting("CAM_MODE", value));
+    EXPECT_TRUE(cd.get_possible_settings(settings));
+    EXPECT_EQ(settings.size(), 9);
+
+    std::string description{};
+    EXPECT_TRUE(cd.get_setting_str("CAM_EV", description));
+    EXPECT_STREQ(description.c_str(), "Exposure Compensation");
+    EXPECT_TRUE(cd.is_setting_range("CAM_CUSTOMWB"));
+}
+
+TEST(CameraDefinition, RejectsInvalidBinary)
+{
+    CameraDefinition parsed;
+    ASSERT_TRUE(parsed.load_file(e90_unit_test_file));
+    std::string binary;
+    ASSERT_TRUE(parsed.save_binary(binary));
+
+    CameraDefinition cd;
+    EXPECT_FALSE(cd.load_binary(binary.data(), binary.size() - 1));
+    EXPECT_FALSE(cd.load_binary(binary.data(), 0));
+
+    binary[4] = '\xff'; // Unknown version
+    EXPECT_FALSE(cd.load_binary(binary.data(), binary.size()));
+}
+
+TEST(CameraDefinition, BinaryValuesAreLittleEndian)
+{
+    // Run this from root.
+    CameraDefinition parsed;
+    ASSERT_TRUE(parsed.load_file(e90_unit_test_file));
+    std::string binary;
+    ASSERT_TRUE(parsed.save_binary(binary));
+
+    // The default of CAM_CUSTOMWB, 5500, whatever the byte order of the host.
+    const char custom_wb_default[] = {char(MAV_PARAM_EXT_TYPE_UINT16), '\x7c', '\x15'};
+    EXPECT_NE(
+        binary.find(std::string(custom_wb_default, sizeof(custom_wb_default))), std::string::npos);
+}
+
+TEST(CameraDefinition, BuiltInBinariesAreUpToDate)
+{
+    // Run this from root.
+    const std::vector<std::pair<std::string, std::string>> built_ins{
+        {"cgoet", std::string(cgoet_binary, cgoet_binary_size)},
+        {"e10t", std::string(e10t_binary, e10t_binary_size)},
+        {"e50", std::string(e50_binary, e50_binary_size)},
+        {"e90", std::string(e90_binary, e90_binary_size)},
+    };
+
+    for (const auto& built_in : built_ins) {
+        CameraDefinition cd;
+        ASSERT_TRUE(
+            cd.load_file("src/plugins/camera/camera_definition_files/" + built_in.first + ".xml"))
+            << built_in.first << " doesn't parse";
+        std::string binary;
+        ASSERT_TRUE(cd.save_binary(binary));
+        EXPECT_EQ(binary, built_in.second)
+            << built_in.first << " changed, run tools/generate_camera_definitions.sh";
+    }
+}
@@ -6,12 +6,21 @@
 #include "camera_definition_files.h"
 #include <functional>
 #include <cmath>
+#include <cstring>
 #include <sstream>
 
 namespace mavsdk {
 
 using namespace std::placeholders; // for `_1`
 
+namespace {
+
+// With fewer unknown params than this, requesting them one by one is quicker than having the
+// camera send all of its params.
+constexpr std::size_t min_unknown_params_to_get_all = 3;
+
+} // namespace
+
 CameraImpl::CameraImpl(System& system) : PluginImplBase(system)
 {
     _parent->register_plugin(this);
@@ -59,6 +68,11 @@ void CameraImpl::init()
         std::bind(&CameraImpl::process_flight_information, this, _1),
         this);
 
+    _parent->register_mavlink_message_handler(
+        MAVLINK_MSG_ID_PARAM_EXT_VALUE,
+        std::bind(&CameraImpl::process_param_ext_value, this, _1),
+        this);
+
     _parent->add_call_every(
         std::bind(&CameraImpl::check_connection_status, this),
         0.5,
@@ -71,6 +85,7 @@ void CameraImpl::deinit()
     _parent->remove_call_every(_status.call_every_cookie);
     _parent->unregister_all_mavlink_message_handlers(this);
     _parent->cancel_all_param(this);
+    _getting_all_params = false;
 
     {
         std::lock_guard<std::mutex> lock(_status.mutex);
@@ -132,6 +147,7 @@ void CameraImpl::enable()
 
 void CameraImpl::manual_enable()
 {
+    _all_params_supported = true;
     refresh_params();
 
     request_camera_information();
@@ -808,37 +824,33 @@ void CameraImpl::process_camera_information(const mavlink_message_t& message)
         }
     }
 
-    std::string content{};
-    bool found_content = false;
+    std::unique_ptr<CameraDefinition> camera_definition{new CameraDefinition()};
+    bool found_definition = false;
 
     // TODO: we might also try to support the correct version of the xml files.
     if (strcmp((const char*)(camera_information.vendor_name), "Yuneec") == 0) {
         if (strcmp((const char*)(camera_information.model_name), "E90") == 0) {
             LogInfo() << "Using cached file for Yuneec E90.";
-            content = e90xml;
-            found_content = true;
+            found_definition = camera_definition->load_binary(e90_binary, e90_binary_size);
         } else if (strcmp((const char*)(camera_information.model_name), "E50") == 0) {
             LogInfo() << "Using cached file for Yuneec E50.";
-            content = e50xml;
-            found_content = true;
+            found_definition = camera_definition->load_binary(e50_binary, e50_binary_size);
         } else if (strcmp((const char*)(camera_information.model_name), "CGOET") == 0) {
             LogInfo() << "Using cached file for Yuneec ET.";
-            content = cgoetxml;
-            found_content = true;
+            found_definition = camera_definition->load_binary(cgoet_binary, cgoet_binary_size);
         } else if (strcmp((const char*)(camera_information.model_name), "E10T") == 0) {
             LogInfo() << "Using cached file for Yuneec E10T.";
-            content = e10txml;
-            found_content = true;
+            found_definition = camera_definition->load_binary(e10t_binary, e10t_binary_size);
         }
     } else {
-        content = camera_information.cam_definition_uri;
-        LogDebug() << "downloading camera definition file from: " << content;
-        found_content = load_definition_file(camera_information.cam_definition_uri, content);
+        found_definition = load_definition_file(
+            camera_information.cam_definition_uri,
+            camera_information.cam_definition_version,
+            *camera_definition);
     }
 
-    if (found_content) {
-        _camera_definition.reset(new CameraDefinition());
-        _camera_definition->load_string(content);
+    if (found_definition) {
+        _camera_definition = std::move(camera_definition);
         refresh_params();
     }
 }
@@ -983,15 +995,26 @@ void CameraImpl::notify_mode()
     _parent->call_user_callback([mode, temp_callback]() { temp_callback(mode); });
 }
 
-bool CameraImpl::load_definition_file(const std::string& uri, std::string& content)
+bool CameraImpl::load_definition_file(
+    const std::string& uri, uint16_t version, CameraDefinition& camera_definition)
 {
+    if (_definition_cache.load(uri, version, camera_definition)) {
+        LogInfo() << "Using cached camera definition from: " << uri;
+        return true;
+    }
+
     HttpLoader http_loader;
+    std::string content;
     LogInfo() << "Downloading camera definition from: " << uri;
     if (!http_loader.download_text_sync(uri, content)) {
         LogErr() << "Failed to download camera definition.";
         return false;
     }
 
+    // What could be parsed is used anyway but only a complete definition is kept.
+    if (camera_definition.load_string(content)) {
+        _definition_cache.store(uri, version, camera_definition);
+    }
     return true;
 }
 
@@ -1406,6 +1429,11 @@ void CameraImpl::refresh_params()
         return;
     }
 
+    if (_getting_all_params) {
+        // Whatever is still unknown once they have arrived gets requested then.
+        return;
+    }
+
     std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>> params;
     _camera_definition->get_unknown_params(params);
     if (params.size() == 0) {
@@ -1416,6 +1444,69 @@ void CameraImpl::refresh_params()
         return;
     }
 
+    if (params.size() >= min_unknown_params_to_get_all && _all_params_supported) {
+        get_all_params();
+        return;
+    }
+
+    get_params_one_by_one(params);
+}
+
+void CameraImpl::get_all_params()
+{
+    if (_getting_all_params.exchange(true)) {
+        return;
+    }
+
+    _parent->get_all_params_async(
+        [this](
+            MAVLinkParameters::Result result,
+            std::map<std::string, MAVLinkParameters::ParamValue> params) {
+            _parent->call_user_callback(std::bind(
+                [this, result](
+                    const std::map<std::string, MAVLinkParameters::ParamValue>& received) {
+                    receive_all_params(result, received);
+                },
+                std::move(params)));
+        },
+        this,
+        static_cast<uint8_t>(MAV_COMP_ID_CAMERA + _camera_id),
+        true);
+}
+
+void CameraImpl::receive_all_params(
+    MAVLinkParameters::Result result,
+    const std::map<std::string, MAVLinkParameters::ParamValue>& params)
+{
+    if (result != MAVLinkParameters::Result::Success && params.empty()) {
+        LogWarn() << "Camera did not send all params, requesting them one by one instead.";
+        _all_params_supported = false;
+    }
+
+    _getting_all_params = false;
+
+    // We need to check again by the time this runs
+    if (!_camera_definition) {
+        return;
+    }
+
+    _camera_definition->update_settings(params);
+
+    // Some might have been lost on the way or changed in the meantime.
+    std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>> missing_params;
+    _camera_definition->get_unknown_params(missing_params);
+    if (missing_params.size() > 0) {
+        get_params_one_by_one(missing_params);
+        return;
+    }
+
+    notify_current_settings();
+    notify_possible_setting_options();
+}
+
+void CameraImpl::get_params_one_by_one(
+    const std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>>& params)
+{
     unsigned count = 0;
     for (const auto& param : params) {
         const std::string& param_name = param.first;
@@ -1434,9 +1525,9 @@ void CameraImpl::refresh_params()
                     return;
                 }
 
-                if (!this->_camera_definition->set_setting(param_name, value)) {
-                    return;
-                }
+                // Unlike set_setting, this doesn't mark those fetched before as needing
+                // another update when they depend on this one.
+                this->_camera_definition->update_settings({{param_name, value}});
 
                 if (is_last) {
                     notify_current_settings();
@@ -1449,6 +1540,40 @@ void CameraImpl::refresh_params()
     }
 }
 
+void CameraImpl::process_param_ext_value(const mavlink_message_t& message)
+{
+    if (message.compid != _camera_id + MAV_COMP_ID_CAMERA) {
+        return;
+    }
+
+    // The ones requested by us are taken care of where they were requested.
+    if (_getting_all_params || !_camera_definition) {
+        return;
+    }
+
+    mavlink_param_ext_value_t param_ext_value;
+    mavlink_msg_param_ext_value_decode(&message, &param_ext_value);
+
+    // The param_id field of the MAVLink struct has length 16 and is not 0 terminated.
+    char param_id[sizeof(param_ext_value.param_id) + 1] = {};
+    std::memcpy(param_id, param_ext_value.param_id, sizeof(param_ext_value.param_id));
+
+    MAVLinkParameters::ParamValue value;
+    value.set_from_mavlink_param_ext_value(param_ext_value);
+
+    // Replies to single params requested have been set already, so this only changes
+    // anything if the camera sent the param because it changed.
+    if (!_camera_definition->update_settings({{param_id, value}})) {
+        return;
+    }
+
+    notify_current_settings();
+    notify_possible_setting_options();
+
+    // Others depending on it might have changed as well.
+    refresh_params();
+}
+
 void CameraImpl::invalidate_params()
 {
     if (!_camera_definition) {
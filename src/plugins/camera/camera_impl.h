@@ -1,6 +1,7 @@
 #pragma once
 
 #include "camera_definition.h"
+#include "camera_definition_cache.h"
 #include "mavlink_include.h"
 #include "plugins/camera/camera.h"
 #include "plugin_impl_base.h"
@@ -118,6 +119,7 @@ private:
     void process_camera_information(const mavlink_message_t& message);
     void process_video_information(const mavlink_message_t& message);
     void process_flight_information(const mavlink_message_t& message);
+    void process_param_ext_value(const mavlink_message_t& message);
 
     Camera::EulerAngle to_euler_angle_from_quaternion(Camera::Quaternion quaternion);
 
@@ -128,10 +130,17 @@ private:
 
     void check_status();
 
-    bool load_definition_file(const std::string& uri, std::string& content);
+    bool load_definition_file(
+        const std::string& uri, uint16_t version, CameraDefinition& camera_definition);
 
     void refresh_params();
     void invalidate_params();
+    void get_all_params();
+    void receive_all_params(
+        MAVLinkParameters::Result result,
+        const std::map<std::string, MAVLinkParameters::ParamValue>& params);
+    void get_params_one_by_one(
+        const std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>>& params);
 
     void save_camera_mode(const float mavlink_camera_mode);
     float to_mavlink_camera_mode(const Camera::Mode mode) const;
@@ -166,10 +175,16 @@ private:
     MAVLinkCommands::CommandLong make_command_request_video_stream_info();
 
     std::unique_ptr<CameraDefinition> _camera_definition{};
+    CameraDefinitionCache _definition_cache{};
 
     std::atomic<unsigned> _camera_id{0};
     std::atomic<bool> _camera_found{false};
 
+    // Whether all params were requested at once and have not all arrived yet, and whether
+    // the camera answers that at all.
+    std::atomic<bool> _getting_all_params{false};
+    std::atomic<bool> _all_params_supported{true};
+
     struct {
         std::mutex mutex{};
         Camera::Status data{};
@@ -0,0 +1,127 @@
+#include "plugins/camera/camera.h"
+#include "autopilot_simulator.h"
+#include "camera_definition.h"
+#include "camera_definition_files/generated/camera_definition_files.h"
+#include "mavsdk.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+class CameraSettings : public ::testing::Test {
+protected:
+    void start(AutopilotSimulator::Config config, const std::string& name)
+    {
+        // The definition is built in, so nothing needs to be downloaded.
+        config.camera_vendor_name = "Yuneec";
+        config.camera_model_name = "E90";
+        _simulator.reset(new AutopilotSimulator(config));
+
+        CameraDefinition camera_definition;
+        ASSERT_TRUE(camera_definition.load_binary(e90_binary, e90_binary_size));
+        camera_definition.assume_default_settings();
+        std::unordered_map<std::string, MAVLinkParameters::ParamValue> settings{};
+        ASSERT_TRUE(camera_definition.get_all_settings(settings));
+        for (const auto& setting : settings) {
+            _simulator->set_camera_param(setting.first, setting.second);
+        }
+        // Not the default, so that we know it came from the camera.
+        set_white_balance(5);
+
+        ASSERT_TRUE(_simulator->start_loopback(name));
+        ASSERT_EQ(_mavsdk.add_any_connection("loopback://" + name), ConnectionResult::Success);
+
+        for (unsigned i = 0; i < 5000 && !_mavsdk.is_connected(); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ASSERT_TRUE(_mavsdk.is_connected());
+
+        _camera.reset(new Camera(_mavsdk.system()));
+        _camera->subscribe_current_settings([this](std::vector<Camera::Setting> current_settings) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _current_settings = current_settings;
+            _cv.notify_all();
+        });
+    }
+
+    void set_white_balance(uint32_t option)
+    {
+        MAVLinkParameters::ParamValue value;
+        value.set_uint32(option);
+        _simulator->set_camera_param("CAM_WBMODE", value);
+    }
+
+    // Waits for the current settings to have the option given, returns all of them.
+    std::vector<Camera::Setting>
+    wait_for_setting(const std::string& setting_id, const std::string& option_id)
+    {
+        const auto has_option = [this, &setting_id, &option_id]() {
+            for (const auto& setting : _current_settings) {
+                if (setting.setting_id == setting_id && setting.option.option_id == option_id) {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait_for(lock, std::chrono::seconds(10), has_option);
+        return has_option() ? _current_settings : std::vector<Camera::Setting>{};
+    }
+
+    void TearDown() override
+    {
+        _camera.reset();
+        if (_simulator) {
+            _simulator->stop();
+        }
+    }
+
+    Mavsdk _mavsdk{};
+    std::unique_ptr<AutopilotSimulator> _simulator{};
+    std::unique_ptr<Camera> _camera{};
+
+    std::mutex _mutex{};
+    std::condition_variable _cv{};
+    std::vector<Camera::Setting> _current_settings{};
+};
+
+} // namespace
+
+TEST_F(CameraSettings, GetsAllSettingsAtOnce)
+{
+    start(AutopilotSimulator::Config{}, "camera_settings_test");
+
+    const auto current_settings = wait_for_setting("CAM_WBMODE", "5");
+    ASSERT_FALSE(current_settings.empty());
+    EXPECT_EQ(current_settings.size(), _camera->possible_setting_options().size());
+}
+
+TEST_F(CameraSettings, GetsSettingsOneByOneIfCameraDoesNotSendAll)
+{
+    AutopilotSimulator::Config config;
+    config.camera_sends_param_list = false;
+    start(config, "camera_settings_test_one_by_one");
+
+    const auto current_settings = wait_for_setting("CAM_WBMODE", "5");
+    ASSERT_FALSE(current_settings.empty());
+    EXPECT_EQ(current_settings.size(), _camera->possible_setting_options().size());
+}
+
+TEST_F(CameraSettings, UpdatesSettingChangedOnCamera)
+{
+    start(AutopilotSimulator::Config{}, "camera_settings_test_changed");
+    ASSERT_FALSE(wait_for_setting("CAM_WBMODE", "5").empty());
+
+    set_white_balance(3);
+    EXPECT_FALSE(wait_for_setting("CAM_WBMODE", "3").empty());
+}
@@ -95,6 +95,11 @@ std::string fs_canonical(const std::string& path)
         st.pop();
     }
 
+    // Relative paths go below the current directory.
+    if (!st1.empty() && !res.empty() && res.back() != '/') {
+        res.append("/");
+    }
+
     while (!st1.empty()) {
         std::string temp = st1.top();
         if (st1.size() != 1) {
@@ -96,6 +96,12 @@ Ftp::are_files_identical(std::string local_file_path, std::string remote_file_pa
     return _impl->are_files_identical(local_file_path, remote_file_path);
 }
 
+void Ftp::sync_directory_async(
+    std::string remote_dir, std::string local_dir, SyncDirectoryCallback callback)
+{
+    _impl->sync_directory_async(remote_dir, local_dir, callback);
+}
+
 Ftp::Result Ftp::set_root_directory(std::string root_dir) const
 {
     return _impl->set_root_directory(root_dir);
@@ -106,6 +112,26 @@ Ftp::Result Ftp::set_target_compid(uint32_t compid) const
     return _impl->set_target_compid(compid);
 }
 
+Ftp::Result Ftp::set_burst_download(bool enabled) const
+{
+    return _impl->set_burst_download(enabled);
+}
+
+Ftp::Result Ftp::set_resumable_download(bool enabled) const
+{
+    return _impl->set_resumable_download(enabled);
+}
+
+Ftp::Result Ftp::set_upload_window_size(uint32_t window_size) const
+{
+    return _impl->set_upload_window_size(window_size);
+}
+
+Ftp::Result Ftp::set_max_parallel_transfers(uint32_t count) const
+{
+    return _impl->set_max_parallel_transfers(count);
+}
+
 uint32_t Ftp::get_our_compid() const
 {
     return _impl->get_our_compid();
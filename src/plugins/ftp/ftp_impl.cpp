@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <fstream>
 #include <functional>
 #include <iostream>
 
@@ -14,6 +16,7 @@
 #include "crc32.h"
 #include "fs.h"
 #include "ftp_impl.h"
+#include "ftp_transfer_manager.h"
 #include "system.h"
 #include "global_include.h"
 
@@ -21,13 +24,56 @@ namespace mavsdk {
 
 using namespace std::placeholders; // for `_1`
 
-FtpImpl::FtpImpl(System& system) : PluginImplBase(system)
+namespace {
+
+#if defined(WINDOWS)
+// Otherwise line endings get translated.
+constexpr int binary_open_flag = O_BINARY;
+#else
+constexpr int binary_open_flag = 0;
+#endif
+
+// Retries of a burst request without any data before we assume bursts are not supported.
+constexpr uint32_t burst_fallback_retries = 2;
+// Reads of missing chunks sent at once after a burst.
+constexpr unsigned max_gap_reads_in_flight = 16;
+// Minimum time between progress callbacks.
+constexpr auto progress_interval = std::chrono::milliseconds(100);
+constexpr uint32_t max_upload_window_size = 256;
+// Next to the partial file of a resumable download.
+constexpr auto checkpoint_suffix = ".resume";
+// Bytes downloaded between checkpoints, in case we don't get to save one in the end.
+constexpr uint32_t checkpoint_interval = 64 * 1024;
+// Files open at once on the server, each one in its own session.
+constexpr std::size_t max_server_sessions = 8;
+// Requests waiting for the server thread, the clients send the ones dropped again.
+constexpr std::size_t max_queued_server_requests = 2048;
+// Chunks of a burst sent before other requests and sessions get their turn.
+constexpr unsigned burst_chunks_per_turn = 16;
+// Chunks sent for the burst requests of all sessions together. Clients ask for the next
+// burst once they got the last chunk, so a fast server doesn't overrun their receive buffer.
+constexpr uint32_t max_burst_chunks = 64;
+// The server reads files ahead in blocks of this size.
+constexpr uint32_t server_read_ahead_size = 64 * 1024;
+
+} // namespace
+
+FtpImpl::FtpImpl(System& system, bool client_only) :
+    PluginImplBase(system),
+    _system(system),
+    _client_only(client_only)
 {
+    if (!_client_only) {
+        _transfer_manager.reset(
+            new FtpTransferManager(std::bind(&FtpImpl::_create_client, this)));
+    }
     _parent->register_plugin(this);
 }
 
 FtpImpl::~FtpImpl()
 {
+    // The clients of the transfer manager go first, they use the same system.
+    _transfer_manager.reset();
     _parent->unregister_plugin(this);
 }
 
@@ -39,7 +85,11 @@ void FtpImpl::init()
         this);
 }
 
-void FtpImpl::deinit() {}
+void FtpImpl::deinit()
+{
+    _parent->unregister_all_mavlink_message_handlers(this);
+    _stop_server();
+}
 
 void FtpImpl::enable() {}
 
@@ -49,6 +99,15 @@ void FtpImpl::_process_ack(PayloadHeader* payload)
 {
     std::lock_guard<std::mutex> lock(_curr_op_mutex);
 
+    // The rest of a burst can still come in after we went on to ask for missing chunks,
+    // or after we are done with the download.
+    if (payload->req_opcode == CMD_BURST_READ_FILE && _curr_op != CMD_BURST_READ_FILE) {
+        if (_download_fd >= 0) {
+            _process_download_data(payload);
+        }
+        return;
+    }
+
     if (_curr_op != payload->req_opcode) {
         LogWarn() << "Received ACK not matching our current operation";
         return;
@@ -63,22 +122,38 @@ void FtpImpl::_process_ack(PayloadHeader* payload)
             _curr_op = CMD_NONE;
             _session_valid = true;
             _session = payload->session;
-            _bytes_transferred = 0;
             _file_size = *(reinterpret_cast<uint32_t*>(payload->data));
-            _call_op_progress_callback(_bytes_transferred, _file_size);
-            _read();
+            _start_download();
+            break;
+
+        case CMD_BURST_READ_FILE:
+            if (!_process_download_data(payload)) {
+                return;
+            }
+            // Data keeps coming, so we are not waiting for a response anymore.
+            _burst_data_received = true;
+            _reset_timer();
+            if (payload->burst_complete || _download_offset >= _file_size) {
+                _continue_download();
+            }
             break;
 
         case CMD_READ_FILE:
-            _ofstream->write(reinterpret_cast<const char*>(payload->data), payload->size);
-            if (!*_ofstream) {
-                _session_result = ServerResult::ERR_FILE_IO_ERROR;
+            if (payload->size == 0) {
+                // Nothing where we expected more, we would ask for it forever.
+                _session_result = ServerResult::ERR_EOF;
                 _end_read_session();
                 return;
             }
-            _bytes_transferred += payload->size;
-            _call_op_progress_callback(_bytes_transferred, _file_size);
-            _read();
+            if (!_process_download_data(payload)) {
+                return;
+            }
+            if (_gap_reads_in_flight > 0) {
+                --_gap_reads_in_flight;
+            }
+            if (_gap_reads_in_flight == 0) {
+                _read();
+            }
             break;
 
         case CMD_OPEN_FILE_WO:
@@ -86,20 +161,35 @@ void FtpImpl::_process_ack(PayloadHeader* payload)
             _session_valid = true;
             _session = payload->session;
             _bytes_transferred = 0;
+            _upload_next_offset = 0;
+            _upload_in_flight.clear();
+            _upload_buffer.clear();
+            _upload_buffer_offset = 0;
+            _last_progress_time = std::chrono::steady_clock::now();
             _call_op_progress_callback(_bytes_transferred, _file_size);
             _write();
             break;
 
-        case CMD_WRITE_FILE:
-            _call_op_progress_callback(_bytes_transferred, _file_size);
+        case CMD_WRITE_FILE: {
+            // Acks of chunks sent again can come in twice.
+            const auto chunk = _upload_in_flight.find(payload->offset);
+            if (chunk == _upload_in_flight.end()) {
+                break;
+            }
+            _upload_in_flight.erase(chunk);
+            _bytes_transferred += _upload_chunk_size(payload->offset);
+            _report_progress(_bytes_transferred);
             _write();
             break;
+        }
 
         case CMD_TERMINATE_SESSION:
             _curr_op = CMD_NONE;
             _session_valid = false;
             _stop_timer();
-            _call_op_result_callback(_session_result);
+            if (!_verify_download_crc()) {
+                _call_op_result_callback(_session_result);
+            }
             break;
 
         case CMD_RESET_SESSIONS:
@@ -158,6 +248,13 @@ void FtpImpl::_process_nak(PayloadHeader* payload)
         if (sr == ServerResult::ERR_FAIL_ERRNO && payload->data[1] == ENOENT) {
             sr = ServerResult::ERR_FAIL_FILE_DOES_NOT_EXIST;
         }
+        {
+            // The end of a burst we are not waiting for anymore.
+            std::lock_guard<std::mutex> lock(_curr_op_mutex);
+            if (payload->req_opcode == CMD_BURST_READ_FILE && _curr_op != CMD_BURST_READ_FILE) {
+                return;
+            }
+        }
         _process_nak(sr);
     }
 }
@@ -170,12 +267,23 @@ void FtpImpl::_process_nak(ServerResult result)
             LogWarn() << "Received NAK without active operation";
             break;
 
+        case CMD_BURST_READ_FILE:
+            if (result == ServerResult::ERR_EOF || result == ServerResult::ERR_UNKOWN_COMMAND) {
+                // The server went through to the end of the file, or it can't do bursts at
+                // all. Either way we read what's still missing chunk by chunk.
+                _add_download_gap(_download_offset, _file_size - _download_offset);
+                _download_offset = _file_size;
+                _continue_download();
+                return;
+            }
+            // FALLTHROUGH
         case CMD_OPEN_FILE_RO:
         case CMD_READ_FILE:
             _session_result = result;
             if (_session_valid) {
                 _end_read_session();
             } else {
+                _close_download_file();
                 _stop_timer();
                 _call_op_result_callback(_session_result);
             }
@@ -187,6 +295,7 @@ void FtpImpl::_process_nak(ServerResult result)
             if (_session_valid) {
                 _end_write_session();
             } else {
+                _close_upload_file();
                 _stop_timer();
                 _call_op_result_callback(_session_result);
             }
@@ -195,6 +304,9 @@ void FtpImpl::_process_nak(ServerResult result)
         case CMD_TERMINATE_SESSION:
             _session_valid = false;
             _stop_timer();
+            if (_session_result == ServerResult::SUCCESS && _verify_download_crc()) {
+                return;
+            }
             _call_op_result_callback(_session_result);
             break;
 
@@ -242,6 +354,18 @@ void FtpImpl::_call_op_progress_callback(uint32_t bytes_read, uint32_t total_byt
     }
 }
 
+void FtpImpl::_report_progress(uint32_t bytes_transferred)
+{
+    // With bursts or many writes in flight chunks come in faster than user callbacks can be
+    // called, so we don't report every chunk.
+    const auto now = std::chrono::steady_clock::now();
+    if (now - _last_progress_time >= progress_interval ||
+        bytes_transferred == _file_size) {
+        _last_progress_time = now;
+        _call_op_progress_callback(bytes_transferred, _file_size);
+    }
+}
+
 void FtpImpl::_call_dir_items_result_callback(ServerResult result, std::vector<std::string> list)
 {
     if (_curr_dir_items_result_callback) {
@@ -277,6 +401,8 @@ Ftp::Result FtpImpl::_translate(ServerResult result)
             return Ftp::Result::Unsupported;
         case ServerResult::ERR_FAIL_FILE_DOES_NOT_EXIST:
             return Ftp::Result::FileDoesNotExist;
+        case ServerResult::ERR_NO_SESSIONS_AVAILABLE:
+            return Ftp::Result::Busy;
         default:
             return Ftp::Result::ProtocolError;
     }
@@ -292,7 +418,7 @@ void FtpImpl::reset_async(Ftp::ResultCallback callback)
 
     uint8_t raw_payload[MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN];
     PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(raw_payload);
-    payload->seq_number = _seq_number++;
+    payload->seq_number = (*_seq_number)++;
     payload->session = _session;
     payload->opcode = _curr_op = CMD_RESET_SESSIONS;
     payload->offset = 0;
@@ -311,12 +437,21 @@ void FtpImpl::download_async(
         return;
     }
 
-    std::string local_path = local_folder + path_separator + fs_filename(remote_path);
-
-    _ofstream =
-        std::make_shared<std::ofstream>(local_path, std::fstream::trunc | std::fstream::binary);
-    if (!*_ofstream) {
-        _end_read_session();
+    _download_path = local_folder + path_separator + fs_filename(remote_path);
+    _download_remote_path = remote_path;
+    _download_crc = Crc32{};
+    _download_crc_offset = 0;
+    _download_checkpoint_offset = 0;
+    _resume_file_size = 0;
+    _verify_download = false;
+
+    // Without a checkpoint to continue from, the file is started over.
+    const bool resume = _resumable_download && _load_download_checkpoint();
+    _download_fd = ::open(
+        _download_path.c_str(),
+        O_RDWR | O_CREAT | (resume ? 0 : O_TRUNC) | binary_open_flag,
+        0666);
+    if (_download_fd < 0) {
         Ftp::ProgressData empty{};
         callback(Ftp::Result::FileIoError, empty);
         return;
@@ -330,36 +465,375 @@ void FtpImpl::download_async(
     };
 
     _generic_command_async(CMD_OPEN_FILE_RO, 0, remote_path, result_callback);
+    if (_curr_op != CMD_OPEN_FILE_RO) {
+        _close_download_file();
+    }
 }
 
 void FtpImpl::_end_read_session()
 {
     _curr_op = CMD_NONE;
-    if (_ofstream) {
-        _ofstream->close();
-        _ofstream = nullptr;
-    }
+    _close_download_file();
     _terminate_session();
 }
 
-void FtpImpl::_read()
+void FtpImpl::_start_download()
 {
-    if (_bytes_transferred >= _file_size) {
-        _session_result = ServerResult::SUCCESS;
+    _download_gaps.clear();
+    _download_missing_bytes = 0;
+    _gap_reads_in_flight = 0;
+    _burst_data_received = false;
+
+    if (_resume_file_size != 0 && _resume_file_size != _file_size) {
+        LogWarn() << "Remote file changed, starting download over";
+        _download_crc = Crc32{};
+        _download_crc_offset = 0;
+        if (ftruncate(_download_fd, 0) != 0) {
+            _session_result = ServerResult::ERR_FILE_IO_ERROR;
+            _end_read_session();
+            return;
+        }
+    }
+    _resume_file_size = _file_size;
+
+    if (!_preallocate_download_file()) {
+        _session_result = ServerResult::ERR_FILE_IO_ERROR;
         _end_read_session();
         return;
     }
+    _last_progress_time = std::chrono::steady_clock::now();
+    _call_op_progress_callback(_download_crc_offset, _file_size);
 
+    // A resumed download continues after what we already have.
+    if (_burst_download) {
+        _download_offset = _download_crc_offset;
+    } else {
+        // The rest is missing, and read one chunk after the other.
+        _download_offset = _file_size;
+        _add_download_gap(_download_crc_offset, _file_size - _download_crc_offset);
+    }
+    _continue_download();
+}
+
+void FtpImpl::_continue_download()
+{
+    if (_download_offset < _file_size) {
+        _request_burst();
+    } else {
+        _read();
+    }
+}
+
+bool FtpImpl::_retry_download()
+{
+    std::lock_guard<std::mutex> lock(_curr_op_mutex);
+    if (_download_fd < 0 || (_curr_op != CMD_BURST_READ_FILE && _curr_op != CMD_READ_FILE)) {
+        return false;
+    }
+
+    const uint32_t retries = _last_command_retries;
+    if (_curr_op == CMD_BURST_READ_FILE && !_burst_data_received &&
+        retries >= burst_fallback_retries) {
+        LogWarn() << "No burst data, reading chunk by chunk instead";
+        _add_download_gap(_download_offset, _file_size - _download_offset);
+        _download_offset = _file_size;
+    }
+
+    // Only ask for what's still missing instead of repeating the last request.
+    _continue_download();
+    _last_command_retries = retries;
+    return true;
+}
+
+void FtpImpl::_request_burst()
+{
     uint8_t raw_payload[MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN];
     PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(raw_payload);
-    payload->seq_number = _seq_number++;
+    payload->seq_number = (*_seq_number)++;
     payload->session = _session;
-    payload->opcode = _curr_op = CMD_READ_FILE;
-    payload->offset = _bytes_transferred;
+    payload->opcode = _curr_op = CMD_BURST_READ_FILE;
+    payload->offset = _download_offset;
     payload->size = 0;
     _send_mavlink_ftp_message(raw_payload);
 }
 
+void FtpImpl::_read()
+{
+    if (_download_gaps.empty()) {
+        _session_result = ServerResult::SUCCESS;
+        _verify_download = _resumable_download;
+        _end_read_session();
+        return;
+    }
+
+    // After a burst there are usually only a few chunks missing all over the file, so we ask
+    // for several at once. Without bursts it's one at a time, as servers expect.
+    const unsigned max_reads = _burst_download ? max_gap_reads_in_flight : 1;
+    _gap_reads_in_flight = 0;
+
+    for (const auto& gap : _download_gaps) {
+        for (uint32_t offset = gap.first;
+             offset < gap.first + gap.second && _gap_reads_in_flight < max_reads;
+             offset += max_data_length) {
+            uint8_t raw_payload[MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN];
+            PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(raw_payload);
+            payload->seq_number = (*_seq_number)++;
+            payload->session = _session;
+            payload->opcode = _curr_op = CMD_READ_FILE;
+            payload->offset = offset;
+            payload->size = 0;
+            _send_mavlink_ftp_message(raw_payload);
+            ++_gap_reads_in_flight;
+        }
+        if (_gap_reads_in_flight >= max_reads) {
+            break;
+        }
+    }
+}
+
+bool FtpImpl::_process_download_data(PayloadHeader* payload)
+{
+    const uint32_t offset = payload->offset;
+    if (payload->size == 0 || offset >= _file_size) {
+        return true;
+    }
+    const uint32_t size = std::min<uint32_t>(payload->size, _file_size - offset);
+
+    if (!_write_download_file(offset, payload->data, size)) {
+        _session_result = ServerResult::ERR_FILE_IO_ERROR;
+        _end_read_session();
+        return false;
+    }
+
+    if (offset > _download_offset) {
+        _add_download_gap(_download_offset, offset - _download_offset);
+    }
+    _mark_download_received(offset, size);
+    _download_offset = std::max(_download_offset, offset + size);
+
+    if (_resumable_download && !_advance_download_crc(offset, payload->data, size)) {
+        _session_result = ServerResult::ERR_FILE_IO_ERROR;
+        _end_read_session();
+        return false;
+    }
+
+    _report_progress(_download_offset - _download_missing_bytes);
+    return true;
+}
+
+void FtpImpl::_add_download_gap(uint32_t offset, uint32_t size)
+{
+    if (size == 0) {
+        return;
+    }
+    _download_gaps[offset] = size;
+    _download_missing_bytes += size;
+}
+
+void FtpImpl::_mark_download_received(uint32_t offset, uint32_t size)
+{
+    const uint32_t end = offset + size;
+
+    // Start with the gap which might contain offset.
+    auto it = _download_gaps.upper_bound(offset);
+    if (it != _download_gaps.begin()) {
+        --it;
+    }
+
+    while (it != _download_gaps.end() && it->first < end) {
+        const uint32_t gap_start = it->first;
+        const uint32_t gap_end = it->first + it->second;
+        if (gap_end <= offset) {
+            ++it;
+            continue;
+        }
+
+        it = _download_gaps.erase(it);
+        _download_missing_bytes -= std::min(gap_end, end) - std::max(gap_start, offset);
+
+        // Whatever is left on either side is still missing.
+        if (gap_start < offset) {
+            _download_gaps[gap_start] = offset - gap_start;
+        }
+        if (gap_end > end) {
+            _download_gaps[end] = gap_end - end;
+        }
+    }
+}
+
+bool FtpImpl::_preallocate_download_file()
+{
+    if (_file_size == 0) {
+        return true;
+    }
+#if defined(LINUX)
+    // Reserves the space up front, not all file systems support it though.
+    if (posix_fallocate(_download_fd, 0, _file_size) == 0) {
+        return true;
+    }
+#endif
+    return ftruncate(_download_fd, _file_size) == 0;
+}
+
+bool FtpImpl::_write_download_file(uint32_t offset, const uint8_t* data, uint32_t size)
+{
+#if defined(WINDOWS)
+    if (lseek(_download_fd, offset, SEEK_SET) < 0) {
+        return false;
+    }
+    return ::write(_download_fd, data, size) == static_cast<int>(size);
+#else
+    return pwrite(_download_fd, data, size, offset) == static_cast<ssize_t>(size);
+#endif
+}
+
+bool FtpImpl::_read_download_file(uint32_t offset, uint8_t* data, uint32_t size)
+{
+#if defined(WINDOWS)
+    if (lseek(_download_fd, offset, SEEK_SET) < 0) {
+        return false;
+    }
+    return ::read(_download_fd, data, size) == static_cast<int>(size);
+#else
+    return pread(_download_fd, data, size, offset) == static_cast<ssize_t>(size);
+#endif
+}
+
+void FtpImpl::_close_download_file()
+{
+    if (_download_fd >= 0) {
+        close(_download_fd);
+        _download_fd = -1;
+
+        // What we have so far is kept to continue from next time.
+        if (_resumable_download && _session_result != ServerResult::SUCCESS) {
+            if (_download_crc_offset > 0) {
+                _save_download_checkpoint();
+            } else {
+                fs_remove(_download_path + checkpoint_suffix);
+            }
+        }
+    }
+}
+
+bool FtpImpl::_load_download_checkpoint()
+{
+    std::ifstream checkpoint(_download_path + checkpoint_suffix);
+    std::string remote_path;
+    uint32_t file_size = 0;
+    uint32_t offset = 0;
+    uint32_t crc = 0;
+    if (!std::getline(checkpoint, remote_path) || !(checkpoint >> file_size >> offset >> crc)) {
+        return false;
+    }
+    if (remote_path != _download_remote_path || offset > file_size ||
+        !fs_exists(_download_path) || fs_file_size(_download_path) < offset) {
+        return false;
+    }
+
+    // The partial file is only of use if it hasn't changed since.
+    const int fd = ::open(_download_path.c_str(), O_RDONLY | binary_open_flag);
+    if (fd < 0) {
+        return false;
+    }
+    Crc32 checksum;
+    uint8_t buffer[4096];
+    uint32_t bytes_read = 0;
+    while (bytes_read < offset) {
+        const auto result =
+            ::read(fd, buffer, std::min<uint32_t>(sizeof(buffer), offset - bytes_read));
+        if (result <= 0) {
+            break;
+        }
+        checksum.add(buffer, static_cast<uint32_t>(result));
+        bytes_read += static_cast<uint32_t>(result);
+    }
+    close(fd);
+    if (bytes_read < offset || static_cast<uint32_t>(checksum.get()) != crc) {
+        LogWarn() << "Partial download " << _download_path << " changed, starting over";
+        return false;
+    }
+
+    LogInfo() << "Resuming download of " << remote_path << " at " << offset << " bytes";
+    _download_crc = checksum;
+    _download_crc_offset = offset;
+    _download_checkpoint_offset = offset;
+    _resume_file_size = file_size;
+    return true;
+}
+
+void FtpImpl::_save_download_checkpoint()
+{
+    std::ofstream checkpoint(_download_path + checkpoint_suffix, std::ios::trunc);
+    checkpoint << _download_remote_path << '\n'
+               << _resume_file_size << ' ' << _download_crc_offset << ' '
+               << static_cast<uint32_t>(_download_crc.get()) << '\n';
+    _download_checkpoint_offset = _download_crc_offset;
+}
+
+bool FtpImpl::_advance_download_crc(uint32_t offset, const uint8_t* data, uint32_t size)
+{
+    // Nothing is missing up to the first gap.
+    const uint32_t end = _download_gaps.empty() ? _download_offset : _download_gaps.begin()->first;
+
+    // In order, the CRC goes on with the chunk which just came in.
+    if (offset <= _download_crc_offset && _download_crc_offset < offset + size) {
+        const uint32_t length = std::min(offset + size, end) - _download_crc_offset;
+        _download_crc.add(data + (_download_crc_offset - offset), length);
+        _download_crc_offset += length;
+    }
+
+    // Chunks which came in before the ones missing in front of them are read back.
+    uint8_t buffer[4096];
+    while (_download_crc_offset < end) {
+        const uint32_t length = std::min<uint32_t>(sizeof(buffer), end - _download_crc_offset);
+        if (!_read_download_file(_download_crc_offset, buffer, length)) {
+            return false;
+        }
+        _download_crc.add(buffer, length);
+        _download_crc_offset += length;
+    }
+
+    if (_download_crc_offset - _download_checkpoint_offset >= checkpoint_interval) {
+        _save_download_checkpoint();
+    }
+    return true;
+}
+
+bool FtpImpl::_verify_download_crc()
+{
+    if (!_verify_download) {
+        return false;
+    }
+    _verify_download = false;
+
+    // If we don't get to verify it now, the next attempt continues with that.
+    _save_download_checkpoint();
+
+    const uint32_t expected_crc = static_cast<uint32_t>(_download_crc.get());
+    const std::string local_path = _download_path;
+    const std::string checkpoint_path = _download_path + checkpoint_suffix;
+    const auto callback = _curr_op_result_callback;
+    _current_crc32_result_callback =
+        [expected_crc, local_path, checkpoint_path, callback](Ftp::Result result, uint32_t crc) {
+            if (result == Ftp::Result::Success && crc != expected_crc) {
+                LogErr() << "CRC32 of " << local_path << " doesn't match, removing it";
+                fs_remove(local_path);
+                fs_remove(checkpoint_path);
+                result = Ftp::Result::ProtocolError;
+            } else if (result == Ftp::Result::Success || result == Ftp::Result::Unsupported) {
+                // Servers which can't calculate a CRC32 can't be verified against.
+                fs_remove(checkpoint_path);
+                result = Ftp::Result::Success;
+            }
+            if (callback) {
+                callback(result);
+            }
+        };
+    _request_file_crc32(_download_remote_path);
+    return true;
+}
+
 void FtpImpl::upload_async(
     const std::string& local_file_path,
     const std::string& remote_folder,
@@ -378,9 +852,8 @@ void FtpImpl::upload_async(
         return;
     }
 
-    _ifstream = std::make_shared<std::ifstream>(local_file_path, std::fstream::binary);
-    if (!*_ifstream) {
-        _end_write_session();
+    _upload_fd = ::open(local_file_path.c_str(), O_RDONLY | binary_open_flag);
+    if (_upload_fd < 0) {
         Ftp::ProgressData empty{};
         callback(Ftp::Result::FileIoError, empty);
         return;
@@ -397,41 +870,151 @@ void FtpImpl::upload_async(
     };
 
     _generic_command_async(CMD_OPEN_FILE_WO, 0, remote_file_path, result_callback);
+    if (_curr_op != CMD_OPEN_FILE_WO) {
+        _close_upload_file();
+    }
 }
 
 void FtpImpl::_end_write_session()
 {
     _curr_op = CMD_NONE;
-    if (_ifstream) {
-        _ifstream->close();
-        _ifstream = nullptr;
-    }
+    _close_upload_file();
     _terminate_session();
 }
 
+Ftp::Result FtpImpl::set_upload_window_size(uint32_t window_size)
+{
+    if (window_size == 0 || window_size > max_upload_window_size) {
+        return Ftp::Result::InvalidParameter;
+    }
+    std::lock_guard<std::mutex> lock(_curr_op_mutex);
+    _upload_window_size = window_size;
+    return Ftp::Result::Success;
+}
+
 void FtpImpl::_write()
 {
-    if (_bytes_transferred >= _file_size) {
+    if (_upload_in_flight.empty() && _upload_next_offset >= _file_size) {
         _session_result = ServerResult::SUCCESS;
         _end_write_session();
         return;
     }
 
+    // Chunks waiting for an ack for too long are lost, or their ack is. Others can still
+    // come in, so we only send these again.
+    const auto now = std::chrono::steady_clock::now();
+    const auto timeout = std::chrono::milliseconds(static_cast<int>(_last_command_timeout));
+    for (auto& chunk : _upload_in_flight) {
+        if (now - chunk.second >= timeout) {
+            if (!_send_upload_chunk(chunk.first)) {
+                return;
+            }
+            chunk.second = now;
+        }
+    }
+
+    // Everything in flight needs to stay in the buffer, in case it has to be sent again.
+    while (_upload_in_flight.size() < _upload_window_size && _upload_next_offset < _file_size) {
+        const uint32_t size = _upload_chunk_size(_upload_next_offset);
+        const uint32_t window_start =
+            _upload_in_flight.empty() ? _upload_next_offset : _upload_in_flight.begin()->first;
+        if (_upload_next_offset + size - window_start > _upload_buffer_capacity()) {
+            break;
+        }
+        if (!_send_upload_chunk(_upload_next_offset)) {
+            return;
+        }
+        _upload_in_flight[_upload_next_offset] = now;
+        _upload_next_offset += size;
+    }
+}
+
+bool FtpImpl::_retry_upload()
+{
+    std::lock_guard<std::mutex> lock(_curr_op_mutex);
+    if (_upload_fd < 0 || _curr_op != CMD_WRITE_FILE) {
+        return false;
+    }
+
+    // Nothing came back for a while, so everything still in flight is sent again.
+    const uint32_t retries = _last_command_retries;
+    const auto now = std::chrono::steady_clock::now();
+    for (auto& chunk : _upload_in_flight) {
+        if (!_send_upload_chunk(chunk.first)) {
+            break;
+        }
+        chunk.second = now;
+    }
+    _last_command_retries = retries;
+    return true;
+}
+
+bool FtpImpl::_send_upload_chunk(uint32_t offset)
+{
+    const uint32_t size = _upload_chunk_size(offset);
+
+    if (offset < _upload_buffer_offset ||
+        offset + size > _upload_buffer_offset + _upload_buffer.size()) {
+        // Refill the buffer from the oldest chunk still in flight.
+        const uint32_t start = _upload_in_flight.empty() ?
+                                   offset :
+                                   std::min(offset, _upload_in_flight.begin()->first);
+        if (!_read_upload_file(start)) {
+            _session_result = ServerResult::ERR_FILE_IO_ERROR;
+            _end_write_session();
+            return false;
+        }
+    }
+
     uint8_t raw_payload[MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN];
     PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(raw_payload);
-    payload->seq_number = _seq_number++;
+    payload->seq_number = (*_seq_number)++;
     payload->session = _session;
     payload->opcode = _curr_op = CMD_WRITE_FILE;
-    payload->offset = _bytes_transferred;
-    int bytes_read = _ifstream->readsome(reinterpret_cast<char*>(payload->data), max_data_length);
-    if (!*_ifstream) {
-        _end_write_session();
-        _call_op_result_callback(ServerResult::ERR_FILE_IO_ERROR);
-        return;
-    }
-    payload->size = bytes_read;
-    _bytes_transferred += bytes_read;
+    payload->offset = offset;
+    payload->size = static_cast<uint8_t>(size);
+    memcpy(payload->data, &_upload_buffer[offset - _upload_buffer_offset], size);
     _send_mavlink_ftp_message(raw_payload);
+    return true;
+}
+
+bool FtpImpl::_read_upload_file(uint32_t offset)
+{
+    const uint32_t size = std::min(_upload_buffer_capacity(), _file_size - offset);
+    _upload_buffer.resize(size);
+    _upload_buffer_offset = offset;
+
+    if (lseek(_upload_fd, offset, SEEK_SET) < 0) {
+        return false;
+    }
+    uint32_t bytes_read = 0;
+    while (bytes_read < size) {
+        const auto result = ::read(_upload_fd, &_upload_buffer[bytes_read], size - bytes_read);
+        if (result <= 0) {
+            // The file got shorter or can't be read.
+            return false;
+        }
+        bytes_read += static_cast<uint32_t>(result);
+    }
+    return true;
+}
+
+uint32_t FtpImpl::_upload_buffer_capacity()
+{
+    return max_upload_window_size * max_data_length;
+}
+
+uint32_t FtpImpl::_upload_chunk_size(uint32_t offset) const
+{
+    return (offset < _file_size) ? std::min<uint32_t>(max_data_length, _file_size - offset) : 0;
+}
+
+void FtpImpl::_close_upload_file()
+{
+    if (_upload_fd >= 0) {
+        close(_upload_fd);
+        _upload_fd = -1;
+    }
 }
 
 void FtpImpl::_terminate_session()
@@ -441,7 +1024,7 @@ void FtpImpl::_terminate_session()
     }
     uint8_t raw_payload[MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN];
     PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(raw_payload);
-    payload->seq_number = _seq_number++;
+    payload->seq_number = (*_seq_number)++;
     payload->session = _session;
     payload->opcode = _curr_op = CMD_TERMINATE_SESSION;
     payload->offset = 0;
@@ -485,7 +1068,7 @@ void FtpImpl::_list_directory(uint32_t offset)
 {
     uint8_t raw_payload[MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN];
     PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(raw_payload);
-    payload->seq_number = _seq_number++;
+    payload->seq_number = (*_seq_number)++;
     payload->session = 0;
     payload->opcode = _curr_op = CMD_LIST_DIRECTORY;
     payload->offset = offset;
@@ -512,7 +1095,7 @@ void FtpImpl::_generic_command_async(
 
     uint8_t raw_payload[MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN];
     PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(raw_payload);
-    payload->seq_number = _seq_number++;
+    payload->seq_number = (*_seq_number)++;
     payload->session = 0;
     payload->opcode = _curr_op = opcode;
     payload->offset = offset;
@@ -596,7 +1179,7 @@ void FtpImpl::rename_async(
 
     uint8_t raw_payload[MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN];
     PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(raw_payload);
-    payload->seq_number = _seq_number++;
+    payload->seq_number = (*_seq_number)++;
     payload->session = 0;
     payload->opcode = _curr_op = CMD_RENAME;
     payload->offset = 0;
@@ -658,6 +1241,42 @@ void FtpImpl::are_files_identical_async(
         });
 }
 
+void FtpImpl::sync_directory_async(
+    const std::string& remote_dir,
+    const std::string& local_dir,
+    Ftp::SyncDirectoryCallback callback)
+{
+    if (!_transfer_manager) {
+        Ftp::ProgressData empty{};
+        callback(Ftp::Result::Unsupported, empty);
+        return;
+    }
+    _transfer_manager->sync_directory_async(remote_dir, local_dir, callback);
+}
+
+Ftp::Result FtpImpl::set_max_parallel_transfers(uint32_t count)
+{
+    if (!_transfer_manager) {
+        return Ftp::Result::Unsupported;
+    }
+    return _transfer_manager->set_max_parallel_transfers(count);
+}
+
+std::unique_ptr<FtpImpl> FtpImpl::_create_client()
+{
+    std::unique_ptr<FtpImpl> client(new FtpImpl(_system, true));
+
+    std::lock_guard<std::mutex> lock(_curr_op_mutex);
+    client->_target_component_id = _target_component_id;
+    client->_target_component_id_set = _target_component_id_set;
+    client->_max_last_command_retries = _max_last_command_retries;
+    client->_burst_download = _burst_download;
+    client->_upload_window_size = _upload_window_size;
+    client->_resumable_download = _resumable_download;
+    client->_seq_number = _seq_number;
+    return client;
+}
+
 void FtpImpl::_calc_file_crc32_async(const std::string& path, file_crc32_ResultCallback callback)
 {
     std::lock_guard<std::mutex> lock(_curr_op_mutex);
@@ -670,20 +1289,26 @@ void FtpImpl::_calc_file_crc32_async(const std::string& path, file_crc32_ResultC
         return;
     }
 
+    _current_crc32_result_callback = callback;
+    _request_file_crc32(path);
+}
+
+void FtpImpl::_request_file_crc32(const std::string& path)
+{
     uint8_t raw_payload[MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN];
     PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(raw_payload);
-    payload->seq_number = _seq_number++;
+    payload->seq_number = (*_seq_number)++;
     payload->session = 0;
     payload->opcode = _curr_op = CMD_CALC_FILE_CRC32;
     payload->offset = 0;
     strncpy(reinterpret_cast<char*>(payload->data), path.c_str(), max_data_length - 1);
     payload->size = path.length() + 1;
-    _current_crc32_result_callback = callback;
     _send_mavlink_ftp_message(raw_payload);
 }
 
 void FtpImpl::_send_mavlink_ftp_message(uint8_t* raw_payload)
 {
+    _last_request_seq = reinterpret_cast<PayloadHeader*>(raw_payload)->seq_number;
     mavlink_msg_file_transfer_protocol_pack(
         _parent->get_own_system_id(),
         _parent->get_own_component_id(),
@@ -718,7 +1343,9 @@ void FtpImpl::_command_timeout()
     } else {
         _last_command_retries++;
         LogWarn() << "Response timeout. Retry: " << _last_command_retries;
-        _parent->send_message(_last_command);
+        if (!_retry_download() && !_retry_upload()) {
+            _parent->send_message(_last_command);
+        }
         _parent->register_timeout_handler(
             std::bind(&FtpImpl::_command_timeout, this),
             static_cast<double>(_last_command_timeout) / 1000.0,
@@ -750,7 +1377,6 @@ void FtpImpl::process_mavlink_ftp_message(const mavlink_message_t& msg)
         return;
     }
 
-    bool stream_send = false;
     mavlink_file_transfer_protocol_t ftp_req;
     mavlink_msg_file_transfer_protocol_decode(&msg, &ftp_req);
 
@@ -761,6 +1387,101 @@ void FtpImpl::process_mavlink_ftp_message(const mavlink_message_t& msg)
 
     PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(&ftp_req.payload[0]);
 
+    if (payload->opcode == RSP_ACK || payload->opcode == RSP_NAK) {
+        if (!_is_response_for_us(payload)) {
+            return;
+        }
+        if (payload->opcode == RSP_ACK) {
+            _process_ack(payload);
+        } else {
+            _process_nak(payload);
+        }
+    } else if (!_client_only) {
+        _queue_server_request(msg, &ftp_req.payload[0]);
+    }
+}
+
+bool FtpImpl::_is_response_for_us(const PayloadHeader* payload)
+{
+    // There can be several clients for the same server, see FtpTransferManager. Responses
+    // to requests in a session carry its id, the others the sequence number of the request
+    // plus one.
+    std::lock_guard<std::mutex> lock(_curr_op_mutex);
+    switch (payload->req_opcode) {
+        case CMD_READ_FILE:
+        case CMD_BURST_READ_FILE:
+        case CMD_WRITE_FILE:
+        case CMD_TERMINATE_SESSION:
+            return _session_valid && payload->session == _session;
+        default:
+            return _curr_op != CMD_NONE &&
+                   payload->seq_number == static_cast<uint16_t>(_last_request_seq + 1);
+    }
+}
+
+void FtpImpl::_queue_server_request(const mavlink_message_t& msg, const uint8_t* raw_payload)
+{
+    std::lock_guard<std::mutex> lock(_server_mutex);
+    if (_server_requests.size() >= max_queued_server_requests) {
+        LogWarn() << "FTP server too slow, dropping request";
+        return;
+    }
+    if (!_server_thread.joinable()) {
+        _server_thread = std::thread(&FtpImpl::_run_server, this);
+    }
+    ServerRequest request;
+    request.system_id = msg.sysid;
+    request.component_id = msg.compid;
+    std::copy(raw_payload, raw_payload + request.payload.size(), request.payload.begin());
+    _server_requests.push_back(request);
+    _server_cv.notify_one();
+}
+
+void FtpImpl::_run_server()
+{
+    bool bursting = false;
+    std::unique_lock<std::mutex> lock(_server_mutex);
+    while (!_server_should_exit) {
+        if (!_server_requests.empty()) {
+            ServerRequest request = _server_requests.front();
+            _server_requests.pop_front();
+            lock.unlock();
+            _process_server_request(request);
+            // The request might have started a burst.
+            bursting = true;
+            lock.lock();
+        } else if (bursting) {
+            // Requests go first, bursts are sent in between.
+            lock.unlock();
+            bursting = _send_burst_chunks();
+            lock.lock();
+        } else {
+            _server_cv.wait(lock);
+        }
+    }
+}
+
+void FtpImpl::_stop_server()
+{
+    {
+        std::lock_guard<std::mutex> lock(_server_mutex);
+        _server_should_exit = true;
+        _server_cv.notify_one();
+    }
+    if (_server_thread.joinable()) {
+        _server_thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(_server_mutex);
+    _server_requests.clear();
+    _server_should_exit = false;
+    _close_server_sessions();
+}
+
+void FtpImpl::_process_server_request(ServerRequest& request)
+{
+    PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(request.payload.data());
+    bool stream_send = false;
     ServerResult error_code = ServerResult::SUCCESS;
 
     // basic sanity checks; must validate length before use
@@ -818,19 +1539,17 @@ void FtpImpl::process_mavlink_ftp_message(const mavlink_message_t& msg)
                 error_code = _work_open(payload, O_CREAT | O_WRONLY);
                 break;
 
+            // Reads, bursts and writes are not logged, there are many of them in a transfer.
             case CMD_READ_FILE:
-                LogInfo() << "OPC:CMD_READ_FILE";
                 error_code = _work_read(payload);
                 break;
 
             case CMD_BURST_READ_FILE:
-                LogInfo() << "OPC:CMD_BURST_READ_FILE";
-                error_code = _work_burst(payload);
+                error_code = _work_burst(payload, request);
                 stream_send = true;
                 break;
 
             case CMD_WRITE_FILE:
-                LogInfo() << "OPC:CMD_WRITE_FILE";
                 error_code = _work_write(payload);
                 break;
 
@@ -859,14 +1578,6 @@ void FtpImpl::process_mavlink_ftp_message(const mavlink_message_t& msg)
                 error_code = _work_calc_file_CRC32(payload);
                 break;
 
-            case RSP_ACK:
-                _process_ack(payload);
-                return;
-
-            case RSP_NAK:
-                _process_nak(payload);
-                return;
-
             default:
                 LogWarn() << "OPC:Unknown command: " << static_cast<int>(payload->opcode);
                 error_code = ServerResult::ERR_UNKOWN_COMMAND;
@@ -903,24 +1614,71 @@ void FtpImpl::process_mavlink_ftp_message(const mavlink_message_t& msg)
 
     _last_reply_valid = false;
 
-    // Stream download replies are sent through mavlink stream mechanism. Unless we need to Nack.
+    // The data of a burst is sent by _send_burst_chunks. Unless we need to Nack.
     if (!stream_send || error_code != ServerResult::SUCCESS) {
         // keep a copy of the last sent response ((n)ack), so that if it gets lost and the GCS
         // resends the request, we can simply resend the response.
         _last_reply_valid = true;
         _last_reply_seq = payload->seq_number;
-        mavlink_msg_file_transfer_protocol_pack(
-            _parent->get_own_system_id(),
-            _parent->get_own_component_id(),
-            &_last_reply,
-            _network_id,
-            _parent->get_system_id(),
-            _get_target_component_id(),
-            reinterpret_cast<const uint8_t*>(payload));
+        _pack_server_message(payload, request.system_id, request.component_id, _last_reply);
         _parent->send_message(_last_reply);
     }
 }
 
+bool FtpImpl::_send_burst_chunks()
+{
+    bool bursting = false;
+    for (auto& entry : _server_sessions) {
+        ServerSession& session = entry.second;
+        for (unsigned i = 0; session.burst && i < burst_chunks_per_turn; ++i) {
+            PayloadHeader payload{};
+            payload.seq_number = session.burst_seq_number++;
+            payload.session = entry.first;
+            payload.req_opcode = CMD_BURST_READ_FILE;
+            payload.offset = session.burst_offset;
+
+            const ServerResult result = _read_server_chunk(session, &payload);
+            if (result == ServerResult::SUCCESS) {
+                payload.opcode = RSP_ACK;
+                session.burst_offset += payload.size;
+                session.burst = session.burst_offset < session.burst_end;
+                payload.burst_complete = session.burst ? 0 : 1;
+            } else {
+                payload.opcode = RSP_NAK;
+                payload.size = 1;
+                payload.data[0] = result;
+                session.burst = false;
+            }
+
+            mavlink_message_t message;
+            _pack_server_message(
+                &payload,
+                session.burst_target_system_id,
+                session.burst_target_component_id,
+                message);
+            _parent->send_message(message);
+        }
+        bursting = bursting || session.burst;
+    }
+    return bursting;
+}
+
+void FtpImpl::_pack_server_message(
+    const PayloadHeader* payload,
+    uint8_t target_system_id,
+    uint8_t target_component_id,
+    mavlink_message_t& message)
+{
+    mavlink_msg_file_transfer_protocol_pack(
+        _parent->get_own_system_id(),
+        _parent->get_own_component_id(),
+        &message,
+        _network_id,
+        target_system_id,
+        target_component_id,
+        reinterpret_cast<const uint8_t*>(payload));
+}
+
 /// @brief Guarantees that the payload data is null terminated.
 /// @return Returns payload data as a std string
 std::string FtpImpl::_data_as_string(PayloadHeader* payload)
@@ -1025,7 +1783,7 @@ FtpImpl::ServerResult FtpImpl::_work_list(PayloadHeader* payload, bool list_hidd
 
 FtpImpl::ServerResult FtpImpl::_work_open(PayloadHeader* payload, int oflag)
 {
-    if (_session_info.fd >= 0) {
+    if (_server_sessions.size() >= max_server_sessions) {
         return ServerResult::ERR_NO_SESSIONS_AVAILABLE;
     }
 
@@ -1046,7 +1804,7 @@ FtpImpl::ServerResult FtpImpl::_work_open(PayloadHeader* payload, int oflag)
     LogInfo() << "Open: " << path << " FS: " << file_size;
 
     // Set mode to 666 incase oflag has O_CREAT
-    int fd = ::open(path.c_str(), oflag, 0666);
+    int fd = ::open(path.c_str(), oflag | binary_open_flag, 0666);
 
     if (fd < 0) {
         LogWarn() << "FTP: Open failed";
@@ -1054,11 +1812,18 @@ FtpImpl::ServerResult FtpImpl::_work_open(PayloadHeader* payload, int oflag)
                                    ServerResult::ERR_FAIL;
     }
 
-    _session_info.fd = fd;
-    _session_info.file_size = file_size;
-    _session_info.stream_download = false;
+    // Ids go round, so late replies of a session just closed aren't taken for the next one.
+    uint8_t session_id = _next_server_session;
+    while (_server_sessions.find(session_id) != _server_sessions.end()) {
+        ++session_id;
+    }
+    _next_server_session = session_id + 1;
 
-    payload->session = 0;
+    ServerSession& session = _server_sessions[session_id];
+    session.fd = fd;
+    session.file_size = file_size;
+
+    payload->session = session_id;
     payload->size = sizeof(uint32_t);
     memcpy(payload->data, &file_size, payload->size);
 
@@ -1067,59 +1832,102 @@ FtpImpl::ServerResult FtpImpl::_work_open(PayloadHeader* payload, int oflag)
 
 FtpImpl::ServerResult FtpImpl::_work_read(PayloadHeader* payload)
 {
-    if (payload->session != 0 || _session_info.fd < 0) {
+    auto it = _server_sessions.find(payload->session);
+    if (it == _server_sessions.end()) {
         return ServerResult::ERR_INVALID_SESSION;
     }
 
+    return _read_server_chunk(it->second, payload);
+}
+
+FtpImpl::ServerResult FtpImpl::_read_server_chunk(ServerSession& session, PayloadHeader* payload)
+{
     // We have to test seek past EOF ourselves, lseek will allow seek past EOF
-    if (payload->offset >= _session_info.file_size) {
+    if (payload->offset >= session.file_size) {
         return ServerResult::ERR_EOF;
     }
 
-    if (lseek(_session_info.fd, payload->offset, SEEK_SET) < 0) {
-        return ServerResult::ERR_FAIL;
-    }
+    const uint32_t buffer_end = session.buffer_offset + session.buffer.size();
+    if (payload->offset < session.buffer_offset || payload->offset >= buffer_end ||
+        (payload->offset + max_data_length > buffer_end && buffer_end < session.file_size)) {
+        // Read ahead, so the chunks to come are taken from memory.
+        session.buffer.resize(server_read_ahead_size);
+        session.buffer_offset = payload->offset;
 
-    int bytes_read = ::read(_session_info.fd, &payload->data[0], max_data_length);
-
-    if (bytes_read < 0) {
-        // Negative return indicates error other than eof
-        return ServerResult::ERR_FAIL;
+        if (lseek(session.fd, payload->offset, SEEK_SET) < 0) {
+            session.buffer.clear();
+            return ServerResult::ERR_FAIL;
+        }
+        uint32_t bytes_read = 0;
+        while (bytes_read < server_read_ahead_size) {
+            const auto result = ::read(
+                session.fd, &session.buffer[bytes_read], server_read_ahead_size - bytes_read);
+            if (result < 0) {
+                // Negative return indicates error other than eof
+                session.buffer.clear();
+                return ServerResult::ERR_FAIL;
+            }
+            if (result == 0) {
+                break;
+            }
+            bytes_read += static_cast<uint32_t>(result);
+        }
+        session.buffer.resize(bytes_read);
+        if (bytes_read == 0) {
+            // The file got shorter since it was opened.
+            return ServerResult::ERR_EOF;
+        }
     }
 
-    payload->size = bytes_read;
+    const uint32_t buffer_index = payload->offset - session.buffer_offset;
+    payload->size = static_cast<uint8_t>(
+        std::min<uint32_t>(max_data_length, session.buffer.size() - buffer_index));
+    memcpy(payload->data, &session.buffer[buffer_index], payload->size);
 
     return ServerResult::SUCCESS;
 }
 
-FtpImpl::ServerResult FtpImpl::_work_burst(PayloadHeader* payload)
+FtpImpl::ServerResult
+FtpImpl::_work_burst(PayloadHeader* payload, const ServerRequest& request)
 {
-    if (payload->session != 0 && _session_info.fd < 0) {
+    auto it = _server_sessions.find(payload->session);
+    if (it == _server_sessions.end()) {
         return ServerResult::ERR_INVALID_SESSION;
     }
+    ServerSession& session = it->second;
+
+    if (payload->offset >= session.file_size) {
+        return ServerResult::ERR_EOF;
+    }
 
-    // Setup for streaming sends
-    _session_info.stream_download = true;
-    _session_info.stream_offset = payload->offset;
-    _session_info.stream_chunk_transmitted = 0;
-    _session_info.stream_seq_number = payload->seq_number + 1;
-    _session_info.stream_target_system_id = _parent->get_system_id();
+    // Setup for streaming sends, _send_burst_chunks goes on from here
+    session.burst = true;
+    session.burst_offset = payload->offset;
+    const uint32_t num_chunks =
+        std::max<uint32_t>(1, max_burst_chunks / static_cast<uint32_t>(_server_sessions.size()));
+    session.burst_end =
+        std::min(session.file_size, payload->offset + num_chunks * max_data_length);
+    session.burst_seq_number = payload->seq_number + 1;
+    session.burst_target_system_id = request.system_id;
+    session.burst_target_component_id = request.component_id;
 
     return ServerResult::SUCCESS;
 }
 
 FtpImpl::ServerResult FtpImpl::_work_write(PayloadHeader* payload)
 {
-    if (payload->session != 0 && _session_info.fd < 0) {
+    auto it = _server_sessions.find(payload->session);
+    if (it == _server_sessions.end()) {
         return ServerResult::ERR_INVALID_SESSION;
     }
+    const int fd = it->second.fd;
 
-    if (lseek(_session_info.fd, payload->offset, SEEK_SET) < 0) {
+    if (lseek(fd, payload->offset, SEEK_SET) < 0) {
         // Unable to see to the specified location
         return ServerResult::ERR_FAIL;
     }
 
-    int bytes_written = ::write(_session_info.fd, &payload->data[0], payload->size);
+    int bytes_written = ::write(fd, &payload->data[0], payload->size);
 
     if (bytes_written < 0) {
         // Negative return indicates error other than eof
@@ -1134,13 +1942,13 @@ FtpImpl::ServerResult FtpImpl::_work_write(PayloadHeader* payload)
 
 FtpImpl::ServerResult FtpImpl::_work_terminate(PayloadHeader* payload)
 {
-    if (payload->session != 0 || _session_info.fd < 0) {
+    auto it = _server_sessions.find(payload->session);
+    if (it == _server_sessions.end()) {
         return ServerResult::ERR_INVALID_SESSION;
     }
 
-    close(_session_info.fd);
-    _session_info.fd = -1;
-    _session_info.stream_download = false;
+    close(it->second.fd);
+    _server_sessions.erase(it);
 
     payload->size = 0;
 
@@ -1149,17 +1957,21 @@ FtpImpl::ServerResult FtpImpl::_work_terminate(PayloadHeader* payload)
 
 FtpImpl::ServerResult FtpImpl::_work_reset(PayloadHeader* payload)
 {
-    if (_session_info.fd != -1) {
-        close(_session_info.fd);
-        _session_info.fd = -1;
-        _session_info.stream_download = false;
-    }
+    _close_server_sessions();
 
     payload->size = 0;
 
     return ServerResult::SUCCESS;
 }
 
+void FtpImpl::_close_server_sessions()
+{
+    for (const auto& entry : _server_sessions) {
+        close(entry.second.fd);
+    }
+    _server_sessions.clear();
+}
+
 FtpImpl::ServerResult FtpImpl::_work_remove_directory(PayloadHeader* payload)
 {
     std::string path = _get_path(payload);
@@ -1299,12 +2111,4 @@ FtpImpl::ServerResult FtpImpl::_work_calc_file_CRC32(PayloadHeader* payload)
     return ServerResult::SUCCESS;
 }
 
-void FtpImpl::send()
-{
-    // Anything to stream?
-    if (!_session_info.stream_download) {
-        return;
-    }
-}
-
 } // namespace mavsdk
@@ -1,9 +1,19 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include "crc32.h"
 #include "mavlink_include.h"
 #include "plugins/ftp/ftp.h"
 #include "plugin_impl_base.h"
@@ -18,9 +28,13 @@
 
 namespace mavsdk {
 
+class FtpTransferManager;
+
 class FtpImpl : public PluginImplBase {
 public:
-    FtpImpl(System& system);
+    // Client only instances don't answer requests, so there can be several of them for one
+    // system next to the one which acts as server.
+    FtpImpl(System& system, bool client_only = false);
     FtpImpl(const FtpImpl&) = delete;
     const FtpImpl& operator=(const FtpImpl&) = delete;
 
@@ -32,8 +46,6 @@ public:
     void enable() override;
     void disable() override;
 
-    void send();
-
     std::pair<Ftp::Result, std::vector<std::string>> list_directory(const std::string& path);
     Ftp::Result create_directory(const std::string& path);
     Ftp::Result remove_directory(const std::string& path);
@@ -62,6 +74,10 @@ public:
         const std::string& local_path,
         const std::string& remote_path,
         Ftp::AreFilesIdenticalCallback callback);
+    void sync_directory_async(
+        const std::string& remote_dir,
+        const std::string& local_dir,
+        Ftp::SyncDirectoryCallback callback);
 
     void set_retries(uint32_t retries) { _max_last_command_retries = retries; }
     Ftp::Result set_root_directory(const std::string& root_dir);
@@ -72,6 +88,20 @@ public:
         return Ftp::Result::Success;
     }
     uint8_t get_our_compid() { return _parent->get_own_component_id(); };
+    Ftp::Result set_upload_window_size(uint32_t window_size);
+    Ftp::Result set_burst_download(bool enabled)
+    {
+        std::lock_guard<std::mutex> lock(_curr_op_mutex);
+        _burst_download = enabled;
+        return Ftp::Result::Success;
+    }
+    Ftp::Result set_resumable_download(bool enabled)
+    {
+        std::lock_guard<std::mutex> lock(_curr_op_mutex);
+        _resumable_download = enabled;
+        return Ftp::Result::Success;
+    }
+    Ftp::Result set_max_parallel_transfers(uint32_t count);
 
 private:
     /// @brief Possible server results returned for requests.
@@ -142,16 +172,35 @@ private:
         uint8_t data[max_data_length]; ///< command data, varies by Opcode
     });
 
-    struct SessionInfo {
+    // The server works off requests in its own thread, so reading and writing files doesn't
+    // hold up receiving messages. Sessions and the last reply are only used in that thread.
+    struct ServerSession {
         int fd{-1};
         uint32_t file_size{0};
-        bool stream_download{false};
-        uint32_t stream_offset{0};
-        uint16_t stream_seq_number{0};
-        uint8_t stream_target_system_id{0};
-        unsigned stream_chunk_transmitted{0};
+        /// Read ahead in large blocks, chunks are sent from here.
+        std::vector<uint8_t> buffer{};
+        uint32_t buffer_offset{0};
+        bool burst{false};
+        uint32_t burst_offset{0};
+        uint32_t burst_end{0};
+        uint16_t burst_seq_number{0};
+        uint8_t burst_target_system_id{0};
+        uint8_t burst_target_component_id{0};
+    };
+    /// Replies go to the component a request came from.
+    struct ServerRequest {
+        uint8_t system_id;
+        uint8_t component_id;
+        std::array<uint8_t, MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN> payload;
     };
-    struct SessionInfo _session_info {}; ///< Session info, fd=-1 for no active session
+
+    std::map<uint8_t, ServerSession> _server_sessions{};
+    uint8_t _next_server_session{0};
+    std::mutex _server_mutex{};
+    std::condition_variable _server_cv{};
+    std::deque<ServerRequest> _server_requests{};
+    bool _server_should_exit{false};
+    std::thread _server_thread{};
 
     uint8_t _network_id = 0;
     uint8_t _target_component_id = 0;
@@ -166,9 +215,10 @@ private:
     uint32_t _max_last_command_retries{5};
     uint32_t _last_command_retries = 0;
     std::string _last_path{};
-    uint16_t _seq_number = 0;
-    std::shared_ptr<std::ifstream> _ifstream{};
-    std::shared_ptr<std::ofstream> _ofstream{};
+    /// Shared with the clients of the transfer manager, so responses can be told apart.
+    std::shared_ptr<std::atomic<uint16_t>> _seq_number{
+        std::make_shared<std::atomic<uint16_t>>(0)};
+    uint16_t _last_request_seq = 0;
     bool _session_valid = false;
     uint8_t _session = 0;
     ServerResult _session_result = ServerResult::SUCCESS;
@@ -176,6 +226,44 @@ private:
     uint32_t _file_size = 0;
     std::vector<std::string> _curr_directory_list{};
 
+    // Downloads are written to their place in a preallocated file, so chunks of a burst can
+    // come in any order and missing ones can be filled in later.
+    int _download_fd{-1};
+    bool _burst_download{true};
+    bool _burst_data_received{false};
+    /// Everything before this offset has been sent by the server, or is in _download_gaps.
+    uint32_t _download_offset{0};
+    /// Missing ranges before _download_offset, size by offset.
+    std::map<uint32_t, uint32_t> _download_gaps{};
+    uint32_t _download_missing_bytes{0};
+
+    // Resumable downloads keep a checkpoint next to the partial file to continue from, and
+    // are verified against the CRC32 of the remote file in the end.
+    bool _resumable_download{false};
+    std::string _download_path{};
+    std::string _download_remote_path{};
+    /// CRC32 of everything before _download_crc_offset, where nothing is missing.
+    Crc32 _download_crc{};
+    uint32_t _download_crc_offset{0};
+    uint32_t _download_checkpoint_offset{0};
+    /// Size of the remote file the partial file is from, 0 if there is none.
+    uint32_t _resume_file_size{0};
+    bool _verify_download{false};
+
+    // Uploads keep several writes in flight, the ones not acked yet are sent again from the
+    // buffer after a timeout.
+    int _upload_fd{-1};
+    uint32_t _upload_window_size{8};
+    uint32_t _upload_next_offset{0};
+    /// Time sent by offset.
+    std::map<uint32_t, std::chrono::steady_clock::time_point> _upload_in_flight{};
+    /// Read from the file in large blocks, starting at the oldest chunk in flight.
+    std::vector<uint8_t> _upload_buffer{};
+    uint32_t _upload_buffer_offset{0};
+
+    std::chrono::steady_clock::time_point _last_progress_time{};
+    unsigned _gap_reads_in_flight{0};
+
     Ftp::ResultCallback _curr_op_result_callback{};
     // _curr_op_progress_callback is used for download_callback_t as well as upload_callback_t
     static_assert(
@@ -184,9 +272,15 @@ private:
     Ftp::DownloadCallback _curr_op_progress_callback{};
     Ftp::ListDirectoryCallback _curr_dir_items_result_callback{};
 
+    System& _system;
+    const bool _client_only;
+    std::unique_ptr<FtpTransferManager> _transfer_manager;
+    std::unique_ptr<FtpImpl> _create_client();
+
     file_crc32_ResultCallback _current_crc32_result_callback{};
 
     void _calc_file_crc32_async(const std::string& path, file_crc32_ResultCallback callback);
+    void _request_file_crc32(const std::string& path);
     Ftp::Result _calc_local_file_crc32(const std::string& path, uint32_t& csum);
 
     void _process_ack(PayloadHeader* payload);
@@ -195,12 +289,34 @@ private:
     static Ftp::Result _translate(ServerResult result);
     void _call_op_result_callback(ServerResult result);
     void _call_op_progress_callback(uint32_t bytes_written, uint32_t total_bytes);
+    void _report_progress(uint32_t bytes_transferred);
     void _call_dir_items_result_callback(ServerResult result, std::vector<std::string> list);
     void _call_crc32_result_callback(ServerResult result, uint32_t crc32);
     void _generic_command_async(
         Opcode opcode, uint32_t offset, const std::string& path, Ftp::ResultCallback callback);
+    void _start_download();
+    void _continue_download();
+    bool _retry_download();
+    void _request_burst();
     void _read();
+    bool _process_download_data(PayloadHeader* payload);
+    void _add_download_gap(uint32_t offset, uint32_t size);
+    void _mark_download_received(uint32_t offset, uint32_t size);
+    bool _preallocate_download_file();
+    bool _write_download_file(uint32_t offset, const uint8_t* data, uint32_t size);
+    bool _read_download_file(uint32_t offset, uint8_t* data, uint32_t size);
+    void _close_download_file();
+    bool _load_download_checkpoint();
+    void _save_download_checkpoint();
+    bool _advance_download_crc(uint32_t offset, const uint8_t* data, uint32_t size);
+    bool _verify_download_crc();
     void _write();
+    bool _retry_upload();
+    bool _send_upload_chunk(uint32_t offset);
+    bool _read_upload_file(uint32_t offset);
+    uint32_t _upload_chunk_size(uint32_t offset) const;
+    static uint32_t _upload_buffer_capacity();
+    void _close_upload_file();
     void _end_read_session();
     void _end_write_session();
     void _terminate_session();
@@ -222,6 +338,19 @@ private:
     mavlink_message_t _last_reply{};
 
     void process_mavlink_ftp_message(const mavlink_message_t& msg);
+    bool _is_response_for_us(const PayloadHeader* payload);
+    void _queue_server_request(const mavlink_message_t& msg, const uint8_t* raw_payload);
+    void _run_server();
+    void _stop_server();
+    void _process_server_request(ServerRequest& request);
+    bool _send_burst_chunks();
+    void _pack_server_message(
+        const PayloadHeader* payload,
+        uint8_t target_system_id,
+        uint8_t target_component_id,
+        mavlink_message_t& message);
+    ServerResult _read_server_chunk(ServerSession& session, PayloadHeader* payload);
+    void _close_server_sessions();
 
     std::string _data_as_string(PayloadHeader* payload);
     std::string _get_path(PayloadHeader* payload);
@@ -231,7 +360,7 @@ private:
     ServerResult _work_list(PayloadHeader* payload, bool list_hidden = false);
     ServerResult _work_open(PayloadHeader* payload, int oflag);
     ServerResult _work_read(PayloadHeader* payload);
-    ServerResult _work_burst(PayloadHeader* payload);
+    ServerResult _work_burst(PayloadHeader* payload, const ServerRequest& request);
     ServerResult _work_write(PayloadHeader* payload);
     ServerResult _work_terminate(PayloadHeader* payload);
     ServerResult _work_reset(PayloadHeader* payload);
@@ -0,0 +1,306 @@
+#include <cstdlib>
+
+#include "fs.h"
+#include "ftp_impl.h"
+#include "ftp_transfer_manager.h"
+#include "log.h"
+
+namespace mavsdk {
+
+namespace {
+
+constexpr unsigned default_parallel_transfers = 4;
+constexpr uint32_t max_parallel_transfers = 8;
+// Downloads started again when the server has no session available and none of ours is
+// open either, another client might just be done with one.
+constexpr unsigned max_busy_retries = 3;
+
+std::string join_remote_path(const std::string& dir, const std::string& name)
+{
+    // MAVLink FTP paths always use slashes.
+    if (!dir.empty() && dir.back() == '/') {
+        return dir + name;
+    }
+    return dir + "/" + name;
+}
+
+} // namespace
+
+FtpTransferManager::FtpTransferManager(CreateClient create_client) :
+    _create_client(create_client),
+    _max_parallel_transfers(default_parallel_transfers),
+    _max_sessions(default_parallel_transfers)
+{}
+
+FtpTransferManager::~FtpTransferManager() {}
+
+Ftp::Result FtpTransferManager::set_max_parallel_transfers(uint32_t count)
+{
+    if (count == 0 || count > max_parallel_transfers) {
+        return Ftp::Result::InvalidParameter;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    _max_parallel_transfers = count;
+    return Ftp::Result::Success;
+}
+
+void FtpTransferManager::sync_directory_async(
+    const std::string& remote_dir,
+    const std::string& local_dir,
+    Ftp::SyncDirectoryCallback callback)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_callback) {
+            _callback = callback;
+            _result = Ftp::Result::Success;
+            _bytes_done = 0;
+            _bytes_total = 0;
+            _max_sessions = _max_parallel_transfers;
+            _num_sessions = 0;
+            // New clients pick up settings changed since the last time.
+            _clients.clear();
+            _jobs.push_back(Job{Job::Type::List, remote_dir, local_dir, 0, 0});
+            callback = nullptr;
+        }
+    }
+
+    if (callback) {
+        Ftp::ProgressData empty{};
+        callback(Ftp::Result::Busy, empty);
+        return;
+    }
+    _dispatch();
+}
+
+void FtpTransferManager::_dispatch()
+{
+    std::vector<std::pair<Client*, Job>> runs;
+    Ftp::SyncDirectoryCallback callback{};
+    Ftp::Result result{};
+    Ftp::ProgressData progress{};
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto job = _jobs.begin();
+        while (job != _jobs.end()) {
+            if (job->type == Job::Type::Download && _num_sessions >= _max_sessions) {
+                // Listing and comparing can go on without a session.
+                ++job;
+                continue;
+            }
+
+            Client* idle_client = nullptr;
+            for (auto& client : _clients) {
+                if (!client->busy) {
+                    idle_client = client.get();
+                    break;
+                }
+            }
+            if (idle_client == nullptr && _clients.size() < _max_parallel_transfers) {
+                std::unique_ptr<Client> client(new Client());
+                client->ftp = _create_client();
+                idle_client = client.get();
+                _clients.push_back(std::move(client));
+            }
+            if (idle_client == nullptr) {
+                break;
+            }
+
+            if (job->type == Job::Type::Download) {
+                ++_num_sessions;
+            }
+            idle_client->busy = true;
+            idle_client->bytes_transferred = 0;
+            runs.emplace_back(idle_client, *job);
+            job = _jobs.erase(job);
+        }
+
+        bool any_busy = false;
+        for (const auto& client : _clients) {
+            any_busy = any_busy || client->busy;
+        }
+        if (_jobs.empty() && !any_busy && _callback) {
+            callback = _callback;
+            _callback = nullptr;
+            result = _result;
+            progress = _progress();
+        }
+    }
+
+    for (const auto& run : runs) {
+        _run(*run.first, run.second);
+    }
+
+    if (callback) {
+        callback(result, progress);
+    }
+}
+
+void FtpTransferManager::_run(Client& client, const Job& job)
+{
+    switch (job.type) {
+        case Job::Type::List:
+            if (!fs_exists(job.local_path) && !fs_create_directory(job.local_path)) {
+                LogErr() << "Could not create directory " << job.local_path;
+                _done(client, Ftp::Result::FileIoError);
+                return;
+            }
+            client.ftp->list_directory_async(
+                job.remote_path,
+                [this, &client, job](Ftp::Result result, std::vector<std::string> entries) {
+                    _on_listed(client, job, result, entries);
+                });
+            break;
+
+        case Job::Type::Compare:
+            client.ftp->are_files_identical_async(
+                job.local_path + path_separator + fs_filename(job.remote_path),
+                job.remote_path,
+                [this, &client, job](Ftp::Result result, bool identical) {
+                    _on_compared(client, job, result, identical);
+                });
+            break;
+
+        case Job::Type::Download:
+            client.ftp->download_async(
+                job.remote_path,
+                job.local_path,
+                [this, &client, job](Ftp::Result result, Ftp::ProgressData progress) {
+                    _on_download_progress(client, job, result, progress);
+                });
+            break;
+    }
+}
+
+void FtpTransferManager::_on_listed(
+    Client& client, const Job& job, Ftp::Result result, const std::vector<std::string>& entries)
+{
+    if (result == Ftp::Result::Success) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (const auto& entry : entries) {
+            // Entries are "F<name>\t<size>" for files and "D<name>" for directories.
+            if (entry.size() < 2) {
+                continue;
+            }
+            std::string name = entry.substr(1);
+            uint32_t size = 0;
+            const auto tab = name.find('\t');
+            if (tab != std::string::npos) {
+                size = static_cast<uint32_t>(std::strtoul(name.c_str() + tab + 1, nullptr, 10));
+                name.erase(tab);
+            }
+            const auto slash = name.rfind('/');
+            if (slash != std::string::npos) {
+                name.erase(0, slash + 1);
+            }
+            if (name.empty() || name == "." || name == "..") {
+                continue;
+            }
+
+            const std::string remote_path = join_remote_path(job.remote_path, name);
+            const std::string local_path = job.local_path + path_separator + name;
+
+            if (entry[0] == 'D') {
+                // Directories first, to find the files to download early.
+                _jobs.push_front(Job{Job::Type::List, remote_path, local_path, 0, 0});
+            } else if (entry[0] == 'F') {
+                if (fs_exists(local_path) && fs_file_size(local_path) == size) {
+                    _jobs.push_back(
+                        Job{Job::Type::Compare, remote_path, job.local_path, size, 0});
+                } else {
+                    _add_download(remote_path, job.local_path, size);
+                }
+            }
+        }
+    }
+    _done(client, result);
+}
+
+void FtpTransferManager::_on_compared(
+    Client& client, const Job& job, Ftp::Result result, bool identical)
+{
+    if (result != Ftp::Result::Success || !identical) {
+        // The server might not be able to calculate a CRC32, we download it either way.
+        std::lock_guard<std::mutex> lock(_mutex);
+        _add_download(job.remote_path, job.local_path, job.size);
+    }
+    _done(client, Ftp::Result::Success);
+}
+
+void FtpTransferManager::_on_download_progress(
+    Client& client, const Job& job, Ftp::Result result, Ftp::ProgressData progress)
+{
+    if (result == Ftp::Result::Next) {
+        Ftp::SyncDirectoryCallback callback{};
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            client.bytes_transferred = progress.bytes_transferred;
+            callback = _callback;
+            progress = _progress();
+        }
+        if (callback) {
+            callback(Ftp::Result::Next, progress);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        --_num_sessions;
+        client.bytes_transferred = 0;
+
+        if (result == Ftp::Result::Busy) {
+            Job retry = job;
+            if (_num_sessions > 0) {
+                // Don't ask for more sessions than the server has.
+                LogInfo() << "No FTP session available, continuing with " << _num_sessions;
+                _max_sessions = _num_sessions;
+                _jobs.push_front(retry);
+                result = Ftp::Result::Success;
+            } else if (retry.busy_retries < max_busy_retries) {
+                ++retry.busy_retries;
+                _jobs.push_front(retry);
+                result = Ftp::Result::Success;
+            }
+        } else if (result == Ftp::Result::Success) {
+            _bytes_done += job.size;
+        }
+    }
+    if (result != Ftp::Result::Success) {
+        LogErr() << "Download of " << job.remote_path << " failed: " << result;
+    }
+    _done(client, result);
+}
+
+void FtpTransferManager::_add_download(
+    const std::string& remote_path, const std::string& local_dir, uint32_t size)
+{
+    _jobs.push_back(Job{Job::Type::Download, remote_path, local_dir, size, 0});
+    _bytes_total += size;
+}
+
+void FtpTransferManager::_done(Client& client, Ftp::Result result)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        client.busy = false;
+        // We go on with everything else, and report the first error at the end.
+        if (result != Ftp::Result::Success && _result == Ftp::Result::Success) {
+            _result = result;
+        }
+    }
+    _dispatch();
+}
+
+Ftp::ProgressData FtpTransferManager::_progress() const
+{
+    Ftp::ProgressData progress{};
+    progress.bytes_transferred = _bytes_done;
+    for (const auto& client : _clients) {
+        progress.bytes_transferred += client->bytes_transferred;
+    }
+    progress.total_bytes = _bytes_total;
+    return progress;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "plugins/ftp/ftp.h"
+
+namespace mavsdk {
+
+class FtpImpl;
+
+// Runs several transfers at once, each with its own client and session on the server.
+// One client handles one request at a time, so with a few of them the round trips of
+// listing, comparing and downloading many files overlap.
+class FtpTransferManager {
+public:
+    using CreateClient = std::function<std::unique_ptr<FtpImpl>()>;
+
+    explicit FtpTransferManager(CreateClient create_client);
+    ~FtpTransferManager();
+    FtpTransferManager(const FtpTransferManager&) = delete;
+    const FtpTransferManager& operator=(const FtpTransferManager&) = delete;
+
+    Ftp::Result set_max_parallel_transfers(uint32_t count);
+
+    void sync_directory_async(
+        const std::string& remote_dir,
+        const std::string& local_dir,
+        Ftp::SyncDirectoryCallback callback);
+
+private:
+    struct Job {
+        enum class Type { List, Compare, Download } type;
+        std::string remote_path;
+        /// Local directory to create for List, the one of the file for Compare and Download.
+        std::string local_path;
+        uint32_t size;
+        unsigned busy_retries;
+    };
+
+    struct Client {
+        std::unique_ptr<FtpImpl> ftp;
+        bool busy{false};
+        uint32_t bytes_transferred{0};
+    };
+
+    void _dispatch();
+    void _run(Client& client, const Job& job);
+    void _on_listed(
+        Client& client,
+        const Job& job,
+        Ftp::Result result,
+        const std::vector<std::string>& entries);
+    void _on_compared(Client& client, const Job& job, Ftp::Result result, bool identical);
+    void _on_download_progress(
+        Client& client, const Job& job, Ftp::Result result, Ftp::ProgressData progress);
+    void _add_download(const std::string& remote_path, const std::string& local_dir, uint32_t size);
+    void _done(Client& client, Ftp::Result result);
+    Ftp::ProgressData _progress() const;
+
+    const CreateClient _create_client;
+
+    std::mutex _mutex{};
+    unsigned _max_parallel_transfers;
+    /// Lowered when the server runs out of sessions.
+    unsigned _max_sessions;
+    unsigned _num_sessions{0};
+    std::vector<std::unique_ptr<Client>> _clients{};
+    std::deque<Job> _jobs{};
+    Ftp::SyncDirectoryCallback _callback{};
+    Ftp::Result _result{Ftp::Result::Success};
+    uint32_t _bytes_done{0};
+    uint32_t _bytes_total{0};
+};
+
+} // namespace mavsdk
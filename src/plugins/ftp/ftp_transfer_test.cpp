@@ -0,0 +1,374 @@
+#include "plugins/ftp/ftp.h"
+#include "autopilot_simulator.h"
+#include "fs.h"
+#include "mavsdk.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+std::vector<uint8_t> random_content(std::size_t size)
+{
+    std::mt19937 random(42);
+    std::vector<uint8_t> content(size);
+    for (auto& byte : content) {
+        byte = uint8_t(random());
+    }
+    return content;
+}
+
+std::vector<uint8_t> read_file(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(
+        (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+// Downloads the file into the current directory, returns the last result
+// and the number of progress updates.
+std::pair<Ftp::Result, unsigned> download(Ftp& ftp, const std::string& remote_path)
+{
+    std::promise<Ftp::Result> prom;
+    auto fut = prom.get_future();
+    unsigned num_progress = 0;
+
+    ftp.download_async(
+        remote_path, ".", [&prom, &num_progress](Ftp::Result result, Ftp::ProgressData) {
+            if (result == Ftp::Result::Next) {
+                ++num_progress;
+            } else {
+                prom.set_value(result);
+            }
+        });
+
+    if (fut.wait_for(std::chrono::seconds(30)) != std::future_status::ready) {
+        return std::make_pair(Ftp::Result::Timeout, num_progress);
+    }
+    return std::make_pair(fut.get(), num_progress);
+}
+
+std::pair<Ftp::Result, unsigned> upload(Ftp& ftp, const std::string& local_path)
+{
+    std::promise<Ftp::Result> prom;
+    auto fut = prom.get_future();
+    unsigned num_progress = 0;
+
+    ftp.upload_async(
+        local_path, "/fs/microsd", [&prom, &num_progress](Ftp::Result result, Ftp::ProgressData) {
+            if (result == Ftp::Result::Next) {
+                ++num_progress;
+            } else {
+                prom.set_value(result);
+            }
+        });
+
+    if (fut.wait_for(std::chrono::seconds(30)) != std::future_status::ready) {
+        return std::make_pair(Ftp::Result::Timeout, num_progress);
+    }
+    return std::make_pair(fut.get(), num_progress);
+}
+
+// Returns the result and the number of bytes which had to be downloaded.
+std::pair<Ftp::Result, uint32_t> sync_directory(
+    Ftp& ftp, const std::string& local_dir, const std::string& remote_dir = "/fs/microsd/logs")
+{
+    std::promise<std::pair<Ftp::Result, uint32_t>> prom;
+    auto fut = prom.get_future();
+
+    ftp.sync_directory_async(
+        remote_dir, local_dir, [&prom](Ftp::Result result, Ftp::ProgressData progress) {
+            if (result != Ftp::Result::Next) {
+                prom.set_value(std::make_pair(result, progress.total_bytes));
+            }
+        });
+
+    if (fut.wait_for(std::chrono::seconds(30)) != std::future_status::ready) {
+        return std::make_pair(Ftp::Result::Timeout, 0u);
+    }
+    return fut.get();
+}
+
+class FtpTransfer : public ::testing::Test {
+protected:
+    void start(const AutopilotSimulator::Config& config, const std::string& name)
+    {
+        _simulator.reset(new AutopilotSimulator(config));
+        _simulator->add_file("/fs/microsd/log.ulg", _content);
+        ASSERT_TRUE(_simulator->start_loopback(name));
+        ASSERT_EQ(_mavsdk.add_any_connection("loopback://" + name), ConnectionResult::Success);
+
+        for (unsigned i = 0; i < 5000 && !_mavsdk.is_connected(); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ASSERT_TRUE(_mavsdk.is_connected());
+        _ftp.reset(new Ftp(_mavsdk.system()));
+    }
+
+    void TearDown() override
+    {
+        _ftp.reset();
+        if (_simulator) {
+            _simulator->stop();
+        }
+        std::remove("log.ulg");
+        std::remove("log.ulg.resume");
+        std::remove("upload.bin");
+        for (const auto& path : _sync_paths) {
+            std::remove(("sync" + path).c_str());
+        }
+        std::remove("sync");
+    }
+
+    // Files in the remote directory to sync, and a subdirectory. Removed in reverse order.
+    void add_sync_files()
+    {
+        for (unsigned i = 0; i < 12; ++i) {
+            _sync_paths.push_back("/" + std::to_string(i) + ".ulg");
+        }
+        _sync_paths.insert(_sync_paths.begin(), "/params");
+        _sync_paths.push_back("/params/params.bson");
+
+        unsigned size = 1000;
+        for (const auto& path : _sync_paths) {
+            if (path != "/params") {
+                _simulator->add_file("/fs/microsd/logs" + path, random_content(size));
+                size += 1000;
+            }
+        }
+        std::reverse(_sync_paths.begin(), _sync_paths.end());
+    }
+
+    // Checks the local copies against the remote files.
+    void expect_synced()
+    {
+        for (const auto& path : _sync_paths) {
+            std::vector<uint8_t> remote;
+            if (_simulator->get_file("/fs/microsd/logs" + path, remote)) {
+                EXPECT_EQ(read_file("sync" + path), remote) << path;
+            }
+        }
+    }
+
+    const std::vector<uint8_t> _content{random_content(100000)};
+    Mavsdk _mavsdk{};
+    std::unique_ptr<AutopilotSimulator> _simulator{};
+    std::unique_ptr<Ftp> _ftp{};
+    std::vector<std::string> _sync_paths{};
+};
+
+} // namespace
+
+TEST_F(FtpTransfer, DownloadBurst)
+{
+    start(AutopilotSimulator::Config{}, "ftp_transfer_test_burst");
+
+    const auto result = download(*_ftp, "/fs/microsd/log.ulg");
+    EXPECT_EQ(result.first, Ftp::Result::Success);
+    EXPECT_GT(result.second, 0u);
+    EXPECT_EQ(read_file("log.ulg"), _content);
+}
+
+TEST_F(FtpTransfer, DownloadBurstFillsInLostChunks)
+{
+    AutopilotSimulator::Config config;
+    config.loss_ratio = 0.05;
+    config.latency = std::chrono::milliseconds(10);
+    start(config, "ftp_transfer_test_lossy");
+
+    const auto result = download(*_ftp, "/fs/microsd/log.ulg");
+    EXPECT_EQ(result.first, Ftp::Result::Success);
+    EXPECT_EQ(read_file("log.ulg"), _content);
+}
+
+TEST_F(FtpTransfer, DownloadChunkByChunk)
+{
+    start(AutopilotSimulator::Config{}, "ftp_transfer_test_chunks");
+    ASSERT_EQ(_ftp->set_burst_download(false), Ftp::Result::Success);
+
+    const auto result = download(*_ftp, "/fs/microsd/log.ulg");
+    EXPECT_EQ(result.first, Ftp::Result::Success);
+    EXPECT_EQ(read_file("log.ulg"), _content);
+}
+
+TEST_F(FtpTransfer, DownloadResumesAfterLinkDrops)
+{
+    AutopilotSimulator::Config config;
+    config.latency = std::chrono::milliseconds(1);
+    start(config, "ftp_transfer_test_resume");
+    ASSERT_EQ(_ftp->set_resumable_download(true), Ftp::Result::Success);
+    // One chunk after the other, so the link drops in the middle.
+    ASSERT_EQ(_ftp->set_burst_download(false), Ftp::Result::Success);
+
+    std::promise<Ftp::Result> prom;
+    auto fut = prom.get_future();
+    _ftp->download_async(
+        "/fs/microsd/log.ulg", ".", [this, &prom](Ftp::Result result, Ftp::ProgressData progress) {
+            if (result == Ftp::Result::Next) {
+                if (progress.bytes_transferred > 30000) {
+                    _simulator->set_link_down(true);
+                }
+            } else {
+                prom.set_value(result);
+            }
+        });
+    ASSERT_EQ(fut.wait_for(std::chrono::seconds(30)), std::future_status::ready);
+    EXPECT_EQ(fut.get(), Ftp::Result::Timeout);
+    ASSERT_FALSE(read_file("log.ulg.resume").empty());
+
+    _simulator->set_link_down(false);
+    ASSERT_EQ(_ftp->set_burst_download(true), Ftp::Result::Success);
+
+    std::promise<Ftp::Result> resumed_prom;
+    auto resumed_fut = resumed_prom.get_future();
+    uint32_t first_progress = 0;
+    _ftp->download_async(
+        "/fs/microsd/log.ulg",
+        ".",
+        [&resumed_prom, &first_progress](Ftp::Result result, Ftp::ProgressData progress) {
+            if (result == Ftp::Result::Next) {
+                if (first_progress == 0) {
+                    first_progress = progress.bytes_transferred;
+                }
+            } else {
+                resumed_prom.set_value(result);
+            }
+        });
+    ASSERT_EQ(resumed_fut.wait_for(std::chrono::seconds(30)), std::future_status::ready);
+    EXPECT_EQ(resumed_fut.get(), Ftp::Result::Success);
+    EXPECT_GT(first_progress, 30000u);
+    EXPECT_EQ(read_file("log.ulg"), _content);
+    EXPECT_TRUE(read_file("log.ulg.resume").empty());
+}
+
+TEST_F(FtpTransfer, UploadWithWritesInFlight)
+{
+    AutopilotSimulator::Config config;
+    config.loss_ratio = 0.05;
+    config.latency = std::chrono::milliseconds(10);
+    start(config, "ftp_transfer_test_upload");
+    ASSERT_EQ(_ftp->set_upload_window_size(32), Ftp::Result::Success);
+
+    std::ofstream("upload.bin", std::ios::binary)
+        .write(reinterpret_cast<const char*>(_content.data()), _content.size());
+
+    const auto result = upload(*_ftp, "upload.bin");
+    EXPECT_EQ(result.first, Ftp::Result::Success);
+    EXPECT_GT(result.second, 0u);
+
+    std::vector<uint8_t> uploaded;
+    ASSERT_TRUE(_simulator->get_file("/fs/microsd/upload.bin", uploaded));
+    EXPECT_EQ(uploaded, _content);
+}
+
+TEST_F(FtpTransfer, UploadWindowSize)
+{
+    start(AutopilotSimulator::Config{}, "ftp_transfer_test_window");
+    EXPECT_EQ(_ftp->set_upload_window_size(0), Ftp::Result::InvalidParameter);
+    EXPECT_EQ(_ftp->set_upload_window_size(257), Ftp::Result::InvalidParameter);
+    ASSERT_EQ(_ftp->set_upload_window_size(1), Ftp::Result::Success);
+
+    std::ofstream("upload.bin", std::ios::binary)
+        .write(reinterpret_cast<const char*>(_content.data()), _content.size());
+
+    EXPECT_EQ(upload(*_ftp, "upload.bin").first, Ftp::Result::Success);
+
+    std::vector<uint8_t> uploaded;
+    ASSERT_TRUE(_simulator->get_file("/fs/microsd/upload.bin", uploaded));
+    EXPECT_EQ(uploaded, _content);
+}
+
+TEST_F(FtpTransfer, SyncDirectoryOnlyDownloadsChanges)
+{
+    AutopilotSimulator::Config config;
+    config.latency = std::chrono::milliseconds(10);
+    start(config, "ftp_transfer_test_sync");
+    add_sync_files();
+
+    const auto first = sync_directory(*_ftp, "sync");
+    EXPECT_EQ(first.first, Ftp::Result::Success);
+    EXPECT_GT(first.second, 0u);
+    expect_synced();
+
+    // Same size but different content, and missing.
+    std::ofstream("sync/3.ulg", std::ios::binary).write(std::string(4000, 'x').data(), 4000);
+    std::remove("sync/params/params.bson");
+
+    const auto second = sync_directory(*_ftp, "sync");
+    EXPECT_EQ(second.first, Ftp::Result::Success);
+    EXPECT_EQ(second.second, 4000u + 13000u);
+    expect_synced();
+
+    const auto third = sync_directory(*_ftp, "sync");
+    EXPECT_EQ(third.first, Ftp::Result::Success);
+    EXPECT_EQ(third.second, 0u);
+}
+
+TEST_F(FtpTransfer, SyncDirectoryWithOneSession)
+{
+    // Like PX4, sessions are opened one after the other.
+    AutopilotSimulator::Config config;
+    config.max_ftp_sessions = 1;
+    start(config, "ftp_transfer_test_sync_session");
+    add_sync_files();
+    EXPECT_EQ(_ftp->set_max_parallel_transfers(0), Ftp::Result::InvalidParameter);
+    ASSERT_EQ(_ftp->set_max_parallel_transfers(8), Ftp::Result::Success);
+
+    EXPECT_EQ(sync_directory(*_ftp, "sync").first, Ftp::Result::Success);
+    expect_synced();
+}
+
+TEST(FtpServer, ServesSeveralDownloadsAtOnce)
+{
+    // MAVSDK as server, e.g. on a companion computer, with the files of a directory.
+    fs_create_directory("ftp_server_root");
+    std::vector<std::vector<uint8_t>> contents;
+    for (unsigned i = 0; i < 4; ++i) {
+        contents.push_back(random_content(20000 + i * 10000));
+        std::ofstream("ftp_server_root/" + std::to_string(i) + ".bin", std::ios::binary)
+            .write(reinterpret_cast<const char*>(contents[i].data()), contents[i].size());
+    }
+
+    Mavsdk server_mavsdk;
+    server_mavsdk.set_configuration(
+        Mavsdk::Configuration(Mavsdk::Configuration::UsageType::Autopilot));
+    ASSERT_EQ(server_mavsdk.setup_udp_remote("127.0.0.1", 14655), ConnectionResult::Success);
+    Ftp server(server_mavsdk.system());
+    ASSERT_EQ(server.set_root_directory("ftp_server_root"), Ftp::Result::Success);
+
+    Mavsdk client_mavsdk;
+    ASSERT_EQ(client_mavsdk.add_udp_connection(14655), ConnectionResult::Success);
+    for (unsigned i = 0; i < 5000 && !client_mavsdk.is_connected(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(client_mavsdk.is_connected());
+    Ftp client(client_mavsdk.system());
+
+    // Each file in its own session, sent in bursts.
+    ASSERT_EQ(client.set_max_parallel_transfers(4), Ftp::Result::Success);
+    EXPECT_EQ(sync_directory(client, "sync", "/").first, Ftp::Result::Success);
+
+    ASSERT_EQ(client.set_burst_download(false), Ftp::Result::Success);
+    EXPECT_EQ(download(client, "/1.bin").first, Ftp::Result::Success);
+    EXPECT_EQ(read_file("1.bin"), contents[1]);
+
+    for (unsigned i = 0; i < contents.size(); ++i) {
+        const std::string name = std::to_string(i) + ".bin";
+        EXPECT_EQ(read_file("sync/" + name), contents[i]) << name;
+        std::remove(("sync/" + name).c_str());
+        std::remove(("ftp_server_root/" + name).c_str());
+    }
+    std::remove("1.bin");
+    std::remove("sync");
+    std::remove("ftp_server_root");
+}
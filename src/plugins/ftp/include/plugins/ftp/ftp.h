@@ -236,6 +236,23 @@ public:
     std::pair<Result, bool>
     are_files_identical(std::string local_file_path, std::string remote_file_path) const;
 
+    /**
+     * @brief Callback type for sync_directory_async.
+     */
+
+    using SyncDirectoryCallback = std::function<void(Ftp::Result, ProgressData)>;
+
+    /**
+     * @brief Downloads the files of a remote directory and its subdirectories which are
+     * missing or different in a local directory.
+     *
+     * Existing files are compared using a CRC32 checksum. Several files are transferred at
+     * once, each in its own session, see 'set_max_parallel_transfers'. Progress is reported
+     * for the files to download found so far.
+     */
+    void sync_directory_async(
+        std::string remote_dir, std::string local_dir, SyncDirectoryCallback callback);
+
     /**
      * @brief Set root directory for MAVLink FTP server.
      *
@@ -254,6 +271,60 @@ public:
      */
     Result set_target_compid(uint32_t compid) const;
 
+    /**
+     * @brief Set whether downloads use burst reads.
+     *
+     * With burst reads the server sends the file without waiting for a request per chunk,
+     * which is much faster over links with a high latency. Chunks lost on the way are
+     * requested again individually. Servers without burst support are detected and fall
+     * back to one read at a time. Enabled by default.
+     *
+     * This function is blocking.
+     *
+     * @return Result of request.
+     */
+    Result set_burst_download(bool enabled) const;
+
+    /**
+     * @brief Set whether downloads can be resumed.
+     *
+     * A resumable download saves a checkpoint next to the partial file, "<file>.resume".
+     * If a download fails, for example because the link drops, the next download of the same
+     * file continues from there. Once complete, the file is verified against the CRC32 of the
+     * remote file, and removed if it doesn't match. Disabled by default.
+     *
+     * This function is blocking.
+     *
+     * @return Result of request.
+     */
+    Result set_resumable_download(bool enabled) const;
+
+    /**
+     * @brief Set the number of writes an upload keeps in flight.
+     *
+     * More writes in flight make uploads faster over links with a high latency, as long as
+     * the link and the server keep up. Writes which are not acked in time are sent again.
+     * With 1, each write waits for the ack of the previous one. Between 1 and 256, 8 by
+     * default.
+     *
+     * This function is blocking.
+     *
+     * @return Result of request.
+     */
+    Result set_upload_window_size(uint32_t window_size) const;
+
+    /**
+     * @brief Set the number of transfers 'sync_directory_async' runs at once.
+     *
+     * Each transfer uses a session on the server. If the server runs out of sessions, fewer
+     * transfers are run at once. Between 1 and 8, 4 by default.
+     *
+     * This function is blocking.
+     *
+     * @return Result of request.
+     */
+    Result set_max_parallel_transfers(uint32_t count) const;
+
     /**
      * @brief Get our own component ID.
      *
@@ -11,6 +11,8 @@ namespace mavsdk {
 
 using Point = Geofence::Point;
 using Polygon = Geofence::Polygon;
+using SimplificationOptions = Geofence::SimplificationOptions;
+using FenceCheck = Geofence::FenceCheck;
 
 Geofence::Geofence(System& system) : PluginBase(), _impl{new GeofenceImpl(system)} {}
 
@@ -26,6 +28,21 @@ Geofence::Result Geofence::upload_geofence(std::vector<Polygon> polygons) const
     return _impl->upload_geofence(polygons);
 }
 
+void Geofence::set_simplification_options(SimplificationOptions simplification_options) const
+{
+    _impl->set_simplification_options(simplification_options);
+}
+
+Geofence::FenceCheck Geofence::check_point(Point point) const
+{
+    return _impl->check_point(point);
+}
+
+std::vector<Geofence::FenceCheck> Geofence::check_points(std::vector<Point> points) const
+{
+    return _impl->check_points(points);
+}
+
 bool operator==(const Geofence::Point& lhs, const Geofence::Point& rhs)
 {
     return ((std::isnan(rhs.latitude_deg) && std::isnan(lhs.latitude_deg)) ||
@@ -74,6 +91,44 @@ std::ostream& operator<<(std::ostream& str, Geofence::Polygon const& polygon)
     return str;
 }
 
+bool operator==(
+    const Geofence::SimplificationOptions& lhs, const Geofence::SimplificationOptions& rhs)
+{
+    return (rhs.enabled == lhs.enabled) &&
+           ((std::isnan(rhs.tolerance_m) && std::isnan(lhs.tolerance_m)) ||
+            rhs.tolerance_m == lhs.tolerance_m) &&
+           (rhs.merge_shared_edges == lhs.merge_shared_edges);
+}
+
+std::ostream&
+operator<<(std::ostream& str, Geofence::SimplificationOptions const& simplification_options)
+{
+    str << std::setprecision(15);
+    str << "simplification_options:" << '\n' << "{\n";
+    str << "    enabled: " << simplification_options.enabled << '\n';
+    str << "    tolerance_m: " << simplification_options.tolerance_m << '\n';
+    str << "    merge_shared_edges: " << simplification_options.merge_shared_edges << '\n';
+    str << '}';
+    return str;
+}
+
+bool operator==(const Geofence::FenceCheck& lhs, const Geofence::FenceCheck& rhs)
+{
+    return (rhs.is_within_fence == lhs.is_within_fence) &&
+           ((std::isnan(rhs.distance_to_boundary_m) && std::isnan(lhs.distance_to_boundary_m)) ||
+            rhs.distance_to_boundary_m == lhs.distance_to_boundary_m);
+}
+
+std::ostream& operator<<(std::ostream& str, Geofence::FenceCheck const& fence_check)
+{
+    str << std::setprecision(15);
+    str << "fence_check:" << '\n' << "{\n";
+    str << "    is_within_fence: " << fence_check.is_within_fence << '\n';
+    str << "    distance_to_boundary_m: " << fence_check.distance_to_boundary_m << '\n';
+    str << '}';
+    return str;
+}
+
 std::ostream& operator<<(std::ostream& str, Geofence::Result const& result)
 {
     switch (result) {
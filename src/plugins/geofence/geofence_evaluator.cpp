@@ -0,0 +1,381 @@
+#include "geofence_evaluator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace mavsdk {
+
+using geometry::CoordinateTransformation;
+
+namespace {
+
+// Number of independent lanes in the edge loops. Keeping separate
+// accumulators per lane allows the compiler to vectorize the reductions.
+constexpr unsigned lanes = 4;
+
+} // namespace
+
+void GeofenceEvaluator::Edges::add(double from_x, double from_y, double to_x, double to_y)
+{
+    const double delta_x = to_x - from_x;
+    const double delta_y = to_y - from_y;
+    const double length_squared = delta_x * delta_x + delta_y * delta_y;
+
+    x0.push_back(from_x);
+    y0.push_back(from_y);
+    dx.push_back(delta_x);
+    dy.push_back(delta_y);
+    y_min.push_back(std::min(from_y, to_y));
+    y_max.push_back(std::max(from_y, to_y));
+    // Horizontal edges never span a point's y, so the slope doesn't matter.
+    x_per_y.push_back(delta_y != 0.0 ? delta_x / delta_y : 0.0);
+    inv_length_squared.push_back(length_squared > 0.0 ? 1.0 / length_squared : 0.0);
+}
+
+GeofenceEvaluator::GeofenceEvaluator(const std::vector<Geofence::Polygon>& polygons)
+{
+    // Use the center of all points as reference to keep the distortion low.
+    double min_lat = std::numeric_limits<double>::max();
+    double max_lat = std::numeric_limits<double>::lowest();
+    double min_lon = std::numeric_limits<double>::max();
+    double max_lon = std::numeric_limits<double>::lowest();
+    for (const auto& polygon : polygons) {
+        for (const auto& point : polygon.points) {
+            min_lat = std::min(min_lat, point.latitude_deg);
+            max_lat = std::max(max_lat, point.latitude_deg);
+            min_lon = std::min(min_lon, point.longitude_deg);
+            max_lon = std::max(max_lon, point.longitude_deg);
+        }
+    }
+    const bool has_points = (min_lat <= max_lat);
+    _ct.reset(new CoordinateTransformation(
+        {has_points ? (min_lat + max_lat) / 2.0 : 0.0,
+         has_points ? (min_lon + max_lon) / 2.0 : 0.0}));
+
+    for (const auto& polygon : polygons) {
+        if (polygon.points.size() < 3) {
+            continue;
+        }
+        add_polygon(to_local(polygon.points), polygon.fence_type);
+    }
+
+    build_grid();
+}
+
+CoordinateTransformation::LocalCoordinate
+GeofenceEvaluator::to_local(const Geofence::Point& point) const
+{
+    return _ct->local_from_global({point.latitude_deg, point.longitude_deg});
+}
+
+std::vector<CoordinateTransformation::LocalCoordinate>
+GeofenceEvaluator::to_local(const std::vector<Geofence::Point>& points) const
+{
+    std::vector<double> latitudes_deg;
+    std::vector<double> longitudes_deg;
+    latitudes_deg.reserve(points.size());
+    longitudes_deg.reserve(points.size());
+    for (const auto& point : points) {
+        latitudes_deg.push_back(point.latitude_deg);
+        longitudes_deg.push_back(point.longitude_deg);
+    }
+
+    std::vector<double> norths_m(points.size());
+    std::vector<double> easts_m(points.size());
+    _ct->local_from_global(
+        latitudes_deg.data(), longitudes_deg.data(), norths_m.data(), easts_m.data(), points.size());
+
+    std::vector<CoordinateTransformation::LocalCoordinate> locals;
+    locals.reserve(points.size());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        locals.push_back({norths_m[i], easts_m[i]});
+    }
+    return locals;
+}
+
+void GeofenceEvaluator::add_polygon(
+    const std::vector<CoordinateTransformation::LocalCoordinate>& ring,
+    Geofence::Polygon::FenceType fence_type)
+{
+    IndexedPolygon polygon{fence_type,
+                           {std::numeric_limits<double>::max(),
+                            std::numeric_limits<double>::max(),
+                            std::numeric_limits<double>::lowest(),
+                            std::numeric_limits<double>::lowest()},
+                           1.0,
+                           {}};
+
+    for (const auto& local : ring) {
+        polygon.bounds.min_x = std::min(polygon.bounds.min_x, local.east_m);
+        polygon.bounds.max_x = std::max(polygon.bounds.max_x, local.east_m);
+        polygon.bounds.min_y = std::min(polygon.bounds.min_y, local.north_m);
+        polygon.bounds.max_y = std::max(polygon.bounds.max_y, local.north_m);
+    }
+
+    // About sqrt(n) bands, so each band holds about sqrt(n) edges.
+    const std::size_t num_bands =
+        std::max<std::size_t>(1, static_cast<std::size_t>(std::sqrt(double(ring.size()))));
+    const double height = polygon.bounds.max_y - polygon.bounds.min_y;
+    polygon.band_height = (height > 0.0) ? height / double(num_bands) : 1.0;
+    polygon.bands.resize(num_bands);
+
+    auto band = [&polygon, num_bands](double y) {
+        const double index = std::floor((y - polygon.bounds.min_y) / polygon.band_height);
+        return std::min(num_bands - 1, static_cast<std::size_t>(std::max(0.0, index)));
+    };
+
+    for (std::size_t i = 0; i < ring.size(); ++i) {
+        const auto& from = ring[i];
+        const auto& to = ring[(i + 1) % ring.size()];
+
+        const std::size_t first = band(std::min(from.north_m, to.north_m));
+        const std::size_t last = band(std::max(from.north_m, to.north_m));
+        for (std::size_t b = first; b <= last; ++b) {
+            polygon.bands[b].add(from.east_m, from.north_m, to.east_m, to.north_m);
+        }
+        _all_edges.add(from.east_m, from.north_m, to.east_m, to.north_m);
+    }
+
+    if (fence_type == Geofence::Polygon::FenceType::Inclusion) {
+        _has_inclusion = true;
+    }
+    _polygons.push_back(polygon);
+}
+
+void GeofenceEvaluator::build_grid()
+{
+    if (_all_edges.size() == 0) {
+        return;
+    }
+
+    _grid_bounds = _polygons.front().bounds;
+    for (const auto& polygon : _polygons) {
+        _grid_bounds.min_x = std::min(_grid_bounds.min_x, polygon.bounds.min_x);
+        _grid_bounds.max_x = std::max(_grid_bounds.max_x, polygon.bounds.max_x);
+        _grid_bounds.min_y = std::min(_grid_bounds.min_y, polygon.bounds.min_y);
+        _grid_bounds.max_y = std::max(_grid_bounds.max_y, polygon.bounds.max_y);
+    }
+
+    // Aim for a few edges per cell but don't let the grid get huge.
+    const double width = _grid_bounds.max_x - _grid_bounds.min_x;
+    const double height = _grid_bounds.max_y - _grid_bounds.min_y;
+    const double target_cells = std::max(1.0, double(_all_edges.size()) / 4.0);
+    _cell_size =
+        std::max(std::sqrt(width * height / target_cells), std::max(width, height) / 1024.0);
+    if (!(_cell_size > 0.0)) {
+        _cell_size = 1.0;
+    }
+    _columns = static_cast<int>(width / _cell_size) + 1;
+    _rows = static_cast<int>(height / _cell_size) + 1;
+    _cells.resize(std::size_t(_columns) * std::size_t(_rows));
+
+    auto column = [this](double x) {
+        return std::min(_columns - 1, static_cast<int>((x - _grid_bounds.min_x) / _cell_size));
+    };
+    auto row = [this](double y) {
+        return std::min(_rows - 1, static_cast<int>((y - _grid_bounds.min_y) / _cell_size));
+    };
+
+    for (std::size_t i = 0; i < _all_edges.size(); ++i) {
+        const double from_x = _all_edges.x0[i];
+        const double from_y = _all_edges.y0[i];
+        const double to_x = from_x + _all_edges.dx[i];
+        const double to_y = from_y + _all_edges.dy[i];
+
+        for (int r = row(std::min(from_y, to_y)); r <= row(std::max(from_y, to_y)); ++r) {
+            for (int c = column(std::min(from_x, to_x)); c <= column(std::max(from_x, to_x));
+                 ++c) {
+                _cells[std::size_t(r) * std::size_t(_columns) + std::size_t(c)].add(
+                    from_x, from_y, to_x, to_y);
+            }
+        }
+    }
+}
+
+unsigned GeofenceEvaluator::count_crossings(const Edges& edges, double x, double y)
+{
+    // Ray casting towards east: count edges which span y and cross east of x.
+    // The half-open span makes sure a shared vertex is only counted once.
+    const std::size_t n = edges.size();
+    const double* x0 = edges.x0.data();
+    const double* y0 = edges.y0.data();
+    const double* y_min = edges.y_min.data();
+    const double* y_max = edges.y_max.data();
+    const double* x_per_y = edges.x_per_y.data();
+
+    unsigned lane_crossings[lanes] = {};
+    std::size_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        for (unsigned lane = 0; lane < lanes; ++lane) {
+            const std::size_t j = i + lane;
+            const double x_cross = x0[j] + (y - y0[j]) * x_per_y[j];
+            lane_crossings[lane] +=
+                unsigned(y_min[j] <= y) & unsigned(y < y_max[j]) & unsigned(x < x_cross);
+        }
+    }
+    unsigned crossings = 0;
+    for (; i < n; ++i) {
+        const double x_cross = x0[i] + (y - y0[i]) * x_per_y[i];
+        crossings += unsigned(y_min[i] <= y) & unsigned(y < y_max[i]) & unsigned(x < x_cross);
+    }
+    for (unsigned lane = 0; lane < lanes; ++lane) {
+        crossings += lane_crossings[lane];
+    }
+    return crossings;
+}
+
+double GeofenceEvaluator::min_distance_squared(const Edges& edges, double x, double y)
+{
+    const std::size_t n = edges.size();
+    const double* x0 = edges.x0.data();
+    const double* y0 = edges.y0.data();
+    const double* dx = edges.dx.data();
+    const double* dy = edges.dy.data();
+    const double* inv_length_squared = edges.inv_length_squared.data();
+
+    auto distance_squared = [&](std::size_t j) {
+        const double px = x - x0[j];
+        const double py = y - y0[j];
+        const double t =
+            std::min(1.0, std::max(0.0, (px * dx[j] + py * dy[j]) * inv_length_squared[j]));
+        const double ex = px - t * dx[j];
+        const double ey = py - t * dy[j];
+        return ex * ex + ey * ey;
+    };
+
+    double lane_min[lanes];
+    std::fill(lane_min, lane_min + lanes, std::numeric_limits<double>::infinity());
+    std::size_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        for (unsigned lane = 0; lane < lanes; ++lane) {
+            lane_min[lane] = std::min(lane_min[lane], distance_squared(i + lane));
+        }
+    }
+    double result = std::numeric_limits<double>::infinity();
+    for (; i < n; ++i) {
+        result = std::min(result, distance_squared(i));
+    }
+    for (unsigned lane = 0; lane < lanes; ++lane) {
+        result = std::min(result, lane_min[lane]);
+    }
+    return result;
+}
+
+bool GeofenceEvaluator::is_inside(const IndexedPolygon& polygon, double x, double y) const
+{
+    if (!polygon.bounds.contains(x, y)) {
+        return false;
+    }
+
+    const double index = std::floor((y - polygon.bounds.min_y) / polygon.band_height);
+    const std::size_t band =
+        std::min(polygon.bands.size() - 1, static_cast<std::size_t>(std::max(0.0, index)));
+
+    return (count_crossings(polygon.bands[band], x, y) % 2) == 1;
+}
+
+bool GeofenceEvaluator::is_within_fence(
+    const CoordinateTransformation::LocalCoordinate& local) const
+{
+    // Without any inclusion polygon, everything not excluded is allowed.
+    bool included = !_has_inclusion;
+
+    for (const auto& polygon : _polygons) {
+        if (!is_inside(polygon, local.east_m, local.north_m)) {
+            continue;
+        }
+        if (polygon.fence_type == Geofence::Polygon::FenceType::Exclusion) {
+            return false;
+        }
+        included = true;
+    }
+    return included;
+}
+
+double GeofenceEvaluator::distance_to_boundary_m(
+    const CoordinateTransformation::LocalCoordinate& local) const
+{
+    if (_cells.empty()) {
+        return NAN;
+    }
+
+    const double x = local.east_m;
+    const double y = local.north_m;
+
+    // For points outside the grid, search from the closest point on the grid.
+    // Since the grid is convex, the distance to any cell is at least the
+    // distance to the grid plus the distance from there.
+    const double clamped_x = std::min(_grid_bounds.max_x, std::max(_grid_bounds.min_x, x));
+    const double clamped_y = std::min(_grid_bounds.max_y, std::max(_grid_bounds.min_y, y));
+    const double outside_squared =
+        (x - clamped_x) * (x - clamped_x) + (y - clamped_y) * (y - clamped_y);
+
+    const int column = std::min(
+        _columns - 1, static_cast<int>((clamped_x - _grid_bounds.min_x) / _cell_size));
+    const int row =
+        std::min(_rows - 1, static_cast<int>((clamped_y - _grid_bounds.min_y) / _cell_size));
+
+    auto search_cell = [&](int c, int r, double& best_squared) {
+        if (c < 0 || c >= _columns || r < 0 || r >= _rows) {
+            return;
+        }
+        const auto& cell = _cells[std::size_t(r) * std::size_t(_columns) + std::size_t(c)];
+        if (cell.size() > 0) {
+            best_squared = std::min(best_squared, min_distance_squared(cell, x, y));
+        }
+    };
+
+    // Search rings of cells around the starting cell until no cell further
+    // out can contain anything closer.
+    double best_squared = std::numeric_limits<double>::infinity();
+    const int max_ring = std::max(_columns, _rows);
+    for (int ring = 0; ring <= max_ring; ++ring) {
+        if (ring == 0) {
+            search_cell(column, row, best_squared);
+        } else {
+            for (int c = column - ring; c <= column + ring; ++c) {
+                search_cell(c, row - ring, best_squared);
+                search_cell(c, row + ring, best_squared);
+            }
+            for (int r = row - ring + 1; r <= row + ring - 1; ++r) {
+                search_cell(column - ring, r, best_squared);
+                search_cell(column + ring, r, best_squared);
+            }
+        }
+
+        const double ring_distance = double(ring) * _cell_size;
+        if (best_squared <= outside_squared + ring_distance * ring_distance) {
+            break;
+        }
+    }
+
+    return std::sqrt(best_squared);
+}
+
+Geofence::FenceCheck GeofenceEvaluator::check(const Geofence::Point& point) const
+{
+    const auto local = to_local(point);
+
+    Geofence::FenceCheck fence_check{};
+    fence_check.is_within_fence = is_within_fence(local);
+    fence_check.distance_to_boundary_m = distance_to_boundary_m(local);
+    return fence_check;
+}
+
+std::vector<Geofence::FenceCheck>
+GeofenceEvaluator::check(const std::vector<Geofence::Point>& points) const
+{
+    std::vector<Geofence::FenceCheck> fence_checks;
+    fence_checks.reserve(points.size());
+
+    for (const auto& local : to_local(points)) {
+        Geofence::FenceCheck fence_check{};
+        fence_check.is_within_fence = is_within_fence(local);
+        fence_check.distance_to_boundary_m = distance_to_boundary_m(local);
+        fence_checks.push_back(fence_check);
+    }
+    return fence_checks;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "geometry.h"
+#include "plugins/geofence/geofence.h"
+
+namespace mavsdk {
+
+// Evaluates points against a set of fence polygons on the ground.
+//
+// A point is within the fence if it is inside at least one inclusion polygon
+// (if there are any) and not inside any exclusion polygon.
+//
+// The polygons are projected into a local frame once. Point-in-polygon uses
+// horizontal bands per polygon so only the edges spanning a point's latitude
+// are tested, and distance-to-boundary uses a uniform grid over all edges.
+// Edges are stored as structure of arrays and tested branchless so the inner
+// loops can be vectorized by the compiler.
+class GeofenceEvaluator {
+public:
+    explicit GeofenceEvaluator(const std::vector<Geofence::Polygon>& polygons);
+    ~GeofenceEvaluator() = default;
+
+    // Delete copy and move constructors and assign operators.
+    GeofenceEvaluator(GeofenceEvaluator const&) = delete;
+    GeofenceEvaluator(GeofenceEvaluator&&) = delete;
+    GeofenceEvaluator& operator=(GeofenceEvaluator const&) = delete;
+    GeofenceEvaluator& operator=(GeofenceEvaluator&&) = delete;
+
+    Geofence::FenceCheck check(const Geofence::Point& point) const;
+    std::vector<Geofence::FenceCheck> check(const std::vector<Geofence::Point>& points) const;
+
+    // Lower level queries in the local frame of the evaluator.
+    geometry::CoordinateTransformation::LocalCoordinate
+    to_local(const Geofence::Point& point) const;
+    bool is_within_fence(const geometry::CoordinateTransformation::LocalCoordinate& local) const;
+    double
+    distance_to_boundary_m(const geometry::CoordinateTransformation::LocalCoordinate& local) const;
+
+    bool empty() const { return _polygons.empty(); }
+
+private:
+    // Edges as structure of arrays, the crossing test needs the edge's start,
+    // its latitude span and slope, the distance test its direction.
+    struct Edges {
+        std::vector<double> x0{};
+        std::vector<double> y0{};
+        std::vector<double> dx{};
+        std::vector<double> dy{};
+        std::vector<double> y_min{};
+        std::vector<double> y_max{};
+        std::vector<double> x_per_y{};
+        std::vector<double> inv_length_squared{};
+
+        void add(double from_x, double from_y, double to_x, double to_y);
+        std::size_t size() const { return x0.size(); }
+    };
+
+    struct Bounds {
+        double min_x;
+        double min_y;
+        double max_x;
+        double max_y;
+
+        bool contains(double x, double y) const
+        {
+            return x >= min_x && x <= max_x && y >= min_y && y <= max_y;
+        }
+    };
+
+    struct IndexedPolygon {
+        Geofence::Polygon::FenceType fence_type;
+        Bounds bounds;
+        double band_height;
+        std::vector<Edges> bands;
+    };
+
+    std::vector<geometry::CoordinateTransformation::LocalCoordinate>
+    to_local(const std::vector<Geofence::Point>& points) const;
+
+    static unsigned count_crossings(const Edges& edges, double x, double y);
+    static double min_distance_squared(const Edges& edges, double x, double y);
+
+    void add_polygon(
+        const std::vector<geometry::CoordinateTransformation::LocalCoordinate>& ring,
+        Geofence::Polygon::FenceType fence_type);
+    void build_grid();
+    bool is_inside(const IndexedPolygon& polygon, double x, double y) const;
+
+    std::unique_ptr<geometry::CoordinateTransformation> _ct{};
+    std::vector<IndexedPolygon> _polygons{};
+    bool _has_inclusion{false};
+
+    // Grid over all edges for distance queries.
+    Edges _all_edges{};
+    Bounds _grid_bounds{0.0, 0.0, 0.0, 0.0};
+    double _cell_size{1.0};
+    int _columns{0};
+    int _rows{0};
+    std::vector<Edges> _cells{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,163 @@
+#include "geofence_evaluator.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <random>
+
+using namespace mavsdk;
+using namespace mavsdk::geometry;
+
+namespace {
+
+const CoordinateTransformation::GlobalCoordinate reference{47.397742, 8.545594};
+
+Geofence::Point to_point(const CoordinateTransformation::LocalCoordinate& local)
+{
+    CoordinateTransformation ct(reference);
+    const auto global = ct.global_from_local(local);
+
+    Geofence::Point point{};
+    point.latitude_deg = global.latitude_deg;
+    point.longitude_deg = global.longitude_deg;
+    return point;
+}
+
+Geofence::Polygon make_polygon(
+    Geofence::Polygon::FenceType fence_type,
+    const std::vector<CoordinateTransformation::LocalCoordinate>& locals)
+{
+    Geofence::Polygon polygon{};
+    polygon.fence_type = fence_type;
+    for (const auto& local : locals) {
+        polygon.points.push_back(to_point(local));
+    }
+    return polygon;
+}
+
+Geofence::Polygon make_square(
+    Geofence::Polygon::FenceType fence_type, double north_m, double east_m, double size_m)
+{
+    return make_polygon(
+        fence_type,
+        {{north_m, east_m},
+         {north_m, east_m + size_m},
+         {north_m + size_m, east_m + size_m},
+         {north_m + size_m, east_m}});
+}
+
+Geofence::Polygon make_star(unsigned num_vertices, double radius_m)
+{
+    std::vector<CoordinateTransformation::LocalCoordinate> locals;
+    for (unsigned i = 0; i < num_vertices; ++i) {
+        const double angle = 2.0 * M_PI * double(i) / double(num_vertices);
+        const double r =
+            radius_m * (1.0 + 0.3 * std::sin(13.0 * angle) + 0.05 * std::sin(997.0 * angle));
+        locals.push_back({r * std::cos(angle), r * std::sin(angle)});
+    }
+    return make_polygon(Geofence::Polygon::FenceType::Inclusion, locals);
+}
+
+} // namespace
+
+TEST(GeofenceEvaluator, Empty)
+{
+    GeofenceEvaluator evaluator({});
+    EXPECT_TRUE(evaluator.empty());
+
+    const auto fence_check = evaluator.check(to_point({0.0, 0.0}));
+    EXPECT_TRUE(fence_check.is_within_fence);
+    EXPECT_TRUE(std::isnan(fence_check.distance_to_boundary_m));
+}
+
+TEST(GeofenceEvaluator, Inclusion)
+{
+    GeofenceEvaluator evaluator(
+        {make_square(Geofence::Polygon::FenceType::Inclusion, -50.0, -50.0, 100.0)});
+
+    auto fence_check = evaluator.check(to_point({0.0, 0.0}));
+    EXPECT_TRUE(fence_check.is_within_fence);
+    EXPECT_NEAR(fence_check.distance_to_boundary_m, 50.0, 0.1);
+
+    fence_check = evaluator.check(to_point({40.0, 0.0}));
+    EXPECT_TRUE(fence_check.is_within_fence);
+    EXPECT_NEAR(fence_check.distance_to_boundary_m, 10.0, 0.1);
+
+    fence_check = evaluator.check(to_point({0.0, 60.0}));
+    EXPECT_FALSE(fence_check.is_within_fence);
+    EXPECT_NEAR(fence_check.distance_to_boundary_m, 10.0, 0.1);
+
+    // Far away from the grid.
+    fence_check = evaluator.check(to_point({2050.0, 0.0}));
+    EXPECT_FALSE(fence_check.is_within_fence);
+    EXPECT_NEAR(fence_check.distance_to_boundary_m, 2000.0, 1.0);
+}
+
+TEST(GeofenceEvaluator, ExclusionInsideInclusion)
+{
+    GeofenceEvaluator evaluator(
+        {make_square(Geofence::Polygon::FenceType::Inclusion, -50.0, -50.0, 100.0),
+         make_square(Geofence::Polygon::FenceType::Exclusion, -10.0, -10.0, 20.0)});
+
+    EXPECT_FALSE(evaluator.check(to_point({0.0, 0.0})).is_within_fence);
+    EXPECT_TRUE(evaluator.check(to_point({30.0, 30.0})).is_within_fence);
+    EXPECT_FALSE(evaluator.check(to_point({80.0, 0.0})).is_within_fence);
+    EXPECT_NEAR(evaluator.check(to_point({0.0, 0.0})).distance_to_boundary_m, 10.0, 0.1);
+}
+
+TEST(GeofenceEvaluator, ExclusionOnly)
+{
+    GeofenceEvaluator evaluator(
+        {make_square(Geofence::Polygon::FenceType::Exclusion, -10.0, -10.0, 20.0)});
+
+    EXPECT_FALSE(evaluator.check(to_point({0.0, 0.0})).is_within_fence);
+    EXPECT_TRUE(evaluator.check(to_point({100.0, 100.0})).is_within_fence);
+}
+
+TEST(GeofenceEvaluator, MatchesBruteForce)
+{
+    const auto polygon = make_star(10000, 1000.0);
+    GeofenceEvaluator evaluator({polygon});
+
+    std::vector<CoordinateTransformation::LocalCoordinate> ring;
+    for (const auto& point : polygon.points) {
+        ring.push_back(evaluator.to_local(point));
+    }
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> position(-1500.0, 1500.0);
+
+    std::vector<Geofence::Point> points;
+    for (unsigned i = 0; i < 2000; ++i) {
+        points.push_back(to_point({position(rng), position(rng)}));
+    }
+    const auto fence_checks = evaluator.check(points);
+    ASSERT_EQ(fence_checks.size(), points.size());
+
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        const auto p = evaluator.to_local(points[i]);
+
+        bool inside = false;
+        double min_distance = std::numeric_limits<double>::max();
+        for (std::size_t j = 0, k = ring.size() - 1; j < ring.size(); k = j++) {
+            const auto& a = ring[j];
+            const auto& b = ring[k];
+            if ((a.north_m > p.north_m) != (b.north_m > p.north_m) &&
+                p.east_m < (b.east_m - a.east_m) * (p.north_m - a.north_m) /
+                                   (b.north_m - a.north_m) +
+                               a.east_m) {
+                inside = !inside;
+            }
+            const double dn = b.north_m - a.north_m;
+            const double de = b.east_m - a.east_m;
+            double t =
+                ((p.north_m - a.north_m) * dn + (p.east_m - a.east_m) * de) / (dn * dn + de * de);
+            t = std::max(0.0, std::min(1.0, t));
+            min_distance = std::min(
+                min_distance,
+                std::hypot(a.north_m + t * dn - p.north_m, a.east_m + t * de - p.east_m));
+        }
+
+        EXPECT_EQ(fence_checks[i].is_within_fence, inside);
+        EXPECT_NEAR(fence_checks[i].distance_to_boundary_m, min_distance, 1e-6);
+    }
+}
@@ -1,4 +1,5 @@
 #include "geofence_impl.h"
+#include "polygon_simplifier.h"
 #include "global_include.h"
 #include "log.h"
 #include <cmath>
@@ -37,16 +38,95 @@ void GeofenceImpl::upload_geofence_async(
 {
     // We can just create these items on the stack because they get copied
     // later in the MAVLinkMissionTransfer constructor.
-    const auto items = assemble_items(polygons);
+    const auto simplified = simplify(polygons);
+    const auto items = assemble_items(simplified);
+
+    // Built upfront so that the index is ready as soon as the upload is done.
+    std::shared_ptr<const GeofenceEvaluator> evaluator =
+        std::make_shared<GeofenceEvaluator>(simplified);
 
     _parent->mission_transfer().upload_items_async(
-        MAV_MISSION_TYPE_FENCE, items, [this, callback](MAVLinkMissionTransfer::Result result) {
+        MAV_MISSION_TYPE_FENCE,
+        items,
+        [this, callback, evaluator](MAVLinkMissionTransfer::Result result) {
+            if (result == MAVLinkMissionTransfer::Result::Success) {
+                std::lock_guard<std::mutex> lock(_evaluator_mutex);
+                _evaluator = evaluator;
+            }
             auto converted_result = convert_result(result);
             _parent->call_user_callback(
                 [callback, converted_result]() { callback(converted_result); });
         });
 }
 
+void GeofenceImpl::set_simplification_options(
+    Geofence::SimplificationOptions simplification_options)
+{
+    std::lock_guard<std::mutex> lock(_simplification_options_mutex);
+    _simplification_options = simplification_options;
+}
+
+Geofence::FenceCheck GeofenceImpl::check_point(const Geofence::Point& point)
+{
+    std::shared_ptr<const GeofenceEvaluator> evaluator;
+    {
+        std::lock_guard<std::mutex> lock(_evaluator_mutex);
+        evaluator = _evaluator;
+    }
+
+    if (!evaluator) {
+        Geofence::FenceCheck fence_check{};
+        fence_check.is_within_fence = true;
+        fence_check.distance_to_boundary_m = NAN;
+        return fence_check;
+    }
+
+    return evaluator->check(point);
+}
+
+std::vector<Geofence::FenceCheck>
+GeofenceImpl::check_points(const std::vector<Geofence::Point>& points)
+{
+    std::shared_ptr<const GeofenceEvaluator> evaluator;
+    {
+        std::lock_guard<std::mutex> lock(_evaluator_mutex);
+        evaluator = _evaluator;
+    }
+
+    if (!evaluator) {
+        Geofence::FenceCheck fence_check{};
+        fence_check.is_within_fence = true;
+        fence_check.distance_to_boundary_m = NAN;
+        return std::vector<Geofence::FenceCheck>(points.size(), fence_check);
+    }
+
+    return evaluator->check(points);
+}
+
+std::vector<Geofence::Polygon>
+GeofenceImpl::simplify(const std::vector<Geofence::Polygon>& polygons)
+{
+    Geofence::SimplificationOptions options;
+    {
+        std::lock_guard<std::mutex> lock(_simplification_options_mutex);
+        options = _simplification_options;
+    }
+
+    if (!options.enabled) {
+        return polygons;
+    }
+
+    PolygonSimplifier simplifier(options.tolerance_m, options.merge_shared_edges);
+    auto simplified = simplifier.simplify(polygons);
+
+    const auto& stats = simplifier.get_stats();
+    LogDebug() << "Simplified geofence from " << stats.polygons_before << " polygons with "
+               << stats.vertices_before << " vertices to " << stats.polygons_after
+               << " polygons with " << stats.vertices_after << " vertices";
+
+    return simplified;
+}
+
 std::vector<MAVLinkMissionTransfer::ItemInt>
 GeofenceImpl::assemble_items(const std::vector<Geofence::Polygon>& polygons)
 {
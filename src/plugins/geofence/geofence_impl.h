@@ -3,9 +3,11 @@
 #include <memory>
 #include <map>
 #include <atomic>
+#include <mutex>
 
 #include "mavlink_include.h"
 #include "plugins/geofence/geofence.h"
+#include "geofence_evaluator.h"
 #include "plugin_impl_base.h"
 #include "system.h"
 
@@ -27,6 +29,11 @@ public:
     void upload_geofence_async(
         const std::vector<Geofence::Polygon>& polygons, const Geofence::ResultCallback& callback);
 
+    void set_simplification_options(Geofence::SimplificationOptions simplification_options);
+
+    Geofence::FenceCheck check_point(const Geofence::Point& point);
+    std::vector<Geofence::FenceCheck> check_points(const std::vector<Geofence::Point>& points);
+
     // Non-copyable
     GeofenceImpl(const GeofenceImpl&) = delete;
     const GeofenceImpl& operator=(const GeofenceImpl&) = delete;
@@ -35,7 +42,16 @@ private:
     std::vector<MAVLinkMissionTransfer::ItemInt>
     assemble_items(const std::vector<Geofence::Polygon>& polygons);
 
+    std::vector<Geofence::Polygon> simplify(const std::vector<Geofence::Polygon>& polygons);
+
     static Geofence::Result convert_result(MAVLinkMissionTransfer::Result result);
+
+    std::mutex _simplification_options_mutex{};
+    Geofence::SimplificationOptions _simplification_options{};
+
+    // Replaced as a whole on upload so checks only need the lock to copy the pointer.
+    std::mutex _evaluator_mutex{};
+    std::shared_ptr<const GeofenceEvaluator> _evaluator{};
 };
 
 } // namespace mavsdk
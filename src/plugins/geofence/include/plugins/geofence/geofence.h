@@ -103,6 +103,60 @@ public:
      */
     friend std::ostream& operator<<(std::ostream& str, Geofence::Polygon const& polygon);
 
+    /**
+     * @brief Simplification applied to polygons before they are uploaded.
+     *
+     * Simplification is one-sided: inclusion polygons are only ever grown and
+     * exclusion polygons are only ever shrunk, so no position allowed by the
+     * given polygons is disallowed by the uploaded ones.
+     */
+    struct SimplificationOptions {
+        bool enabled{false}; /**< @brief Whether to simplify polygons before upload */
+        double tolerance_m{
+            1.0}; /**< @brief Maximum deviation of the simplified outline in meters */
+        bool merge_shared_edges{
+            true}; /**< @brief Merge polygons of the same type sharing edges into one */
+    };
+
+    /**
+     * @brief Equal operator to compare two `Geofence::SimplificationOptions` objects.
+     *
+     * @return `true` if items are equal.
+     */
+    friend bool operator==(
+        const Geofence::SimplificationOptions& lhs, const Geofence::SimplificationOptions& rhs);
+
+    /**
+     * @brief Stream operator to print information about a `Geofence::SimplificationOptions`.
+     *
+     * @return A reference to the stream.
+     */
+    friend std::ostream&
+    operator<<(std::ostream& str, Geofence::SimplificationOptions const& simplification_options);
+
+    /**
+     * @brief Result of checking a point against the uploaded geofence.
+     */
+    struct FenceCheck {
+        bool is_within_fence{}; /**< @brief Whether the point is allowed by the geofence */
+        double distance_to_boundary_m{}; /**< @brief Distance to the closest polygon edge in
+                                            meters (NaN if no geofence) */
+    };
+
+    /**
+     * @brief Equal operator to compare two `Geofence::FenceCheck` objects.
+     *
+     * @return `true` if items are equal.
+     */
+    friend bool operator==(const Geofence::FenceCheck& lhs, const Geofence::FenceCheck& rhs);
+
+    /**
+     * @brief Stream operator to print information about a `Geofence::FenceCheck`.
+     *
+     * @return A reference to the stream.
+     */
+    friend std::ostream& operator<<(std::ostream& str, Geofence::FenceCheck const& fence_check);
+
     /**
      * @brief Possible results returned for geofence requests.
      */
@@ -150,6 +204,45 @@ public:
      */
     Result upload_geofence(std::vector<Polygon> polygons) const;
 
+    /**
+     * @brief Set simplification applied to polygons on upload.
+     *
+     * Large polygons, e.g. from GIS data, can consist of many thousand vertices
+     * which each need to be transferred as a separate item. Simplification
+     * reduces the number of items and therefore the upload time.
+     *
+     * This function is blocking.
+     *
+     * @return Result of request.
+     */
+    void set_simplification_options(SimplificationOptions simplification_options) const;
+
+    /**
+     * @brief Check a point against the last successfully uploaded geofence.
+     *
+     * The check is done locally without any communication with the vehicle,
+     * e.g. to warn about a vehicle approaching the fence. A point is within the
+     * fence if it is inside any inclusion polygon (if there are any) and not
+     * inside any exclusion polygon.
+     *
+     * This function is blocking.
+     *
+     * @return Result of request.
+     */
+    Geofence::FenceCheck check_point(Point point) const;
+
+    /**
+     * @brief Check a batch of points against the last successfully uploaded geofence.
+     *
+     * This is more efficient than checking points one by one, e.g. for the
+     * positions of a whole fleet. The results are in the order of the points.
+     *
+     * This function is blocking.
+     *
+     * @return Result of request.
+     */
+    std::vector<Geofence::FenceCheck> check_points(std::vector<Point> points) const;
+
     /**
      * @brief Copy constructor (object is not copyable).
      */
@@ -0,0 +1,503 @@
+#include "polygon_simplifier.h"
+#include "global_include.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <queue>
+#include <utility>
+
+namespace mavsdk {
+
+PolygonSimplifier::PolygonSimplifier(double tolerance_m, bool merge_shared_edges) :
+    _tolerance_m(tolerance_m),
+    _merge_shared_edges(merge_shared_edges)
+{}
+
+std::vector<Geofence::Polygon>
+PolygonSimplifier::simplify(const std::vector<Geofence::Polygon>& polygons)
+{
+    _stats = Stats{};
+    _stats.polygons_before = polygons.size();
+
+    std::vector<Ring> rings;
+    std::vector<Ring> degenerate_rings;
+    for (const auto& polygon : polygons) {
+        _stats.vertices_before += polygon.points.size();
+
+        auto ring = ring_from_polygon(polygon);
+        if (ring.vertices.size() < 3) {
+            // Nothing sensible to do with these, pass them on unchanged.
+            degenerate_rings.push_back(ring);
+            continue;
+        }
+        make_counter_clockwise(ring);
+        rings.push_back(ring);
+    }
+
+    if (_merge_shared_edges) {
+        rings = merge_shared_edges(rings);
+    }
+
+    if (_tolerance_m > 0.0) {
+        for (auto& ring : rings) {
+            simplify_ring(ring);
+        }
+    }
+
+    std::vector<Geofence::Polygon> result;
+    for (const auto& ring : rings) {
+        result.push_back(polygon_from_ring(ring));
+        _stats.vertices_after += ring.vertices.size();
+    }
+    for (const auto& ring : degenerate_rings) {
+        result.push_back(polygon_from_ring(ring));
+        _stats.vertices_after += ring.vertices.size();
+    }
+    _stats.polygons_after = result.size();
+
+    return result;
+}
+
+PolygonSimplifier::Ring PolygonSimplifier::ring_from_polygon(const Geofence::Polygon& polygon)
+{
+    Ring ring{{}, polygon.fence_type};
+    ring.vertices.reserve(polygon.points.size());
+
+    for (const auto& point : polygon.points) {
+        const Vertex vertex{int32_t(std::round(point.latitude_deg * 1e7)),
+                            int32_t(std::round(point.longitude_deg * 1e7))};
+        // Consecutive duplicates don't add anything.
+        if (!ring.vertices.empty() && ring.vertices.back() == vertex) {
+            continue;
+        }
+        ring.vertices.push_back(vertex);
+    }
+
+    // Polygons are implicitly closed, an explicit closing vertex is redundant.
+    while (ring.vertices.size() > 1 && ring.vertices.front() == ring.vertices.back()) {
+        ring.vertices.pop_back();
+    }
+
+    return ring;
+}
+
+Geofence::Polygon PolygonSimplifier::polygon_from_ring(const Ring& ring)
+{
+    Geofence::Polygon polygon{};
+    polygon.fence_type = ring.fence_type;
+    polygon.points.reserve(ring.vertices.size());
+
+    for (const auto& vertex : ring.vertices) {
+        Geofence::Point point{};
+        point.latitude_deg = double(vertex.lat_e7) * 1e-7;
+        point.longitude_deg = double(vertex.lon_e7) * 1e-7;
+        polygon.points.push_back(point);
+    }
+    return polygon;
+}
+
+uint64_t PolygonSimplifier::key(const Vertex& vertex)
+{
+    return (uint64_t(uint32_t(vertex.lat_e7)) << 32) | uint64_t(uint32_t(vertex.lon_e7));
+}
+
+double PolygonSimplifier::signed_area(const std::vector<Vertex>& vertices)
+{
+    if (vertices.empty()) {
+        return 0.0;
+    }
+
+    // Relative to the first vertex to keep the products small.
+    const auto& origin = vertices.front();
+    double area = 0.0;
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        const auto& one = vertices[i];
+        const auto& two = vertices[(i + 1) % vertices.size()];
+        const double x1 = double(one.lon_e7 - origin.lon_e7);
+        const double y1 = double(one.lat_e7 - origin.lat_e7);
+        const double x2 = double(two.lon_e7 - origin.lon_e7);
+        const double y2 = double(two.lat_e7 - origin.lat_e7);
+        area += x1 * y2 - x2 * y1;
+    }
+    return area / 2.0;
+}
+
+void PolygonSimplifier::make_counter_clockwise(Ring& ring)
+{
+    if (signed_area(ring.vertices) < 0.0) {
+        std::reverse(ring.vertices.begin(), ring.vertices.end());
+    }
+}
+
+std::vector<PolygonSimplifier::Ring> PolygonSimplifier::merge_shared_edges(std::vector<Ring>& rings)
+{
+    // All rings are counter-clockwise, so an edge shared by two adjacent
+    // rings shows up as a->b in one and as b->a in the other one.
+    std::map<std::pair<uint64_t, uint64_t>, std::size_t> edge_owner;
+    for (std::size_t i = 0; i < rings.size(); ++i) {
+        const auto& vertices = rings[i].vertices;
+        for (std::size_t j = 0; j < vertices.size(); ++j) {
+            edge_owner[std::make_pair(key(vertices[j]), key(vertices[(j + 1) % vertices.size()]))] =
+                i;
+        }
+    }
+
+    // Union-find to group rings which are connected by shared edges.
+    std::vector<std::size_t> parent(rings.size());
+    for (std::size_t i = 0; i < parent.size(); ++i) {
+        parent[i] = i;
+    }
+    auto find = [&parent](std::size_t i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    };
+
+    for (std::size_t i = 0; i < rings.size(); ++i) {
+        const auto& vertices = rings[i].vertices;
+        for (std::size_t j = 0; j < vertices.size(); ++j) {
+            const auto reverse_edge =
+                std::make_pair(key(vertices[(j + 1) % vertices.size()]), key(vertices[j]));
+            const auto it = edge_owner.find(reverse_edge);
+            if (it == edge_owner.end() || it->second == i ||
+                rings[it->second].fence_type != rings[i].fence_type) {
+                continue;
+            }
+            parent[find(i)] = find(it->second);
+        }
+    }
+
+    std::map<std::size_t, std::vector<std::size_t>> components;
+    for (std::size_t i = 0; i < rings.size(); ++i) {
+        components[find(i)].push_back(i);
+    }
+
+    std::vector<Ring> result;
+    for (const auto& component : components) {
+        const auto& members = component.second;
+        if (members.size() > 1 && merge_component(rings, members, result)) {
+            continue;
+        }
+        // Not merged, keep the rings as they are.
+        for (auto member : members) {
+            result.push_back(rings[member]);
+        }
+    }
+    return result;
+}
+
+bool PolygonSimplifier::merge_component(
+    const std::vector<Ring>& rings,
+    const std::vector<std::size_t>& members,
+    std::vector<Ring>& merged)
+{
+    std::map<std::pair<uint64_t, uint64_t>, unsigned> edge_count;
+    std::map<uint64_t, Vertex> vertices_by_key;
+
+    for (auto member : members) {
+        const auto& vertices = rings[member].vertices;
+        for (std::size_t j = 0; j < vertices.size(); ++j) {
+            const auto& from = vertices[j];
+            const auto& to = vertices[(j + 1) % vertices.size()];
+            vertices_by_key[key(from)] = from;
+            if (++edge_count[std::make_pair(key(from), key(to))] > 1) {
+                // The same edge in the same direction means the rings overlap.
+                return false;
+            }
+        }
+    }
+
+    // Drop shared edges and link up whatever is left.
+    std::map<uint64_t, uint64_t> next;
+    for (const auto& edge : edge_count) {
+        if (edge_count.find(std::make_pair(edge.first.second, edge.first.first)) !=
+            edge_count.end()) {
+            continue;
+        }
+        if (!next.insert(std::make_pair(edge.first.first, edge.first.second)).second) {
+            // Rings touching in a single vertex can't be stitched unambiguously.
+            return false;
+        }
+    }
+
+    std::vector<Ring> stitched;
+    while (!next.empty()) {
+        Ring ring{{}, rings[members.front()].fence_type};
+
+        const uint64_t start = next.begin()->first;
+        uint64_t current = start;
+        do {
+            const auto it = next.find(current);
+            if (it == next.end()) {
+                return false;
+            }
+            ring.vertices.push_back(vertices_by_key[current]);
+            current = it->second;
+            next.erase(it);
+        } while (current != start);
+
+        // A clockwise ring is a hole which a fence polygon can't represent.
+        if (ring.vertices.size() < 3 || signed_area(ring.vertices) <= 0.0) {
+            return false;
+        }
+        stitched.push_back(ring);
+    }
+
+    merged.insert(merged.end(), stitched.begin(), stitched.end());
+    return true;
+}
+
+namespace {
+
+constexpr double world_radius_m = 6371000.0;
+
+struct LocalPoint {
+    double x; // east
+    double y; // north
+};
+
+double cross(const LocalPoint& o, const LocalPoint& a, const LocalPoint& b)
+{
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+double distance_to_segment(const LocalPoint& p, const LocalPoint& a, const LocalPoint& b)
+{
+    const double dx = b.x - a.x;
+    const double dy = b.y - a.y;
+    const double length_squared = dx * dx + dy * dy;
+
+    double t = 0.0;
+    if (length_squared > 0.0) {
+        t = std::max(0.0, std::min(1.0, ((p.x - a.x) * dx + (p.y - a.y) * dy) / length_squared));
+    }
+    const double ex = a.x + t * dx - p.x;
+    const double ey = a.y + t * dy - p.y;
+    return std::sqrt(ex * ex + ey * ey);
+}
+
+bool is_in_triangle(
+    const LocalPoint& p, const LocalPoint& a, const LocalPoint& b, const LocalPoint& c)
+{
+    const double d1 = cross(a, b, p);
+    const double d2 = cross(b, c, p);
+    const double d3 = cross(c, a, p);
+    const bool has_negative = (d1 < 0.0) || (d2 < 0.0) || (d3 < 0.0);
+    const bool has_positive = (d1 > 0.0) || (d2 > 0.0) || (d3 > 0.0);
+    return !(has_negative && has_positive);
+}
+
+// Uniform grid over the ring vertices to find vertices inside a triangle fast.
+class VertexGrid {
+public:
+    explicit VertexGrid(const std::vector<LocalPoint>& points) : _points(points)
+    {
+        _min_x = _max_x = points.front().x;
+        _min_y = _max_y = points.front().y;
+        for (const auto& point : points) {
+            _min_x = std::min(_min_x, point.x);
+            _max_x = std::max(_max_x, point.x);
+            _min_y = std::min(_min_y, point.y);
+            _max_y = std::max(_max_y, point.y);
+        }
+
+        // Aim for a handful of vertices per cell.
+        const auto cells_per_side = std::max<std::size_t>(
+            1, static_cast<std::size_t>(std::sqrt(double(points.size()) / 4.0)));
+        _cell_size = std::max(_max_x - _min_x, _max_y - _min_y) / double(cells_per_side);
+        if (!(_cell_size > 0.0)) {
+            _cell_size = 1.0;
+        }
+        _columns = static_cast<std::size_t>((_max_x - _min_x) / _cell_size) + 1;
+        _rows = static_cast<std::size_t>((_max_y - _min_y) / _cell_size) + 1;
+        _cells.resize(_columns * _rows);
+
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            _cells[cell_index(points[i].x, points[i].y)].push_back(i);
+        }
+    }
+
+    void remove(std::size_t index)
+    {
+        auto& cell = _cells[cell_index(_points[index].x, _points[index].y)];
+        cell.erase(std::remove(cell.begin(), cell.end(), index), cell.end());
+    }
+
+    // Returns true if any vertex other than the corners is inside the triangle.
+    bool any_inside(std::size_t a, std::size_t b, std::size_t c) const
+    {
+        const auto& pa = _points[a];
+        const auto& pb = _points[b];
+        const auto& pc = _points[c];
+
+        const std::size_t col_begin = column(std::min({pa.x, pb.x, pc.x}));
+        const std::size_t col_end = column(std::max({pa.x, pb.x, pc.x}));
+        const std::size_t row_begin = row(std::min({pa.y, pb.y, pc.y}));
+        const std::size_t row_end = row(std::max({pa.y, pb.y, pc.y}));
+
+        for (std::size_t r = row_begin; r <= row_end; ++r) {
+            for (std::size_t col = col_begin; col <= col_end; ++col) {
+                for (auto index : _cells[r * _columns + col]) {
+                    if (index == a || index == b || index == c) {
+                        continue;
+                    }
+                    if (is_in_triangle(_points[index], pa, pb, pc)) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+private:
+    std::size_t column(double x) const
+    {
+        return std::min(
+            _columns - 1, static_cast<std::size_t>(std::max(0.0, (x - _min_x) / _cell_size)));
+    }
+    std::size_t row(double y) const
+    {
+        return std::min(
+            _rows - 1, static_cast<std::size_t>(std::max(0.0, (y - _min_y) / _cell_size)));
+    }
+    std::size_t cell_index(double x, double y) const { return row(y) * _columns + column(x); }
+
+    const std::vector<LocalPoint>& _points;
+    double _min_x{0.0};
+    double _max_x{0.0};
+    double _min_y{0.0};
+    double _max_y{0.0};
+    double _cell_size{1.0};
+    std::size_t _columns{1};
+    std::size_t _rows{1};
+    std::vector<std::vector<std::size_t>> _cells{};
+};
+
+struct Candidate {
+    double cost;
+    std::size_t index;
+    unsigned version;
+
+    bool operator>(const Candidate& other) const { return cost > other.cost; }
+};
+
+} // namespace
+
+void PolygonSimplifier::simplify_ring(Ring& ring)
+{
+    const std::size_t n = ring.vertices.size();
+    if (n <= 3) {
+        return;
+    }
+
+    // Fence polygons are evaluated as planar in latitude/longitude, so an
+    // equirectangular projection is used which keeps edges straight and only
+    // scales longitude to get distances in meters.
+    const double meters_per_e7 = 1e-7 * to_rad_from_deg(1.0) * world_radius_m;
+    const double east_scale =
+        meters_per_e7 * std::cos(to_rad_from_deg(double(ring.vertices.front().lat_e7) * 1e-7));
+
+    std::vector<LocalPoint> points(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        points[i] = LocalPoint{
+            double(ring.vertices[i].lon_e7 - ring.vertices.front().lon_e7) * east_scale,
+            double(ring.vertices[i].lat_e7 - ring.vertices.front().lat_e7) * meters_per_e7};
+    }
+
+    std::vector<std::size_t> prev(n);
+    std::vector<std::size_t> next(n);
+    std::vector<unsigned> version(n, 0);
+    std::vector<bool> removed(n, false);
+    for (std::size_t i = 0; i < n; ++i) {
+        prev[i] = (i + n - 1) % n;
+        next[i] = (i + 1) % n;
+    }
+
+    const bool may_grow = (ring.fence_type == Geofence::Polygon::FenceType::Inclusion);
+
+    // Cost of removing a vertex is the largest distance of any original vertex
+    // which would be replaced by the new edge, or infinity if removing it would
+    // move the outline to the wrong side.
+    auto cost = [&](std::size_t i) {
+        const std::size_t a = prev[i];
+        const std::size_t b = next[i];
+
+        // The ring is counter-clockwise, so a left turn is a convex vertex.
+        // Removing a convex vertex cuts off a triangle, removing a reflex one adds one.
+        const double turn = cross(points[a], points[i], points[b]);
+        if ((may_grow && turn > 0.0) || (!may_grow && turn < 0.0)) {
+            return std::numeric_limits<double>::infinity();
+        }
+
+        double max_distance = 0.0;
+        for (std::size_t j = (a + 1) % n; j != b; j = (j + 1) % n) {
+            max_distance =
+                std::max(max_distance, distance_to_segment(points[j], points[a], points[b]));
+            if (max_distance > _tolerance_m) {
+                break;
+            }
+        }
+        return max_distance;
+    };
+
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> queue;
+    auto consider = [&](std::size_t i) {
+        const double c = cost(i);
+        if (c <= _tolerance_m) {
+            queue.push(Candidate{c, i, version[i]});
+        }
+    };
+
+    for (std::size_t i = 0; i < n; ++i) {
+        consider(i);
+    }
+
+    VertexGrid grid(points);
+    std::size_t remaining = n;
+
+    while (!queue.empty() && remaining > 3) {
+        const Candidate candidate = queue.top();
+        queue.pop();
+
+        const std::size_t i = candidate.index;
+        if (removed[i] || candidate.version != version[i]) {
+            continue;
+        }
+
+        // The new edge must not cut through any other part of the ring. Since
+        // the ring is simple, it is enough to check that no other vertex is in
+        // the triangle which gets added or removed.
+        const std::size_t a = prev[i];
+        const std::size_t b = next[i];
+        if (grid.any_inside(a, i, b)) {
+            continue;
+        }
+
+        removed[i] = true;
+        grid.remove(i);
+        next[a] = b;
+        prev[b] = a;
+        --remaining;
+
+        ++version[a];
+        ++version[b];
+        consider(a);
+        consider(b);
+    }
+
+    std::vector<Vertex> kept;
+    kept.reserve(remaining);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (!removed[i]) {
+            kept.push_back(ring.vertices[i]);
+        }
+    }
+    ring.vertices = kept;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "plugins/geofence/geofence.h"
+
+namespace mavsdk {
+
+// Reduces the number of fence vertices before they are uploaded.
+//
+// The simplification is one-sided: an inclusion polygon is only ever grown
+// and an exclusion polygon is only ever shrunk, so no position which was
+// allowed by the original fence gets disallowed by the simplified one.
+// The deviation of the simplified outline from the original one is bounded
+// by the tolerance.
+//
+// Polygons of the same fence type sharing edges (e.g. adjacent zones from GIS
+// data) can additionally be merged into one polygon by dropping the shared
+// edges. This only works if the shared edges use identical vertices, and is
+// skipped where the merge would result in a polygon with holes.
+class PolygonSimplifier {
+public:
+    struct Stats {
+        std::size_t polygons_before{0};
+        std::size_t polygons_after{0};
+        std::size_t vertices_before{0};
+        std::size_t vertices_after{0};
+    };
+
+    PolygonSimplifier(double tolerance_m, bool merge_shared_edges);
+    ~PolygonSimplifier() = default;
+
+    // Delete copy and move constructors and assign operators.
+    PolygonSimplifier(PolygonSimplifier const&) = delete;
+    PolygonSimplifier(PolygonSimplifier&&) = delete;
+    PolygonSimplifier& operator=(PolygonSimplifier const&) = delete;
+    PolygonSimplifier& operator=(PolygonSimplifier&&) = delete;
+
+    std::vector<Geofence::Polygon> simplify(const std::vector<Geofence::Polygon>& polygons);
+
+    const Stats& get_stats() const { return _stats; }
+
+private:
+    // Vertices are handled in the 1e-7 degree resolution used on the wire.
+    struct Vertex {
+        int32_t lat_e7;
+        int32_t lon_e7;
+
+        bool operator==(const Vertex& other) const
+        {
+            return lat_e7 == other.lat_e7 && lon_e7 == other.lon_e7;
+        }
+        bool operator!=(const Vertex& other) const { return !(*this == other); }
+    };
+
+    struct Ring {
+        std::vector<Vertex> vertices;
+        Geofence::Polygon::FenceType fence_type;
+    };
+
+    static Ring ring_from_polygon(const Geofence::Polygon& polygon);
+    static Geofence::Polygon polygon_from_ring(const Ring& ring);
+    static uint64_t key(const Vertex& vertex);
+    static double signed_area(const std::vector<Vertex>& vertices);
+    static void make_counter_clockwise(Ring& ring);
+
+    std::vector<Ring> merge_shared_edges(std::vector<Ring>& rings);
+    bool merge_component(
+        const std::vector<Ring>& rings,
+        const std::vector<std::size_t>& members,
+        std::vector<Ring>& merged);
+    void simplify_ring(Ring& ring);
+
+    const double _tolerance_m;
+    const bool _merge_shared_edges;
+    Stats _stats{};
+};
+
+} // namespace mavsdk
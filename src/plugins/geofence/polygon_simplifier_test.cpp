@@ -0,0 +1,237 @@
+#include "polygon_simplifier.h"
+#include "geometry.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace mavsdk;
+using namespace mavsdk::geometry;
+
+namespace {
+
+CoordinateTransformation::GlobalCoordinate reference{47.397742, 8.545594};
+
+Geofence::Polygon make_polygon(
+    Geofence::Polygon::FenceType fence_type,
+    const std::vector<CoordinateTransformation::LocalCoordinate>& locals)
+{
+    CoordinateTransformation ct(reference);
+
+    Geofence::Polygon polygon{};
+    polygon.fence_type = fence_type;
+    for (const auto& local : locals) {
+        const auto global = ct.global_from_local(local);
+        // Use the same resolution as on the wire.
+        Geofence::Point point{};
+        point.latitude_deg = std::round(global.latitude_deg * 1e7) * 1e-7;
+        point.longitude_deg = std::round(global.longitude_deg * 1e7) * 1e-7;
+        polygon.points.push_back(point);
+    }
+    return polygon;
+}
+
+// A circle with a bumpy outline, the kind of shape which has many vertices.
+Geofence::Polygon
+make_bumpy_circle(Geofence::Polygon::FenceType fence_type, unsigned num_vertices, double radius_m)
+{
+    std::vector<CoordinateTransformation::LocalCoordinate> locals;
+    for (unsigned i = 0; i < num_vertices; ++i) {
+        const double angle = 2.0 * M_PI * double(i) / double(num_vertices);
+        const double r = radius_m + 2.0 * std::sin(37.0 * angle) + 0.5 * std::sin(211.0 * angle);
+        locals.push_back({r * std::cos(angle), r * std::sin(angle)});
+    }
+    return make_polygon(fence_type, locals);
+}
+
+Geofence::Polygon make_polygon_deg(
+    Geofence::Polygon::FenceType fence_type,
+    const std::vector<CoordinateTransformation::GlobalCoordinate>& globals)
+{
+    Geofence::Polygon polygon{};
+    polygon.fence_type = fence_type;
+    for (const auto& global : globals) {
+        Geofence::Point point{};
+        point.latitude_deg = global.latitude_deg;
+        point.longitude_deg = global.longitude_deg;
+        polygon.points.push_back(point);
+    }
+    return polygon;
+}
+
+std::vector<CoordinateTransformation::LocalCoordinate> to_local(const Geofence::Polygon& polygon)
+{
+    CoordinateTransformation ct(reference);
+
+    std::vector<CoordinateTransformation::LocalCoordinate> locals;
+    for (const auto& point : polygon.points) {
+        locals.push_back(ct.local_from_global({point.latitude_deg, point.longitude_deg}));
+    }
+    return locals;
+}
+
+double distance_to_outline(
+    const CoordinateTransformation::LocalCoordinate& p,
+    const std::vector<CoordinateTransformation::LocalCoordinate>& outline)
+{
+    double min_distance = std::numeric_limits<double>::max();
+    for (std::size_t i = 0; i < outline.size(); ++i) {
+        const auto& a = outline[i];
+        const auto& b = outline[(i + 1) % outline.size()];
+        const double dn = b.north_m - a.north_m;
+        const double de = b.east_m - a.east_m;
+        double t =
+            ((p.north_m - a.north_m) * dn + (p.east_m - a.east_m) * de) / (dn * dn + de * de);
+        t = std::max(0.0, std::min(1.0, t));
+        min_distance = std::min(
+            min_distance, std::hypot(a.north_m + t * dn - p.north_m, a.east_m + t * de - p.east_m));
+    }
+    return min_distance;
+}
+
+bool is_inside_or_on(
+    const CoordinateTransformation::LocalCoordinate& p,
+    const std::vector<CoordinateTransformation::LocalCoordinate>& outline)
+{
+    // Allow for the 1e-7 degree quantization.
+    if (distance_to_outline(p, outline) < 0.01) {
+        return true;
+    }
+
+    bool inside = false;
+    for (std::size_t i = 0, j = outline.size() - 1; i < outline.size(); j = i++) {
+        const auto& a = outline[i];
+        const auto& b = outline[j];
+        if ((a.north_m > p.north_m) != (b.north_m > p.north_m) &&
+            p.east_m <
+                (b.east_m - a.east_m) * (p.north_m - a.north_m) / (b.north_m - a.north_m) +
+                    a.east_m) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+} // namespace
+
+TEST(PolygonSimplifier, RemovesDuplicateVertices)
+{
+    auto polygon = make_polygon(
+        Geofence::Polygon::FenceType::Inclusion,
+        {{0.0, 0.0}, {0.0, 0.0}, {0.0, 100.0}, {100.0, 100.0}, {100.0, 0.0}, {0.0, 0.0}});
+
+    PolygonSimplifier simplifier(0.0, false);
+    const auto result = simplifier.simplify({polygon});
+
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result[0].points.size(), 4);
+    EXPECT_EQ(simplifier.get_stats().vertices_before, 6);
+    EXPECT_EQ(simplifier.get_stats().vertices_after, 4);
+}
+
+TEST(PolygonSimplifier, MergesSharedEdges)
+{
+    // Axis aligned in lat/lon, so the collinear vertices are exactly collinear.
+    const auto fence_type = Geofence::Polygon::FenceType::Exclusion;
+    auto left = make_polygon_deg(
+        fence_type, {{47.0, 8.0}, {47.0, 8.001}, {47.001, 8.001}, {47.001, 8.0}});
+    // Clockwise on purpose, it needs to be normalized before merging.
+    auto right = make_polygon_deg(
+        fence_type, {{47.0, 8.001}, {47.0, 8.002}, {47.001, 8.002}, {47.001, 8.001}});
+    std::reverse(right.points.begin(), right.points.end());
+
+    PolygonSimplifier merger(0.0, true);
+    auto result = merger.simplify({left, right});
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result[0].points.size(), 6);
+    EXPECT_EQ(result[0].fence_type, fence_type);
+
+    // With a tolerance the now collinear vertices go away too.
+    PolygonSimplifier simplifier(0.1, true);
+    result = simplifier.simplify({left, right});
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result[0].points.size(), 4);
+}
+
+TEST(PolygonSimplifier, DoesNotMergeDifferentTypes)
+{
+    auto left = make_polygon(
+        Geofence::Polygon::FenceType::Inclusion,
+        {{0.0, 0.0}, {100.0, 0.0}, {100.0, 100.0}, {0.0, 100.0}});
+    auto right = make_polygon(
+        Geofence::Polygon::FenceType::Exclusion,
+        {{0.0, 100.0}, {0.0, 200.0}, {100.0, 200.0}, {100.0, 100.0}});
+
+    PolygonSimplifier simplifier(0.0, true);
+    EXPECT_EQ(simplifier.simplify({left, right}).size(), 2);
+}
+
+TEST(PolygonSimplifier, DoesNotMergeIntoHole)
+{
+    // Eight squares around a courtyard would leave a hole when merged.
+    std::vector<Geofence::Polygon> polygons;
+    for (int north = 0; north < 3; ++north) {
+        for (int east = 0; east < 3; ++east) {
+            if (north == 1 && east == 1) {
+                continue;
+            }
+            const double n = north * 50.0;
+            const double e = east * 50.0;
+            polygons.push_back(make_polygon(
+                Geofence::Polygon::FenceType::Exclusion,
+                {{n, e}, {n, e + 50.0}, {n + 50.0, e + 50.0}, {n + 50.0, e}}));
+        }
+    }
+
+    PolygonSimplifier simplifier(0.0, true);
+    EXPECT_EQ(simplifier.simplify(polygons).size(), 8);
+}
+
+TEST(PolygonSimplifier, InclusionIsNeverShrunk)
+{
+    const auto original =
+        make_bumpy_circle(Geofence::Polygon::FenceType::Inclusion, 5000, 500.0);
+
+    PolygonSimplifier simplifier(3.0, true);
+    const auto result = simplifier.simplify({original});
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_LT(result[0].points.size(), original.points.size() / 10);
+
+    const auto simplified = to_local(result[0]);
+    for (const auto& point : to_local(original)) {
+        EXPECT_TRUE(is_inside_or_on(point, simplified));
+    }
+}
+
+TEST(PolygonSimplifier, ExclusionIsNeverGrown)
+{
+    const auto original =
+        make_bumpy_circle(Geofence::Polygon::FenceType::Exclusion, 5000, 500.0);
+
+    PolygonSimplifier simplifier(3.0, true);
+    const auto result = simplifier.simplify({original});
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_LT(result[0].points.size(), original.points.size() / 10);
+
+    const auto outline = to_local(original);
+    for (const auto& point : to_local(result[0])) {
+        EXPECT_TRUE(is_inside_or_on(point, outline));
+    }
+}
+
+TEST(PolygonSimplifier, StaysWithinTolerance)
+{
+    const double tolerance_m = 1.5;
+    const auto original =
+        make_bumpy_circle(Geofence::Polygon::FenceType::Inclusion, 2000, 300.0);
+
+    PolygonSimplifier simplifier(tolerance_m, false);
+    const auto result = simplifier.simplify({original});
+    ASSERT_EQ(result.size(), 1);
+
+    const auto simplified = to_local(result[0]);
+    for (const auto& point : to_local(original)) {
+        // Some slack for the 1e-7 degree quantization.
+        EXPECT_LT(distance_to_outline(point, simplified), tolerance_m + 0.01);
+    }
+}
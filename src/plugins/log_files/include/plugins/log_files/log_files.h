@@ -49,6 +49,8 @@ public:
      */
     struct ProgressData {
         float progress{float(NAN)}; /**< @brief Progress from 0 to 1 */
+        float throughput_bytes_s{float(NAN)}; /**< @brief Average download rate so far in bytes
+                                                 per second */
     };
 
     /**
@@ -146,6 +148,35 @@ public:
      */
     void download_log_file_async(uint32_t id, std::string path, DownloadLogFileCallback callback);
 
+    /**
+     * @brief Callback type for download_log_files_async.
+     */
+
+    using DownloadLogFilesCallback = std::function<void(LogFiles::Result, ProgressData)>;
+
+    /**
+     * @brief Download several log files into a directory, one after the other.
+     *
+     * The files are named "log_<id>_<date>.ulg". Logs already there with the same size are
+     * skipped, downloads cut short before are continued where they stopped. The entries
+     * need to be listed with get_entries first. Progress is over all of the logs, the
+     * result is the first error if any log failed.
+     */
+    void download_log_files_async(
+        std::vector<uint32_t> ids, std::string directory, DownloadLogFilesCallback callback);
+
+    /**
+     * @brief Set how many systems download logs at once over the same link.
+     *
+     * The limit is for all systems, downloads beyond it wait for another one on the link
+     * to be done. The default is 4, lower it for radios the vehicles share.
+     *
+     * This function is blocking.
+     *
+     * @return Result of request.
+     */
+    Result set_max_downloads_per_link(uint32_t count) const;
+
     /**
      * @brief Copy constructor (object is not copyable).
      */
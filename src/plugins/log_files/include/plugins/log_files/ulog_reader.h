@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace mavsdk {
+
+class ULogReaderImpl;
+
+/**
+ * @brief Reads ULog files, such as the logs PX4 writes and LogFiles downloads.
+ *
+ * The file is mapped into memory and indexed in one pass when opened, which
+ * notes where the messages of each topic are. The fields of topics can then be
+ * extracted into arrays, several topics at once each on its own thread.
+ *
+ * The format is described in https://docs.px4.io/master/en/dev_log/ulog_file_format.html
+ */
+class ULogReader {
+public:
+    /**
+     * @brief Constructor, use open() to read a file.
+     */
+    ULogReader();
+
+    /**
+     * @brief Destructor, closes the file if still open.
+     */
+    ~ULogReader();
+
+    /**
+     * @brief Possible results returned for requests.
+     */
+    enum class Result {
+        Unknown, /**< @brief Unknown error. */
+        Success, /**< @brief Request succeeded. */
+        FileOpenFailed, /**< @brief File could not be opened or mapped. */
+        InvalidFile, /**< @brief Not a ULog file, or one of an unsupported version. */
+        TopicNotFound, /**< @brief Topic or instance not in the log. */
+        FieldNotFound, /**< @brief Field not in the topic, or not of a basic type. */
+    };
+
+    /**
+     * @brief Stream operator to print information about a `ULogReader::Result`.
+     *
+     * @return A reference to the stream.
+     */
+    friend std::ostream& operator<<(std::ostream& str, ULogReader::Result const& result);
+
+    /**
+     * @brief Instance of a topic logged.
+     */
+    struct Topic {
+        std::string name{}; /**< @brief Name of the topic, e.g. "battery_status" */
+        uint8_t multi_id{}; /**< @brief Instance of the topic, 0 unless logged several times */
+        uint64_t num_messages{}; /**< @brief Number of messages logged */
+    };
+
+    /**
+     * @brief Fields to extract of a topic.
+     *
+     * Fields are named as in the message definition. Elements of arrays and fields
+     * of nested messages are given like "voltage_cell_v[2]" or "esc[0].esc_rpm".
+     */
+    struct Request {
+        std::string topic{}; /**< @brief Name of the topic */
+        uint8_t multi_id{}; /**< @brief Instance of the topic */
+        std::vector<std::string> fields{}; /**< @brief Fields to extract */
+    };
+
+    /**
+     * @brief Values of a topic over time, one array per field.
+     */
+    struct Series {
+        std::vector<uint64_t> timestamps_us{}; /**< @brief Timestamp of each message */
+        std::vector<std::vector<double>> fields{}; /**< @brief Values of each field asked for,
+                                                      in the order asked for */
+    };
+
+    /**
+     * @brief Map a file into memory and index it.
+     *
+     * Reading stops at a message cut short, e.g. of a log still being written.
+     *
+     * @return Result of request.
+     */
+    Result open(const std::string& path);
+
+    /**
+     * @brief Close the file.
+     */
+    void close();
+
+    /**
+     * @brief Get the topics logged.
+     *
+     * @return Topics and instances logged, in the order they were added to the log.
+     */
+    std::vector<Topic> topics() const;
+
+    /**
+     * @brief Extract fields of a topic.
+     *
+     * @return Result of request.
+     */
+    Result extract(const Request& request, Series& series) const;
+
+    /**
+     * @brief Extract fields of several topics, each on its own thread if there are cores
+     * to spare.
+     *
+     * @return Result of request, the first error if any.
+     */
+    Result extract(const std::vector<Request>& requests, std::vector<Series>& series) const;
+
+    /**
+     * @brief Copy constructor (object is not copyable).
+     */
+    ULogReader(const ULogReader&) = delete;
+
+    /**
+     * @brief Equality operator (object is not copyable).
+     */
+    const ULogReader& operator=(const ULogReader&) = delete;
+
+private:
+    /** @private Underlying implementation, set at instantiation */
+    std::unique_ptr<ULogReaderImpl> _impl;
+};
+
+} // namespace mavsdk
@@ -0,0 +1,122 @@
+#include "log_download_coordinator.h"
+
+#include <vector>
+
+namespace mavsdk {
+
+namespace {
+
+// The rate limit of the autopilot usually keeps a vehicle well below what a link can
+// carry, a few of them at once still fit over most.
+constexpr unsigned default_downloads_per_link = 4;
+
+} // namespace
+
+LogDownloadCoordinator& LogDownloadCoordinator::instance()
+{
+    static LogDownloadCoordinator coordinator;
+    return coordinator;
+}
+
+LogDownloadCoordinator::LogDownloadCoordinator() :
+    _max_downloads_per_link(default_downloads_per_link)
+{}
+
+LogDownloadCoordinator::~LogDownloadCoordinator() {}
+
+bool LogDownloadCoordinator::set_max_downloads_per_link(unsigned count)
+{
+    if (count == 0) {
+        return false;
+    }
+
+    std::vector<StartCallback> starts;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _max_downloads_per_link = count;
+        for (auto& link : _links) {
+            while (auto start = next_to_start(link.first)) {
+                starts.push_back(start);
+            }
+        }
+    }
+    for (const auto& start : starts) {
+        start();
+    }
+    return true;
+}
+
+void LogDownloadCoordinator::acquire(const void* link, const void* owner, StartCallback start)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _links[link].waiting.emplace_back(owner, start);
+        start = next_to_start(link);
+    }
+    if (start) {
+        start();
+    }
+}
+
+void LogDownloadCoordinator::release(const void* link, const void* owner)
+{
+    StartCallback start{};
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _downloading.find(owner);
+        if (it == _downloading.end() || it->second != link) {
+            return;
+        }
+        _downloading.erase(it);
+        --_links[link].num_downloading;
+        start = next_to_start(link);
+    }
+    if (start) {
+        start();
+    }
+}
+
+void LogDownloadCoordinator::cancel(const void* owner)
+{
+    std::vector<StartCallback> starts;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& link : _links) {
+            auto& waiting = link.second.waiting;
+            for (auto it = waiting.begin(); it != waiting.end();) {
+                it = (it->first == owner) ? waiting.erase(it) : std::next(it);
+            }
+        }
+
+        auto it = _downloading.find(owner);
+        if (it != _downloading.end()) {
+            const void* link = it->second;
+            _downloading.erase(it);
+            --_links[link].num_downloading;
+            if (auto start = next_to_start(link)) {
+                starts.push_back(start);
+            }
+        }
+    }
+    for (const auto& start : starts) {
+        start();
+    }
+}
+
+LogDownloadCoordinator::StartCallback LogDownloadCoordinator::next_to_start(const void* link)
+{
+    // Assumes to have the lock for _mutex.
+
+    auto& entry = _links[link];
+    if (entry.waiting.empty() || entry.num_downloading >= _max_downloads_per_link) {
+        return nullptr;
+    }
+
+    const auto next = entry.waiting.front();
+    entry.waiting.pop_front();
+    ++entry.num_downloading;
+    _downloading[next.first] = link;
+    return next.second;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace mavsdk {
+
+// Limits how many systems download logs at once over the same link, for all LogFiles
+// plugins of the process. Several vehicles sending logs over one radio only share its
+// bandwidth and lose more of it to each other, while vehicles on their own links can
+// all go at once.
+class LogDownloadCoordinator {
+public:
+    using StartCallback = std::function<void()>;
+
+    static LogDownloadCoordinator& instance();
+
+    LogDownloadCoordinator();
+    ~LogDownloadCoordinator();
+    LogDownloadCoordinator(const LogDownloadCoordinator&) = delete;
+    const LogDownloadCoordinator& operator=(const LogDownloadCoordinator&) = delete;
+
+    bool set_max_downloads_per_link(unsigned count);
+
+    // Calls start once the owner can download over the link, right away or as soon as
+    // another download on the link is done. Never with the lock held.
+    void acquire(const void* link, const void* owner, StartCallback start);
+
+    // Hands the link on to the next one waiting, if any.
+    void release(const void* link, const void* owner);
+
+    // Forgets the owner, whether it is downloading or still waiting.
+    void cancel(const void* owner);
+
+private:
+    struct Link {
+        unsigned num_downloading{0};
+        std::deque<std::pair<const void*, StartCallback>> waiting{};
+    };
+
+    // Takes the next one waiting for the link if there is room, assumes to have the lock
+    // for _mutex.
+    StartCallback next_to_start(const void* link);
+
+    std::mutex _mutex{};
+    unsigned _max_downloads_per_link;
+    std::map<const void*, Link> _links{};
+    // The link each owner downloads over.
+    std::map<const void*, const void*> _downloading{};
+};
+
+} // namespace mavsdk
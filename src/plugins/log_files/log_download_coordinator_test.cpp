@@ -0,0 +1,69 @@
+#include "log_download_coordinator.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+// Owners and links are only told apart by their address.
+const int links[2]{};
+const int owners[3]{};
+const void* const first_link = &links[0];
+const void* const second_link = &links[1];
+
+} // namespace
+
+TEST(LogDownloadCoordinator, LimitsDownloadsPerLink)
+{
+    LogDownloadCoordinator coordinator;
+    ASSERT_TRUE(coordinator.set_max_downloads_per_link(2));
+    std::vector<int> started;
+
+    for (int i = 0; i < 3; ++i) {
+        coordinator.acquire(first_link, &owners[i], [&started, i]() { started.push_back(i); });
+    }
+    EXPECT_EQ(started, (std::vector<int>{0, 1}));
+
+    coordinator.release(first_link, &owners[1]);
+    EXPECT_EQ(started, (std::vector<int>{0, 1, 2}));
+
+    // Nothing left waiting.
+    coordinator.release(first_link, &owners[0]);
+    coordinator.release(first_link, &owners[2]);
+    EXPECT_EQ(started.size(), 3u);
+}
+
+TEST(LogDownloadCoordinator, KeepsLinksApart)
+{
+    LogDownloadCoordinator coordinator;
+    ASSERT_TRUE(coordinator.set_max_downloads_per_link(1));
+    std::vector<int> started;
+
+    coordinator.acquire(first_link, &owners[0], [&started]() { started.push_back(0); });
+    coordinator.acquire(first_link, &owners[1], [&started]() { started.push_back(1); });
+    coordinator.acquire(second_link, &owners[2], [&started]() { started.push_back(2); });
+    EXPECT_EQ(started, (std::vector<int>{0, 2}));
+
+    // Raising the limit lets the ones waiting go.
+    ASSERT_TRUE(coordinator.set_max_downloads_per_link(2));
+    EXPECT_EQ(started, (std::vector<int>{0, 2, 1}));
+
+    EXPECT_FALSE(coordinator.set_max_downloads_per_link(0));
+}
+
+TEST(LogDownloadCoordinator, HandsOnWhenCancelled)
+{
+    LogDownloadCoordinator coordinator;
+    ASSERT_TRUE(coordinator.set_max_downloads_per_link(1));
+    std::vector<int> started;
+
+    for (int i = 0; i < 3; ++i) {
+        coordinator.acquire(first_link, &owners[i], [&started, i]() { started.push_back(i); });
+    }
+
+    // One waiting goes away, the one downloading as well.
+    coordinator.cancel(&owners[1]);
+    coordinator.cancel(&owners[0]);
+    EXPECT_EQ(started, (std::vector<int>{0, 2}));
+}
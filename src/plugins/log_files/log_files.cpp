@@ -32,9 +32,23 @@ void LogFiles::download_log_file_async(
     _impl->download_log_file_async(id, path, callback);
 }
 
+void LogFiles::download_log_files_async(
+    std::vector<uint32_t> ids, std::string directory, DownloadLogFilesCallback callback)
+{
+    _impl->download_log_files_async(ids, directory, callback);
+}
+
+LogFiles::Result LogFiles::set_max_downloads_per_link(uint32_t count) const
+{
+    return _impl->set_max_downloads_per_link(count);
+}
+
 bool operator==(const LogFiles::ProgressData& lhs, const LogFiles::ProgressData& rhs)
 {
-    return ((std::isnan(rhs.progress) && std::isnan(lhs.progress)) || rhs.progress == lhs.progress);
+    return ((std::isnan(rhs.progress) && std::isnan(lhs.progress)) ||
+            rhs.progress == lhs.progress) &&
+           ((std::isnan(rhs.throughput_bytes_s) && std::isnan(lhs.throughput_bytes_s)) ||
+            rhs.throughput_bytes_s == lhs.throughput_bytes_s);
 }
 
 std::ostream& operator<<(std::ostream& str, LogFiles::ProgressData const& progress_data)
@@ -42,6 +56,7 @@ std::ostream& operator<<(std::ostream& str, LogFiles::ProgressData const& progre
     str << std::setprecision(15);
     str << "progress_data:" << '\n' << "{\n";
     str << "    progress: " << progress_data.progress << '\n';
+    str << "    throughput_bytes_s: " << progress_data.throughput_bytes_s << '\n';
     str << '}';
     return str;
 }
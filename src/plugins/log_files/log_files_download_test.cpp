@@ -0,0 +1,260 @@
+#include "plugins/log_files/log_files.h"
+#include "autopilot_simulator.h"
+#include "mavsdk.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+std::vector<uint8_t> random_content(std::size_t size)
+{
+    std::mt19937 random(42);
+    std::vector<uint8_t> content(size);
+    for (auto& byte : content) {
+        byte = uint8_t(random());
+    }
+    return content;
+}
+
+// Named after the date of the log, which the simulator makes a day apart each.
+const std::string first_log_path = "./log_0_2020-01-01T00-00-00Z.ulg";
+const std::string second_log_path = "./log_1_2020-01-02T00-00-00Z.ulg";
+
+std::vector<uint8_t> read_file(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(
+        (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+class LogFilesDownload : public ::testing::Test {
+protected:
+    void start(const AutopilotSimulator::Config& config, const std::string& name)
+    {
+        _simulator.reset(new AutopilotSimulator(config));
+        _simulator->add_log(random_content(1000));
+        _simulator->add_log(_content);
+        ASSERT_TRUE(_simulator->start_loopback(name));
+        ASSERT_EQ(_mavsdk.add_any_connection("loopback://" + name), ConnectionResult::Success);
+
+        for (unsigned i = 0; i < 5000 && !_mavsdk.is_connected(); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ASSERT_TRUE(_mavsdk.is_connected());
+        _log_files.reset(new LogFiles(_mavsdk.system()));
+
+        list_entries();
+    }
+
+    void list_entries()
+    {
+        const auto entries = _log_files->get_entries();
+        ASSERT_EQ(entries.first, LogFiles::Result::Success);
+        ASSERT_EQ(entries.second.size(), 2u);
+        EXPECT_EQ(entries.second[1].size_bytes, _content.size());
+    }
+
+    LogFiles::Result download_all()
+    {
+        std::promise<LogFiles::Result> prom;
+        auto fut = prom.get_future();
+
+        _log_files->download_log_files_async(
+            {0, 1}, ".", [&prom](LogFiles::Result result, LogFiles::ProgressData) {
+                if (result != LogFiles::Result::Next) {
+                    prom.set_value(result);
+                }
+            });
+
+        if (fut.wait_for(std::chrono::seconds(30)) != std::future_status::ready) {
+            return LogFiles::Result::Timeout;
+        }
+        return fut.get();
+    }
+
+    // Returns the last result and progress.
+    std::pair<LogFiles::Result, LogFiles::ProgressData> download(uint32_t id)
+    {
+        std::promise<std::pair<LogFiles::Result, LogFiles::ProgressData>> prom;
+        auto fut = prom.get_future();
+
+        _log_files->download_log_file_async(
+            id, "log.ulg", [&prom](LogFiles::Result result, LogFiles::ProgressData progress) {
+                if (result != LogFiles::Result::Next) {
+                    prom.set_value(std::make_pair(result, progress));
+                }
+            });
+
+        if (fut.wait_for(std::chrono::seconds(30)) != std::future_status::ready) {
+            return std::make_pair(LogFiles::Result::Timeout, LogFiles::ProgressData{});
+        }
+        return fut.get();
+    }
+
+    void TearDown() override
+    {
+        _log_files.reset();
+        if (_simulator) {
+            _simulator->stop();
+        }
+        for (const auto& path : {std::string("log.ulg"), first_log_path, second_log_path}) {
+            std::remove(path.c_str());
+            std::remove((path + ".resume").c_str());
+        }
+    }
+
+    const std::vector<uint8_t> _content{random_content(500000)};
+    Mavsdk _mavsdk{};
+    std::unique_ptr<AutopilotSimulator> _simulator{};
+    std::unique_ptr<LogFiles> _log_files{};
+};
+
+} // namespace
+
+TEST_F(LogFilesDownload, DownloadsLog)
+{
+    start(AutopilotSimulator::Config{}, "log_files_download_test");
+
+    const auto result = download(1);
+    EXPECT_EQ(result.first, LogFiles::Result::Success);
+    EXPECT_EQ(result.second.progress, 1.0f);
+    EXPECT_GT(result.second.throughput_bytes_s, 0.0f);
+    EXPECT_EQ(read_file("log.ulg"), _content);
+}
+
+TEST_F(LogFilesDownload, FillsInLostChunks)
+{
+    AutopilotSimulator::Config config;
+    config.loss_ratio = 0.05;
+    config.latency = std::chrono::milliseconds(10);
+    config.log_data_rate_bytes_s = 2000000.0;
+    start(config, "log_files_download_test_lossy");
+
+    const auto result = download(1);
+    EXPECT_EQ(result.first, LogFiles::Result::Success);
+    EXPECT_EQ(read_file("log.ulg"), _content);
+}
+
+TEST_F(LogFilesDownload, RejectsUnknownLog)
+{
+    start(AutopilotSimulator::Config{}, "log_files_download_test_unknown");
+
+    EXPECT_EQ(download(2).first, LogFiles::Result::InvalidArgument);
+}
+
+TEST_F(LogFilesDownload, DownloadsSeveralLogsAndSkipsThoseThere)
+{
+    start(AutopilotSimulator::Config{}, "log_files_download_test_several");
+
+    EXPECT_EQ(download_all(), LogFiles::Result::Success);
+    EXPECT_EQ(read_file(first_log_path), random_content(1000));
+    EXPECT_EQ(read_file(second_log_path), _content);
+
+    // A file of the right size is taken to be the log.
+    std::vector<uint8_t> other_content(1000, 0x55);
+    std::ofstream(first_log_path, std::ios::binary)
+        .write(reinterpret_cast<const char*>(other_content.data()), other_content.size());
+    std::remove(second_log_path.c_str());
+
+    EXPECT_EQ(download_all(), LogFiles::Result::Success);
+    EXPECT_EQ(read_file(first_log_path), other_content);
+    EXPECT_EQ(read_file(second_log_path), _content);
+}
+
+TEST_F(LogFilesDownload, RejectsDownloadDuringOthers)
+{
+    AutopilotSimulator::Config config;
+    config.log_data_rate_bytes_s = 500000.0;
+    start(config, "log_files_download_test_busy");
+
+    struct Progress {
+        std::mutex mutex{};
+        std::promise<void> half_way{};
+        bool is_half_way{false};
+        std::promise<LogFiles::Result> done{};
+    };
+    auto progress = std::make_shared<Progress>();
+    _log_files->download_log_files_async(
+        {0, 1}, ".", [progress](LogFiles::Result result, LogFiles::ProgressData data) {
+            std::lock_guard<std::mutex> lock(progress->mutex);
+            if (result != LogFiles::Result::Next) {
+                progress->done.set_value(result);
+            } else if (data.progress >= 0.5f && !progress->is_half_way) {
+                progress->is_half_way = true;
+                progress->half_way.set_value();
+            }
+        });
+    ASSERT_EQ(
+        progress->half_way.get_future().wait_for(std::chrono::seconds(10)),
+        std::future_status::ready);
+
+    // Doesn't get in the way of the log being downloaded.
+    EXPECT_EQ(download(1).first, LogFiles::Result::InvalidArgument);
+
+    auto done = progress->done.get_future();
+    ASSERT_EQ(done.wait_for(std::chrono::seconds(30)), std::future_status::ready);
+    EXPECT_EQ(done.get(), LogFiles::Result::Success);
+    EXPECT_EQ(read_file(first_log_path), random_content(1000));
+    EXPECT_EQ(read_file(second_log_path), _content);
+}
+
+TEST_F(LogFilesDownload, ResumesDownloadCutShort)
+{
+    AutopilotSimulator::Config config;
+    config.log_data_rate_bytes_s = 500000.0;
+    start(config, "log_files_download_test_resume");
+
+    // Cut short by the plugin going away half way through.
+    struct Progress {
+        std::mutex mutex{};
+        std::promise<void> half_way{};
+        bool is_half_way{false};
+    };
+    auto progress = std::make_shared<Progress>();
+    _log_files->download_log_file_async(
+        1, "log.ulg", [progress](LogFiles::Result result, LogFiles::ProgressData data) {
+            std::lock_guard<std::mutex> lock(progress->mutex);
+            if (result == LogFiles::Result::Next && data.progress >= 0.5f &&
+                !progress->is_half_way) {
+                progress->is_half_way = true;
+                progress->half_way.set_value();
+            }
+        });
+    ASSERT_EQ(
+        progress->half_way.get_future().wait_for(std::chrono::seconds(10)),
+        std::future_status::ready);
+    _log_files.reset();
+    _log_files.reset(new LogFiles(_mavsdk.system()));
+    list_entries();
+
+    float first_progress = float(NAN);
+    std::promise<LogFiles::Result> prom;
+    auto fut = prom.get_future();
+    _log_files->download_log_file_async(
+        1,
+        "log.ulg",
+        [&prom, &first_progress](LogFiles::Result result, LogFiles::ProgressData data) {
+            if (result == LogFiles::Result::Next && std::isnan(first_progress)) {
+                first_progress = data.progress;
+            } else if (result != LogFiles::Result::Next) {
+                prom.set_value(result);
+            }
+        });
+    ASSERT_EQ(fut.wait_for(std::chrono::seconds(30)), std::future_status::ready);
+    EXPECT_EQ(fut.get(), LogFiles::Result::Success);
+    EXPECT_GE(first_progress, 0.5f);
+    EXPECT_EQ(read_file("log.ulg"), _content);
+}
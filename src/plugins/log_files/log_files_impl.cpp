@@ -1,13 +1,83 @@
 #include "global_include.h"
 #include "log_files_impl.h"
+#include "log_download_coordinator.h"
 #include "mavsdk_impl.h"
 #include <algorithm>
 #include <cmath>
+#include <cstdio>
 #include <ctime>
 #include <cstring>
+#include <fstream>
+#include <sys/stat.h>
+
+#if defined(WINDOWS)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include <fcntl.h>
 
 namespace mavsdk {
 
+namespace {
+
+#if defined(WINDOWS)
+// Otherwise line endings get translated.
+constexpr int binary_open_flag = O_BINARY;
+#else
+constexpr int binary_open_flag = 0;
+#endif
+
+constexpr uint32_t chunk_size = MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
+// Asking for a whole log at once is too much for PX4 SITL to keep up with, we start with
+// the parts of 512 chunks we used to ask for one after the other.
+constexpr uint32_t initial_window_chunks = 512;
+constexpr uint32_t min_window_chunks = 32;
+constexpr uint32_t max_window_chunks = 16384;
+// Ratio of chunks lost in a window above which the next one is smaller.
+constexpr double max_window_loss = 0.02;
+// Round trips of data a window is at least big enough for.
+constexpr double window_per_round_trip = 10.0;
+// How early the next range is asked for, lowered when the end of the current one gets cut.
+constexpr double initial_lead = 0.9;
+constexpr double min_lead = 0.3;
+constexpr double max_lead = 1.0;
+// Chunks of a range to tell the rate the autopilot sends at.
+constexpr uint32_t min_chunks_for_rate = 16;
+// Requests without any data in return before we give up.
+constexpr unsigned max_data_retries = 10;
+// Minimum time between progress callbacks.
+constexpr double progress_interval_s = 0.1;
+// Time between saving which chunks we have, for a download cut short to go on from there.
+constexpr double checkpoint_interval_s = 1.0;
+const std::string checkpoint_suffix = ".resume";
+
+#if defined(WINDOWS)
+const std::string path_separator = "\\";
+#else
+const std::string path_separator = "/";
+#endif
+
+bool get_file_size(const std::string& path, uint32_t& size)
+{
+    struct stat file_stat;
+    if (stat(path.c_str(), &file_stat) != 0) {
+        return false;
+    }
+    size = uint32_t(file_stat.st_size);
+    return true;
+}
+
+std::string log_file_path(const std::string& directory, const LogFiles::Entry& entry)
+{
+    // Colons are not allowed in file names everywhere.
+    std::string date = entry.date;
+    std::replace(date.begin(), date.end(), ':', '-');
+    return directory + path_separator + "log_" + std::to_string(entry.id) + "_" + date + ".ulg";
+}
+
+} // namespace
+
 LogFilesImpl::LogFilesImpl(System& system) : PluginImplBase(system)
 {
     _parent->register_plugin(this);
@@ -41,9 +111,20 @@ void LogFilesImpl::deinit()
         _parent->unregister_timeout_handler(_entries.cookie);
     }
 
+    LogDownloadCoordinator::instance().cancel(this);
+    {
+        std::lock_guard<std::mutex> lock(_batch.mutex);
+        _batch.entries.clear();
+        _batch.callback = nullptr;
+    }
+
     {
         std::lock_guard<std::mutex> lock(_data.mutex);
         _parent->unregister_timeout_handler(_data.cookie);
+        if (_data.fd >= 0) {
+            save_checkpoint();
+        }
+        finish_logfile();
     }
     _parent->unregister_all_mavlink_message_handlers(this);
 }
@@ -199,7 +280,7 @@ void LogFilesImpl::list_timeout()
 void LogFilesImpl::download_log_file_async(
     unsigned id, const std::string& file_path, LogFiles::DownloadLogFileCallback callback)
 {
-    unsigned bytes_to_get;
+    LogFiles::Entry entry;
     {
         std::lock_guard<std::mutex> lock(_entries.mutex);
 
@@ -217,13 +298,31 @@ void LogFilesImpl::download_log_file_async(
             return;
         }
 
-        bytes_to_get = _entries.entry_map[id].size_bytes;
+        entry = it->second;
     }
 
     {
         std::lock_guard<std::mutex> lock(_data.mutex);
 
-        if (!start_logfile(file_path)) {
+        // One log at a time, also while downloading those of download_log_files_async.
+        if (_data.fd >= 0) {
+            LogErr() << "Already downloading log " << _data.id;
+            if (callback) {
+                const auto tmp_callback = callback;
+                _parent->call_user_callback([tmp_callback]() {
+                    LogFiles::ProgressData progress;
+                    progress.progress = 0.0f;
+                    tmp_callback(LogFiles::Result::InvalidArgument, progress);
+                });
+            }
+            return;
+        }
+
+        _data.bytes_to_get = entry.size_bytes;
+        _data.chunks_received.assign((entry.size_bytes + chunk_size - 1) / chunk_size, false);
+        const bool resume = load_checkpoint(file_path, entry);
+
+        if (!start_logfile(file_path, resume)) {
             if (callback) {
                 const auto tmp_callback = callback;
                 _parent->call_user_callback([tmp_callback]() {
@@ -232,41 +331,211 @@ void LogFilesImpl::download_log_file_async(
                     tmp_callback(LogFiles::Result::FileOpenFailed, progress);
                 });
             }
+            reset_data();
             return;
         }
 
         _data.id = id;
+        _data.date = entry.date;
+        _data.path = file_path;
         _data.callback = callback;
         _data.time_started = _time.steady_time();
-        _data.bytes_to_get = bytes_to_get;
-        _data.part_start = 0;
-        const auto part_size = determine_part_end() - _data.part_start;
-        _data.bytes.resize(part_size);
-        _data.chunks_received.resize(part_size / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-
-        _parent->register_timeout_handler(
-            std::bind(&LogFilesImpl::data_timeout, this), DATA_TIMEOUT_S, &_data.cookie);
-
-        request_log_data(_data.id, _data.part_start, _data.bytes.size());
+        _data.time_last_progress = _data.time_started;
+        _data.bytes_received = 0;
+        for (std::size_t chunk = 0; chunk < _data.chunks_received.size(); ++chunk) {
+            if (_data.chunks_received[chunk]) {
+                _data.bytes_received +=
+                    std::min(chunk_size, entry.size_bytes - uint32_t(chunk) * chunk_size);
+            }
+        }
+        _data.bytes_resumed = _data.bytes_received;
+        if (resume) {
+            LogInfo() << "Resuming download of log " << id << " at " << _data.bytes_received
+                      << " of " << entry.size_bytes << " bytes";
+        }
+        // Written right away, so a download cut short is never taken for a complete one.
+        save_checkpoint();
+        _data.ranges.clear();
+        _data.next_window_start = 0;
+        _data.window_chunks = initial_window_chunks;
+        _data.round_trip_s = 0.0;
+        _data.rate_bytes_s = 0.0;
+        _data.lead = initial_lead;
+        _data.retries = 0;
 
         if (_data.callback) {
             const auto tmp_callback = _data.callback;
-            _parent->call_user_callback([tmp_callback]() {
+            const float progress_so_far = (entry.size_bytes > 0) ?
+                                              float(_data.bytes_received) /
+                                                  float(entry.size_bytes) :
+                                              0.0f;
+            _parent->call_user_callback([tmp_callback, progress_so_far]() {
                 LogFiles::ProgressData progress;
-                progress.progress = 0.0f;
+                progress.progress = progress_so_far;
                 tmp_callback(LogFiles::Result::Next, progress);
             });
         }
+
+        request_next_range();
     }
 }
 
-std::size_t LogFilesImpl::determine_part_end()
+void LogFilesImpl::download_log_files_async(
+    const std::vector<uint32_t>& ids,
+    const std::string& directory,
+    LogFiles::DownloadLogFilesCallback callback)
 {
-    // Assumes to have the lock for _data.mutex.
+    auto report = [this, callback](LogFiles::Result result, float progress_so_far) {
+        if (callback) {
+            _parent->call_user_callback([callback, result, progress_so_far]() {
+                LogFiles::ProgressData progress;
+                progress.progress = progress_so_far;
+                callback(result, progress);
+            });
+        }
+    };
+
+    std::vector<LogFiles::Entry> entries;
+    const void* link = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_entries.mutex);
+        for (const auto id : ids) {
+            auto it = _entries.entry_map.find(id);
+            if (it == _entries.entry_map.end()) {
+                LogErr() << "Log entry id " << id << " not found";
+                report(LogFiles::Result::InvalidArgument, 0.0f);
+                return;
+            }
+            entries.push_back(it->second);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_batch.mutex);
+        if (_batch.callback) {
+            LogErr() << "Already downloading log files";
+            report(LogFiles::Result::InvalidArgument, 0.0f);
+            return;
+        }
 
-    return std::min(
-        _data.part_start + PART_SIZE * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN,
-        std::size_t(_data.bytes_to_get));
+        _batch.entries.clear();
+        _batch.directory = directory;
+        _batch.bytes_total = 0;
+        _batch.bytes_done = 0;
+        _batch.result = LogFiles::Result::Success;
+
+        for (const auto& entry : entries) {
+            // Without a checkpoint, a file of the right size was downloaded completely.
+            const std::string path = log_file_path(directory, entry);
+            uint32_t size = 0;
+            uint32_t checkpoint_size = 0;
+            if (get_file_size(path, size) && size == entry.size_bytes &&
+                !get_file_size(path + checkpoint_suffix, checkpoint_size)) {
+                LogDebug() << "Log " << entry.id << " is already there";
+                continue;
+            }
+            _batch.entries.push_back(entry);
+            _batch.bytes_total += entry.size_bytes;
+        }
+
+        if (_batch.entries.empty()) {
+            report(LogFiles::Result::Success, 1.0f);
+            return;
+        }
+
+        _batch.callback = callback;
+        _batch.link = _parent->get_link();
+        link = _batch.link;
+    }
+
+    report(LogFiles::Result::Next, 0.0f);
+    LogDownloadCoordinator::instance().acquire(link, this, [this]() { download_next_log(); });
+}
+
+LogFiles::Result LogFilesImpl::set_max_downloads_per_link(uint32_t count)
+{
+    return LogDownloadCoordinator::instance().set_max_downloads_per_link(count) ?
+               LogFiles::Result::Success :
+               LogFiles::Result::InvalidArgument;
+}
+
+void LogFilesImpl::download_next_log()
+{
+    LogFiles::Entry entry;
+    std::string path;
+    const void* link_done = nullptr;
+    bool is_done = false;
+    {
+        std::lock_guard<std::mutex> lock(_batch.mutex);
+        if (!_batch.callback) {
+            return;
+        }
+
+        if (_batch.entries.empty()) {
+            const auto callback = _batch.callback;
+            const auto result = _batch.result;
+            _parent->call_user_callback([callback, result]() {
+                LogFiles::ProgressData progress;
+                progress.progress = 1.0f;
+                callback(result, progress);
+            });
+            _batch.callback = nullptr;
+            link_done = _batch.link;
+            is_done = true;
+        } else {
+            entry = _batch.entries.front();
+            _batch.entries.pop_front();
+            path = log_file_path(_batch.directory, entry);
+        }
+    }
+
+    if (is_done) {
+        // Whoever is next on the link might start right away, so not with the lock.
+        LogDownloadCoordinator::instance().release(link_done, this);
+        return;
+    }
+
+    download_log_file_async(
+        entry.id,
+        path,
+        [this, entry](LogFiles::Result result, LogFiles::ProgressData progress) {
+            process_batch_progress(entry, result, progress);
+        });
+}
+
+void LogFilesImpl::process_batch_progress(
+    const LogFiles::Entry& entry, LogFiles::Result result, LogFiles::ProgressData progress)
+{
+    LogFiles::DownloadLogFilesCallback callback{nullptr};
+    {
+        std::lock_guard<std::mutex> lock(_batch.mutex);
+        if (!_batch.callback) {
+            return;
+        }
+
+        if (result == LogFiles::Result::Next) {
+            callback = _batch.callback;
+            const double bytes =
+                double(_batch.bytes_done) + double(progress.progress) * entry.size_bytes;
+            progress.progress = float(bytes / double(_batch.bytes_total));
+        } else {
+            // We go on with the other logs, and report the first error in the end.
+            if (result != LogFiles::Result::Success) {
+                LogErr() << "Download of log " << entry.id << " failed: " << result;
+                if (_batch.result == LogFiles::Result::Success) {
+                    _batch.result = result;
+                }
+            }
+            _batch.bytes_done += entry.size_bytes;
+        }
+    }
+
+    if (callback) {
+        // Already on the thread for user callbacks.
+        callback(LogFiles::Result::Next, progress);
+    } else {
+        download_next_log();
+    }
 }
 
 void LogFilesImpl::process_log_data(const mavlink_message_t& message)
@@ -285,103 +554,328 @@ void LogFilesImpl::process_log_data(const mavlink_message_t& message)
 
     std::lock_guard<std::mutex> lock(_data.mutex);
 
-    _parent->refresh_timeout_handler(_data.cookie);
-
-    if (log_data.count > MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN) {
-        LogErr() << "Ignoring wrong count";
+    if (_data.fd < 0 || log_data.id != _data.id) {
+        // Not for the download going on, if there is one.
         return;
     }
 
-    if (log_data.ofs < _data.part_start ||
-        log_data.ofs + log_data.count > _data.part_start + _data.bytes.size()) {
+    if (log_data.ofs % chunk_size != 0 || log_data.ofs >= _data.bytes_to_get) {
         LogErr() << "Ignoring wrong offset";
         return;
     }
 
-    std::memcpy(&_data.bytes[log_data.ofs - _data.part_start], log_data.data, log_data.count);
-    _data.chunks_received[(log_data.ofs - _data.part_start) / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN] =
-        true;
+    if (log_data.count != std::min(chunk_size, _data.bytes_to_get - log_data.ofs)) {
+        LogErr() << "Ignoring wrong count";
+        return;
+    }
+
+    auto in_range = [&log_data](const Range& range) {
+        return log_data.ofs >= range.start && log_data.ofs < range.end;
+    };
+
+    // Data of the range asked for ahead means the autopilot is done with the current one.
+    if (_data.ranges.size() > 1 && in_range(_data.ranges[1])) {
+        finish_range(true);
+    }
+
+    const bool is_current = !_data.ranges.empty() && in_range(_data.ranges.front());
+    if (is_current) {
+        auto& range = _data.ranges.front();
+        const auto now = _time.steady_time();
+        _parent->refresh_timeout_handler(_data.cookie);
+
+        if (range.chunks_received == 0) {
+            _data.retries = 0;
+            range.time_first_data = now;
+            // A new request replaces the old one right away, even if asked for ahead.
+            const double round_trip_s = _time.elapsed_since_s(range.time_requested);
+            _data.round_trip_s = (_data.round_trip_s > 0.0) ?
+                                     0.875 * _data.round_trip_s + 0.125 * round_trip_s :
+                                     round_trip_s;
+        }
+        ++range.chunks_received;
+        range.received_end = std::max(range.received_end, log_data.ofs + log_data.count);
+        range.time_last_data = now;
+    }
+
+    const std::size_t chunk = log_data.ofs / chunk_size;
+    if (!_data.chunks_received[chunk]) {
+        if (!write_to_logfile(log_data.ofs, log_data.data, log_data.count)) {
+            LogErr() << "Could not write to log file";
+            report_result(LogFiles::Result::FileOpenFailed);
+            return;
+        }
+        _data.chunks_received[chunk] = true;
+        _data.bytes_received += log_data.count;
 
-    if (log_data.ofs + log_data.count - _data.part_start == _data.bytes.size() ||
-        _data.rerequesting) {
-        // We received last message of this part.
-        _data.rerequesting = true;
-        check_part();
+        if (_time.elapsed_since_s(_data.time_last_checkpoint) >= checkpoint_interval_s) {
+            save_checkpoint();
+        }
     }
+
+    if (is_current) {
+        if (_data.ranges.front().received_end >= _data.ranges.front().end) {
+            finish_range(false);
+            if (_data.ranges.empty()) {
+                request_next_range();
+                return;
+            }
+        } else {
+            maybe_request_range_ahead();
+        }
+    }
+
+    report_progress(false);
 }
 
-void LogFilesImpl::report_progress(unsigned transferred, unsigned total)
+void LogFilesImpl::report_progress(bool force)
 {
-    float progress = float(transferred) / float(total);
+    // Assumes to have the lock for _data.mutex.
+
+    if (!force && _time.elapsed_since_s(_data.time_last_progress) < progress_interval_s) {
+        return;
+    }
+    _data.time_last_progress = _time.steady_time();
+
+    const float progress = float(_data.bytes_received) / float(_data.bytes_to_get);
+    const float throughput = throughput_bytes_s();
 
     if (_data.callback) {
         const auto tmp_callback = _data.callback;
-        _parent->call_user_callback([tmp_callback, progress]() {
+        _parent->call_user_callback([tmp_callback, progress, throughput]() {
             LogFiles::ProgressData progress_data;
             progress_data.progress = progress;
+            progress_data.throughput_bytes_s = throughput;
 
             tmp_callback(LogFiles::Result::Next, progress_data);
         });
     }
 }
 
-void LogFilesImpl::check_part()
+void LogFilesImpl::report_result(LogFiles::Result result)
 {
     // Assumes to have the lock for _data.mutex.
 
-    auto first_missing =
-        std::find(_data.chunks_received.begin(), _data.chunks_received.end(), false);
-    if (first_missing != _data.chunks_received.end()) {
-        auto first_missing_index = std::distance(_data.chunks_received.begin(), first_missing);
+    _parent->unregister_timeout_handler(_data.cookie);
+    finish_logfile();
+    if (result == LogFiles::Result::Success) {
+        std::remove((_data.path + checkpoint_suffix).c_str());
+    } else if (_data.path.size() > 0) {
+        save_checkpoint();
+    }
 
-        auto first_not_missing = std::find(first_missing, _data.chunks_received.end(), true);
+    const float progress = (_data.bytes_to_get > 0) ?
+                               float(_data.bytes_received) / float(_data.bytes_to_get) :
+                               1.0f;
+    const float throughput = throughput_bytes_s();
 
-        auto first_not_missing_index =
-            std::distance(_data.chunks_received.begin(), first_not_missing);
+    LogDebug() << _data.bytes_received << " B of " << _data.bytes_to_get << " B ("
+               << throughput / 1024.0f << " kiB/s)";
 
-        request_log_data(
-            _data.id,
-            _data.part_start + first_missing_index * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN,
-            (first_not_missing_index - first_missing_index) * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-    } else {
-        _data.rerequesting = false;
+    if (_data.callback) {
+        const auto tmp_callback = _data.callback;
+        _parent->call_user_callback([tmp_callback, result, progress, throughput]() {
+            LogFiles::ProgressData progress_data;
+            progress_data.progress = progress;
+            progress_data.throughput_bytes_s = throughput;
+            tmp_callback(result, progress_data);
+        });
+    }
 
-        write_part_to_disk();
+    reset_data();
+}
 
-        report_progress(_data.part_start + _data.bytes.size(), _data.bytes_to_get);
+float LogFilesImpl::throughput_bytes_s()
+{
+    // Assumes to have the lock for _data.mutex.
 
-        const float kib_s = float(_data.part_start + _data.bytes.size()) /
-                            float(_time.elapsed_since_s(_data.time_started)) / 1024.0f;
+    const double elapsed_s = _time.elapsed_since_s(_data.time_started);
+    const double bytes = double(_data.bytes_received) - double(_data.bytes_resumed);
+    return (elapsed_s > 0.0) ? float(bytes / elapsed_s) : 0.0f;
+}
 
-        LogDebug() << _data.part_start + _data.bytes.size() << " B of " << _data.bytes_to_get
-                   << " B (" << kib_s << " kiB/s)";
+bool LogFilesImpl::plan_range(uint32_t from, Range& range)
+{
+    // Assumes to have the lock for _data.mutex.
 
-        if (_data.part_start + _data.bytes.size() == _data.bytes_to_get) {
-            _parent->unregister_timeout_handler(_data.cookie);
+    range = Range{};
+
+    const auto begin = _data.chunks_received.begin();
+    const auto end = _data.chunks_received.end();
+
+    if (_data.next_window_start < _data.bytes_to_get) {
+        // What we got before a download was cut short is left out.
+        const auto window_start =
+            std::find(begin + _data.next_window_start / chunk_size, end, false);
+        range.start = uint32_t(std::distance(begin, window_start)) * chunk_size;
+        if (range.start < _data.bytes_to_get) {
+            range.end = uint32_t(std::min(
+                uint64_t(range.start) + uint64_t(_data.window_chunks) * chunk_size,
+                uint64_t(_data.bytes_to_get)));
+            range.is_window = true;
+            return true;
+        }
+    }
 
-            finish_logfile();
+    const auto first_missing = std::find(begin + (from + chunk_size - 1) / chunk_size, end, false);
+    if (first_missing == end) {
+        return false;
+    }
 
-            if (_data.callback) {
-                const auto tmp_callback = _data.callback;
-                _parent->call_user_callback([tmp_callback]() {
-                    LogFiles::ProgressData progress_data;
-                    progress_data.progress = 1.0f;
-                    tmp_callback(LogFiles::Result::Success, progress_data);
-                });
-            }
+    // Chunks in between gaps are sent again if that takes less time than a round trip
+    // for another request.
+    const auto max_chunks_between =
+        std::ptrdiff_t(estimate_rate_bytes_s() * _data.round_trip_s / chunk_size);
+
+    auto missing = first_missing;
+    auto missing_end = std::find(missing, end, true);
+    while (missing_end != end) {
+        missing = std::find(missing_end, end, false);
+        if (missing == end || std::distance(missing_end, missing) > max_chunks_between) {
+            break;
+        }
+        missing_end = std::find(missing, end, true);
+    }
 
-            reset_data();
+    range.start = uint32_t(std::distance(begin, first_missing)) * chunk_size;
+    range.end =
+        std::min(uint32_t(std::distance(begin, missing_end)) * chunk_size, _data.bytes_to_get);
+    return true;
+}
+
+void LogFilesImpl::request_range(Range& range)
+{
+    // Assumes to have the lock for _data.mutex.
+
+    if (range.is_window) {
+        _data.next_window_start = range.end;
+    }
+    range.time_requested = _time.steady_time();
+    _data.ranges.push_back(range);
+    request_log_data(_data.id, range.start, range.end - range.start);
+
+    if (_data.ranges.size() == 1) {
+        register_data_timeout();
+    }
+}
+
+void LogFilesImpl::request_next_range()
+{
+    // Assumes to have the lock for _data.mutex.
+
+    // With nothing asked for anymore, we can go back for everything missing.
+    Range range;
+    if (!plan_range(0, range)) {
+        report_result(LogFiles::Result::Success);
+        return;
+    }
+    request_range(range);
+}
+
+void LogFilesImpl::maybe_request_range_ahead()
+{
+    // Assumes to have the lock for _data.mutex.
+
+    if (_data.ranges.size() != 1) {
+        return;
+    }
+
+    // The autopilot is about half a round trip ahead of the data we get, and the request
+    // takes another half to get there.
+    const auto& current = _data.ranges.front();
+    const double rate_bytes_s = estimate_rate_bytes_s();
+    if (rate_bytes_s <= 0.0 ||
+        current.end - current.received_end > rate_bytes_s * _data.round_trip_s * _data.lead) {
+        return;
+    }
+
+    Range range;
+    if (plan_range(current.end, range)) {
+        request_range(range);
+    }
+}
+
+void LogFilesImpl::finish_range(bool next_started)
+{
+    // Assumes to have the lock for _data.mutex.
+
+    const Range range = _data.ranges.front();
+    _data.ranges.pop_front();
+
+    // The end of the range didn't make it if the next one was asked for too early, more
+    // than one chunk is rarely lost otherwise.
+    uint32_t chunks_cut = 0;
+    if (next_started) {
+        chunks_cut = (range.end - std::max(range.received_end, range.start) + chunk_size - 1) /
+                     chunk_size;
+        if (chunks_cut > 1) {
+            _data.lead = std::max(_data.lead * 0.8, min_lead);
         } else {
-            _data.part_start = _data.part_start + _data.bytes.size();
+            _data.lead = std::min(_data.lead + 0.02, max_lead);
+            chunks_cut = 0;
+        }
+    }
 
-            const auto part_size = determine_part_end() - _data.part_start;
-            _data.bytes.resize(part_size);
-            _data.chunks_received.resize(part_size / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-            std::fill(_data.chunks_received.begin(), _data.chunks_received.end(), false);
+    if (range.chunks_received >= min_chunks_for_rate) {
+        const double elapsed_s =
+            std::chrono::duration<double>(range.time_last_data - range.time_first_data).count();
+        if (elapsed_s > 0.0) {
+            const double rate_bytes_s =
+                (double(range.received_end) - double(range.start) - chunk_size) / elapsed_s;
+            _data.rate_bytes_s = (_data.rate_bytes_s > 0.0) ?
+                                     0.75 * _data.rate_bytes_s + 0.25 * rate_bytes_s :
+                                     rate_bytes_s;
+        }
+    }
+
+    if (range.is_window) {
+        const uint32_t chunks = (range.end - range.start + chunk_size - 1) / chunk_size;
+        const uint32_t chunks_lost = chunks - std::min(chunks, range.chunks_received + chunks_cut);
+        adapt_window(double(chunks_lost) / double(chunks));
+    }
 
-            request_log_data(_data.id, _data.part_start, _data.bytes.size());
+    report_progress(false);
+}
+
+void LogFilesImpl::adapt_window(double loss)
+{
+    // Assumes to have the lock for _data.mutex.
+
+    // Lost chunks are asked for again in the end, each gap in its own request, so we
+    // back off if the autopilot or link can't keep up.
+    if (loss > max_window_loss) {
+        _data.window_chunks = std::max(_data.window_chunks / 2, min_window_chunks);
+    } else {
+        _data.window_chunks = std::min(_data.window_chunks * 2, max_window_chunks);
+    }
+
+    // Either way, a window should take a few round trips to get, so that asking for the
+    // next one too early or too late doesn't cost much.
+    const double window_bytes =
+        estimate_rate_bytes_s() * _data.round_trip_s * window_per_round_trip;
+    const auto min_chunks =
+        uint32_t(std::min(window_bytes / chunk_size, double(max_window_chunks)));
+    _data.window_chunks = std::max(_data.window_chunks, min_chunks);
+}
+
+double LogFilesImpl::estimate_rate_bytes_s() const
+{
+    // Assumes to have the lock for _data.mutex.
+
+    // The current range tells best while we are at it.
+    if (!_data.ranges.empty()) {
+        const auto& range = _data.ranges.front();
+        if (range.chunks_received >= min_chunks_for_rate) {
+            const double elapsed_s =
+                std::chrono::duration<double>(range.time_last_data - range.time_first_data)
+                    .count();
+            if (elapsed_s > 0.0) {
+                return (double(range.received_end) - double(range.start) - chunk_size) /
+                       elapsed_s;
+            }
         }
     }
+    return _data.rate_bytes_s;
 }
 
 void LogFilesImpl::request_log_data(unsigned id, unsigned start, unsigned count)
@@ -400,51 +894,177 @@ void LogFilesImpl::request_log_data(unsigned id, unsigned start, unsigned count)
     _parent->send_message(msg);
 }
 
+void LogFilesImpl::register_data_timeout()
+{
+    // Assumes to have the lock for _data.mutex.
+
+    // The first data of a request takes a round trip.
+    _parent->unregister_timeout_handler(_data.cookie);
+    _parent->register_timeout_handler(
+        std::bind(&LogFilesImpl::data_timeout, this),
+        DATA_TIMEOUT_S + 2.0 * _data.round_trip_s,
+        &_data.cookie);
+}
+
 void LogFilesImpl::data_timeout()
 {
-    {
-        std::lock_guard<std::mutex> lock(_data.mutex);
-        _parent->register_timeout_handler(
-            std::bind(&LogFilesImpl::data_timeout, this), DATA_TIMEOUT_S, &_data.cookie);
-        _data.rerequesting = true;
-        check_part();
+    std::lock_guard<std::mutex> lock(_data.mutex);
+
+    if (_data.fd < 0 || _data.ranges.empty()) {
+        return;
+    }
+
+    if (_data.ranges.front().chunks_received > 0) {
+        // The end of the range got lost, what else is missing is asked for later, including
+        // what we asked for ahead.
+        finish_range(false);
+        _data.ranges.clear();
+        request_next_range();
+        return;
+    }
+
+    if (++_data.retries > max_data_retries) {
+        LogWarn() << "Too many log data retries, giving up.";
+        report_result(LogFiles::Result::Timeout);
+        return;
     }
+
+    // The request or everything we got got lost.
+    Range range = _data.ranges.front();
+    _data.ranges.clear();
+    request_range(range);
 }
 
-bool LogFilesImpl::start_logfile(const std::string& path)
+bool LogFilesImpl::start_logfile(const std::string& path, bool resume)
 {
     // Assumes to have the lock for _data.mutex.
 
-    _data.file.open(path, std::ios::out | std::ios::binary);
+    const int flags = resume ? O_WRONLY : (O_WRONLY | O_CREAT | O_TRUNC);
+    _data.fd = ::open(path.c_str(), flags | binary_open_flag, 0666);
+    if (_data.fd < 0) {
+        return false;
+    }
 
-    return ((_data.file.rdstate() & std::ofstream::failbit) == 0);
+    // The whole file is reserved up front, we write the data wherever it belongs.
+    if (_data.bytes_to_get == 0) {
+        return true;
+    }
+#if defined(LINUX)
+    // Not all file systems support it though.
+    if (posix_fallocate(_data.fd, 0, _data.bytes_to_get) == 0) {
+        return true;
+    }
+#endif
+#if defined(WINDOWS)
+    const bool resized = _chsize(_data.fd, long(_data.bytes_to_get)) == 0;
+#else
+    const bool resized = ftruncate(_data.fd, off_t(_data.bytes_to_get)) == 0;
+#endif
+    if (!resized) {
+        finish_logfile();
+    }
+    return resized;
 }
 
-void LogFilesImpl::write_part_to_disk()
+bool LogFilesImpl::write_to_logfile(uint32_t offset, const uint8_t* data, uint32_t size)
 {
     // Assumes to have the lock for _data.mutex.
 
-    _data.file.write(reinterpret_cast<char*>(_data.bytes.data()), _data.bytes.size());
+#if defined(WINDOWS)
+    if (_lseek(_data.fd, long(offset), SEEK_SET) < 0) {
+        return false;
+    }
+    return _write(_data.fd, data, size) == int(size);
+#else
+    return pwrite(_data.fd, data, size, off_t(offset)) == ssize_t(size);
+#endif
 }
 
 void LogFilesImpl::finish_logfile()
 {
     // Assumes to have the lock for _data.mutex.
 
-    _data.file.close();
+    if (_data.fd >= 0) {
+        close(_data.fd);
+        _data.fd = -1;
+    }
+}
+
+bool LogFilesImpl::load_checkpoint(const std::string& path, const LogFiles::Entry& entry)
+{
+    // Assumes to have the lock for _data.mutex.
+
+    std::ifstream checkpoint(path + checkpoint_suffix);
+    unsigned id = 0;
+    std::string date;
+    uint32_t size = 0;
+    std::string chunks;
+    if (!(checkpoint >> id >> date >> size >> chunks)) {
+        return false;
+    }
+
+    // Log ids are just the index in the list, so they can be for another log by now.
+    uint32_t file_size = 0;
+    if (id != entry.id || date != entry.date || size != entry.size_bytes ||
+        !get_file_size(path, file_size) || file_size != size ||
+        chunks.size() != (_data.chunks_received.size() + 3) / 4) {
+        LogWarn() << "Partial download " << path << " doesn't match, starting over";
+        return false;
+    }
+
+    // Four chunks to a hex digit.
+    std::vector<bool> chunks_received(_data.chunks_received.size(), false);
+    for (std::size_t chunk = 0; chunk < chunks_received.size(); ++chunk) {
+        const char digit = chunks[chunk / 4];
+        const int value = (digit >= 'a') ? digit - 'a' + 10 : digit - '0';
+        if (value < 0 || value > 15) {
+            return false;
+        }
+        chunks_received[chunk] = (value >> (chunk % 4)) & 1;
+    }
+    _data.chunks_received = chunks_received;
+    return true;
+}
+
+void LogFilesImpl::save_checkpoint()
+{
+    // Assumes to have the lock for _data.mutex.
+
+    static const char digits[] = "0123456789abcdef";
+    const std::size_t num_chunks = _data.chunks_received.size();
+    std::string chunks;
+    chunks.reserve((num_chunks + 3) / 4);
+    for (std::size_t chunk = 0; chunk < num_chunks; chunk += 4) {
+        unsigned value = 0;
+        for (std::size_t bit = 0; bit < 4 && chunk + bit < num_chunks; ++bit) {
+            value |= unsigned(_data.chunks_received[chunk + bit]) << bit;
+        }
+        chunks += digits[value];
+    }
+
+    std::ofstream checkpoint(_data.path + checkpoint_suffix, std::ios::trunc);
+    checkpoint << _data.id << ' ' << _data.date << ' ' << _data.bytes_to_get << '\n'
+               << chunks << '\n';
+    _data.time_last_checkpoint = _time.steady_time();
 }
 
 void LogFilesImpl::reset_data()
 {
     // Assumes to have the lock for _data.mutex.
     _data.id = 0;
+    _data.date.clear();
+    _data.path.clear();
     _data.bytes_to_get = 0;
-    _data.bytes.clear();
+    _data.bytes_received = 0;
+    _data.bytes_resumed = 0;
     _data.chunks_received.clear();
-    _data.part_start = 0;
+    _data.ranges.clear();
+    _data.next_window_start = 0;
+    _data.window_chunks = 0;
+    _data.round_trip_s = 0.0;
+    _data.rate_bytes_s = 0.0;
+    _data.lead = 0.0;
     _data.retries = 0;
-    _data.rerequesting = false;
-    _data.last_ofs_rerequested = -1;
     _data.callback = nullptr;
 }
 
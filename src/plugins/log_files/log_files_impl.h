@@ -4,7 +4,7 @@
 #include "plugins/log_files/log_files.h"
 #include "plugin_impl_base.h"
 #include "system.h"
-#include <fstream>
+#include <deque>
 
 namespace mavsdk {
 
@@ -25,6 +25,13 @@ public:
     void download_log_file_async(
         unsigned id, const std::string& file_path, LogFiles::DownloadLogFileCallback callback);
 
+    void download_log_files_async(
+        const std::vector<uint32_t>& ids,
+        const std::string& directory,
+        LogFiles::DownloadLogFilesCallback callback);
+
+    LogFiles::Result set_max_downloads_per_link(uint32_t count);
+
 private:
     void request_end();
 
@@ -34,16 +41,43 @@ private:
 
     void request_list_entry(int entry_id);
 
-    void check_part();
+    struct Range {
+        uint32_t start{0};
+        uint32_t end{0};
+        // The data comes in order, up to here so far.
+        uint32_t received_end{0};
+        uint32_t chunks_received{0};
+        bool is_window{false};
+        dl_time_t time_requested{};
+        dl_time_t time_first_data{};
+        dl_time_t time_last_data{};
+    };
+
     void request_log_data(unsigned id, unsigned start, unsigned count);
+    bool plan_range(uint32_t from, Range& range);
+    void request_range(Range& range);
+    void request_next_range();
+    void maybe_request_range_ahead();
+    void finish_range(bool next_started);
+    void adapt_window(double loss);
+    double estimate_rate_bytes_s() const;
     void data_timeout();
+    void register_data_timeout();
 
-    bool start_logfile(const std::string& path);
-    void write_part_to_disk();
+    bool start_logfile(const std::string& path, bool resume);
+    bool write_to_logfile(uint32_t offset, const uint8_t* data, uint32_t size);
     void finish_logfile();
-    void report_progress(unsigned transferred, unsigned total);
+    void report_progress(bool force);
+    void report_result(LogFiles::Result result);
+    float throughput_bytes_s();
+
+    bool load_checkpoint(const std::string& path, const LogFiles::Entry& entry);
+    void save_checkpoint();
+
+    void download_next_log();
+    void process_batch_progress(
+        const LogFiles::Entry& entry, LogFiles::Result result, LogFiles::ProgressData progress);
 
-    std::size_t determine_part_end();
     void reset_data();
 
     static constexpr double LIST_TIMEOUT_S = 0.2;
@@ -60,31 +94,53 @@ private:
         void* cookie{nullptr};
     } _entries{};
 
-    // We download data in parts of 512 * 90 bytes.
-    // If we request the whole file at once we get too much data at once and
-    // can't keep up (at least for PX4 SITL). Also, we need to keep track of
-    // way too many parts which makes the progress and re-transmission
-    // calculation too expensive.
+    // The autopilot sends the data of one LOG_REQUEST_DATA at a time, a new one replaces the
+    // range it is working on. So we ask for one window after the other, the next one timed
+    // to arrive just when the autopilot gets to the end of the current one, and only go back
+    // for what got lost in the end.
     //
-    // This is very much inspired from how QGroundControl does it.
-    static constexpr unsigned PART_SIZE = 512;
-    // A part refers to the
-
+    // Data goes to the file as it comes in, and the chunks received are kept for the whole
+    // file, so gaps can be asked for chunk by chunk.
     struct {
         std::mutex mutex{};
         void* cookie{nullptr};
         unsigned id{0};
-        unsigned bytes_to_get{0};
-        std::vector<uint8_t> bytes{};
+        std::string date{};
+        std::string path{};
+        uint32_t bytes_to_get{0};
+        uint32_t bytes_received{0};
+        // Got by a download cut short before.
+        uint32_t bytes_resumed{0};
+        int fd{-1};
         std::vector<bool> chunks_received{};
-        std::size_t part_start{0};
+        // The range the autopilot is working on, and the one asked for ahead of time.
+        std::deque<Range> ranges{};
+        // Everything before was asked for in a window.
+        uint32_t next_window_start{0};
+        uint32_t window_chunks{0};
+        double round_trip_s{0.0};
+        double rate_bytes_s{0.0};
+        // Part of a round trip of data left in the current range when we ask for the next.
+        double lead{0.0};
         unsigned retries{0};
-        bool rerequesting{false};
-        int last_ofs_rerequested{-1};
         dl_time_t time_started{};
-        std::ofstream file{};
+        dl_time_t time_last_progress{};
+        dl_time_t time_last_checkpoint{};
         LogFiles::DownloadLogFileCallback callback{nullptr};
     } _data{};
+
+    // The logs of download_log_files_async, downloaded one after the other once the
+    // coordinator lets us have the link.
+    struct {
+        std::mutex mutex{};
+        std::deque<LogFiles::Entry> entries{};
+        std::string directory{};
+        const void* link{nullptr};
+        uint64_t bytes_total{0};
+        uint64_t bytes_done{0};
+        LogFiles::Result result{LogFiles::Result::Success};
+        LogFiles::DownloadLogFilesCallback callback{nullptr};
+    } _batch{};
 };
 
 } // namespace mavsdk
@@ -0,0 +1,56 @@
+#include "plugins/log_files/ulog_reader.h"
+#include "ulog_reader_impl.h"
+
+namespace mavsdk {
+
+ULogReader::ULogReader() : _impl{new ULogReaderImpl()} {}
+
+ULogReader::~ULogReader() {}
+
+ULogReader::Result ULogReader::open(const std::string& path)
+{
+    return _impl->open(path);
+}
+
+void ULogReader::close()
+{
+    _impl->close();
+}
+
+std::vector<ULogReader::Topic> ULogReader::topics() const
+{
+    return _impl->topics();
+}
+
+ULogReader::Result ULogReader::extract(const Request& request, Series& series) const
+{
+    return _impl->extract(request, series);
+}
+
+ULogReader::Result
+ULogReader::extract(const std::vector<Request>& requests, std::vector<Series>& series) const
+{
+    return _impl->extract(requests, series);
+}
+
+std::ostream& operator<<(std::ostream& str, ULogReader::Result const& result)
+{
+    switch (result) {
+        case ULogReader::Result::Unknown:
+            return str << "Unknown";
+        case ULogReader::Result::Success:
+            return str << "Success";
+        case ULogReader::Result::FileOpenFailed:
+            return str << "File Open Failed";
+        case ULogReader::Result::InvalidFile:
+            return str << "Invalid File";
+        case ULogReader::Result::TopicNotFound:
+            return str << "Topic Not Found";
+        case ULogReader::Result::FieldNotFound:
+            return str << "Field Not Found";
+        default:
+            return str << "Unknown";
+    }
+}
+
+} // namespace mavsdk
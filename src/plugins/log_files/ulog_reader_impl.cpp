@@ -0,0 +1,555 @@
+#include "ulog_reader_impl.h"
+#include "log.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#if defined(WINDOWS)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mavsdk {
+
+namespace {
+
+const uint8_t header_magic[] = {'U', 'L', 'o', 'g', 0x01, 0x12, 0x35};
+constexpr uint64_t header_size = 16;
+// Message size and type.
+constexpr uint64_t message_header_size = 3;
+// Version 1 added the flag bits, anything later would have to be told apart by them.
+constexpr uint8_t max_version = 1;
+// Data appended after the end of the log, e.g. parameters changed after landing.
+constexpr uint8_t incompat_flag_data_appended = 1;
+constexpr unsigned max_appended_offsets = 3;
+// Nested message definitions deeper than this are taken to refer to each other.
+constexpr unsigned max_nesting = 16;
+
+template<typename T> T read(const uint8_t* data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+template<typename T> double read_as_double(const uint8_t* data)
+{
+    return double(read<T>(data));
+}
+
+// Splits "name[number]" into its parts, for types of arrays and elements of them.
+bool parse_brackets(
+    const std::string& text, std::string& name, bool& has_number, uint32_t& number)
+{
+    number = 0;
+    const auto bracket = text.find('[');
+    has_number = bracket != std::string::npos;
+    if (!has_number) {
+        name = text;
+        return !name.empty();
+    }
+    name = text.substr(0, bracket);
+    char* end = nullptr;
+    number = uint32_t(std::strtoul(text.c_str() + bracket + 1, &end, 10));
+    return !name.empty() && end != text.c_str() + bracket + 1 && *end == ']' &&
+           end + 1 == text.c_str() + text.size();
+}
+
+} // namespace
+
+ULogReaderImpl::ULogReaderImpl() {}
+
+ULogReaderImpl::~ULogReaderImpl()
+{
+    close();
+}
+
+ULogReader::Result ULogReaderImpl::open(const std::string& path)
+{
+    close();
+
+    if (!map_file(path)) {
+        LogErr() << "Could not map " << path;
+        return ULogReader::Result::FileOpenFailed;
+    }
+
+    if (!index()) {
+        close();
+        return ULogReader::Result::InvalidFile;
+    }
+    return ULogReader::Result::Success;
+}
+
+void ULogReaderImpl::close()
+{
+    unmap_file();
+    _formats.clear();
+    _subscriptions.clear();
+}
+
+bool ULogReaderImpl::map_file(const std::string& path)
+{
+#if defined(WINDOWS)
+    _file = CreateFileA(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr);
+    if (_file == INVALID_HANDLE_VALUE) {
+        _file = nullptr;
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(_file, &size) || size.QuadPart == 0) {
+        unmap_file();
+        return false;
+    }
+    _size = uint64_t(size.QuadPart);
+    _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (_mapping == nullptr) {
+        unmap_file();
+        return false;
+    }
+    _data = static_cast<const uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (_data == nullptr) {
+        unmap_file();
+        return false;
+    }
+    return true;
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    _size = uint64_t(file_stat.st_size);
+
+    // The mapping stays valid without the file descriptor.
+    void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        _size = 0;
+        return false;
+    }
+    // Indexing goes through all of it once, front to back.
+    madvise(data, _size, MADV_SEQUENTIAL);
+    _data = static_cast<const uint8_t*>(data);
+    return true;
+#endif
+}
+
+void ULogReaderImpl::unmap_file()
+{
+#if defined(WINDOWS)
+    if (_data != nullptr) {
+        UnmapViewOfFile(_data);
+    }
+    if (_mapping != nullptr) {
+        CloseHandle(_mapping);
+        _mapping = nullptr;
+    }
+    if (_file != nullptr) {
+        CloseHandle(_file);
+        _file = nullptr;
+    }
+#else
+    if (_data != nullptr) {
+        munmap(const_cast<uint8_t*>(_data), _size);
+    }
+#endif
+    _data = nullptr;
+    _size = 0;
+}
+
+bool ULogReaderImpl::index()
+{
+    if (_size < header_size || std::memcmp(_data, header_magic, sizeof(header_magic)) != 0) {
+        LogErr() << "Not a ULog file";
+        return false;
+    }
+    if (_data[sizeof(header_magic)] > max_version) {
+        LogErr() << "Unsupported ULog version " << int(_data[sizeof(header_magic)]);
+        return false;
+    }
+
+    // Subscriptions by message id, ids can be used again once removed.
+    std::unordered_map<uint16_t, std::size_t> subscription_of_id;
+    // The message before data appended can be cut short, we go on with what was appended.
+    std::vector<uint64_t> appended_offsets;
+
+    uint64_t pos = header_size;
+    while (pos + message_header_size <= _size) {
+        const uint16_t msg_size = read<uint16_t>(_data + pos);
+        const char msg_type = char(_data[pos + 2]);
+        const uint64_t end = pos + message_header_size + msg_size;
+
+        if (!appended_offsets.empty() && end > appended_offsets.front() &&
+            pos < appended_offsets.front()) {
+            pos = appended_offsets.front();
+            appended_offsets.erase(appended_offsets.begin());
+            continue;
+        }
+        if (end > _size) {
+            LogWarn() << "ULog file cut short at " << pos << " bytes";
+            break;
+        }
+        const uint8_t* payload = _data + pos + message_header_size;
+
+        switch (msg_type) {
+            case 'D':
+                if (msg_size >= sizeof(uint16_t)) {
+                    auto it = subscription_of_id.find(read<uint16_t>(payload));
+                    if (it != subscription_of_id.end()) {
+                        _subscriptions[it->second].offsets.push_back(pos);
+                    }
+                }
+                break;
+
+            case 'F': {
+                const std::string text(reinterpret_cast<const char*>(payload), msg_size);
+                const auto colon = text.find(':');
+                if (colon != std::string::npos) {
+                    Format format{};
+                    format.definition = text.substr(colon + 1);
+                    _formats[text.substr(0, colon)] = format;
+                }
+                break;
+            }
+
+            case 'A':
+                if (msg_size > sizeof(uint8_t) + sizeof(uint16_t)) {
+                    Subscription subscription{};
+                    subscription.multi_id = payload[0];
+                    subscription.name = std::string(
+                        reinterpret_cast<const char*>(payload + 3), std::size_t(msg_size - 3));
+                    subscription_of_id[read<uint16_t>(payload + 1)] = _subscriptions.size();
+                    _subscriptions.push_back(subscription);
+                }
+                break;
+
+            case 'R':
+                if (msg_size >= sizeof(uint16_t)) {
+                    subscription_of_id.erase(read<uint16_t>(payload));
+                }
+                break;
+
+            case 'B':
+                // Only the first message can have flags.
+                if (pos == header_size && msg_size >= 40) {
+                    const uint8_t* incompat_flags = payload + 8;
+                    if ((incompat_flags[0] & ~incompat_flag_data_appended) != 0 ||
+                        std::any_of(incompat_flags + 1, incompat_flags + 8, [](uint8_t flags) {
+                            return flags != 0;
+                        })) {
+                        LogErr() << "ULog file has flags we don't know";
+                        return false;
+                    }
+                    if (incompat_flags[0] & incompat_flag_data_appended) {
+                        for (unsigned i = 0; i < max_appended_offsets; ++i) {
+                            const auto offset = read<uint64_t>(payload + 16 + 8 * i);
+                            if (offset > pos) {
+                                appended_offsets.push_back(offset);
+                            }
+                        }
+                        std::sort(appended_offsets.begin(), appended_offsets.end());
+                    }
+                }
+                break;
+
+            default:
+                // Info, parameters, logged strings, sync and dropouts, and whatever might
+                // be added to the format, which is meant to be skipped.
+                break;
+        }
+        pos = end;
+    }
+
+    // Definitions can refer to others defined later, so we only work them out at the end.
+    for (auto& format : _formats) {
+        if (!resolve_format(format.first, 0)) {
+            LogWarn() << "Could not work out definition of " << format.first;
+        }
+    }
+    return true;
+}
+
+bool ULogReaderImpl::resolve_format(const std::string& name, unsigned depth)
+{
+    auto it = _formats.find(name);
+    if (it == _formats.end() || depth > max_nesting) {
+        return false;
+    }
+    Format& format = it->second;
+    if (format.is_resolved) {
+        return true;
+    }
+
+    static const std::unordered_map<std::string, std::pair<Type, uint32_t>> basic_types{
+        {"int8_t", {Type::Int8, 1}},
+        {"uint8_t", {Type::UInt8, 1}},
+        {"int16_t", {Type::Int16, 2}},
+        {"uint16_t", {Type::UInt16, 2}},
+        {"int32_t", {Type::Int32, 4}},
+        {"uint32_t", {Type::UInt32, 4}},
+        {"int64_t", {Type::Int64, 8}},
+        {"uint64_t", {Type::UInt64, 8}},
+        {"float", {Type::Float, 4}},
+        {"double", {Type::Double, 8}},
+        {"bool", {Type::Bool, 1}},
+        {"char", {Type::Char, 1}},
+    };
+
+    // Fields are "type name;" one after the other, packed without alignment.
+    std::vector<Field> fields;
+    uint32_t offset = 0;
+    std::size_t start = 0;
+    while (start < format.definition.size()) {
+        auto end = format.definition.find(';', start);
+        if (end == std::string::npos) {
+            end = format.definition.size();
+        }
+        const std::string text = format.definition.substr(start, end - start);
+        start = end + 1;
+
+        const auto space = text.find(' ');
+        if (space == std::string::npos) {
+            continue;
+        }
+
+        Field field{};
+        field.name = text.substr(space + 1);
+        bool is_array = false;
+        if (!parse_brackets(text.substr(0, space), field.type_name, is_array, field.array_size) ||
+            (is_array && field.array_size == 0)) {
+            return false;
+        }
+
+        auto basic_type = basic_types.find(field.type_name);
+        if (basic_type != basic_types.end()) {
+            field.type = basic_type->second.first;
+            field.element_size = basic_type->second.second;
+        } else {
+            if (!resolve_format(field.type_name, depth + 1)) {
+                return false;
+            }
+            field.type = Type::Nested;
+            field.element_size = _formats[field.type_name].size;
+        }
+
+        field.offset = offset;
+        offset += field.element_size * std::max(field.array_size, uint32_t(1));
+        fields.push_back(field);
+    }
+
+    format.fields = fields;
+    format.size = offset;
+    format.is_resolved = true;
+    return true;
+}
+
+std::vector<ULogReader::Topic> ULogReaderImpl::topics() const
+{
+    std::vector<ULogReader::Topic> topics;
+    for (const auto& subscription : _subscriptions) {
+        ULogReader::Topic topic;
+        topic.name = subscription.name;
+        topic.multi_id = subscription.multi_id;
+        topic.num_messages = subscription.offsets.size();
+        topics.push_back(topic);
+    }
+    return topics;
+}
+
+const ULogReaderImpl::Subscription*
+ULogReaderImpl::find_subscription(const std::string& topic, uint8_t multi_id) const
+{
+    for (const auto& subscription : _subscriptions) {
+        if (subscription.name == topic && subscription.multi_id == multi_id) {
+            return &subscription;
+        }
+    }
+    return nullptr;
+}
+
+bool ULogReaderImpl::resolve_column(
+    const Format& format, const std::string& path, Column& column) const
+{
+    // A path like "esc[0].esc_rpm" goes down one nested message for each dot.
+    const Format* current = &format;
+    column.offset = 0;
+    std::size_t start = 0;
+    while (true) {
+        const auto dot = path.find('.', start);
+        const std::string part = path.substr(start, dot - start);
+
+        std::string name;
+        bool has_index = false;
+        uint32_t index = 0;
+        if (!parse_brackets(part, name, has_index, index)) {
+            return false;
+        }
+
+        auto field = std::find_if(
+            current->fields.begin(), current->fields.end(), [&name](const Field& candidate) {
+                return candidate.name == name;
+            });
+        if (field == current->fields.end() || has_index != (field->array_size > 0) ||
+            (has_index && index >= field->array_size)) {
+            return false;
+        }
+        column.offset += field->offset + index * field->element_size;
+
+        if (dot == std::string::npos) {
+            column.type = field->type;
+            column.size = field->element_size;
+            return field->type != Type::Nested;
+        }
+        if (field->type != Type::Nested) {
+            return false;
+        }
+        current = &_formats.at(field->type_name);
+        start = dot + 1;
+    }
+}
+
+ULogReader::Result
+ULogReaderImpl::extract(const ULogReader::Request& request, ULogReader::Series& series) const
+{
+    series = ULogReader::Series{};
+
+    const Subscription* subscription = find_subscription(request.topic, request.multi_id);
+    if (subscription == nullptr) {
+        return ULogReader::Result::TopicNotFound;
+    }
+    auto format = _formats.find(subscription->name);
+    if (format == _formats.end() || !format->second.is_resolved) {
+        return ULogReader::Result::TopicNotFound;
+    }
+
+    Column timestamp{};
+    if (!resolve_column(format->second, "timestamp", timestamp) ||
+        timestamp.type != Type::UInt64) {
+        return ULogReader::Result::FieldNotFound;
+    }
+    std::vector<Column> columns(request.fields.size());
+    for (std::size_t i = 0; i < columns.size(); ++i) {
+        if (!resolve_column(format->second, request.fields[i], columns[i])) {
+            LogErr() << "No field " << request.fields[i] << " in " << request.topic;
+            return ULogReader::Result::FieldNotFound;
+        }
+    }
+
+    const std::size_t num_messages = subscription->offsets.size();
+    series.timestamps_us.resize(num_messages);
+    series.fields.assign(columns.size(), std::vector<double>(num_messages));
+
+    for (std::size_t i = 0; i < num_messages; ++i) {
+        const uint8_t* message = _data + subscription->offsets[i];
+        // Past the message id, padding at the end is left out.
+        const uint32_t size = read<uint16_t>(message) - uint32_t(sizeof(uint16_t));
+        const uint8_t* data = message + message_header_size + sizeof(uint16_t);
+
+        series.timestamps_us[i] = (timestamp.offset + sizeof(uint64_t) <= size) ?
+                                      read<uint64_t>(data + timestamp.offset) :
+                                      0;
+
+        for (std::size_t j = 0; j < columns.size(); ++j) {
+            const Column& column = columns[j];
+            const uint8_t* value = data + column.offset;
+            double& result = series.fields[j][i];
+
+            if (column.offset + column.size > size) {
+                result = double(NAN);
+                continue;
+            }
+            switch (column.type) {
+                case Type::Int8:
+                case Type::Char:
+                    result = read_as_double<int8_t>(value);
+                    break;
+                case Type::UInt8:
+                case Type::Bool:
+                    result = read_as_double<uint8_t>(value);
+                    break;
+                case Type::Int16:
+                    result = read_as_double<int16_t>(value);
+                    break;
+                case Type::UInt16:
+                    result = read_as_double<uint16_t>(value);
+                    break;
+                case Type::Int32:
+                    result = read_as_double<int32_t>(value);
+                    break;
+                case Type::UInt32:
+                    result = read_as_double<uint32_t>(value);
+                    break;
+                case Type::Int64:
+                    result = read_as_double<int64_t>(value);
+                    break;
+                case Type::UInt64:
+                    result = read_as_double<uint64_t>(value);
+                    break;
+                case Type::Float:
+                    result = read_as_double<float>(value);
+                    break;
+                case Type::Double:
+                    result = read<double>(value);
+                    break;
+                case Type::Nested:
+                    result = double(NAN);
+                    break;
+            }
+        }
+    }
+    return ULogReader::Result::Success;
+}
+
+ULogReader::Result ULogReaderImpl::extract(
+    const std::vector<ULogReader::Request>& requests,
+    std::vector<ULogReader::Series>& series) const
+{
+    series.assign(requests.size(), ULogReader::Series{});
+    std::vector<ULogReader::Result> results(requests.size(), ULogReader::Result::Unknown);
+
+    // Each thread takes the next topic left, they only read the mapped file.
+    std::atomic<std::size_t> next{0};
+    auto work = [&]() {
+        for (std::size_t i = next++; i < requests.size(); i = next++) {
+            results[i] = extract(requests[i], series[i]);
+        }
+    };
+
+    const std::size_t num_threads =
+        std::min<std::size_t>(requests.size(), std::max(std::thread::hardware_concurrency(), 1u));
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < num_threads; ++i) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (const auto result : results) {
+        if (result != ULogReader::Result::Success) {
+            return result;
+        }
+    }
+    return ULogReader::Result::Success;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "plugins/log_files/ulog_reader.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mavsdk {
+
+class ULogReaderImpl {
+public:
+    ULogReaderImpl();
+    ~ULogReaderImpl();
+
+    ULogReader::Result open(const std::string& path);
+    void close();
+
+    std::vector<ULogReader::Topic> topics() const;
+
+    ULogReader::Result
+    extract(const ULogReader::Request& request, ULogReader::Series& series) const;
+    ULogReader::Result extract(
+        const std::vector<ULogReader::Request>& requests,
+        std::vector<ULogReader::Series>& series) const;
+
+    ULogReaderImpl(const ULogReaderImpl&) = delete;
+    const ULogReaderImpl& operator=(const ULogReaderImpl&) = delete;
+
+private:
+    enum class Type {
+        Int8,
+        UInt8,
+        Int16,
+        UInt16,
+        Int32,
+        UInt32,
+        Int64,
+        UInt64,
+        Float,
+        Double,
+        Bool,
+        Char,
+        Nested,
+    };
+
+    struct Field {
+        std::string name;
+        Type type;
+        // Name of the message definition for nested ones.
+        std::string type_name;
+        uint32_t offset;
+        uint32_t element_size;
+        // 0 if not an array.
+        uint32_t array_size;
+    };
+
+    struct Format {
+        std::string definition;
+        std::vector<Field> fields;
+        uint32_t size;
+        bool is_resolved;
+    };
+
+    // A topic instance as added to the log, with where each of its messages starts.
+    struct Subscription {
+        std::string name;
+        uint8_t multi_id;
+        std::vector<uint64_t> offsets;
+    };
+
+    struct Column {
+        Type type;
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    bool map_file(const std::string& path);
+    void unmap_file();
+    bool index();
+    bool resolve_format(const std::string& name, unsigned depth);
+    bool resolve_column(const Format& format, const std::string& path, Column& column) const;
+    const Subscription* find_subscription(const std::string& topic, uint8_t multi_id) const;
+
+    const uint8_t* _data{nullptr};
+    uint64_t _size{0};
+#if defined(WINDOWS)
+    void* _file{nullptr};
+    void* _mapping{nullptr};
+#endif
+
+    std::unordered_map<std::string, Format> _formats{};
+    std::vector<Subscription> _subscriptions{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,285 @@
+#include "plugins/log_files/ulog_reader.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+const std::string path = "ulog_reader_test.ulg";
+
+// Writes ULog files the way PX4 does, as far as needed here.
+class ULogWriter {
+public:
+    explicit ULogWriter(bool with_appended_data = false)
+    {
+        const uint8_t header[] = {'U', 'L', 'o', 'g', 0x01, 0x12, 0x35, 0x01};
+        _bytes.insert(_bytes.end(), header, header + sizeof(header));
+        append<uint64_t>(_bytes, 1000);
+
+        std::vector<uint8_t> flags(40, 0);
+        flags[8] = with_appended_data ? 1 : 0;
+        message('B', flags);
+    }
+
+    void format(const std::string& text) { message('F', text_bytes(text)); }
+
+    void add(uint8_t multi_id, uint16_t msg_id, const std::string& name)
+    {
+        std::vector<uint8_t> payload{multi_id};
+        append(payload, msg_id);
+        const auto name_bytes = text_bytes(name);
+        payload.insert(payload.end(), name_bytes.begin(), name_bytes.end());
+        message('A', payload);
+    }
+
+    void data(uint16_t msg_id, const std::vector<uint8_t>& fields)
+    {
+        std::vector<uint8_t> payload;
+        append(payload, msg_id);
+        payload.insert(payload.end(), fields.begin(), fields.end());
+        message('D', payload);
+    }
+
+    void message(char type, const std::vector<uint8_t>& payload)
+    {
+        append(_bytes, uint16_t(payload.size()));
+        _bytes.push_back(uint8_t(type));
+        _bytes.insert(_bytes.end(), payload.begin(), payload.end());
+    }
+
+    // The start of a message which never got written completely.
+    void cut_short()
+    {
+        append(_bytes, uint16_t(100));
+        _bytes.push_back(uint8_t('D'));
+        _bytes.push_back(0);
+    }
+
+    // Everything from here on is appended data, as noted in the flags.
+    void start_appended_data()
+    {
+        const uint64_t offset = _bytes.size();
+        // Header, message header, compat and incompat flags.
+        std::memcpy(&_bytes[16 + 3 + 16], &offset, sizeof(offset));
+    }
+
+    void write() const
+    {
+        std::ofstream(path, std::ios::binary)
+            .write(reinterpret_cast<const char*>(_bytes.data()), _bytes.size());
+    }
+
+    template<typename T> static void append(std::vector<uint8_t>& bytes, T value)
+    {
+        const auto* data = reinterpret_cast<const uint8_t*>(&value);
+        bytes.insert(bytes.end(), data, data + sizeof(value));
+    }
+
+private:
+    static std::vector<uint8_t> text_bytes(const std::string& text)
+    {
+        return std::vector<uint8_t>(text.begin(), text.end());
+    }
+
+    std::vector<uint8_t> _bytes{};
+};
+
+// Like PX4 battery and GPS topics, the battery with nested messages and padding at the end,
+// which PX4 leaves out of the data.
+void write_definitions(ULogWriter& writer)
+{
+    writer.format("esc_report:int32_t rpm;uint8_t temperature;");
+    writer.format(
+        "battery_status:uint64_t timestamp;float voltage_v;float[4] voltage_cell_v;"
+        "esc_report[2] esc;bool connected;uint8_t[3] _padding0;");
+    writer.format("vehicle_gps_position:uint64_t timestamp;int32_t lat;int32_t lon;");
+    writer.add(0, 0, "battery_status");
+    writer.add(1, 1, "battery_status");
+    writer.add(0, 2, "vehicle_gps_position");
+}
+
+std::vector<uint8_t> battery(uint64_t timestamp, float voltage, int32_t rpm)
+{
+    std::vector<uint8_t> fields;
+    ULogWriter::append(fields, timestamp);
+    ULogWriter::append(fields, voltage);
+    for (int i = 0; i < 4; ++i) {
+        ULogWriter::append(fields, voltage / 4.0f + float(i));
+    }
+    for (int i = 0; i < 2; ++i) {
+        ULogWriter::append(fields, rpm + i);
+        ULogWriter::append(fields, uint8_t(40 + i));
+    }
+    ULogWriter::append(fields, true);
+    return fields;
+}
+
+std::vector<uint8_t> gps(uint64_t timestamp, int32_t lat, int32_t lon)
+{
+    std::vector<uint8_t> fields;
+    ULogWriter::append(fields, timestamp);
+    ULogWriter::append(fields, lat);
+    ULogWriter::append(fields, lon);
+    return fields;
+}
+
+void write_log()
+{
+    ULogWriter writer;
+    write_definitions(writer);
+    writer.message('I', {4, 's', 'y', 's', '_', 'x'});
+    for (unsigned i = 0; i < 10; ++i) {
+        writer.data(0, battery(2000 + i * 100, 16.0f - float(i) * 0.1f, 1000 + int32_t(i)));
+        writer.data(2, gps(2050 + i * 100, 473977418 + int32_t(i), 85455938 - int32_t(i)));
+        // Unknown types are skipped.
+        writer.message('X', {1, 2, 3});
+    }
+    writer.data(1, battery(5000, 12.0f, 0));
+    writer.write();
+}
+
+class ULogReaderTest : public ::testing::Test {
+protected:
+    void TearDown() override { std::remove(path.c_str()); }
+
+    ULogReader _reader{};
+};
+
+} // namespace
+
+TEST_F(ULogReaderTest, IndexesTopics)
+{
+    write_log();
+    ASSERT_EQ(_reader.open(path), ULogReader::Result::Success);
+
+    const auto topics = _reader.topics();
+    ASSERT_EQ(topics.size(), 3u);
+    EXPECT_EQ(topics[0].name, "battery_status");
+    EXPECT_EQ(topics[0].multi_id, 0);
+    EXPECT_EQ(topics[0].num_messages, 10u);
+    EXPECT_EQ(topics[1].name, "battery_status");
+    EXPECT_EQ(topics[1].multi_id, 1);
+    EXPECT_EQ(topics[1].num_messages, 1u);
+    EXPECT_EQ(topics[2].name, "vehicle_gps_position");
+    EXPECT_EQ(topics[2].num_messages, 10u);
+}
+
+TEST_F(ULogReaderTest, ExtractsFields)
+{
+    write_log();
+    ASSERT_EQ(_reader.open(path), ULogReader::Result::Success);
+
+    ULogReader::Request request;
+    request.topic = "battery_status";
+    request.fields = {"voltage_v", "voltage_cell_v[3]", "esc[1].rpm", "esc[0].temperature",
+                      "connected"};
+    ULogReader::Series series;
+    ASSERT_EQ(_reader.extract(request, series), ULogReader::Result::Success);
+
+    ASSERT_EQ(series.timestamps_us.size(), 10u);
+    ASSERT_EQ(series.fields.size(), 5u);
+    for (unsigned i = 0; i < 10; ++i) {
+        const float voltage = 16.0f - float(i) * 0.1f;
+        EXPECT_EQ(series.timestamps_us[i], 2000u + i * 100);
+        EXPECT_EQ(series.fields[0][i], double(voltage));
+        EXPECT_EQ(series.fields[1][i], double(voltage / 4.0f + 3.0f));
+        EXPECT_EQ(series.fields[2][i], 1001.0 + i);
+        EXPECT_EQ(series.fields[3][i], 40.0);
+        EXPECT_EQ(series.fields[4][i], 1.0);
+    }
+
+    request.multi_id = 1;
+    ASSERT_EQ(_reader.extract(request, series), ULogReader::Result::Success);
+    ASSERT_EQ(series.timestamps_us.size(), 1u);
+    EXPECT_EQ(series.fields[0][0], 12.0);
+}
+
+TEST_F(ULogReaderTest, ExtractsSeveralTopicsAtOnce)
+{
+    write_log();
+    ASSERT_EQ(_reader.open(path), ULogReader::Result::Success);
+
+    std::vector<ULogReader::Request> requests(2);
+    requests[0].topic = "vehicle_gps_position";
+    requests[0].fields = {"lat", "lon"};
+    requests[1].topic = "battery_status";
+    requests[1].fields = {"voltage_v"};
+
+    std::vector<ULogReader::Series> series;
+    ASSERT_EQ(_reader.extract(requests, series), ULogReader::Result::Success);
+    ASSERT_EQ(series.size(), 2u);
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        ULogReader::Series single;
+        ASSERT_EQ(_reader.extract(requests[i], single), ULogReader::Result::Success);
+        EXPECT_EQ(series[i].timestamps_us, single.timestamps_us);
+        EXPECT_EQ(series[i].fields, single.fields);
+    }
+    EXPECT_EQ(series[0].fields[0][9], 473977427.0);
+    EXPECT_EQ(series[0].fields[1][9], 85455929.0);
+}
+
+TEST_F(ULogReaderTest, RejectsUnknownTopicsAndFields)
+{
+    write_log();
+    ASSERT_EQ(_reader.open(path), ULogReader::Result::Success);
+
+    ULogReader::Request request;
+    ULogReader::Series series;
+    request.topic = "sensor_combined";
+    EXPECT_EQ(_reader.extract(request, series), ULogReader::Result::TopicNotFound);
+    request.topic = "vehicle_gps_position";
+    request.multi_id = 1;
+    EXPECT_EQ(_reader.extract(request, series), ULogReader::Result::TopicNotFound);
+
+    request.topic = "battery_status";
+    request.multi_id = 0;
+    for (const auto& field : {"current_a", "voltage_cell_v", "voltage_cell_v[4]", "esc[0]",
+                              "voltage_v[0]", "esc[0].rpm.x"}) {
+        request.fields = {field};
+        EXPECT_EQ(_reader.extract(request, series), ULogReader::Result::FieldNotFound)
+            << field;
+    }
+
+    // Several at once report the error as well.
+    std::vector<ULogReader::Series> several;
+    EXPECT_EQ(
+        _reader.extract(std::vector<ULogReader::Request>{request}, several),
+        ULogReader::Result::FieldNotFound);
+}
+
+TEST_F(ULogReaderTest, GoesOnWithAppendedData)
+{
+    ULogWriter writer(true);
+    write_definitions(writer);
+    writer.data(2, gps(1000, 1, 2));
+    writer.cut_short();
+    writer.start_appended_data();
+    writer.data(2, gps(2000, 3, 4));
+    // And the end of a log still being written.
+    writer.cut_short();
+    writer.write();
+
+    ASSERT_EQ(_reader.open(path), ULogReader::Result::Success);
+    ULogReader::Request request;
+    request.topic = "vehicle_gps_position";
+    request.fields = {"lat"};
+    ULogReader::Series series;
+    ASSERT_EQ(_reader.extract(request, series), ULogReader::Result::Success);
+    EXPECT_EQ(series.timestamps_us, (std::vector<uint64_t>{1000, 2000}));
+    EXPECT_EQ(series.fields[0], (std::vector<double>{1.0, 3.0}));
+}
+
+TEST_F(ULogReaderTest, RejectsOtherFiles)
+{
+    EXPECT_EQ(_reader.open(path), ULogReader::Result::FileOpenFailed);
+
+    std::ofstream(path) << "This is not a log file, but long enough for one.";
+    EXPECT_EQ(_reader.open(path), ULogReader::Result::InvalidFile);
+    EXPECT_TRUE(_reader.topics().empty());
+}
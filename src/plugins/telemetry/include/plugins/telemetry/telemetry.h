@@ -130,6 +130,36 @@ public:
      */
     friend std::ostream& operator<<(std::ostream& str, Telemetry::LandedState const& landed_state);
 
+    /**
+     * @brief Telemetry fields of which history can be recorded.
+     *
+     * The components of each field are listed in the order of the columns in
+     * `History` and of the values in `HistoryStatistics`.
+     */
+    enum class HistoryField {
+        Position, /**< @brief latitude_deg, longitude_deg, absolute_altitude_m,
+                     relative_altitude_m. */
+        VelocityNed, /**< @brief north_m_s, east_m_s, down_m_s. */
+        PositionVelocityNed, /**< @brief north_m, east_m, down_m, north_m_s, east_m_s,
+                                down_m_s. */
+        AttitudeQuaternion, /**< @brief w, x, y, z. */
+        AttitudeEuler, /**< @brief roll_deg, pitch_deg, yaw_deg. */
+        AngularVelocityBody, /**< @brief roll_rad_s, pitch_rad_s, yaw_rad_s. */
+        Imu, /**< @brief Acceleration forward/right/down, angular velocity forward/right/down,
+                magnetic field forward/right/down, temperature_degc. */
+        Battery, /**< @brief voltage_v, remaining_percent. */
+        FixedwingMetrics, /**< @brief airspeed_m_s, throttle_percentage, climb_rate_m_s. */
+        GroundTruth, /**< @brief latitude_deg, longitude_deg, absolute_altitude_m. */
+    };
+
+    /**
+     * @brief Stream operator to print information about a `Telemetry::HistoryField`.
+     *
+     * @return A reference to the stream.
+     */
+    friend std::ostream&
+    operator<<(std::ostream& str, Telemetry::HistoryField const& history_field);
+
     /**
      * @brief Position type in global coordinates.
      */
@@ -771,6 +801,125 @@ public:
      */
     friend std::ostream& operator<<(std::ostream& str, Telemetry::Imu const& imu);
 
+    /**
+     * @brief Snapshot of the telemetry state.
+     *
+     * All fields are copied at once and are consistent with each other.
+     */
+    struct Snapshot {
+        Position position{}; /**< @brief Position */
+        Position home{}; /**< @brief Home position */
+        bool in_air{false}; /**< @brief True if the vehicle is flying */
+        bool armed{false}; /**< @brief True if the vehicle is armed */
+        LandedState landed_state{}; /**< @brief Landed state */
+        FlightMode flight_mode{}; /**< @brief Flight mode */
+        Health health{}; /**< @brief Health */
+        Quaternion attitude_quaternion{}; /**< @brief Attitude as quaternion */
+        EulerAngle attitude_euler{}; /**< @brief Attitude as euler angles */
+        AngularVelocityBody
+            attitude_angular_velocity_body{}; /**< @brief Angular velocity in body frame */
+        Quaternion camera_attitude_quaternion{}; /**< @brief Camera attitude as quaternion */
+        EulerAngle camera_attitude_euler{}; /**< @brief Camera attitude as euler angles */
+        VelocityNed velocity_ned{}; /**< @brief Velocity in NED frame */
+        PositionVelocityNed position_velocity_ned{}; /**< @brief Position and velocity in NED */
+        GroundTruth ground_truth{}; /**< @brief Ground truth */
+        FixedwingMetrics fixedwing_metrics{}; /**< @brief Fixedwing metrics */
+        Imu imu{}; /**< @brief IMU reading */
+        GpsInfo gps_info{}; /**< @brief GPS information */
+        Battery battery{}; /**< @brief Battery */
+        RcStatus rc_status{}; /**< @brief RC status */
+        uint64_t unix_epoch_time_us{}; /**< @brief Unix epoch time in microseconds */
+    };
+
+    /**
+     * @brief Equal operator to compare two `Telemetry::Snapshot` objects.
+     *
+     * @return `true` if items are equal.
+     */
+    friend bool operator==(const Telemetry::Snapshot& lhs, const Telemetry::Snapshot& rhs);
+
+    /**
+     * @brief Stream operator to print information about a `Telemetry::Snapshot`.
+     *
+     * @return A reference to the stream.
+     */
+    friend std::ostream& operator<<(std::ostream& str, Telemetry::Snapshot const& snapshot);
+
+    /**
+     * @brief Recorded values of one component of a telemetry field.
+     */
+    struct HistoryColumn {
+        std::vector<double> values{}; /**< @brief Value of each sample */
+    };
+
+    /**
+     * @brief Equal operator to compare two `Telemetry::HistoryColumn` objects.
+     *
+     * @return `true` if items are equal.
+     */
+    friend bool
+    operator==(const Telemetry::HistoryColumn& lhs, const Telemetry::HistoryColumn& rhs);
+
+    /**
+     * @brief Stream operator to print information about a `Telemetry::HistoryColumn`.
+     *
+     * @return A reference to the stream.
+     */
+    friend std::ostream&
+    operator<<(std::ostream& str, Telemetry::HistoryColumn const& history_column);
+
+    /**
+     * @brief Recorded history of a telemetry field, in columns.
+     */
+    struct History {
+        std::vector<uint64_t>
+            time_us{}; /**< @brief Autopilot Unix time of each sample in microseconds */
+        std::vector<HistoryColumn>
+            columns{}; /**< @brief One column for each component of the field */
+    };
+
+    /**
+     * @brief Equal operator to compare two `Telemetry::History` objects.
+     *
+     * @return `true` if items are equal.
+     */
+    friend bool operator==(const Telemetry::History& lhs, const Telemetry::History& rhs);
+
+    /**
+     * @brief Stream operator to print information about a `Telemetry::History`.
+     *
+     * @return A reference to the stream.
+     */
+    friend std::ostream& operator<<(std::ostream& str, Telemetry::History const& history);
+
+    /**
+     * @brief Aggregates over the recorded history of a telemetry field.
+     *
+     * Values which are not set (NaN) are skipped.
+     */
+    struct HistoryStatistics {
+        uint64_t count{}; /**< @brief Number of samples */
+        std::vector<double> min{}; /**< @brief Minimum of each component */
+        std::vector<double> max{}; /**< @brief Maximum of each component */
+        std::vector<double> mean{}; /**< @brief Mean of each component */
+    };
+
+    /**
+     * @brief Equal operator to compare two `Telemetry::HistoryStatistics` objects.
+     *
+     * @return `true` if items are equal.
+     */
+    friend bool
+    operator==(const Telemetry::HistoryStatistics& lhs, const Telemetry::HistoryStatistics& rhs);
+
+    /**
+     * @brief Stream operator to print information about a `Telemetry::HistoryStatistics`.
+     *
+     * @return A reference to the stream.
+     */
+    friend std::ostream&
+    operator<<(std::ostream& str, Telemetry::HistoryStatistics const& history_statistics);
+
     /**
      * @brief Possible results returned for telemetry requests.
      */
@@ -1264,6 +1413,65 @@ public:
      */
     uint64_t unix_epoch_time() const;
 
+    /**
+     * @brief Get all telemetry at once.
+     *
+     * This does not lock, so it can be called at a high rate, e.g. by a UI.
+     * Status text, actuator and odometry are not part of the snapshot.
+     *
+     * This function is blocking.
+     *
+     * @return Result of request.
+     */
+    Telemetry::Snapshot snapshot() const;
+
+    /**
+     * @brief Set the number of samples of history to keep for a field.
+     *
+     * History is off by default, a capacity of 0 turns it off again. Changing
+     * the capacity drops the history recorded so far. Once full, the oldest
+     * samples are overwritten.
+     *
+     * Each sample takes 8 bytes for the timestamp plus 8 bytes per component,
+     * e.g. one hour of position at 10 Hz is 36000 * (8 + 4 * 8) bytes = 1.4 MB.
+     *
+     * This function is blocking.
+     *
+     * @return Result of request.
+     */
+    void set_history_capacity(HistoryField field, uint32_t capacity) const;
+
+    /**
+     * @brief Get the recorded history of a field within a time range.
+     *
+     * The range is in autopilot Unix time in microseconds, both ends are
+     * included. If there are more than max_samples samples in the range, they
+     * are downsampled by averaging consecutive samples, 0 returns all of them.
+     * The history is empty if it is off for the field.
+     *
+     * This function is blocking.
+     *
+     * @return Result of request.
+     */
+    Telemetry::History history(
+        HistoryField field,
+        uint64_t start_time_us,
+        uint64_t end_time_us,
+        uint32_t max_samples) const;
+
+    /**
+     * @brief Get minimum, maximum and mean of a field within a time range.
+     *
+     * The range is in autopilot Unix time in microseconds, both ends are
+     * included. The statistics are empty if history is off for the field.
+     *
+     * This function is blocking.
+     *
+     * @return Result of request.
+     */
+    Telemetry::HistoryStatistics
+    history_statistics(HistoryField field, uint64_t start_time_us, uint64_t end_time_us) const;
+
     /**
      * @brief Set rate to 'position' updates.
      *
@@ -33,6 +33,10 @@ using AccelerationFrd = Telemetry::AccelerationFrd;
 using AngularVelocityFrd = Telemetry::AngularVelocityFrd;
 using MagneticFieldFrd = Telemetry::MagneticFieldFrd;
 using Imu = Telemetry::Imu;
+using Snapshot = Telemetry::Snapshot;
+using HistoryColumn = Telemetry::HistoryColumn;
+using History = Telemetry::History;
+using HistoryStatistics = Telemetry::HistoryStatistics;
 
 Telemetry::Telemetry(System& system) : PluginBase(), _impl{new TelemetryImpl(system)} {}
 
@@ -299,6 +303,28 @@ uint64_t Telemetry::unix_epoch_time() const
     return _impl->unix_epoch_time();
 }
 
+Telemetry::Snapshot Telemetry::snapshot() const
+{
+    return _impl->snapshot();
+}
+
+void Telemetry::set_history_capacity(HistoryField field, uint32_t capacity) const
+{
+    _impl->set_history_capacity(field, capacity);
+}
+
+Telemetry::History Telemetry::history(
+    HistoryField field, uint64_t start_time_us, uint64_t end_time_us, uint32_t max_samples) const
+{
+    return _impl->history(field, start_time_us, end_time_us, max_samples);
+}
+
+Telemetry::HistoryStatistics Telemetry::history_statistics(
+    HistoryField field, uint64_t start_time_us, uint64_t end_time_us) const
+{
+    return _impl->history_statistics(field, start_time_us, end_time_us);
+}
+
 void Telemetry::set_rate_position_async(double rate_hz, const ResultCallback callback)
 {
     _impl->set_rate_position_async(rate_hz, callback);
@@ -986,6 +1012,125 @@ std::ostream& operator<<(std::ostream& str, Telemetry::Imu const& imu)
     return str;
 }
 
+bool operator==(const Telemetry::Snapshot& lhs, const Telemetry::Snapshot& rhs)
+{
+    return (rhs.position == lhs.position) && (rhs.home == lhs.home) && (rhs.in_air == lhs.in_air) &&
+           (rhs.armed == lhs.armed) && (rhs.landed_state == lhs.landed_state) &&
+           (rhs.flight_mode == lhs.flight_mode) && (rhs.health == lhs.health) &&
+           (rhs.attitude_quaternion == lhs.attitude_quaternion) &&
+           (rhs.attitude_euler == lhs.attitude_euler) &&
+           (rhs.attitude_angular_velocity_body == lhs.attitude_angular_velocity_body) &&
+           (rhs.camera_attitude_quaternion == lhs.camera_attitude_quaternion) &&
+           (rhs.camera_attitude_euler == lhs.camera_attitude_euler) &&
+           (rhs.velocity_ned == lhs.velocity_ned) &&
+           (rhs.position_velocity_ned == lhs.position_velocity_ned) &&
+           (rhs.ground_truth == lhs.ground_truth) &&
+           (rhs.fixedwing_metrics == lhs.fixedwing_metrics) && (rhs.imu == lhs.imu) &&
+           (rhs.gps_info == lhs.gps_info) && (rhs.battery == lhs.battery) &&
+           (rhs.rc_status == lhs.rc_status) && (rhs.unix_epoch_time_us == lhs.unix_epoch_time_us);
+}
+
+std::ostream& operator<<(std::ostream& str, Telemetry::Snapshot const& snapshot)
+{
+    str << std::setprecision(15);
+    str << "snapshot:" << '\n' << "{\n";
+    str << "    position: " << snapshot.position << '\n';
+    str << "    home: " << snapshot.home << '\n';
+    str << "    in_air: " << snapshot.in_air << '\n';
+    str << "    armed: " << snapshot.armed << '\n';
+    str << "    landed_state: " << snapshot.landed_state << '\n';
+    str << "    flight_mode: " << snapshot.flight_mode << '\n';
+    str << "    health: " << snapshot.health << '\n';
+    str << "    attitude_quaternion: " << snapshot.attitude_quaternion << '\n';
+    str << "    attitude_euler: " << snapshot.attitude_euler << '\n';
+    str << "    attitude_angular_velocity_body: " << snapshot.attitude_angular_velocity_body
+        << '\n';
+    str << "    camera_attitude_quaternion: " << snapshot.camera_attitude_quaternion << '\n';
+    str << "    camera_attitude_euler: " << snapshot.camera_attitude_euler << '\n';
+    str << "    velocity_ned: " << snapshot.velocity_ned << '\n';
+    str << "    position_velocity_ned: " << snapshot.position_velocity_ned << '\n';
+    str << "    ground_truth: " << snapshot.ground_truth << '\n';
+    str << "    fixedwing_metrics: " << snapshot.fixedwing_metrics << '\n';
+    str << "    imu: " << snapshot.imu << '\n';
+    str << "    gps_info: " << snapshot.gps_info << '\n';
+    str << "    battery: " << snapshot.battery << '\n';
+    str << "    rc_status: " << snapshot.rc_status << '\n';
+    str << "    unix_epoch_time_us: " << snapshot.unix_epoch_time_us << '\n';
+    str << '}';
+    return str;
+}
+
+bool operator==(const Telemetry::HistoryColumn& lhs, const Telemetry::HistoryColumn& rhs)
+{
+    return (rhs.values == lhs.values);
+}
+
+std::ostream& operator<<(std::ostream& str, Telemetry::HistoryColumn const& history_column)
+{
+    str << std::setprecision(15);
+    str << "history_column:" << '\n' << "{\n";
+    str << "    values: [";
+    for (auto it = history_column.values.begin(); it != history_column.values.end(); ++it) {
+        str << *it;
+        str << (it + 1 != history_column.values.end() ? ", " : "]\n");
+    }
+    str << '}';
+    return str;
+}
+
+bool operator==(const Telemetry::History& lhs, const Telemetry::History& rhs)
+{
+    return (rhs.time_us == lhs.time_us) && (rhs.columns == lhs.columns);
+}
+
+std::ostream& operator<<(std::ostream& str, Telemetry::History const& history)
+{
+    str << std::setprecision(15);
+    str << "history:" << '\n' << "{\n";
+    str << "    time_us: [";
+    for (auto it = history.time_us.begin(); it != history.time_us.end(); ++it) {
+        str << *it;
+        str << (it + 1 != history.time_us.end() ? ", " : "]\n");
+    }
+    str << "    columns: [";
+    for (auto it = history.columns.begin(); it != history.columns.end(); ++it) {
+        str << *it;
+        str << (it + 1 != history.columns.end() ? ", " : "]\n");
+    }
+    str << '}';
+    return str;
+}
+
+bool operator==(const Telemetry::HistoryStatistics& lhs, const Telemetry::HistoryStatistics& rhs)
+{
+    return (rhs.count == lhs.count) && (rhs.min == lhs.min) && (rhs.max == lhs.max) &&
+           (rhs.mean == lhs.mean);
+}
+
+std::ostream& operator<<(std::ostream& str, Telemetry::HistoryStatistics const& history_statistics)
+{
+    str << std::setprecision(15);
+    str << "history_statistics:" << '\n' << "{\n";
+    str << "    count: " << history_statistics.count << '\n';
+    str << "    min: [";
+    for (auto it = history_statistics.min.begin(); it != history_statistics.min.end(); ++it) {
+        str << *it;
+        str << (it + 1 != history_statistics.min.end() ? ", " : "]\n");
+    }
+    str << "    max: [";
+    for (auto it = history_statistics.max.begin(); it != history_statistics.max.end(); ++it) {
+        str << *it;
+        str << (it + 1 != history_statistics.max.end() ? ", " : "]\n");
+    }
+    str << "    mean: [";
+    for (auto it = history_statistics.mean.begin(); it != history_statistics.mean.end(); ++it) {
+        str << *it;
+        str << (it + 1 != history_statistics.mean.end() ? ", " : "]\n");
+    }
+    str << '}';
+    return str;
+}
+
 std::ostream& operator<<(std::ostream& str, Telemetry::Result const& result)
 {
     switch (result) {
@@ -1100,4 +1245,32 @@ std::ostream& operator<<(std::ostream& str, Telemetry::LandedState const& landed
     }
 }
 
+std::ostream& operator<<(std::ostream& str, Telemetry::HistoryField const& history_field)
+{
+    switch (history_field) {
+        case Telemetry::HistoryField::Position:
+            return str << "Position";
+        case Telemetry::HistoryField::VelocityNed:
+            return str << "Velocity Ned";
+        case Telemetry::HistoryField::PositionVelocityNed:
+            return str << "Position Velocity Ned";
+        case Telemetry::HistoryField::AttitudeQuaternion:
+            return str << "Attitude Quaternion";
+        case Telemetry::HistoryField::AttitudeEuler:
+            return str << "Attitude Euler";
+        case Telemetry::HistoryField::AngularVelocityBody:
+            return str << "Angular Velocity Body";
+        case Telemetry::HistoryField::Imu:
+            return str << "Imu";
+        case Telemetry::HistoryField::Battery:
+            return str << "Battery";
+        case Telemetry::HistoryField::FixedwingMetrics:
+            return str << "Fixedwing Metrics";
+        case Telemetry::HistoryField::GroundTruth:
+            return str << "Ground Truth";
+        default:
+            return str << "Unknown";
+    }
+}
+
 } // namespace mavsdk
\ No newline at end of file
@@ -0,0 +1,244 @@
+#include "telemetry_history.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace mavsdk {
+
+TimeSeries::TimeSeries(std::size_t capacity, std::size_t num_components) :
+    _capacity(capacity),
+    _num_components(num_components),
+    _times_us(capacity),
+    _values(capacity * num_components)
+{}
+
+std::size_t TimeSeries::memory_bytes(std::size_t capacity, std::size_t num_components)
+{
+    return capacity * (sizeof(uint64_t) + num_components * sizeof(double));
+}
+
+void TimeSeries::push(uint64_t time_us, const double* values)
+{
+    if (_size > 0) {
+        time_us = std::max(time_us, _times_us[physical(_size - 1)]);
+    }
+
+    std::size_t i;
+    if (_size < _capacity) {
+        i = physical(_size);
+        ++_size;
+    } else {
+        // Full, overwrite the oldest.
+        i = _start;
+        _start = (_start + 1) % _capacity;
+    }
+
+    _times_us[i] = time_us;
+    for (std::size_t component = 0; component < _num_components; ++component) {
+        _values[component * _capacity + i] = values[component];
+    }
+}
+
+std::size_t TimeSeries::lower_bound(uint64_t time_us) const
+{
+    std::size_t first = 0;
+    std::size_t count = _size;
+    while (count > 0) {
+        const std::size_t step = count / 2;
+        if (_times_us[physical(first + step)] < time_us) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    return first;
+}
+
+Telemetry::History
+TimeSeries::query(uint64_t start_time_us, uint64_t end_time_us, std::size_t max_samples) const
+{
+    Telemetry::History history{};
+    history.columns.resize(_num_components);
+
+    const std::size_t begin = lower_bound(start_time_us);
+    const std::size_t end = (end_time_us == std::numeric_limits<uint64_t>::max()) ?
+                                _size :
+                                lower_bound(end_time_us + 1);
+    if (begin >= end) {
+        return history;
+    }
+
+    const std::size_t count = end - begin;
+    const std::size_t num_buckets = (max_samples > 0) ? std::min(count, max_samples) : count;
+
+    if (num_buckets == count) {
+        // Nothing to average, copy the columns in at most two parts.
+        const std::size_t first = physical(begin);
+        const std::size_t first_part = std::min(count, _capacity - first);
+
+        auto copy = [&](const uint64_t* from_times_us, const double* from_values, std::size_t n) {
+            history.time_us.insert(history.time_us.end(), from_times_us, from_times_us + n);
+            for (std::size_t component = 0; component < _num_components; ++component) {
+                const double* column = from_values + component * _capacity;
+                auto& values = history.columns[component].values;
+                values.insert(values.end(), column, column + n);
+            }
+        };
+        copy(&_times_us[first], &_values[first], first_part);
+        copy(&_times_us[0], &_values[0], count - first_part);
+        return history;
+    }
+
+    history.time_us.reserve(num_buckets);
+    for (auto& column : history.columns) {
+        column.values.reserve(num_buckets);
+    }
+
+    // Downsample by averaging buckets of (almost) the same number of samples.
+    for (std::size_t bucket = 0; bucket < num_buckets; ++bucket) {
+        const std::size_t bucket_begin = begin + bucket * count / num_buckets;
+        const std::size_t bucket_end = begin + (bucket + 1) * count / num_buckets;
+        const std::size_t bucket_size = bucket_end - bucket_begin;
+
+        const std::size_t first = physical(bucket_begin);
+
+        const uint64_t first_time_us = _times_us[first];
+        uint64_t time_offset_sum_us = 0;
+        for (std::size_t n = 0, i = first; n < bucket_size; ++n, i = next(i)) {
+            time_offset_sum_us += _times_us[i] - first_time_us;
+        }
+        history.time_us.push_back(first_time_us + time_offset_sum_us / bucket_size);
+
+        for (std::size_t component = 0; component < _num_components; ++component) {
+            const double* column = &_values[component * _capacity];
+            double sum = 0.0;
+            for (std::size_t n = 0, i = first; n < bucket_size; ++n, i = next(i)) {
+                sum += column[i];
+            }
+            history.columns[component].values.push_back(sum / double(bucket_size));
+        }
+    }
+
+    return history;
+}
+
+Telemetry::HistoryStatistics
+TimeSeries::statistics(uint64_t start_time_us, uint64_t end_time_us) const
+{
+    Telemetry::HistoryStatistics statistics{};
+
+    const std::size_t begin = lower_bound(start_time_us);
+    const std::size_t end = (end_time_us == std::numeric_limits<uint64_t>::max()) ?
+                                _size :
+                                lower_bound(end_time_us + 1);
+
+    statistics.count = (end > begin) ? end - begin : 0;
+
+    for (std::size_t component = 0; component < _num_components; ++component) {
+        const double* column = &_values[component * _capacity];
+        // Missing values (NaN) are skipped.
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+        double sum = 0.0;
+        std::size_t num_values = 0;
+        for (std::size_t n = 0, i = physical(begin); n < statistics.count; ++n, i = next(i)) {
+            const double v = column[i];
+            if (std::isnan(v)) {
+                continue;
+            }
+            min = (v < min) ? v : min;
+            max = (v > max) ? v : max;
+            sum += v;
+            ++num_values;
+        }
+
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        statistics.min.push_back((num_values > 0) ? min : nan);
+        statistics.max.push_back((num_values > 0) ? max : nan);
+        statistics.mean.push_back((num_values > 0) ? sum / double(num_values) : nan);
+    }
+
+    return statistics;
+}
+
+std::size_t TelemetryHistory::num_components(Telemetry::HistoryField field)
+{
+    switch (field) {
+        case Telemetry::HistoryField::Position:
+            return 4;
+        case Telemetry::HistoryField::VelocityNed:
+            return 3;
+        case Telemetry::HistoryField::PositionVelocityNed:
+            return 6;
+        case Telemetry::HistoryField::AttitudeQuaternion:
+            return 4;
+        case Telemetry::HistoryField::AttitudeEuler:
+            return 3;
+        case Telemetry::HistoryField::AngularVelocityBody:
+            return 3;
+        case Telemetry::HistoryField::Imu:
+            return 10;
+        case Telemetry::HistoryField::Battery:
+            return 2;
+        case Telemetry::HistoryField::FixedwingMetrics:
+            return 3;
+        case Telemetry::HistoryField::GroundTruth:
+            return 3;
+    }
+    return 0;
+}
+
+void TelemetryHistory::set_capacity(Telemetry::HistoryField field, std::size_t capacity)
+{
+    auto& slot = _slots[index(field)];
+
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    slot.enabled = false;
+    slot.time_series.reset();
+
+    if (capacity > 0) {
+        slot.time_series.reset(new TimeSeries(capacity, num_components(field)));
+        slot.enabled = true;
+    }
+}
+
+void TelemetryHistory::record(Telemetry::HistoryField field, uint64_t time_us, const double* values)
+{
+    auto& slot = _slots[index(field)];
+
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    if (slot.time_series) {
+        slot.time_series->push(time_us, values);
+    }
+}
+
+Telemetry::History TelemetryHistory::query(
+    Telemetry::HistoryField field,
+    uint64_t start_time_us,
+    uint64_t end_time_us,
+    std::size_t max_samples) const
+{
+    const auto& slot = _slots[index(field)];
+
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    if (!slot.time_series) {
+        return Telemetry::History{};
+    }
+    return slot.time_series->query(start_time_us, end_time_us, max_samples);
+}
+
+Telemetry::HistoryStatistics TelemetryHistory::statistics(
+    Telemetry::HistoryField field, uint64_t start_time_us, uint64_t end_time_us) const
+{
+    const auto& slot = _slots[index(field)];
+
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    if (!slot.time_series) {
+        return Telemetry::HistoryStatistics{};
+    }
+    return slot.time_series->statistics(start_time_us, end_time_us);
+}
+
+} // namespace mavsdk
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "plugins/telemetry/telemetry.h"
+
+namespace mavsdk {
+
+// Fixed capacity history of one telemetry field.
+//
+// Samples are kept in a ring buffer in columnar layout: one column for the
+// timestamps and one per component of the field, so queries and aggregates
+// over a component only touch its own column. Once full, the oldest samples
+// are overwritten.
+//
+// Timestamps have to be increasing so that ranges can be found by binary
+// search, a timestamp earlier than the previous one is clamped to it.
+class TimeSeries {
+public:
+    TimeSeries(std::size_t capacity, std::size_t num_components);
+    ~TimeSeries() = default;
+
+    void push(uint64_t time_us, const double* values);
+
+    Telemetry::History
+    query(uint64_t start_time_us, uint64_t end_time_us, std::size_t max_samples) const;
+    Telemetry::HistoryStatistics statistics(uint64_t start_time_us, uint64_t end_time_us) const;
+
+    std::size_t size() const { return _size; }
+    std::size_t capacity() const { return _capacity; }
+
+    static std::size_t memory_bytes(std::size_t capacity, std::size_t num_components);
+
+private:
+    // Index of the sample which is the nth oldest.
+    std::size_t physical(std::size_t nth) const { return (_start + nth) % _capacity; }
+    std::size_t next(std::size_t i) const { return (i + 1 == _capacity) ? 0 : i + 1; }
+
+    // First sample not before time_us.
+    std::size_t lower_bound(uint64_t time_us) const;
+
+    const std::size_t _capacity;
+    const std::size_t _num_components;
+    std::size_t _start{0};
+    std::size_t _size{0};
+
+    std::vector<uint64_t> _times_us;
+    std::vector<double> _values;
+};
+
+// History of all telemetry fields which have it enabled.
+class TelemetryHistory {
+public:
+    TelemetryHistory() = default;
+    ~TelemetryHistory() = default;
+
+    // Delete copy and move constructors and assign operators.
+    TelemetryHistory(TelemetryHistory const&) = delete;
+    TelemetryHistory(TelemetryHistory&&) = delete;
+    TelemetryHistory& operator=(TelemetryHistory const&) = delete;
+    TelemetryHistory& operator=(TelemetryHistory&&) = delete;
+
+    // A capacity of 0 disables it, changing it drops the history so far.
+    void set_capacity(Telemetry::HistoryField field, std::size_t capacity);
+
+    bool is_enabled(Telemetry::HistoryField field) const
+    {
+        return _slots[index(field)].enabled.load(std::memory_order_relaxed);
+    }
+
+    // The number of values needs to match num_components for the field.
+    void record(Telemetry::HistoryField field, uint64_t time_us, const double* values);
+
+    Telemetry::History query(
+        Telemetry::HistoryField field,
+        uint64_t start_time_us,
+        uint64_t end_time_us,
+        std::size_t max_samples) const;
+    Telemetry::HistoryStatistics statistics(
+        Telemetry::HistoryField field, uint64_t start_time_us, uint64_t end_time_us) const;
+
+    static std::size_t num_components(Telemetry::HistoryField field);
+
+private:
+    static constexpr std::size_t num_fields =
+        static_cast<std::size_t>(Telemetry::HistoryField::GroundTruth) + 1;
+
+    static std::size_t index(Telemetry::HistoryField field)
+    {
+        return static_cast<std::size_t>(field);
+    }
+
+    struct Slot {
+        std::atomic<bool> enabled{false};
+        mutable std::mutex mutex{};
+        std::unique_ptr<TimeSeries> time_series{};
+    };
+
+    std::array<Slot, num_fields> _slots{};
+};
+
+} // namespace mavsdk
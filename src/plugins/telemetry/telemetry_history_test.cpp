@@ -0,0 +1,129 @@
+#include "telemetry_history.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+
+using namespace mavsdk;
+
+namespace {
+
+constexpr uint64_t all_time_us = std::numeric_limits<uint64_t>::max();
+
+void push(TimeSeries& time_series, uint64_t time_us, double value)
+{
+    const double values[2] = {value, -value};
+    time_series.push(time_us, values);
+}
+
+} // namespace
+
+TEST(TelemetryHistory, QueryRange)
+{
+    TimeSeries time_series(10, 2);
+    for (uint64_t i = 0; i < 5; ++i) {
+        push(time_series, 1000 + i * 100, double(i));
+    }
+
+    const auto all = time_series.query(0, all_time_us, 0);
+    EXPECT_EQ(all.time_us, (std::vector<uint64_t>{1000, 1100, 1200, 1300, 1400}));
+    ASSERT_EQ(all.columns.size(), 2);
+    EXPECT_EQ(all.columns[0].values, (std::vector<double>{0.0, 1.0, 2.0, 3.0, 4.0}));
+    EXPECT_EQ(all.columns[1].values, (std::vector<double>{-0.0, -1.0, -2.0, -3.0, -4.0}));
+
+    // Both ends are inclusive.
+    const auto range = time_series.query(1100, 1300, 0);
+    EXPECT_EQ(range.time_us, (std::vector<uint64_t>{1100, 1200, 1300}));
+    EXPECT_EQ(range.columns[0].values, (std::vector<double>{1.0, 2.0, 3.0}));
+
+    const auto between = time_series.query(1150, 1250, 0);
+    EXPECT_EQ(between.time_us, (std::vector<uint64_t>{1200}));
+
+    const auto outside = time_series.query(2000, 3000, 0);
+    EXPECT_TRUE(outside.time_us.empty());
+    EXPECT_TRUE(outside.columns[0].values.empty());
+}
+
+TEST(TelemetryHistory, OverwritesOldest)
+{
+    TimeSeries time_series(4, 2);
+    for (uint64_t i = 0; i < 10; ++i) {
+        push(time_series, i, double(i));
+    }
+    EXPECT_EQ(time_series.size(), 4);
+
+    const auto all = time_series.query(0, all_time_us, 0);
+    EXPECT_EQ(all.time_us, (std::vector<uint64_t>{6, 7, 8, 9}));
+    EXPECT_EQ(all.columns[0].values, (std::vector<double>{6.0, 7.0, 8.0, 9.0}));
+
+    const auto range = time_series.query(0, 7, 0);
+    EXPECT_EQ(range.time_us, (std::vector<uint64_t>{6, 7}));
+}
+
+TEST(TelemetryHistory, TimeGoingBackwardsIsClamped)
+{
+    TimeSeries time_series(4, 2);
+    push(time_series, 100, 1.0);
+    push(time_series, 50, 2.0);
+    push(time_series, 200, 3.0);
+
+    const auto all = time_series.query(0, all_time_us, 0);
+    EXPECT_EQ(all.time_us, (std::vector<uint64_t>{100, 100, 200}));
+}
+
+TEST(TelemetryHistory, Downsampling)
+{
+    TimeSeries time_series(100, 2);
+    for (uint64_t i = 0; i < 10; ++i) {
+        push(time_series, i * 10, double(i));
+    }
+
+    const auto downsampled = time_series.query(0, all_time_us, 5);
+    EXPECT_EQ(downsampled.time_us, (std::vector<uint64_t>{5, 25, 45, 65, 85}));
+    EXPECT_EQ(downsampled.columns[0].values, (std::vector<double>{0.5, 2.5, 4.5, 6.5, 8.5}));
+
+    // Uneven buckets.
+    const auto three = time_series.query(0, all_time_us, 3);
+    EXPECT_EQ(three.columns[0].values, (std::vector<double>{1.0, 4.0, 7.5}));
+
+    // Fewer samples than requested.
+    EXPECT_EQ(time_series.query(0, all_time_us, 50).time_us.size(), 10);
+}
+
+TEST(TelemetryHistory, Statistics)
+{
+    TimeSeries time_series(100, 2);
+    for (uint64_t i = 0; i < 10; ++i) {
+        push(time_series, i, double(i));
+    }
+    push(time_series, 10, std::numeric_limits<double>::quiet_NaN());
+
+    auto statistics = time_series.statistics(2, 10);
+    EXPECT_EQ(statistics.count, 9);
+    EXPECT_EQ(statistics.min, (std::vector<double>{2.0, -9.0}));
+    EXPECT_EQ(statistics.max, (std::vector<double>{9.0, -2.0}));
+    EXPECT_EQ(statistics.mean, (std::vector<double>{5.5, -5.5}));
+
+    statistics = time_series.statistics(100, 200);
+    EXPECT_EQ(statistics.count, 0);
+    EXPECT_TRUE(std::isnan(statistics.mean[0]));
+}
+
+TEST(TelemetryHistory, OptIn)
+{
+    TelemetryHistory history{};
+    EXPECT_FALSE(history.is_enabled(Telemetry::HistoryField::Battery));
+    EXPECT_TRUE(history.query(Telemetry::HistoryField::Battery, 0, all_time_us, 0).time_us.empty());
+
+    history.set_capacity(Telemetry::HistoryField::Battery, 10);
+    EXPECT_TRUE(history.is_enabled(Telemetry::HistoryField::Battery));
+    EXPECT_FALSE(history.is_enabled(Telemetry::HistoryField::Position));
+
+    const double values[2] = {12.3, 0.5};
+    history.record(Telemetry::HistoryField::Battery, 42, values);
+    const auto result = history.query(Telemetry::HistoryField::Battery, 0, all_time_us, 0);
+    EXPECT_EQ(result.time_us, (std::vector<uint64_t>{42}));
+    EXPECT_EQ(result.columns[1].values, (std::vector<double>{0.5}));
+
+    history.set_capacity(Telemetry::HistoryField::Battery, 0);
+    EXPECT_FALSE(history.is_enabled(Telemetry::HistoryField::Battery));
+}
@@ -107,6 +107,8 @@ void TelemetryImpl::init()
 
     _parent->register_param_changed_handler(
         std::bind(&TelemetryImpl::process_parameter_update, this, _1), this);
+
+    set_flight_mode(telemetry_flight_mode_from_flight_mode(_parent->get_flight_mode()));
 }
 
 void TelemetryImpl::deinit()
@@ -843,6 +845,11 @@ void TelemetryImpl::process_heartbeat(const mavlink_message_t& message)
 
     set_armed(((heartbeat.base_mode & MAV_MODE_FLAG_SAFETY_ARMED) ? true : false));
 
+    // The flight mode is already parsed in SystemImpl, so we can take it
+    // from there.  This assumes that SystemImpl gets called first because
+    // it's earlier in the callback list.
+    set_flight_mode(telemetry_flight_mode_from_flight_mode(_parent->get_flight_mode()));
+
     if (_armed_subscription) {
         auto callback = _armed_subscription;
         auto arg = armed();
@@ -851,10 +858,7 @@ void TelemetryImpl::process_heartbeat(const mavlink_message_t& message)
 
     if (_flight_mode_subscription) {
         auto callback = _flight_mode_subscription;
-        // The flight mode is already parsed in SystemImpl, so we can take it
-        // from there.  This assumes that SystemImpl gets called first because
-        // it's earlier in the callback list.
-        auto arg = telemetry_flight_mode_from_flight_mode(_parent->get_flight_mode());
+        auto arg = flight_mode();
         _parent->call_user_callback([callback, arg]() { callback(arg); });
     }
 
@@ -1181,53 +1185,63 @@ void TelemetryImpl::receive_unix_epoch_timeout()
 
 Telemetry::PositionVelocityNed TelemetryImpl::position_velocity_ned() const
 {
-    std::lock_guard<std::mutex> lock(_position_velocity_ned_mutex);
-    return _position_velocity_ned;
+    return _state.load(&Telemetry::Snapshot::position_velocity_ned);
 }
 
 void TelemetryImpl::set_position_velocity_ned(Telemetry::PositionVelocityNed position_velocity_ned)
 {
-    std::lock_guard<std::mutex> lock(_position_velocity_ned_mutex);
-    _position_velocity_ned = position_velocity_ned;
+    _state.store(&Telemetry::Snapshot::position_velocity_ned, position_velocity_ned);
+
+    record_history(
+        Telemetry::HistoryField::PositionVelocityNed,
+        {position_velocity_ned.position.north_m,
+         position_velocity_ned.position.east_m,
+         position_velocity_ned.position.down_m,
+         position_velocity_ned.velocity.north_m_s,
+         position_velocity_ned.velocity.east_m_s,
+         position_velocity_ned.velocity.down_m_s});
 }
 
 Telemetry::Position TelemetryImpl::position() const
 {
-    std::lock_guard<std::mutex> lock(_position_mutex);
-    return _position;
+    return _state.load(&Telemetry::Snapshot::position);
 }
 
 void TelemetryImpl::set_position(Telemetry::Position position)
 {
-    std::lock_guard<std::mutex> lock(_position_mutex);
-    _position = position;
+    _state.store(&Telemetry::Snapshot::position, position);
+
+    record_history(
+        Telemetry::HistoryField::Position,
+        {position.latitude_deg,
+         position.longitude_deg,
+         position.absolute_altitude_m,
+         position.relative_altitude_m});
 }
 
 Telemetry::Position TelemetryImpl::home() const
 {
-    std::lock_guard<std::mutex> lock(_home_position_mutex);
-    return _home_position;
+    return _state.load(&Telemetry::Snapshot::home);
 }
 
 void TelemetryImpl::set_home_position(Telemetry::Position home_position)
 {
-    std::lock_guard<std::mutex> lock(_home_position_mutex);
-    _home_position = home_position;
+    _state.store(&Telemetry::Snapshot::home, home_position);
 }
 
 bool TelemetryImpl::armed() const
 {
-    return _armed;
+    return _state.load(&Telemetry::Snapshot::armed);
 }
 
 bool TelemetryImpl::in_air() const
 {
-    return _in_air;
+    return _state.load(&Telemetry::Snapshot::in_air);
 }
 
 void TelemetryImpl::set_in_air(bool in_air_new)
 {
-    _in_air = in_air_new;
+    _state.store(&Telemetry::Snapshot::in_air, in_air_new);
 }
 
 void TelemetryImpl::set_status_text(Telemetry::StatusText status_text)
@@ -1244,153 +1258,179 @@ Telemetry::StatusText TelemetryImpl::status_text() const
 
 void TelemetryImpl::set_armed(bool armed_new)
 {
-    _armed = armed_new;
+    _state.store(&Telemetry::Snapshot::armed, armed_new);
+}
+
+void TelemetryImpl::set_flight_mode(Telemetry::FlightMode flight_mode)
+{
+    _state.store(&Telemetry::Snapshot::flight_mode, flight_mode);
 }
 
 Telemetry::Quaternion TelemetryImpl::attitude_quaternion() const
 {
-    std::lock_guard<std::mutex> lock(_attitude_quaternion_mutex);
-    return _attitude_quaternion;
+    return _state.load(&Telemetry::Snapshot::attitude_quaternion);
 }
 
 Telemetry::AngularVelocityBody TelemetryImpl::attitude_angular_velocity_body() const
 {
-    std::lock_guard<std::mutex> lock(_attitude_angular_velocity_body_mutex);
-    return _attitude_angular_velocity_body;
+    return _state.load(&Telemetry::Snapshot::attitude_angular_velocity_body);
 }
 
 Telemetry::GroundTruth TelemetryImpl::ground_truth() const
 {
-    std::lock_guard<std::mutex> lock(_ground_truth_mutex);
-    return _ground_truth;
+    return _state.load(&Telemetry::Snapshot::ground_truth);
 }
 
 Telemetry::FixedwingMetrics TelemetryImpl::fixedwing_metrics() const
 {
-    std::lock_guard<std::mutex> lock(_fixedwing_metrics_mutex);
-    return _fixedwing_metrics;
+    return _state.load(&Telemetry::Snapshot::fixedwing_metrics);
 }
 
 Telemetry::EulerAngle TelemetryImpl::attitude_euler() const
 {
-    std::lock_guard<std::mutex> lock(_attitude_quaternion_mutex);
-    Telemetry::EulerAngle euler = to_euler_angle_from_quaternion(_attitude_quaternion);
-
-    return euler;
+    return to_euler_angle_from_quaternion(attitude_quaternion());
 }
 
 void TelemetryImpl::set_attitude_quaternion(Telemetry::Quaternion quaternion)
 {
-    std::lock_guard<std::mutex> lock(_attitude_quaternion_mutex);
-    _attitude_quaternion = quaternion;
+    _state.store(&Telemetry::Snapshot::attitude_quaternion, quaternion);
+
+    record_history(
+        Telemetry::HistoryField::AttitudeQuaternion,
+        {quaternion.w, quaternion.x, quaternion.y, quaternion.z});
+
+    if (_history.is_enabled(Telemetry::HistoryField::AttitudeEuler)) {
+        const auto euler_angle = to_euler_angle_from_quaternion(quaternion);
+        record_history(
+            Telemetry::HistoryField::AttitudeEuler,
+            {euler_angle.roll_deg, euler_angle.pitch_deg, euler_angle.yaw_deg});
+    }
 }
 
 void TelemetryImpl::set_attitude_angular_velocity_body(
     Telemetry::AngularVelocityBody angular_velocity_body)
 {
-    std::lock_guard<std::mutex> lock(_attitude_quaternion_mutex);
-    _attitude_angular_velocity_body = angular_velocity_body;
+    _state.store(&Telemetry::Snapshot::attitude_angular_velocity_body, angular_velocity_body);
+
+    record_history(
+        Telemetry::HistoryField::AngularVelocityBody,
+        {angular_velocity_body.roll_rad_s,
+         angular_velocity_body.pitch_rad_s,
+         angular_velocity_body.yaw_rad_s});
 }
 
 void TelemetryImpl::set_ground_truth(Telemetry::GroundTruth ground_truth)
 {
-    std::lock_guard<std::mutex> lock(_ground_truth_mutex);
-    _ground_truth = ground_truth;
+    _state.store(&Telemetry::Snapshot::ground_truth, ground_truth);
+
+    record_history(
+        Telemetry::HistoryField::GroundTruth,
+        {ground_truth.latitude_deg, ground_truth.longitude_deg, ground_truth.absolute_altitude_m});
 }
 
 void TelemetryImpl::set_fixedwing_metrics(Telemetry::FixedwingMetrics fixedwing_metrics)
 {
-    std::lock_guard<std::mutex> lock(_fixedwing_metrics_mutex);
-    _fixedwing_metrics = fixedwing_metrics;
+    _state.store(&Telemetry::Snapshot::fixedwing_metrics, fixedwing_metrics);
+
+    record_history(
+        Telemetry::HistoryField::FixedwingMetrics,
+        {fixedwing_metrics.airspeed_m_s,
+         fixedwing_metrics.throttle_percentage,
+         fixedwing_metrics.climb_rate_m_s});
 }
 
 Telemetry::Quaternion TelemetryImpl::camera_attitude_quaternion() const
 {
-    std::lock_guard<std::mutex> lock(_camera_attitude_euler_angle_mutex);
-    Telemetry::Quaternion quaternion = to_quaternion_from_euler_angle(_camera_attitude_euler_angle);
-
-    return quaternion;
+    return to_quaternion_from_euler_angle(camera_attitude_euler());
 }
 
 Telemetry::EulerAngle TelemetryImpl::camera_attitude_euler() const
 {
-    std::lock_guard<std::mutex> lock(_camera_attitude_euler_angle_mutex);
-
-    return _camera_attitude_euler_angle;
+    return _state.load(&Telemetry::Snapshot::camera_attitude_euler);
 }
 
 void TelemetryImpl::set_camera_attitude_euler_angle(Telemetry::EulerAngle euler_angle)
 {
-    std::lock_guard<std::mutex> lock(_camera_attitude_euler_angle_mutex);
-    _camera_attitude_euler_angle = euler_angle;
+    _state.store(&Telemetry::Snapshot::camera_attitude_euler, euler_angle);
 }
 
 Telemetry::VelocityNed TelemetryImpl::velocity_ned() const
 {
-    std::lock_guard<std::mutex> lock(_velocity_ned_mutex);
-    return _velocity_ned;
+    return _state.load(&Telemetry::Snapshot::velocity_ned);
 }
 
 void TelemetryImpl::set_velocity_ned(Telemetry::VelocityNed velocity_ned)
 {
-    std::lock_guard<std::mutex> lock(_velocity_ned_mutex);
-    _velocity_ned = velocity_ned;
+    _state.store(&Telemetry::Snapshot::velocity_ned, velocity_ned);
+
+    record_history(
+        Telemetry::HistoryField::VelocityNed,
+        {velocity_ned.north_m_s, velocity_ned.east_m_s, velocity_ned.down_m_s});
 }
 
 Telemetry::Imu TelemetryImpl::imu() const
 {
-    std::lock_guard<std::mutex> lock(_imu_reading_ned_mutex);
-    return _imu_reading_ned;
+    return _state.load(&Telemetry::Snapshot::imu);
 }
 
 void TelemetryImpl::set_imu_reading_ned(Telemetry::Imu imu_reading_ned)
 {
-    std::lock_guard<std::mutex> lock(_imu_reading_ned_mutex);
-    _imu_reading_ned = imu_reading_ned;
+    _state.store(&Telemetry::Snapshot::imu, imu_reading_ned);
+
+    record_history(
+        Telemetry::HistoryField::Imu,
+        {imu_reading_ned.acceleration_frd.forward_m_s2,
+         imu_reading_ned.acceleration_frd.right_m_s2,
+         imu_reading_ned.acceleration_frd.down_m_s2,
+         imu_reading_ned.angular_velocity_frd.forward_rad_s,
+         imu_reading_ned.angular_velocity_frd.right_rad_s,
+         imu_reading_ned.angular_velocity_frd.down_rad_s,
+         imu_reading_ned.magnetic_field_frd.forward_gauss,
+         imu_reading_ned.magnetic_field_frd.right_gauss,
+         imu_reading_ned.magnetic_field_frd.down_gauss,
+         imu_reading_ned.temperature_degc});
 }
 
 Telemetry::GpsInfo TelemetryImpl::gps_info() const
 {
-    std::lock_guard<std::mutex> lock(_gps_info_mutex);
-    return _gps_info;
+    return _state.load(&Telemetry::Snapshot::gps_info);
 }
 
 void TelemetryImpl::set_gps_info(Telemetry::GpsInfo gps_info)
 {
-    std::lock_guard<std::mutex> lock(_gps_info_mutex);
-    _gps_info = gps_info;
+    _state.store(&Telemetry::Snapshot::gps_info, gps_info);
 }
 
 Telemetry::Battery TelemetryImpl::battery() const
 {
-    std::lock_guard<std::mutex> lock(_battery_mutex);
-    return _battery;
+    return _state.load(&Telemetry::Snapshot::battery);
 }
 
 void TelemetryImpl::set_battery(Telemetry::Battery battery)
 {
-    std::lock_guard<std::mutex> lock(_battery_mutex);
-    _battery = battery;
+    _state.store(&Telemetry::Snapshot::battery, battery);
+
+    record_history(
+        Telemetry::HistoryField::Battery, {battery.voltage_v, battery.remaining_percent});
 }
 
 Telemetry::FlightMode TelemetryImpl::flight_mode() const
 {
-    return telemetry_flight_mode_from_flight_mode(_parent->get_flight_mode());
+    return _state.load(&Telemetry::Snapshot::flight_mode);
 }
 
 Telemetry::Health TelemetryImpl::health() const
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    return _health;
+    return _state.load(&Telemetry::Snapshot::health);
 }
 
 bool TelemetryImpl::health_all_ok() const
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    if (_health.is_gyrometer_calibration_ok && _health.is_accelerometer_calibration_ok &&
-        _health.is_magnetometer_calibration_ok && _health.is_level_calibration_ok &&
-        _health.is_local_position_ok && _health.is_global_position_ok &&
-        _health.is_home_position_ok) {
+    const auto health = _state.load(&Telemetry::Snapshot::health);
+    if (health.is_gyrometer_calibration_ok && health.is_accelerometer_calibration_ok &&
+        health.is_magnetometer_calibration_ok && health.is_level_calibration_ok &&
+        health.is_local_position_ok && health.is_global_position_ok &&
+        health.is_home_position_ok) {
         return true;
     } else {
         return false;
@@ -1399,14 +1439,54 @@ bool TelemetryImpl::health_all_ok() const
 
 Telemetry::RcStatus TelemetryImpl::rc_status() const
 {
-    std::lock_guard<std::mutex> lock(_rc_status_mutex);
-    return _rc_status;
+    return _state.load(&Telemetry::Snapshot::rc_status);
 }
 
 uint64_t TelemetryImpl::unix_epoch_time() const
 {
-    std::lock_guard<std::mutex> lock(_unix_epoch_time_mutex);
-    return _unix_epoch_time_us;
+    return _state.load(&Telemetry::Snapshot::unix_epoch_time_us);
+}
+
+Telemetry::Snapshot TelemetryImpl::snapshot() const
+{
+    auto snapshot = _state.load();
+    snapshot.attitude_euler = to_euler_angle_from_quaternion(snapshot.attitude_quaternion);
+    snapshot.camera_attitude_quaternion =
+        to_quaternion_from_euler_angle(snapshot.camera_attitude_euler);
+    return snapshot;
+}
+
+void TelemetryImpl::set_history_capacity(Telemetry::HistoryField field, uint32_t capacity)
+{
+    _history.set_capacity(field, capacity);
+}
+
+Telemetry::History TelemetryImpl::history(
+    Telemetry::HistoryField field,
+    uint64_t start_time_us,
+    uint64_t end_time_us,
+    uint32_t max_samples) const
+{
+    return _history.query(field, start_time_us, end_time_us, max_samples);
+}
+
+Telemetry::HistoryStatistics TelemetryImpl::history_statistics(
+    Telemetry::HistoryField field, uint64_t start_time_us, uint64_t end_time_us) const
+{
+    return _history.statistics(field, start_time_us, end_time_us);
+}
+
+void TelemetryImpl::record_history(
+    Telemetry::HistoryField field, std::initializer_list<double> values)
+{
+    if (!_history.is_enabled(field)) {
+        return;
+    }
+
+    const auto time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                             _parent->get_autopilot_time().now().time_since_epoch())
+                             .count();
+    _history.record(field, static_cast<uint64_t>(time_us), values.begin());
 }
 
 Telemetry::ActuatorControlTarget TelemetryImpl::actuator_control_target() const
@@ -1429,76 +1509,84 @@ Telemetry::Odometry TelemetryImpl::odometry() const
 
 void TelemetryImpl::set_health_local_position(bool ok)
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    _health.is_local_position_ok = ok;
+    _state.modify(&Telemetry::Snapshot::health, [ok](Telemetry::Health& health) {
+        health.is_local_position_ok = ok;
+    });
 }
 
 void TelemetryImpl::set_health_global_position(bool ok)
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    _health.is_global_position_ok = ok;
+    _state.modify(&Telemetry::Snapshot::health, [ok](Telemetry::Health& health) {
+        health.is_global_position_ok = ok;
+    });
 }
 
 void TelemetryImpl::set_health_home_position(bool ok)
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    _health.is_home_position_ok = ok;
+    _state.modify(&Telemetry::Snapshot::health, [ok](Telemetry::Health& health) {
+        health.is_home_position_ok = ok;
+    });
 }
 
 void TelemetryImpl::set_health_gyrometer_calibration(bool ok)
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    _health.is_gyrometer_calibration_ok = (ok || _hitl_enabled);
+    ok = (ok || _hitl_enabled);
+    _state.modify(&Telemetry::Snapshot::health, [ok](Telemetry::Health& health) {
+        health.is_gyrometer_calibration_ok = ok;
+    });
 }
 
 void TelemetryImpl::set_health_accelerometer_calibration(bool ok)
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    _health.is_accelerometer_calibration_ok = (ok || _hitl_enabled);
+    ok = (ok || _hitl_enabled);
+    _state.modify(&Telemetry::Snapshot::health, [ok](Telemetry::Health& health) {
+        health.is_accelerometer_calibration_ok = ok;
+    });
 }
 
 void TelemetryImpl::set_health_magnetometer_calibration(bool ok)
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    _health.is_magnetometer_calibration_ok = (ok || _hitl_enabled);
+    ok = (ok || _hitl_enabled);
+    _state.modify(&Telemetry::Snapshot::health, [ok](Telemetry::Health& health) {
+        health.is_magnetometer_calibration_ok = ok;
+    });
 }
 
 void TelemetryImpl::set_health_level_calibration(bool ok)
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    _health.is_level_calibration_ok = (ok || _hitl_enabled);
+    ok = (ok || _hitl_enabled);
+    _state.modify(&Telemetry::Snapshot::health, [ok](Telemetry::Health& health) {
+        health.is_level_calibration_ok = ok;
+    });
 }
 
 Telemetry::LandedState TelemetryImpl::landed_state() const
 {
-    std::lock_guard<std::mutex> lock(_landed_state_mutex);
-    return _landed_state;
+    return _state.load(&Telemetry::Snapshot::landed_state);
 }
 
 void TelemetryImpl::set_landed_state(Telemetry::LandedState landed_state)
 {
-    std::lock_guard<std::mutex> lock(_landed_state_mutex);
-    _landed_state = landed_state;
+    _state.store(&Telemetry::Snapshot::landed_state, landed_state);
 }
 
 void TelemetryImpl::set_rc_status(bool available, float signal_strength_percent)
 {
-    std::lock_guard<std::mutex> lock(_rc_status_mutex);
+    _state.modify(&Telemetry::Snapshot::rc_status, [&](Telemetry::RcStatus& rc_status) {
+        if (available) {
+            rc_status.was_available_once = true;
+            rc_status.signal_strength_percent = signal_strength_percent;
+        } else {
+            rc_status.signal_strength_percent = 0.0f;
+        }
 
-    if (available) {
-        _rc_status.was_available_once = true;
-        _rc_status.signal_strength_percent = signal_strength_percent;
-    } else {
-        _rc_status.signal_strength_percent = 0.0f;
-    }
-
-    _rc_status.is_available = available;
+        rc_status.is_available = available;
+    });
 }
 
 void TelemetryImpl::set_unix_epoch_time_us(uint64_t time_us)
 {
-    std::lock_guard<std::mutex> lock(_unix_epoch_time_mutex);
-    _unix_epoch_time_us = time_us;
+    _state.store(&Telemetry::Snapshot::unix_epoch_time_us, time_us);
 }
 
 void TelemetryImpl::set_actuator_control_target(uint8_t group, const std::vector<float>& controls)
@@ -1517,7 +1605,7 @@ void TelemetryImpl::set_actuator_output_status(uint32_t active, const std::vecto
 
 void TelemetryImpl::set_odometry(Telemetry::Odometry& odometry)
 {
-    std::lock_guard<std::mutex> lock(_actuator_output_status_mutex);
+    std::lock_guard<std::mutex> lock(_odometry_mutex);
     _odometry = odometry;
 }
 
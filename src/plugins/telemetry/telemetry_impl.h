@@ -1,12 +1,15 @@
 #pragma once
 
 #include <atomic>
+#include <initializer_list>
 #include <mutex>
 
 #include "plugins/telemetry/telemetry.h"
 #include "mavlink_include.h"
 #include "plugin_impl_base.h"
+#include "seqlock.h"
 #include "system.h"
+#include "telemetry_history.h"
 
 // Since not all vehicles support/require level calibration, this
 // is disabled for now.
@@ -91,6 +94,16 @@ public:
     Telemetry::ActuatorOutputStatus actuator_output_status() const;
     Telemetry::Odometry odometry() const;
     uint64_t unix_epoch_time() const;
+    Telemetry::Snapshot snapshot() const;
+
+    void set_history_capacity(Telemetry::HistoryField field, uint32_t capacity);
+    Telemetry::History history(
+        Telemetry::HistoryField field,
+        uint64_t start_time_us,
+        uint64_t end_time_us,
+        uint32_t max_samples) const;
+    Telemetry::HistoryStatistics history_statistics(
+        Telemetry::HistoryField field, uint64_t start_time_us, uint64_t end_time_us) const;
 
     void position_velocity_ned_async(Telemetry::PositionVelocityNedCallback& callback);
     void position_async(Telemetry::PositionCallback& callback);
@@ -131,6 +144,7 @@ private:
     void set_landed_state(Telemetry::LandedState landed_state);
     void set_status_text(Telemetry::StatusText status_text);
     void set_armed(bool armed);
+    void set_flight_mode(Telemetry::FlightMode flight_mode);
     void set_attitude_quaternion(Telemetry::Quaternion quaternion);
     void set_attitude_angular_velocity_body(Telemetry::AngularVelocityBody angular_velocity_body);
     void set_fixedwing_metrics(Telemetry::FixedwingMetrics fixedwing_metrics);
@@ -153,6 +167,8 @@ private:
     void set_actuator_output_status(uint32_t active, const std::vector<float>& actuators);
     void set_odometry(Telemetry::Odometry& odometry);
 
+    void record_history(Telemetry::HistoryField field, std::initializer_list<double> values);
+
     void process_position_velocity_ned(const mavlink_message_t& message);
     void process_global_position_int(const mavlink_message_t& message);
     void process_home_position(const mavlink_message_t& message);
@@ -197,64 +213,19 @@ private:
     static Telemetry::FlightMode
     telemetry_flight_mode_from_flight_mode(SystemImpl::FlightMode flight_mode);
 
-    // Make all fields thread-safe using mutexs
+    // Everything which can be copied trivially is kept in one seqlock, so
+    // getters never lock and don't contend with the receive thread, and
+    // snapshot() gets all fields consistently.
+    // The attitude euler and camera quaternion fields are left at their
+    // defaults here, snapshot() derives them from the other representation.
+    Seqlock<Telemetry::Snapshot> _state{};
+
+    // The rest is on the heap and can't go into the seqlock.
     // The mutexs are mutable so that the lock can get aqcuired in
     // methods marked const.
-    mutable std::mutex _position_mutex{};
-    Telemetry::Position _position{};
-
-    mutable std::mutex _position_velocity_ned_mutex{};
-    Telemetry::PositionVelocityNed _position_velocity_ned{};
-
-    mutable std::mutex _home_position_mutex{};
-    Telemetry::Position _home_position{};
-
-    // If possible, just use atomic instead of a mutex.
-    std::atomic_bool _in_air{false};
-    std::atomic_bool _armed{false};
-
     mutable std::mutex _status_text_mutex{};
     Telemetry::StatusText _status_text{};
 
-    mutable std::mutex _attitude_quaternion_mutex{};
-    Telemetry::Quaternion _attitude_quaternion{};
-
-    mutable std::mutex _camera_attitude_euler_angle_mutex{};
-    Telemetry::EulerAngle _camera_attitude_euler_angle{};
-
-    mutable std::mutex _attitude_angular_velocity_body_mutex{};
-    Telemetry::AngularVelocityBody _attitude_angular_velocity_body{};
-
-    mutable std::mutex _ground_truth_mutex{};
-    Telemetry::GroundTruth _ground_truth{};
-
-    mutable std::mutex _fixedwing_metrics_mutex{};
-    Telemetry::FixedwingMetrics _fixedwing_metrics{};
-
-    mutable std::mutex _velocity_ned_mutex{};
-    Telemetry::VelocityNed _velocity_ned{};
-
-    mutable std::mutex _imu_reading_ned_mutex{};
-    Telemetry::Imu _imu_reading_ned{};
-
-    mutable std::mutex _gps_info_mutex{};
-    Telemetry::GpsInfo _gps_info{};
-
-    mutable std::mutex _battery_mutex{};
-    Telemetry::Battery _battery{};
-
-    mutable std::mutex _health_mutex{};
-    Telemetry::Health _health{};
-
-    mutable std::mutex _landed_state_mutex{};
-    Telemetry::LandedState _landed_state{Telemetry::LandedState::Unknown};
-
-    mutable std::mutex _rc_status_mutex{};
-    Telemetry::RcStatus _rc_status{};
-
-    mutable std::mutex _unix_epoch_time_mutex{};
-    uint64_t _unix_epoch_time_us{};
-
     mutable std::mutex _actuator_control_target_mutex{};
     Telemetry::ActuatorControlTarget _actuator_control_target{};
 
@@ -264,6 +235,9 @@ private:
     mutable std::mutex _odometry_mutex{};
     Telemetry::Odometry _odometry{};
 
+    // Opt-in history of some of the fields above.
+    TelemetryHistory _history{};
+
     std::atomic<bool> _hitl_enabled{false};
 
     Telemetry::PositionVelocityNedCallback _position_velocity_ned_subscription{nullptr};